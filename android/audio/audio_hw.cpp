@@ -40,8 +40,10 @@
 
 #define AUDIO_DEVICE_NAME "/dev/anbox_audio"
 #define OUT_SAMPLING_RATE 44100
-#define OUT_BUFFER_SIZE 4096
-#define OUT_LATENCY_MS 20
+#define OUT_PERIOD_FRAMES 256
+// Number of periods the host keeps queued in front of the audio device
+// without any underruns.
+#define OUT_HOST_PERIODS 2
 #define IN_SAMPLING_RATE 8000
 #define IN_BUFFER_SIZE 320
 
@@ -58,6 +60,7 @@ struct generic_stream_out {
   struct generic_audio_device *dev;
   audio_devices_t device;
   int fd;
+  anbox::audio::StreamConfig config;
 };
 
 struct generic_stream_in {
@@ -76,7 +79,8 @@ static int out_set_sample_rate(struct audio_stream *stream, uint32_t rate) {
 }
 
 static size_t out_get_buffer_size(const struct audio_stream *stream) {
-  return OUT_BUFFER_SIZE;
+  const struct generic_stream_out *out = (const struct generic_stream_out *)stream;
+  return out->config.period_size();
 }
 
 static audio_channel_mask_t out_get_channels(const struct audio_stream *stream) {
@@ -164,7 +168,9 @@ static char *out_get_parameters(const struct audio_stream *stream, const char *k
 }
 
 static uint32_t out_get_latency(const struct audio_stream_out *stream) {
-  return OUT_LATENCY_MS;
+  const struct generic_stream_out *out = (const struct generic_stream_out *)stream;
+  // One period we are writing plus what the host keeps queued.
+  return (out->config.period_frames * (1 + OUT_HOST_PERIODS) * 1000) / out->config.sample_rate;
 }
 
 static int out_set_volume(struct audio_stream_out *stream, float left,
@@ -331,7 +337,8 @@ static int in_remove_audio_effect(const struct audio_stream *stream, effect_hand
   return 0;
 }
 
-static int connect_audio_server(const anbox::audio::ClientInfo::Type &type) {
+static int connect_audio_server(const anbox::audio::ClientInfo::Type &type,
+                                anbox::audio::StreamConfig *stream_config) {
   int fd = socket(AF_LOCAL, SOCK_STREAM, 0);
   if (fd < 0)
     return -errno;
@@ -349,20 +356,36 @@ static int connect_audio_server(const anbox::audio::ClientInfo::Type &type) {
   // We will send out client type information to the server and the
   // server will either deny the request by closing the connection
   // or by sending us the approved client details back.
-  anbox::audio::ClientInfo client_info{type};
+  // When a stream configuration is given we ask the server to negotiate
+  // it and use whatever it accepted.
+  auto type_flags = static_cast<uint8_t>(type);
+  if (stream_config)
+    type_flags |= anbox::audio::ClientInfo::negotiate_flag;
+
+  anbox::audio::ClientInfo client_info{static_cast<anbox::audio::ClientInfo::Type>(type_flags)};
   if (::write(fd, &client_info, sizeof(client_info)) < 0) {
     close(fd);
     return -EIO;
   }
 
+  if (stream_config && ::write(fd, stream_config, sizeof(*stream_config)) < 0) {
+    close(fd);
+    return -EIO;
+  }
+
   auto bytes_read = ::read(fd, &client_info, sizeof(client_info));
-  if (bytes_read < 0) {
+  if (bytes_read != sizeof(client_info)) {
     close(fd);
     return -EIO;
   }
 
-  // FIXME once we have real client details we need to check if we
-  // got everything we need or if anything is missing.
+  if (stream_config) {
+    bytes_read = ::read(fd, stream_config, sizeof(*stream_config));
+    if (bytes_read != sizeof(*stream_config)) {
+      close(fd);
+      return -EIO;
+    }
+  }
 
   ALOGE("Successfully connected Anbox audio server");
 
@@ -379,6 +402,7 @@ static int adev_open_output_stream(struct audio_hw_device *dev,
   struct generic_audio_device *adev = (struct generic_audio_device *)dev;
   struct generic_stream_out *out;
   int ret = 0, fd = 0;
+  anbox::audio::StreamConfig stream_config;
 
   pthread_mutex_lock(&adev->lock);
   if (adev->output != NULL) {
@@ -386,13 +410,6 @@ static int adev_open_output_stream(struct audio_hw_device *dev,
     goto error;
   }
 
-  fd = connect_audio_server(anbox::audio::ClientInfo::Type::Playback);
-  if (fd < 0) {
-    ret = fd;
-    ALOGE("Failed to connect with Anbox audio servers (err %d)", ret);
-    goto error;
-  }
-
   if ((config->format != AUDIO_FORMAT_PCM_16_BIT) ||
       (config->channel_mask != AUDIO_CHANNEL_OUT_STEREO) ||
       (config->sample_rate != OUT_SAMPLING_RATE)) {
@@ -405,8 +422,29 @@ static int adev_open_output_stream(struct audio_hw_device *dev,
     goto error;
   }
 
+  stream_config = {OUT_SAMPLING_RATE, 2, anbox::audio::StreamConfig::Format::S16,
+                   0, OUT_PERIOD_FRAMES};
+  fd = connect_audio_server(anbox::audio::ClientInfo::Type::Playback, &stream_config);
+  if (fd < 0) {
+    ret = fd;
+    ALOGE("Failed to connect with Anbox audio servers (err %d)", ret);
+    goto error;
+  }
+
+  // We only ever ask for what Android gave us so the server must not
+  // have changed anything but the period size.
+  if (stream_config.sample_rate != OUT_SAMPLING_RATE ||
+      stream_config.channels != 2 ||
+      stream_config.format != anbox::audio::StreamConfig::Format::S16) {
+    ALOGE("Audio server didn't accept our stream configuration");
+    close(fd);
+    ret = -EINVAL;
+    goto error;
+  }
+
   out = (struct generic_stream_out *)calloc(1, sizeof(struct generic_stream_out));
   out->fd = fd;
+  out->config = stream_config;
 
   out->stream.common.get_sample_rate = out_get_sample_rate;
   out->stream.common.set_sample_rate = out_set_sample_rate;
@@ -540,7 +578,7 @@ static int adev_open_input_stream(struct audio_hw_device *dev,
     goto error;
   }
 
-  fd = connect_audio_server(anbox::audio::ClientInfo::Type::Recording);
+  fd = connect_audio_server(anbox::audio::ClientInfo::Type::Recording, nullptr);
   if (fd < 0) {
     ret = fd;
     ALOGE("Failed to connect with Anbox audio servers (err %d)", ret);
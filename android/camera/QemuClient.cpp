@@ -22,6 +22,9 @@
 #define LOG_NDEBUG 1
 #define LOG_TAG "EmulatedCamera_QemuClient"
 #include <cutils/log.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
 #include "EmulatedCamera.h"
 #include "QemuClient.h"
 
@@ -433,14 +436,44 @@ const char CameraQemuClient::mQueryStop[]       = "stop";
 /* Get next video frame from the camera device. */
 const char CameraQemuClient::mQueryFrame[]      = "frame";
 
+/*
+ * Layout of the frame ring shared by the camera service. This has to match
+ * anbox::camera::FrameRing on the host: a page with the ring header followed
+ * by the slots, each starting on its own page with a 64 byte slot header in
+ * front of the frame data. Each slot is guarded by a sequence which is odd
+ * while the host writes to it.
+ */
+
+static const uint32_t kFrameRingMagic           = 0x616e6672;
+static const uint32_t kFrameRingVersion         = 1;
+static const size_t   kFrameRingPageSize        = 4096;
+static const size_t   kFrameRingSlotHeaderSize  = 64;
+
+struct FrameRingHeader {
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    slot_count;
+    uint32_t    reserved;
+    uint64_t    slot_size;
+    uint64_t    slot_stride;
+};
+
+struct FrameRingSlot {
+    uint64_t    sequence;
+    uint32_t    video_size;
+    uint32_t    preview_size;
+};
+
 CameraQemuClient::CameraQemuClient()
-    : QemuClient()
+    : QemuClient(),
+      mFrameRing(NULL),
+      mFrameRingSize(0)
 {
 }
 
 CameraQemuClient::~CameraQemuClient()
 {
-
+    detachFrameRing();
 }
 
 status_t CameraQemuClient::queryConnect()
@@ -460,6 +493,8 @@ status_t CameraQemuClient::queryDisconnect()
 {
     ALOGV("%s", __FUNCTION__);
 
+    detachFrameRing();
+
     QemuQuery query(mQueryDisconnect);
     doQuery(&query);
     const status_t res = query.getCompletionStatus();
@@ -476,14 +511,24 @@ status_t CameraQemuClient::queryStart(uint32_t pixel_format,
     ALOGV("%s", __FUNCTION__);
 
     char query_str[256];
-    snprintf(query_str, sizeof(query_str), "%s dim=%dx%d pix=%d",
+    snprintf(query_str, sizeof(query_str), "%s dim=%dx%d pix=%d shm",
              mQueryStart, width, height, pixel_format);
     QemuQuery query(query_str);
     doQuery(&query);
-    const status_t res = query.getCompletionStatus();
+    status_t res = query.getCompletionStatus();
     ALOGE_IF(res != NO_ERROR, "%s: Query failed: %s",
             __FUNCTION__, query.mReplyData ? query.mReplyData :
                                              "No error message");
+
+    /* Services which don't support the frame ring just reply 'ok' and keep
+     * sending frames with the frame replies. */
+    if (res == NO_ERROR && query.mReplyData != NULL &&
+        !strncmp(query.mReplyData, "shm=", 4)) {
+        res = attachFrameRing(query.mReplyData + 4);
+        if (res != NO_ERROR) {
+            queryStop();
+        }
+    }
     return res;
 }
 
@@ -491,6 +536,8 @@ status_t CameraQemuClient::queryStop()
 {
     ALOGV("%s", __FUNCTION__);
 
+    detachFrameRing();
+
     QemuQuery query(mQueryStop);
     doQuery(&query);
     const status_t res = query.getCompletionStatus();
@@ -526,6 +573,11 @@ status_t CameraQemuClient::queryFrame(void* vframe,
         return res;
     }
 
+    if (mFrameRing != NULL) {
+        return readFrameSlot(query.mReplyData, vframe, pframe, vframe_size,
+                             pframe_size);
+    }
+
     /* Copy requested frames. */
     size_t cur_offset = 0;
     const uint8_t* frame = reinterpret_cast<const uint8_t*>(query.mReplyData);
@@ -556,4 +608,141 @@ status_t CameraQemuClient::queryFrame(void* vframe,
     return NO_ERROR;
 }
 
+status_t CameraQemuClient::attachFrameRing(const char* params)
+{
+    ALOGV("%s: '%s'", __FUNCTION__, params);
+
+    /* The memfd comes right after the reply, attached to a dummy byte which
+     * has to be consumed here so it doesn't end up in the next reply. */
+    char dummy = 0;
+    struct iovec iov;
+    iov.iov_base = &dummy;
+    iov.iov_len = 1;
+    char control[CMSG_SPACE(sizeof(int))];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t received;
+    do {
+        received = recvmsg(mPipeFD, &msg, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+    if (received != 1) {
+        ALOGE("%s: Unable to receive the frame ring: %s",
+             __FUNCTION__, received < 0 ? strerror(errno) : "Connection closed");
+        return received < 0 && errno ? errno : EIO;
+    }
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET ||
+        cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(sizeof(int))) {
+        ALOGE("%s: Frame ring reply doesn't carry a file descriptor", __FUNCTION__);
+        return EIO;
+    }
+    int fd = -1;
+    memcpy(&fd, CMSG_DATA(cmsg), sizeof(fd));
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 ||
+        static_cast<size_t>(st.st_size) <= kFrameRingPageSize) {
+        ALOGE("%s: Invalid frame ring memory", __FUNCTION__);
+        close(fd);
+        return EINVAL;
+    }
+
+    const size_t size = st.st_size;
+    void* ring = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ring == MAP_FAILED) {
+        ALOGE("%s: Unable to map the frame ring: %s", __FUNCTION__, strerror(errno));
+        return errno ? errno : ENOMEM;
+    }
+
+    unsigned int slots = 0;
+    unsigned long long slot_size = 0;
+    const FrameRingHeader* header = reinterpret_cast<const FrameRingHeader*>(ring);
+    if (sscanf(params, "%u,%llu", &slots, &slot_size) != 2 ||
+        header->magic != kFrameRingMagic || header->version != kFrameRingVersion ||
+        header->slot_count != slots || header->slot_size != slot_size ||
+        header->slot_stride < kFrameRingSlotHeaderSize + header->slot_size ||
+        kFrameRingPageSize + header->slot_stride * header->slot_count != size) {
+        ALOGE("%s: Shared memory doesn't contain a valid frame ring", __FUNCTION__);
+        munmap(ring, size);
+        return EINVAL;
+    }
+
+    mFrameRing = reinterpret_cast<const uint8_t*>(ring);
+    mFrameRingSize = size;
+    return NO_ERROR;
+}
+
+void CameraQemuClient::detachFrameRing()
+{
+    if (mFrameRing != NULL) {
+        munmap(const_cast<uint8_t*>(mFrameRing), mFrameRingSize);
+        mFrameRing = NULL;
+        mFrameRingSize = 0;
+    }
+}
+
+status_t CameraQemuClient::readFrameSlot(const char* params,
+                                         void* vframe,
+                                         void* pframe,
+                                         size_t vframe_size,
+                                         size_t pframe_size)
+{
+    unsigned int slot = 0;
+    size_t video_size = 0;
+    size_t preview_size = 0;
+    const FrameRingHeader* header =
+        reinterpret_cast<const FrameRingHeader*>(mFrameRing);
+    if (params == NULL ||
+        sscanf(params, "slot=%u,%zu,%zu", &slot, &video_size, &preview_size) != 3 ||
+        slot >= header->slot_count) {
+        ALOGE("%s: Invalid frame reply '%s'", __FUNCTION__,
+             params ? params : "");
+        return EINVAL;
+    }
+
+    if ((vframe != NULL && vframe_size != 0 && video_size < vframe_size) ||
+        (pframe != NULL && pframe_size != 0 && preview_size < pframe_size)) {
+        ALOGE("%s: Slot with %zu/%zu bytes is too small for %zu/%zu bytes frames",
+             __FUNCTION__, video_size, preview_size, vframe_size, pframe_size);
+        return EINVAL;
+    }
+
+    const uint8_t* base = mFrameRing + kFrameRingPageSize + header->slot_stride * slot;
+    const FrameRingSlot* info = reinterpret_cast<const FrameRingSlot*>(base);
+    const uint8_t* frame = base + kFrameRingSlotHeaderSize;
+
+    /* The host only reuses the slot after filling all others, which takes
+     * further frame queries, so the slot has to be stable while we copy it.
+     * A changed sequence means we can't trust what we copied. */
+    const uint64_t before = __atomic_load_n(&info->sequence, __ATOMIC_ACQUIRE);
+    if (before == 0 || (before & 1) || info->video_size != video_size ||
+        info->preview_size != preview_size ||
+        video_size + preview_size > header->slot_size) {
+        ALOGE("%s: Slot %u doesn't hold the announced frame", __FUNCTION__, slot);
+        return EIO;
+    }
+
+    if (vframe != NULL && vframe_size != 0) {
+        memcpy(vframe, frame, vframe_size);
+    }
+    if (pframe != NULL && pframe_size != 0) {
+        memcpy(pframe, frame + video_size, pframe_size);
+    }
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&info->sequence, __ATOMIC_RELAXED) != before) {
+        ALOGE("%s: Slot %u was overwritten while reading it", __FUNCTION__, slot);
+        return EIO;
+    }
+
+    return NO_ERROR;
+}
+
 }; /* namespace android */
@@ -378,6 +378,11 @@ public:
     status_t queryDisconnect();
 
     /* Queries camera to start capturing video.
+     * The service is asked to deliver frames through a shared frame ring. If
+     * it agrees, its reply 'ok:shm=<slots>,<slot size>' is followed by the
+     * memfd of the ring, passed with SCM_RIGHTS along with a single dummy
+     * byte, which is received and mapped here. Frame replies then only name
+     * the ring slot holding the frame.
      * Param:
      *  pixel_format - Pixel format that is used by the client to push video
      *      frames to the camera framework.
@@ -430,6 +435,32 @@ private:
     static const char mQueryStop[];
     /* Query frame(s). */
     static const char mQueryFrame[];
+
+    /****************************************************************************
+     * Shared frame ring
+     ***************************************************************************/
+
+private:
+    /* Receives the memfd following the 'shm' start reply and maps it.
+     * Param:
+     *  params - Reply data following 'shm='.
+     */
+    status_t attachFrameRing(const char* params);
+
+    /* Unmaps the frame ring if there is one. */
+    void detachFrameRing();
+
+    /* Copies the frames a 'slot=' frame reply refers to. */
+    status_t readFrameSlot(const char* params,
+                           void* vframe,
+                           void* pframe,
+                           size_t vframe_size,
+                           size_t pframe_size);
+
+    /* Mapping of the frame ring or NULL if frames come with the reply. */
+    const uint8_t*  mFrameRing;
+    /* Size of the frame ring mapping. */
+    size_t          mFrameRingSize;
 };
 
 }; /* namespace android */
@@ -94,9 +94,13 @@ private:
 // When a client opens a connection to the renderer, it should
 // send unsigned int value indicating the "clientFlags".
 // The following are the bitmask of the clientFlags.
-// currently only one bit is used which flags the server
-// it should exit.
+// IOSTREAM_CLIENT_EXIT_SERVER flags the server it should exit.
+// IOSTREAM_CLIENT_SHARED_MEMORY asks the server to transfer all further
+// client data through a shared memory ring. The server replies with a
+// single byte which carries the ring's memfd and its data and space
+// eventfds on success and no file descriptors otherwise.
 //
 #define IOSTREAM_CLIENT_EXIT_SERVER      1
+#define IOSTREAM_CLIENT_SHARED_MEMORY    2
 
 #endif
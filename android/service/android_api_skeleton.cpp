@@ -173,4 +173,34 @@ void AndroidApiSkeleton::resize_task(anbox::protobuf::bridge::ResizeTask const *
 
   done->Run();
 }
+
+void AndroidApiSkeleton::set_display_size(anbox::protobuf::bridge::SetDisplaySize const *request,
+                                          anbox::protobuf::rpc::Void *response,
+                                          google::protobuf::Closure *done) {
+    // The physical display keeps its size. The window manager lays out and
+    // renders everything at the forced size and the host scales it back up.
+    std::vector<std::string> size_argv = {"/system/bin/wm", "size"};
+    if (request->width() > 0 && request->height() > 0)
+        size_argv.push_back(std::to_string(request->width()) + "x" + std::to_string(request->height()));
+    else
+        size_argv.push_back("reset");
+
+    std::vector<std::string> density_argv = {"/system/bin/wm", "density"};
+    if (request->density() > 0)
+        density_argv.push_back(std::to_string(request->density()));
+    else
+        density_argv.push_back("reset");
+
+    ALOGI("Setting display size to %dx%d with density %d",
+          request->width(), request->height(), request->density());
+
+    for (const auto &argv : {size_argv, density_argv}) {
+        auto process = core::posix::exec("/system/bin/sh", argv, common_env, core::posix::StandardStream::empty);
+        wait_for_process(process, response);
+        if (response->has_error())
+            break;
+    }
+
+    done->Run();
+}
 } // namespace anbox
@@ -41,6 +41,7 @@ class SetDnsServers;
 class SetFocusedTask;
 class RemoveTask;
 class ResizeTask;
+class SetDisplaySize;
 } // namespace bridge
 namespace rpc {
 class Void;
@@ -67,6 +68,10 @@ public:
                      anbox::protobuf::rpc::Void *response,
                      google::protobuf::Closure *done);
 
+    void set_display_size(anbox::protobuf::bridge::SetDisplaySize const *request,
+                          anbox::protobuf::rpc::Void *response,
+                          google::protobuf::Closure *done);
+
 private:
     void wait_for_process(core::posix::ChildProcess &process,
                           anbox::protobuf::rpc::Void *response);
@@ -45,6 +45,8 @@ void MessageProcessor::dispatch(rpc::Invocation const& invocation) {
     invoke(this, platform_api_.get(), &AndroidApiSkeleton::remove_task, invocation);
   else if (invocation.method_name() == "resize_task")
     invoke(this, platform_api_.get(), &AndroidApiSkeleton::resize_task, invocation);
+  else if (invocation.method_name() == "set_display_size")
+    invoke(this, platform_api_.get(), &AndroidApiSkeleton::set_display_size, invocation);
 }
 
 void MessageProcessor::process_event_sequence(const std::string&) {
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/audio/adaptive_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace anbox {
+namespace audio {
+constexpr const std::size_t AdaptiveBuffer::initial_target_periods;
+
+AdaptiveBuffer::AdaptiveBuffer(const StreamConfig &config, std::size_t max_target_periods)
+    : config_(config),
+      period_size_(config.period_size()),
+      max_target_(period_size_ * std::max(max_target_periods, initial_target_periods)),
+      ring_(max_target_ + period_size_),
+      target_(period_size_ * initial_target_periods),
+      underruns_(0),
+      prebuffering_(true),
+      ran_dry_(false),
+      silence_since_dry_(0) {}
+
+AdaptiveBuffer::~AdaptiveBuffer() {}
+
+void AdaptiveBuffer::grow_target() {
+  const auto target = target_.load();
+  target_.store(std::min(target * 2, max_target_));
+}
+
+std::size_t AdaptiveBuffer::write(const std::uint8_t *data, std::size_t size) {
+  if (ran_dry_.exchange(false)) {
+    // Data arriving shortly after the device ran dry means the writer was
+    // not idle but just too late, so we need a larger buffer. After a
+    // longer gap the stream was simply paused.
+    if (silence_since_dry_.load() <= 2 * target_.load()) {
+      underruns_.fetch_add(1);
+      grow_target();
+    }
+  }
+
+  const auto limit = target_.load() + period_size_;
+  const auto buffered = ring_.available();
+  if (buffered >= limit)
+    return 0;
+
+  return ring_.write(data, std::min(size, limit - buffered));
+}
+
+void AdaptiveBuffer::read(std::uint8_t *data, std::size_t size) {
+  const auto silence = config_.format == StreamConfig::Format::U8 ? 0x80 : 0x00;
+
+  if (prebuffering_.load()) {
+    if (ring_.available() < target_.load()) {
+      std::memset(data, silence, size);
+      silence_since_dry_.fetch_add(size);
+      return;
+    }
+    prebuffering_.store(false);
+  }
+
+  const auto count = ring_.read(data, size);
+  if (count == size)
+    return;
+
+  std::memset(data + count, silence, size - count);
+  silence_since_dry_.store(size - count);
+  prebuffering_.store(true);
+  ran_dry_.store(true);
+}
+
+bool AdaptiveBuffer::idle() const {
+  return ran_dry_.load() && silence_since_dry_.load() > 2 * target_.load();
+}
+
+std::size_t AdaptiveBuffer::buffered() const {
+  return ring_.available();
+}
+
+std::size_t AdaptiveBuffer::target() const {
+  return target_.load();
+}
+
+std::uint64_t AdaptiveBuffer::underruns() const {
+  return underruns_.load();
+}
+
+std::chrono::microseconds AdaptiveBuffer::duration_of(std::size_t bytes) const {
+  const auto frames = bytes / config_.frame_size();
+  return std::chrono::microseconds{frames * 1000000ULL / config_.sample_rate};
+}
+}  // namespace audio
+}  // namespace anbox
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_AUDIO_ADAPTIVE_BUFFER_H_
+#define ANBOX_AUDIO_ADAPTIVE_BUFFER_H_
+
+#include "anbox/audio/client_info.h"
+#include "anbox/audio/ring_buffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace anbox {
+namespace audio {
+// AdaptiveBuffer sits between a stream writer and the audio device callback
+// and keeps only as much data buffered as needed to play without gaps. It
+// starts out with a target of two periods and doubles it every time the
+// device ran dry while the writer was still actively producing data. The
+// target never shrinks again for the lifetime of the stream.
+//
+// write() is called from exactly one producer thread and read() from the
+// audio callback; neither of them ever blocks.
+class AdaptiveBuffer {
+ public:
+  static constexpr const std::size_t initial_target_periods{2};
+
+  AdaptiveBuffer(const StreamConfig &config, std::size_t max_target_periods);
+  ~AdaptiveBuffer();
+
+  // write queues as much of data as fits below the current target (plus
+  // one period of slack) and returns the number of bytes accepted.
+  std::size_t write(const std::uint8_t *data, std::size_t size);
+
+  // read always fills the whole buffer. Until the target level was reached
+  // and after the buffer ran dry silence is returned.
+  void read(std::uint8_t *data, std::size_t size);
+
+  // Returns true once the buffer ran dry long enough ago for the stream
+  // to be considered paused. Reading from an idle buffer only returns
+  // silence so consumers can skip it until the next write.
+  bool idle() const;
+
+  std::size_t buffered() const;
+  std::size_t target() const;
+  std::uint64_t underruns() const;
+
+  // Converts the given number of bytes into the playback time they
+  // represent with the configuration of the stream.
+  std::chrono::microseconds duration_of(std::size_t bytes) const;
+
+ private:
+  void grow_target();
+
+  const StreamConfig config_;
+  const std::size_t period_size_;
+  const std::size_t max_target_;
+  RingBuffer ring_;
+  std::atomic<std::size_t> target_;
+  std::atomic<std::uint64_t> underruns_;
+  // Set by the consumer once it switches to prebuffering; cleared once
+  // enough data was queued again.
+  std::atomic<bool> prebuffering_;
+  // Set by the consumer when it ran out of data in the middle of playback.
+  // The amount of silence played since then tells the producer whether it
+  // was just late (an underrun) or the stream was idle.
+  std::atomic<bool> ran_dry_;
+  std::atomic<std::size_t> silence_since_dry_;
+};
+}  // namespace audio
+}  // namespace anbox
+
+#endif
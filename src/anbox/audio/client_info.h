@@ -28,8 +28,50 @@ struct ClientInfo {
     Recording = 1,
     Max = 2,
   };
+
+  // Clients which set this flag in the type field send a StreamConfig
+  // right after the ClientInfo and get the ClientInfo and the StreamConfig
+  // the server accepted back. Clients without the flag always use the
+  // legacy 44.1 kHz stereo 16 bit configuration.
+  static constexpr const std::uint8_t negotiate_flag{0x80};
+
   Type type;
 };
+
+struct StreamConfig {
+  enum class Format : std::uint8_t {
+    S16 = 0,
+    U8 = 1,
+    S32 = 2,
+    Float = 3,
+  };
+
+  std::uint32_t sample_rate;
+  std::uint8_t channels;
+  Format format;
+  std::uint16_t reserved;
+  // Number of frames the client writes at once and the host consumes per
+  // audio callback.
+  std::uint32_t period_frames;
+
+  std::uint32_t bytes_per_sample() const {
+    switch (format) {
+    case Format::U8:
+      return 1;
+    case Format::S32:
+    case Format::Float:
+      return 4;
+    case Format::S16:
+    default:
+      return 2;
+    }
+  }
+
+  std::uint32_t frame_size() const { return bytes_per_sample() * channels; }
+  std::uint32_t period_size() const { return frame_size() * period_frames; }
+};
+
+static_assert(sizeof(StreamConfig) == 12, "StreamConfig is part of the wire protocol");
 } // namespace audio
 } // namespace anbox
 
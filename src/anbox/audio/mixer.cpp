@@ -0,0 +1,305 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/audio/mixer.h"
+#include "anbox/audio/statistics.h"
+#include "anbox/logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+// Upper bound for the amount of audio we buffer for a single stream after
+// repeated underruns.
+const constexpr std::chrono::milliseconds max_latency{250};
+// Gains are applied as 4.12 fixed point values.
+const constexpr std::int32_t unity_gain{1 << 12};
+const constexpr float max_gain{4.0f};
+const constexpr std::uint32_t unity_step{1 << 16};
+
+std::size_t max_periods_for(const anbox::audio::StreamConfig &config) {
+  const auto max_frames = config.sample_rate * max_latency.count() / 1000;
+  return (max_frames + config.period_frames - 1) / config.period_frames;
+}
+
+inline std::int16_t clamp_s16(std::int32_t value) {
+  return static_cast<std::int16_t>(std::max(-32768, std::min(32767, value)));
+}
+
+void add_saturated(std::int16_t *dst, const std::int16_t *src, std::size_t count) {
+  std::size_t n = 0;
+#if defined(__SSE2__)
+  for (; n + 8 <= count; n += 8) {
+    const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + n));
+    const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + n));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n), _mm_adds_epi16(a, b));
+  }
+#elif defined(__ARM_NEON)
+  for (; n + 8 <= count; n += 8)
+    vst1q_s16(dst + n, vqaddq_s16(vld1q_s16(dst + n), vld1q_s16(src + n)));
+#endif
+  for (; n < count; n++)
+    dst[n] = clamp_s16(static_cast<std::int32_t>(dst[n]) + src[n]);
+}
+
+void apply_gain(std::int16_t *samples, std::size_t count, std::int32_t gain) {
+  for (std::size_t n = 0; n < count; n++)
+    samples[n] = clamp_s16((static_cast<std::int32_t>(samples[n]) * gain) >> 12);
+}
+}
+
+namespace anbox {
+namespace audio {
+constexpr const std::size_t Mixer::max_streams;
+
+Mixer::Stream::Stream(const std::shared_ptr<Mixer> &mixer, const StreamConfig &config)
+    : mixer_(mixer),
+      config_(config),
+      buffer_(config, max_periods_for(config)),
+      gain_(unity_gain),
+      step_(static_cast<std::uint32_t>((static_cast<std::uint64_t>(config.sample_rate) << 16) /
+                                       mixer->output_config().sample_rate)) {
+  // Enough room for a whole output period so render() doesn't allocate
+  // in the common case.
+  const auto frames = (static_cast<std::uint64_t>(mixer->output_config().period_frames) * step_ >> 16) + 2;
+  input_.resize(frames * config_.frame_size());
+  converted_.resize(frames * 2);
+  Statistics::get()->set_target_latency(buffer_.duration_of(buffer_.target()));
+}
+
+Mixer::Stream::~Stream() {
+  mixer_->remove_stream(this);
+}
+
+void Mixer::Stream::set_gain(float gain) {
+  gain = std::max(0.0f, std::min(max_gain, gain));
+  gain_.store(static_cast<std::int32_t>(gain * unity_gain));
+}
+
+float Mixer::Stream::gain() const {
+  return static_cast<float>(gain_.load()) / unity_gain;
+}
+
+bool Mixer::Stream::active() const {
+  return !buffer_.idle();
+}
+
+const AdaptiveBuffer& Mixer::Stream::buffer() const {
+  return buffer_;
+}
+
+void Mixer::Stream::write_data(const std::vector<std::uint8_t> &data) {
+  const auto period = buffer_.duration_of(config_.period_size());
+  auto written = 0u;
+  while (written < data.size()) {
+    const auto underruns = buffer_.underruns();
+    written += buffer_.write(data.data() + written, data.size() - written);
+
+    if (buffer_.underruns() != underruns) {
+      auto stats = Statistics::get();
+      stats->underrun();
+      stats->set_target_latency(buffer_.duration_of(buffer_.target()));
+      DEBUG("Audio underrun, now buffering %d bytes", buffer_.target());
+    }
+
+    if (written == data.size())
+      break;
+
+    // The buffer is full so wait until the mixer consumed the next period.
+    // The mixer doesn't take the lock when notifying so we use a timeout
+    // to never miss a wake up.
+    std::unique_lock<std::mutex> l(lock_);
+    space_available_.wait_for(l, period);
+  }
+}
+
+void Mixer::Stream::convert(const std::uint8_t *src, std::int16_t *dst, std::size_t frames) const {
+  const auto samples = frames * config_.channels;
+  const auto stereo = config_.channels == 2;
+
+  for (std::size_t n = 0; n < samples; n++) {
+    std::int16_t value = 0;
+    switch (config_.format) {
+    case StreamConfig::Format::U8:
+      value = static_cast<std::int16_t>((static_cast<std::int32_t>(src[n]) - 128) << 8);
+      break;
+    case StreamConfig::Format::S32: {
+      std::int32_t v;
+      std::memcpy(&v, src + n * sizeof(v), sizeof(v));
+      value = static_cast<std::int16_t>(v >> 16);
+      break;
+    }
+    case StreamConfig::Format::Float: {
+      float v;
+      std::memcpy(&v, src + n * sizeof(v), sizeof(v));
+      value = clamp_s16(static_cast<std::int32_t>(v * 32767.0f));
+      break;
+    }
+    case StreamConfig::Format::S16:
+    default:
+      std::memcpy(&value, src + n * sizeof(value), sizeof(value));
+      break;
+    }
+
+    if (stereo) {
+      dst[n] = value;
+    } else {
+      dst[2 * n] = value;
+      dst[2 * n + 1] = value;
+    }
+  }
+}
+
+bool Mixer::Stream::render(std::int16_t *dst, std::size_t frames) {
+  if (buffer_.idle())
+    return false;
+
+  Statistics::get()->buffered(buffer_.duration_of(buffer_.buffered()));
+
+  if (step_ == unity_step) {
+    const auto size = frames * config_.frame_size();
+    if (input_.size() < size)
+      input_.resize(size);
+    buffer_.read(input_.data(), size);
+    convert(input_.data(), dst, frames);
+  } else {
+    // Linear interpolation between the two input frames surrounding each
+    // output frame. We consume exactly as many input frames as the output
+    // position moves forward.
+    const auto needed = static_cast<std::size_t>((phase_ + static_cast<std::uint64_t>(frames) * step_) >> 16);
+    const auto size = needed * config_.frame_size();
+    if (input_.size() < size)
+      input_.resize(size);
+    if (converted_.size() < needed * 2)
+      converted_.resize(needed * 2);
+    buffer_.read(input_.data(), size);
+    convert(input_.data(), converted_.data(), needed);
+
+    std::size_t consumed = 0;
+    for (std::size_t n = 0; n < frames; n++) {
+      for (std::size_t c = 0; c < 2; c++) {
+        // A full scale step times the 16.16 phase doesn't fit into 32 bits
+        const auto delta = static_cast<std::int64_t>(next_[c]) - current_[c];
+        dst[2 * n + c] = static_cast<std::int16_t>(current_[c] + ((delta * phase_) >> 16));
+      }
+
+      phase_ += step_;
+      while (phase_ >= unity_step) {
+        current_ = next_;
+        next_[0] = converted_[2 * consumed];
+        next_[1] = converted_[2 * consumed + 1];
+        consumed++;
+        phase_ -= unity_step;
+      }
+    }
+  }
+
+  const auto gain = gain_.load();
+  if (gain != unity_gain)
+    apply_gain(dst, frames * 2, gain);
+
+  return true;
+}
+
+Mixer::Mixer(const StreamConfig &output)
+    : output_{output.sample_rate, 2, StreamConfig::Format::S16, 0, output.period_frames},
+      mixing_(false),
+      active_streams_(0),
+      accumulator_(output.period_frames * 2),
+      scratch_(output.period_frames * 2) {
+  for (auto &stream : streams_)
+    stream.store(nullptr);
+}
+
+Mixer::~Mixer() {}
+
+std::shared_ptr<Mixer::Stream> Mixer::create_stream(const StreamConfig &config) {
+  auto stream = std::make_shared<Stream>(shared_from_this(), config);
+  for (auto &slot : streams_) {
+    Stream *expected = nullptr;
+    if (slot.compare_exchange_strong(expected, stream.get()))
+      return stream;
+  }
+  ERROR("Can't mix more than %d audio streams", max_streams);
+  return nullptr;
+}
+
+void Mixer::remove_stream(Stream *stream) {
+  for (auto &slot : streams_) {
+    Stream *expected = stream;
+    if (slot.compare_exchange_strong(expected, nullptr))
+      break;
+  }
+
+  // The stream may still be used by a mix pass which started before it
+  // was removed from its slot.
+  while (mixing_.load())
+    std::this_thread::yield();
+}
+
+void Mixer::mix(std::uint8_t *data, std::size_t size) {
+  const auto frames = size / output_.frame_size();
+  const auto samples = frames * 2;
+  if (accumulator_.size() < samples) {
+    accumulator_.resize(samples);
+    scratch_.resize(samples);
+  }
+
+  mixing_.store(true);
+
+  std::size_t active = 0;
+  for (auto &slot : streams_) {
+    auto stream = slot.load();
+    if (!stream)
+      continue;
+
+    auto dst = active == 0 ? accumulator_.data() : scratch_.data();
+    if (!stream->render(dst, frames))
+      continue;
+
+    if (active > 0)
+      add_saturated(accumulator_.data(), scratch_.data(), samples);
+
+    stream->space_available_.notify_one();
+    active++;
+  }
+
+  mixing_.store(false);
+  active_streams_.store(active);
+
+  if (active == 0)
+    std::memset(data, 0, size);
+  else
+    std::memcpy(data, accumulator_.data(), samples * sizeof(std::int16_t));
+}
+
+const StreamConfig& Mixer::output_config() const {
+  return output_;
+}
+
+std::size_t Mixer::active_streams() const {
+  return active_streams_.load();
+}
+}  // namespace audio
+}  // namespace anbox
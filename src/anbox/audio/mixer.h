@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_AUDIO_MIXER_H_
+#define ANBOX_AUDIO_MIXER_H_
+
+#include "anbox/audio/adaptive_buffer.h"
+#include "anbox/audio/client_info.h"
+#include "anbox/audio/sink.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace anbox {
+namespace audio {
+// Mixer combines up to max_streams playback streams into the signed 16 bit
+// stereo output of a single audio device. Only the sample rate and period
+// size of the output configuration are used. Every stream can use its own
+// sample rate, format and channel count; it is converted while mixing.
+//
+// mix() is meant to be called from the realtime callback of the output
+// device and never blocks. Streams which didn't write anything for a few
+// periods are skipped until they write again.
+class Mixer : public std::enable_shared_from_this<Mixer> {
+ public:
+  static constexpr const std::size_t max_streams{16};
+
+  class Stream : public Sink {
+   public:
+    Stream(const std::shared_ptr<Mixer> &mixer, const StreamConfig &config);
+    ~Stream();
+
+    void write_data(const std::vector<std::uint8_t> &data) override;
+
+    // Linear gain applied to the stream, clamped to [0, 4].
+    void set_gain(float gain);
+    float gain() const;
+
+    bool active() const;
+    const AdaptiveBuffer& buffer() const;
+
+   private:
+    friend class Mixer;
+
+    // Renders the given number of frames converted to the output rate and
+    // format of the mixer into dst. Returns false when the stream turned
+    // idle and nothing was rendered.
+    bool render(std::int16_t *dst, std::size_t frames);
+    void convert(const std::uint8_t *src, std::int16_t *dst, std::size_t frames) const;
+
+    std::shared_ptr<Mixer> mixer_;
+    const StreamConfig config_;
+    AdaptiveBuffer buffer_;
+    std::atomic<std::int32_t> gain_;
+    std::mutex lock_;
+    std::condition_variable space_available_;
+
+    // Resampler state. The output position is tracked as 16.16 fixed point
+    // offset between the current and the next input frame.
+    const std::uint32_t step_;
+    std::uint32_t phase_ = 0;
+    std::array<std::int16_t, 2> current_{{0, 0}};
+    std::array<std::int16_t, 2> next_{{0, 0}};
+    std::vector<std::uint8_t> input_;
+    std::vector<std::int16_t> converted_;
+  };
+
+  explicit Mixer(const StreamConfig &output);
+  ~Mixer();
+
+  // Returns a new stream or nullptr if all stream slots are taken.
+  std::shared_ptr<Stream> create_stream(const StreamConfig &config);
+
+  // Fills data with the next size bytes of mixed audio.
+  void mix(std::uint8_t *data, std::size_t size);
+
+  const StreamConfig& output_config() const;
+  std::size_t active_streams() const;
+
+ private:
+  void remove_stream(Stream *stream);
+
+  const StreamConfig output_;
+  std::array<std::atomic<Stream*>, max_streams> streams_;
+  std::atomic<bool> mixing_;
+  std::atomic<std::size_t> active_streams_;
+  std::vector<std::int16_t> accumulator_;
+  std::vector<std::int16_t> scratch_;
+};
+}  // namespace audio
+}  // namespace anbox
+
+#endif
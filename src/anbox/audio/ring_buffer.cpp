@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/audio/ring_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace anbox {
+namespace audio {
+RingBuffer::RingBuffer(std::size_t capacity)
+    : data_(capacity), read_pos_(0), write_pos_(0) {}
+
+RingBuffer::~RingBuffer() {}
+
+std::size_t RingBuffer::write(const std::uint8_t *data, std::size_t size) {
+  const auto write_pos = write_pos_.load(std::memory_order_relaxed);
+  const auto read_pos = read_pos_.load(std::memory_order_acquire);
+
+  const auto count = std::min(size, data_.size() - (write_pos - read_pos));
+  if (count == 0)
+    return 0;
+
+  const auto offset = write_pos % data_.size();
+  const auto first_part = std::min(count, data_.size() - offset);
+  std::memcpy(data_.data() + offset, data, first_part);
+  std::memcpy(data_.data(), data + first_part, count - first_part);
+
+  write_pos_.store(write_pos + count, std::memory_order_release);
+  return count;
+}
+
+std::size_t RingBuffer::read(std::uint8_t *data, std::size_t size) {
+  const auto read_pos = read_pos_.load(std::memory_order_relaxed);
+  const auto write_pos = write_pos_.load(std::memory_order_acquire);
+
+  const auto count = std::min(size, write_pos - read_pos);
+  if (count == 0)
+    return 0;
+
+  const auto offset = read_pos % data_.size();
+  const auto first_part = std::min(count, data_.size() - offset);
+  std::memcpy(data, data_.data() + offset, first_part);
+  std::memcpy(data + first_part, data_.data(), count - first_part);
+
+  read_pos_.store(read_pos + count, std::memory_order_release);
+  return count;
+}
+
+std::size_t RingBuffer::available() const {
+  return write_pos_.load(std::memory_order_acquire) -
+         read_pos_.load(std::memory_order_acquire);
+}
+
+std::size_t RingBuffer::free_space() const {
+  return data_.size() - available();
+}
+
+std::size_t RingBuffer::capacity() const {
+  return data_.size();
+}
+}  // namespace audio
+}  // namespace anbox
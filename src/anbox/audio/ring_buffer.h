@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_AUDIO_RING_BUFFER_H_
+#define ANBOX_AUDIO_RING_BUFFER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace anbox {
+namespace audio {
+// RingBuffer is a lock-free byte ring for exactly one producer and one
+// consumer thread. It is used to hand audio data over to the realtime
+// audio callback which must never block.
+class RingBuffer {
+ public:
+  explicit RingBuffer(std::size_t capacity);
+  ~RingBuffer();
+
+  // write copies as much of data as fits into the ring and returns the
+  // number of bytes written. Must only be called from the producer.
+  std::size_t write(const std::uint8_t *data, std::size_t size);
+
+  // read copies up to size bytes out of the ring and returns the number of
+  // bytes read. Must only be called from the consumer.
+  std::size_t read(std::uint8_t *data, std::size_t size);
+
+  std::size_t available() const;
+  std::size_t free_space() const;
+  std::size_t capacity() const;
+
+ private:
+  std::vector<std::uint8_t> data_;
+  // Both positions grow monotonically and are only wrapped when accessing
+  // the data. This way a full ring can be told apart from an empty one.
+  std::atomic<std::size_t> read_pos_;
+  std::atomic<std::size_t> write_pos_;
+};
+}  // namespace audio
+}  // namespace anbox
+
+#endif
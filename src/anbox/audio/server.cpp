@@ -26,8 +26,23 @@
 #include "anbox/utils.h"
 #include "anbox/logger.h"
 
+#include <algorithm>
+
 using namespace std::placeholders;
 
+namespace {
+const constexpr std::uint32_t min_sample_rate{8000};
+const constexpr std::uint32_t max_sample_rate{192000};
+const constexpr std::uint8_t max_channels{2};
+const constexpr std::uint32_t min_period_frames{64};
+const constexpr std::uint32_t max_period_frames{4096};
+const constexpr std::uint32_t default_period_frames{256};
+
+// Configuration used by clients which don't negotiate.
+const constexpr anbox::audio::StreamConfig legacy_stream_config{
+    44100, 2, anbox::audio::StreamConfig::Format::S16, 0, default_period_frames};
+}
+
 namespace {
 class AudioForwarder : public anbox::network::MessageProcessor {
  public:
@@ -47,12 +62,15 @@ class AudioForwarder : public anbox::network::MessageProcessor {
 
 namespace anbox {
 namespace audio {
+constexpr const char *Server::executor;
+
 Server::Server(const std::shared_ptr<Runtime>& rt, const std::shared_ptr<platform::Policy> &platform_policy) :
   platform_policy_(platform_policy),
   socket_file_(utils::string_format("%s/anbox_audio", SystemConfiguration::instance().socket_dir())),
   connector_(std::make_shared<network::PublishedSocketConnector>(
              socket_file_, rt,
-             std::make_shared<network::DelegateConnectionCreator<boost::asio::local::stream_protocol>>(std::bind(&Server::create_connection_for, this, _1)))),
+             std::make_shared<network::DelegateConnectionCreator<boost::asio::local::stream_protocol>>(std::bind(&Server::create_connection_for, this, _1)),
+             executor)),
   connections_(std::make_shared<network::Connections<network::SocketConnection>>()),
   next_id_(0) {
 
@@ -63,6 +81,19 @@ Server::Server(const std::shared_ptr<Runtime>& rt, const std::shared_ptr<platfor
 
 Server::~Server() {}
 
+StreamConfig Server::negotiate(const StreamConfig &requested) {
+  StreamConfig config = requested;
+  config.reserved = 0;
+  config.sample_rate = std::max(min_sample_rate, std::min(max_sample_rate, config.sample_rate));
+  config.channels = std::max<std::uint8_t>(1, std::min(max_channels, config.channels));
+  if (config.format > StreamConfig::Format::Float)
+    config.format = StreamConfig::Format::S16;
+  if (config.period_frames == 0)
+    config.period_frames = default_period_frames;
+  config.period_frames = std::max(min_period_frames, std::min(max_period_frames, config.period_frames));
+  return config;
+}
+
 void Server::create_connection_for(std::shared_ptr<boost::asio::basic_stream_socket<boost::asio::local::stream_protocol>> const& socket) {
   auto const messenger =
       std::make_shared<network::LocalSocketMessenger>(socket);
@@ -77,23 +108,48 @@ void Server::create_connection_for(std::shared_ptr<boost::asio::basic_stream_soc
     return;
   }
 
+  auto stream_config = legacy_stream_config;
+  const auto type_flags = static_cast<std::uint8_t>(client_info.type);
+  const auto negotiating = (type_flags & ClientInfo::negotiate_flag) != 0;
+  if (negotiating) {
+    err = messenger->receive_msg(
+        boost::asio::buffer(&stream_config, sizeof(StreamConfig)));
+    if (err) {
+      ERROR("Failed to read stream configuration: %s", err.message());
+      return;
+    }
+    stream_config = negotiate(stream_config);
+  }
+
   std::shared_ptr<network::MessageProcessor> processor;
 
-  switch (client_info.type) {
-  case ClientInfo::Type::Playback:
-    processor = std::make_shared<AudioForwarder>(platform_policy_->create_audio_sink());
+  const auto type = static_cast<ClientInfo::Type>(type_flags & ~ClientInfo::negotiate_flag);
+  switch (type) {
+  case ClientInfo::Type::Playback: {
+    DEBUG("Playback stream with %d Hz, %d channels, format %d and %d frames per period",
+          stream_config.sample_rate, static_cast<int>(stream_config.channels),
+          static_cast<int>(stream_config.format), stream_config.period_frames);
+    auto sink = platform_policy_->create_audio_sink(stream_config);
+    if (!sink) {
+      ERROR("Failed to create audio sink for playback stream");
+      return;
+    }
+    processor = std::make_shared<AudioForwarder>(sink);
     break;
+  }
   case ClientInfo::Type::Recording:
     break;
   default:
-    ERROR("Invalid client type %d", static_cast<int>(client_info.type));
+    ERROR("Invalid client type %d", static_cast<int>(type));
     return;
   }
 
   // Everything ok, so approve the client by sending the requesting client
-  // info back. Once we have more things to negotiate we will send a modified
-  // client info struct back.
+  // info back followed by the configuration we accepted if the client asked
+  // for one.
   messenger->send(reinterpret_cast<char*>(&client_info), sizeof(client_info));
+  if (negotiating)
+    messenger->send(reinterpret_cast<char*>(&stream_config), sizeof(stream_config));
 
   auto connection = std::make_shared<network::SocketConnection>(
         messenger, messenger, next_id(), connections_, processor);
@@ -33,11 +33,20 @@ class PublishedSocketConnector;
 namespace audio {
 class Server {
  public:
+  // Name of the runtime executor handling the audio client connections.
+  // Stream writes block until the mixer has room for the data, so it needs
+  // a thread per concurrently playing stream.
+  static constexpr const char *executor{"audio"};
+
   Server(const std::shared_ptr<Runtime>& rt, const std::shared_ptr<platform::Policy> &platform_policy);
   ~Server();
 
   std::string socket_file() const { return socket_file_; }
 
+  // Returns the closest configuration to the requested one we're able to
+  // play back.
+  static StreamConfig negotiate(const StreamConfig &requested);
+
  private:
   void create_connection_for(std::shared_ptr<boost::asio::basic_stream_socket<
                              boost::asio::local::stream_protocol>> const& socket);
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/audio/statistics.h"
+
+namespace anbox {
+namespace audio {
+std::shared_ptr<Statistics> Statistics::get() {
+  static auto statistics = std::make_shared<Statistics>();
+  return statistics;
+}
+
+Statistics::Statistics() : underruns_(0), target_latency_us_(0) {}
+
+Statistics::~Statistics() {}
+
+void Statistics::underrun() {
+  underruns_.fetch_add(1);
+}
+
+void Statistics::set_target_latency(const std::chrono::microseconds &latency) {
+  target_latency_us_.store(latency.count());
+}
+
+void Statistics::buffered(const std::chrono::microseconds &latency) {
+  latency_.record(latency);
+}
+
+std::uint64_t Statistics::underruns() const {
+  return underruns_.load();
+}
+
+std::chrono::microseconds Statistics::target_latency() const {
+  return std::chrono::microseconds{target_latency_us_.load()};
+}
+
+const common::LatencyHistogram& Statistics::latency() const {
+  return latency_;
+}
+
+std::map<std::string, std::uint64_t> Statistics::summary() const {
+  auto result = latency_.summary("latency_");
+  result["underruns"] = underruns();
+  result["target_latency_us"] = target_latency().count();
+  return result;
+}
+}  // namespace audio
+}  // namespace anbox
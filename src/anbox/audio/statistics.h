@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_AUDIO_STATISTICS_H_
+#define ANBOX_AUDIO_STATISTICS_H_
+
+#include "anbox/common/latency_histogram.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace anbox {
+namespace audio {
+// Statistics collects playback statistics of all audio output streams.
+class Statistics {
+ public:
+  static std::shared_ptr<Statistics> get();
+
+  Statistics();
+  ~Statistics();
+
+  void underrun();
+  void set_target_latency(const std::chrono::microseconds &latency);
+  // Records the amount of audio queued in front of the device when it
+  // requested the next period.
+  void buffered(const std::chrono::microseconds &latency);
+
+  std::uint64_t underruns() const;
+  std::chrono::microseconds target_latency() const;
+  const common::LatencyHistogram& latency() const;
+
+  std::map<std::string, std::uint64_t> summary() const;
+
+ private:
+  std::atomic<std::uint64_t> underruns_;
+  std::atomic<std::uint64_t> target_latency_us_;
+  common::LatencyHistogram latency_;
+};
+}  // namespace audio
+}  // namespace anbox
+
+#endif
@@ -17,6 +17,7 @@
 
 #include "anbox/bridge/android_api_stub.h"
 #include "anbox/config.h"
+#include "anbox/graphics/render_scale.h"
 #include "anbox/logger.h"
 #include "anbox/rpc/channel.h"
 #include "anbox/utils.h"
@@ -27,8 +28,27 @@
 
 #include <boost/filesystem.hpp>
 
+#ifdef USE_SFDROID
+#include "anbox/graphics/sfdroid/DisplayManager.h"
+#else
+#include "anbox/graphics/emugl/DisplayManager.h"
+#endif
+
 namespace fs = boost::filesystem;
 
+namespace {
+// Android lays out tasks on its own display which is smaller than the host
+// one with a render scale below 1.
+anbox::graphics::Rect to_guest(const anbox::graphics::Rect &rect) {
+  const auto display_manager = DisplayManager::get();
+  if (!display_manager) return rect;
+
+  const auto info = display_manager->display_info();
+  return anbox::graphics::RenderScale::get()->to_guest(
+      rect, {0, 0, info.horizontal_resolution, info.vertical_resolution});
+}
+}  // namespace
+
 namespace anbox {
 namespace bridge {
 AndroidApiStub::AndroidApiStub() {}
@@ -74,11 +94,12 @@ void AndroidApiStub::launch(const android::Intent &intent,
   }
 
   if (launch_bounds != graphics::Rect::Invalid) {
+    const auto bounds = to_guest(launch_bounds);
     auto rect = message.mutable_launch_bounds();
-    rect->set_left(launch_bounds_.left());
-    rect->set_top(launch_bounds_.top());
-    rect->set_right(launch_bounds_.right());
-    rect->set_bottom(launch_bounds_.bottom());
+    rect->set_left(bounds.left());
+    rect->set_top(bounds.top());
+    rect->set_right(bounds.right());
+    rect->set_bottom(bounds.bottom());
   }
 
   auto launch_intent = message.mutable_intent();
@@ -183,11 +204,12 @@ void AndroidApiStub::resize_task(const std::int32_t &id,
   message.set_id(id);
   message.set_resize_mode(resize_mode);
 
+  const auto bounds = to_guest(rect);
   auto r = message.mutable_rect();
-  r->set_left(rect.left());
-  r->set_top(rect.top());
-  r->set_right(rect.right());
-  r->set_bottom(rect.bottom());
+  r->set_left(bounds.left());
+  r->set_top(bounds.top());
+  r->set_right(bounds.right());
+  r->set_bottom(bounds.bottom());
 
   {
     std::lock_guard<decltype(mutex_)> lock(mutex_);
@@ -207,5 +229,35 @@ void AndroidApiStub::task_resized(Request<protobuf::rpc::Void> *request) {
   (void)request;
   resize_task_handle_.result_received();
 }
+
+void AndroidApiStub::set_display_size(const graphics::Rect &size,
+                                      const std::int32_t &density) {
+  ensure_rpc_channel();
+
+  auto c = std::make_shared<Request<protobuf::rpc::Void>>();
+
+  protobuf::bridge::SetDisplaySize message;
+  message.set_width(size.width());
+  message.set_height(size.height());
+  message.set_density(density);
+
+  {
+    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    set_display_size_handle_.expect_result();
+  }
+
+  channel_->call_method("set_display_size", &message, c->response.get(),
+                        google::protobuf::NewCallback(
+                            this, &AndroidApiStub::display_size_set, c.get()));
+
+  set_display_size_handle_.wait_for_all();
+
+  if (c->response->has_error()) throw std::runtime_error(c->response->error());
+}
+
+void AndroidApiStub::display_size_set(Request<protobuf::rpc::Void> *request) {
+  (void)request;
+  set_display_size_handle_.result_received();
+}
 }  // namespace bridge
 }  // namespace anbox
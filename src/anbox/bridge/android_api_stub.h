@@ -47,6 +47,9 @@ class AndroidApiStub : public anbox::application::Manager {
   void remove_task(const std::int32_t &id);
   void resize_task(const std::int32_t &id, const anbox::graphics::Rect &rect,
                    const std::int32_t &resize_mode);
+  // Makes Android lay out its display with the given size and density. An
+  // empty size and a density of zero restore the physical display values.
+  void set_display_size(const graphics::Rect &size, const std::int32_t &density);
 
   void launch(const android::Intent &intent,
               const graphics::Rect &launch_bounds = graphics::Rect::Invalid,
@@ -68,6 +71,7 @@ class AndroidApiStub : public anbox::application::Manager {
   void focused_task_set(Request<protobuf::rpc::Void> *request);
   void task_removed(Request<protobuf::rpc::Void> *request);
   void task_resized(Request<protobuf::rpc::Void> *request);
+  void display_size_set(Request<protobuf::rpc::Void> *request);
 
   mutable std::mutex mutex_;
   std::shared_ptr<rpc::Channel> channel_;
@@ -75,7 +79,7 @@ class AndroidApiStub : public anbox::application::Manager {
   common::WaitHandle set_focused_task_handle_;
   common::WaitHandle remove_task_handle_;
   common::WaitHandle resize_task_handle_;
-  graphics::Rect launch_bounds_ = graphics::Rect::Invalid;
+  common::WaitHandle set_display_size_handle_;
   core::Property<bool> ready_;
 };
 }  // namespace bridge
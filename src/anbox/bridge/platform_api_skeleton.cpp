@@ -17,6 +17,7 @@
 
 #include "anbox/bridge/platform_api_skeleton.h"
 #include "anbox/application/database.h"
+#include "anbox/graphics/render_scale.h"
 #include "anbox/platform/policy.h"
 #include "anbox/wm/manager.h"
 #include "anbox/wm/window_state.h"
@@ -28,6 +29,12 @@
 
 #include "anbox_bridge.pb.h"
 
+#ifdef USE_SFDROID
+#include "anbox/graphics/sfdroid/DisplayManager.h"
+#else
+#include "anbox/graphics/emugl/DisplayManager.h"
+#endif
+
 namespace anbox {
 namespace bridge {
 PlatformApiSkeleton::PlatformApiSkeleton(
@@ -72,13 +79,23 @@ void PlatformApiSkeleton::handle_boot_finished_event(const anbox::protobuf::brid
 }
 
 void PlatformApiSkeleton::handle_window_state_update_event(const anbox::protobuf::bridge::WindowStateUpdateEvent &event) {
-  auto convert_window_state = [](
+  // Android reports the frames on its own display which is smaller than
+  // the host one with a render scale below 1.
+  auto display = graphics::Rect::Invalid;
+  if (const auto display_manager = DisplayManager::get()) {
+    const auto info = display_manager->display_info();
+    display = graphics::Rect{0, 0, info.horizontal_resolution, info.vertical_resolution};
+  }
+  const auto scale = graphics::RenderScale::get();
+
+  auto convert_window_state = [&](
       const ::anbox::protobuf::bridge::WindowStateUpdateEvent_WindowState
           &window) {
+    const auto frame = graphics::Rect(window.frame_left(), window.frame_top(),
+                                      window.frame_right(), window.frame_bottom());
     return wm::WindowState(
         wm::Display::Id(window.display_id()), window.has_surface(),
-        graphics::Rect(window.frame_left(), window.frame_top(),
-                       window.frame_right(), window.frame_bottom()),
+        display == graphics::Rect::Invalid ? frame : scale->to_host(frame, display),
         window.package_name(), wm::Task::Id(window.task_id()),
         wm::Stack::Id(window.stack_id()));
   };
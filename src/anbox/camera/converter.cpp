@@ -0,0 +1,389 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/camera/converter.h"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ANBOX_CAMERA_SSE2 1
+#endif
+
+// All conversions use 16 bit fixed point arithmetic so that the vectorized
+// versions can process eight pixels per instruction. The scalar versions
+// follow the same steps and therefore give identical results.
+//
+//   Y = ((66 R + 129 G + 25 B + 128) >> 8) + 16
+//   U = ((-38 R - 74 G + 112 B + 128) >> 8) + 128
+//   V = ((112 R - 94 G - 18 B + 128) >> 8) + 128
+//
+//   R = (74 (Y - 16) + 102 (V - 128) + 32) >> 6
+//   G = (74 (Y - 16) - 25 (U - 128) - 52 (V - 128) + 32) >> 6
+//   B = (74 (Y - 16) + 129 (U - 128) + 32) >> 6
+//
+// Chroma is computed from the average of each 2x2 block.
+
+namespace {
+inline std::uint8_t clamp(int value) {
+  return static_cast<std::uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+inline std::uint8_t luma(int r, int g, int b) {
+  return static_cast<std::uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+inline std::uint8_t chroma_u(int r, int g, int b) {
+  return static_cast<std::uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+inline std::uint8_t chroma_v(int r, int g, int b) {
+  return static_cast<std::uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+inline void yuv_to_rgb(int y, int u, int v, std::uint8_t *out) {
+  const auto c = 74 * (y - 16);
+  const auto d = u - 128;
+  const auto e = v - 128;
+  out[0] = clamp((c + 102 * e + 32) >> 6);
+  out[1] = clamp((c - 25 * d - 52 * e + 32) >> 6);
+  out[2] = clamp((c + 129 * d + 32) >> 6);
+  out[3] = 0xff;
+}
+
+// Converts the 2x2 blocks of two rows starting at column begin.
+void rgb32_to_i420_rows(const std::uint8_t *row0, const std::uint8_t *row1,
+                        int begin, int width, std::uint8_t *y0,
+                        std::uint8_t *y1, std::uint8_t *u, std::uint8_t *v) {
+  for (int x = begin; x < width; x += 2) {
+    const auto p00 = row0 + x * 4, p01 = p00 + 4;
+    const auto p10 = row1 + x * 4, p11 = p10 + 4;
+    y0[x] = luma(p00[0], p00[1], p00[2]);
+    y0[x + 1] = luma(p01[0], p01[1], p01[2]);
+    y1[x] = luma(p10[0], p10[1], p10[2]);
+    y1[x + 1] = luma(p11[0], p11[1], p11[2]);
+
+    const auto r = (p00[0] + p01[0] + p10[0] + p11[0] + 2) >> 2;
+    const auto g = (p00[1] + p01[1] + p10[1] + p11[1] + 2) >> 2;
+    const auto b = (p00[2] + p01[2] + p10[2] + p11[2] + 2) >> 2;
+    u[x / 2] = chroma_u(r, g, b);
+    v[x / 2] = chroma_v(r, g, b);
+  }
+}
+
+void i420_to_rgb32_row(const std::uint8_t *y, const std::uint8_t *u,
+                       const std::uint8_t *v, int begin, int width,
+                       std::uint8_t *out) {
+  for (int x = begin; x < width; x++)
+    yuv_to_rgb(y[x], u[x / 2], v[x / 2], out + x * 4);
+}
+
+void interleave(const std::uint8_t *a, const std::uint8_t *b,
+                std::uint8_t *out, std::size_t count) {
+  std::size_t n = 0;
+#if defined(ANBOX_CAMERA_SSE2)
+  for (; n + 16 <= count; n += 16) {
+    const auto va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + n));
+    const auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + n));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + n * 2),
+                     _mm_unpacklo_epi8(va, vb));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + n * 2 + 16),
+                     _mm_unpackhi_epi8(va, vb));
+  }
+#endif
+  for (; n < count; n++) {
+    out[n * 2] = a[n];
+    out[n * 2 + 1] = b[n];
+  }
+}
+
+#if defined(ANBOX_CAMERA_SSE2)
+// Splits four RGBA pixels into one 32 bit lane per pixel for each channel.
+inline void split_channels(const std::uint8_t *pixels, __m128i &r, __m128i &g,
+                           __m128i &b) {
+  const auto mask = _mm_set1_epi32(0xff);
+  const auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels));
+  const auto hi =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + 16));
+  r = _mm_packs_epi32(_mm_and_si128(lo, mask), _mm_and_si128(hi, mask));
+  g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 8), mask),
+                      _mm_and_si128(_mm_srli_epi32(hi, 8), mask));
+  b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 16), mask),
+                      _mm_and_si128(_mm_srli_epi32(hi, 16), mask));
+}
+
+inline __m128i luma_simd(__m128i r, __m128i g, __m128i b) {
+  // The sum exceeds the signed range but never 16 bit so treat it unsigned
+  auto sum = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(66)),
+                           _mm_mullo_epi16(g, _mm_set1_epi16(129)));
+  sum = _mm_add_epi16(sum, _mm_mullo_epi16(b, _mm_set1_epi16(25)));
+  sum = _mm_add_epi16(sum, _mm_set1_epi16(128));
+  return _mm_add_epi16(_mm_srli_epi16(sum, 8), _mm_set1_epi16(16));
+}
+
+inline __m128i chroma_simd(__m128i r, __m128i g, __m128i b, short cr, short cg,
+                           short cb) {
+  auto sum = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(cr)),
+                           _mm_mullo_epi16(g, _mm_set1_epi16(cg)));
+  sum = _mm_add_epi16(sum, _mm_mullo_epi16(b, _mm_set1_epi16(cb)));
+  sum = _mm_add_epi16(sum, _mm_set1_epi16(128));
+  return _mm_add_epi16(_mm_srai_epi16(sum, 8), _mm_set1_epi16(128));
+}
+
+// Averages the 2x2 blocks of eight pixels in two rows into four values.
+inline __m128i average_blocks(__m128i row0, __m128i row1) {
+  const auto pairs =
+      _mm_madd_epi16(_mm_add_epi16(row0, row1), _mm_set1_epi16(1));
+  const auto average =
+      _mm_srli_epi32(_mm_add_epi32(pairs, _mm_set1_epi32(2)), 2);
+  return _mm_packs_epi32(average, average);
+}
+
+inline void store4(std::uint8_t *out, __m128i values) {
+  const int packed = _mm_cvtsi128_si32(_mm_packus_epi16(values, values));
+  std::memcpy(out, &packed, 4);
+}
+
+inline __m128i load4_as_words(const std::uint8_t *in) {
+  int packed;
+  std::memcpy(&packed, in, 4);
+  return _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), _mm_setzero_si128());
+}
+#endif
+}  // namespace
+
+namespace anbox {
+namespace camera {
+bool pixel_format_from_fourcc(std::uint32_t value, PixelFormat &format) {
+  switch (static_cast<PixelFormat>(value)) {
+    case PixelFormat::yuv420:
+    case PixelFormat::yvu420:
+    case PixelFormat::nv12:
+    case PixelFormat::nv21:
+    case PixelFormat::rgb32:
+      format = static_cast<PixelFormat>(value);
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
+std::size_t frame_size(PixelFormat format, int width, int height) {
+  if (format == PixelFormat::rgb32) return width * height * 4;
+  return width * height * 3 / 2;
+}
+
+void convert(const Frame &frame, PixelFormat format, std::uint8_t *out) {
+  const std::size_t luma_size = frame.width() * frame.height();
+  const std::size_t chroma_size = luma_size / 4;
+
+  switch (format) {
+    case PixelFormat::yuv420:
+      std::memcpy(out, frame.y(), luma_size + 2 * chroma_size);
+      break;
+    case PixelFormat::yvu420:
+      std::memcpy(out, frame.y(), luma_size);
+      std::memcpy(out + luma_size, frame.v(), chroma_size);
+      std::memcpy(out + luma_size + chroma_size, frame.u(), chroma_size);
+      break;
+    case PixelFormat::nv12:
+      std::memcpy(out, frame.y(), luma_size);
+      interleave(frame.u(), frame.v(), out + luma_size, chroma_size);
+      break;
+    case PixelFormat::nv21:
+      std::memcpy(out, frame.y(), luma_size);
+      interleave(frame.v(), frame.u(), out + luma_size, chroma_size);
+      break;
+    case PixelFormat::rgb32:
+      i420_to_rgb32(frame, out);
+      break;
+  }
+}
+
+void rgb32_to_i420(const std::uint8_t *rgb, Frame &frame) {
+#if defined(ANBOX_CAMERA_SSE2)
+  const auto width = frame.width();
+  const auto chroma_width = width / 2;
+  const auto vector_width = width & ~7;
+
+  for (int y = 0; y < frame.height(); y += 2) {
+    const auto row0 = rgb + y * width * 4;
+    const auto row1 = row0 + width * 4;
+    const auto y0 = frame.y() + y * width;
+    const auto y1 = y0 + width;
+    const auto u = frame.u() + (y / 2) * chroma_width;
+    const auto v = frame.v() + (y / 2) * chroma_width;
+
+    for (int x = 0; x < vector_width; x += 8) {
+      __m128i r0, g0, b0, r1, g1, b1;
+      split_channels(row0 + x * 4, r0, g0, b0);
+      split_channels(row1 + x * 4, r1, g1, b1);
+
+      const auto l0 = luma_simd(r0, g0, b0);
+      const auto l1 = luma_simd(r1, g1, b1);
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(y0 + x),
+                       _mm_packus_epi16(l0, l0));
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(y1 + x),
+                       _mm_packus_epi16(l1, l1));
+
+      const auto r = average_blocks(r0, r1);
+      const auto g = average_blocks(g0, g1);
+      const auto b = average_blocks(b0, b1);
+      store4(u + x / 2, chroma_simd(r, g, b, -38, -74, 112));
+      store4(v + x / 2, chroma_simd(r, g, b, 112, -94, -18));
+    }
+
+    rgb32_to_i420_rows(row0, row1, vector_width, width, y0, y1, u, v);
+  }
+#else
+  reference::rgb32_to_i420(rgb, frame);
+#endif
+}
+
+void i420_to_rgb32(const Frame &frame, std::uint8_t *rgb) {
+#if defined(ANBOX_CAMERA_SSE2)
+  const auto width = frame.width();
+  const auto chroma_width = width / 2;
+  const auto vector_width = width & ~7;
+  const auto zero = _mm_setzero_si128();
+  const auto alpha = _mm_set1_epi8(static_cast<char>(0xff));
+
+  for (int y = 0; y < frame.height(); y++) {
+    const auto yrow = frame.y() + y * width;
+    const auto urow = frame.u() + (y / 2) * chroma_width;
+    const auto vrow = frame.v() + (y / 2) * chroma_width;
+    const auto out = rgb + y * width * 4;
+
+    for (int x = 0; x < vector_width; x += 8) {
+      const auto luma = _mm_unpacklo_epi8(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i *>(yrow + x)), zero);
+      auto u = load4_as_words(urow + x / 2);
+      auto v = load4_as_words(vrow + x / 2);
+      u = _mm_unpacklo_epi16(u, u);
+      v = _mm_unpacklo_epi16(v, v);
+
+      const auto c = _mm_mullo_epi16(_mm_sub_epi16(luma, _mm_set1_epi16(16)),
+                                     _mm_set1_epi16(74));
+      const auto d = _mm_sub_epi16(u, _mm_set1_epi16(128));
+      const auto e = _mm_sub_epi16(v, _mm_set1_epi16(128));
+      const auto round = _mm_set1_epi16(32);
+
+      auto r = _mm_adds_epi16(c, _mm_mullo_epi16(e, _mm_set1_epi16(102)));
+      auto g = _mm_subs_epi16(c, _mm_mullo_epi16(d, _mm_set1_epi16(25)));
+      g = _mm_subs_epi16(g, _mm_mullo_epi16(e, _mm_set1_epi16(52)));
+      auto b = _mm_adds_epi16(c, _mm_mullo_epi16(d, _mm_set1_epi16(129)));
+      r = _mm_srai_epi16(_mm_adds_epi16(r, round), 6);
+      g = _mm_srai_epi16(_mm_adds_epi16(g, round), 6);
+      b = _mm_srai_epi16(_mm_adds_epi16(b, round), 6);
+
+      const auto r8 = _mm_packus_epi16(r, r);
+      const auto g8 = _mm_packus_epi16(g, g);
+      const auto b8 = _mm_packus_epi16(b, b);
+      const auto rg = _mm_unpacklo_epi8(r8, g8);
+      const auto ba = _mm_unpacklo_epi8(b8, alpha);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + x * 4),
+                       _mm_unpacklo_epi16(rg, ba));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + x * 4 + 16),
+                       _mm_unpackhi_epi16(rg, ba));
+    }
+
+    i420_to_rgb32_row(yrow, urow, vrow, vector_width, width, out);
+  }
+#else
+  reference::i420_to_rgb32(frame, rgb);
+#endif
+}
+
+void yuyv_to_i420(const std::uint8_t *yuyv, std::size_t stride, Frame &frame) {
+  const auto width = frame.width();
+
+  for (int y = 0; y < frame.height(); y += 2) {
+    const auto row0 = yuyv + y * stride;
+    const auto row1 = row0 + stride;
+    const auto y0 = frame.y() + y * width;
+    const auto y1 = y0 + width;
+    const auto u = frame.u() + (y / 2) * (width / 2);
+    const auto v = frame.v() + (y / 2) * (width / 2);
+
+    for (int x = 0; x < width; x += 2) {
+      const auto p0 = row0 + x * 2;
+      const auto p1 = row1 + x * 2;
+      y0[x] = p0[0];
+      y0[x + 1] = p0[2];
+      y1[x] = p1[0];
+      y1[x + 1] = p1[2];
+      u[x / 2] = static_cast<std::uint8_t>((p0[1] + p1[1] + 1) >> 1);
+      v[x / 2] = static_cast<std::uint8_t>((p0[3] + p1[3] + 1) >> 1);
+    }
+  }
+}
+
+void scale(const Frame &src, Frame &dst) {
+  auto scale_plane = [](const std::uint8_t *in, int in_width, int in_height,
+                        std::uint8_t *out, int out_width, int out_height) {
+    for (int y = 0; y < out_height; y++) {
+      const auto row = in + (y * in_height / out_height) * in_width;
+      for (int x = 0; x < out_width; x++)
+        out[y * out_width + x] = row[x * in_width / out_width];
+    }
+  };
+
+  if (src.size() == dst.size()) {
+    std::memcpy(dst.y(), src.y(), src.byte_size());
+    return;
+  }
+
+  scale_plane(src.y(), src.width(), src.height(), dst.y(), dst.width(),
+              dst.height());
+  scale_plane(src.u(), src.width() / 2, src.height() / 2, dst.u(),
+              dst.width() / 2, dst.height() / 2);
+  scale_plane(src.v(), src.width() / 2, src.height() / 2, dst.v(),
+              dst.width() / 2, dst.height() / 2);
+}
+
+bool simd_available() {
+#if defined(ANBOX_CAMERA_SSE2)
+  return true;
+#else
+  return false;
+#endif
+}
+
+namespace reference {
+void rgb32_to_i420(const std::uint8_t *rgb, Frame &frame) {
+  const auto width = frame.width();
+  for (int y = 0; y < frame.height(); y += 2) {
+    const auto row0 = rgb + y * width * 4;
+    rgb32_to_i420_rows(row0, row0 + width * 4, 0, width,
+                       frame.y() + y * width, frame.y() + (y + 1) * width,
+                       frame.u() + (y / 2) * (width / 2),
+                       frame.v() + (y / 2) * (width / 2));
+  }
+}
+
+void i420_to_rgb32(const Frame &frame, std::uint8_t *rgb) {
+  const auto width = frame.width();
+  for (int y = 0; y < frame.height(); y++)
+    i420_to_rgb32_row(frame.y() + y * width,
+                      frame.u() + (y / 2) * (width / 2),
+                      frame.v() + (y / 2) * (width / 2), 0, width,
+                      rgb + y * width * 4);
+}
+}  // namespace reference
+}  // namespace camera
+}  // namespace anbox
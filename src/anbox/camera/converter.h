@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_CAMERA_CONVERTER_H_
+#define ANBOX_CAMERA_CONVERTER_H_
+
+#include "anbox/camera/frame.h"
+
+#include <cstdint>
+
+namespace anbox {
+namespace camera {
+constexpr std::uint32_t fourcc(char a, char b, char c, char d) {
+  return static_cast<std::uint32_t>(a) | (static_cast<std::uint32_t>(b) << 8) |
+         (static_cast<std::uint32_t>(c) << 16) |
+         (static_cast<std::uint32_t>(d) << 24);
+}
+
+// Formats the camera HAL asks for. The values are the V4L2 fourccs the HAL
+// sends in its start query.
+enum class PixelFormat : std::uint32_t {
+  yuv420 = fourcc('Y', 'U', '1', '2'),
+  yvu420 = fourcc('Y', 'V', '1', '2'),
+  nv12 = fourcc('N', 'V', '1', '2'),
+  nv21 = fourcc('N', 'V', '2', '1'),
+  // One byte each for red, green, blue and alpha in that order in memory.
+  rgb32 = fourcc('R', 'G', 'B', '4'),
+};
+
+bool pixel_format_from_fourcc(std::uint32_t value, PixelFormat &format);
+std::size_t frame_size(PixelFormat format, int width, int height);
+
+// Converts the frame into the given format. out has to provide room for
+// frame_size(format, frame.width(), frame.height()) bytes.
+void convert(const Frame &frame, PixelFormat format, std::uint8_t *out);
+
+// Colour conversions use BT.601 limited range coefficients. They are
+// vectorized with SSE2 where available and produce exactly the same
+// results as the scalar versions in the reference namespace.
+void rgb32_to_i420(const std::uint8_t *rgb, Frame &frame);
+void i420_to_rgb32(const Frame &frame, std::uint8_t *rgb);
+
+// Packed YUYV 4:2:2 as delivered by most webcams to I420. stride is the
+// number of bytes per row of the input.
+void yuyv_to_i420(const std::uint8_t *yuyv, std::size_t stride, Frame &frame);
+
+// Nearest neighbour scaling of src to the size of dst.
+void scale(const Frame &src, Frame &dst);
+
+bool simd_available();
+
+namespace reference {
+void rgb32_to_i420(const std::uint8_t *rgb, Frame &frame);
+void i420_to_rgb32(const Frame &frame, std::uint8_t *rgb);
+}  // namespace reference
+}  // namespace camera
+}  // namespace anbox
+
+#endif
@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/camera/frame.h"
+
+namespace anbox {
+namespace camera {
+Frame::Frame() : width_(0), height_(0) {}
+
+Frame::Frame(int width, int height) : width_(0), height_(0) {
+  resize(width, height);
+}
+
+void Frame::resize(int width, int height) {
+  width_ = width & ~1;
+  height_ = height & ~1;
+  data_.resize(width_ * height_ * 3 / 2);
+}
+}  // namespace camera
+}  // namespace anbox
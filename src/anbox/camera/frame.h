@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_CAMERA_FRAME_H_
+#define ANBOX_CAMERA_FRAME_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace anbox {
+namespace camera {
+struct Size {
+  Size(int width, int height) : width(width), height(height) {}
+
+  bool operator==(const Size &other) const {
+    return width == other.width && height == other.height;
+  }
+  bool operator!=(const Size &other) const { return !(*this == other); }
+
+  int width;
+  int height;
+};
+
+// Frame holds a single image in planar YUV 4:2:0 (I420) which is the format
+// all sources deliver and all conversions start from. Width and height are
+// always even.
+class Frame {
+ public:
+  Frame();
+  Frame(int width, int height);
+
+  void resize(int width, int height);
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  Size size() const { return Size{width_, height_}; }
+  std::size_t byte_size() const { return data_.size(); }
+
+  std::uint8_t *y() { return data_.data(); }
+  std::uint8_t *u() { return y() + width_ * height_; }
+  std::uint8_t *v() { return u() + (width_ / 2) * (height_ / 2); }
+  const std::uint8_t *y() const { return data_.data(); }
+  const std::uint8_t *u() const { return y() + width_ * height_; }
+  const std::uint8_t *v() const { return u() + (width_ / 2) * (height_ / 2); }
+
+ private:
+  int width_;
+  int height_;
+  std::vector<std::uint8_t> data_;
+};
+}  // namespace camera
+}  // namespace anbox
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/camera/frame_ring.h"
+#include "anbox/common/sequence_lock.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace {
+constexpr const std::uint32_t ring_magic{0x616e6672};
+constexpr const std::uint32_t ring_version{1};
+// Header and every slot start on their own page.
+constexpr const std::size_t page_size{4096};
+constexpr const std::size_t slot_header_size{64};
+
+std::size_t page_align(std::size_t size) {
+  return (size + page_size - 1) / page_size * page_size;
+}
+}
+
+namespace anbox {
+namespace camera {
+constexpr const std::uint32_t FrameRing::default_slot_count;
+
+struct FrameRing::Header {
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t slot_count;
+  std::uint32_t reserved;
+  std::uint64_t slot_size;
+  std::uint64_t slot_stride;
+};
+
+struct FrameRing::Slot {
+  common::SequenceLock lock;
+  std::uint32_t video_size;
+  std::uint32_t preview_size;
+};
+
+std::shared_ptr<FrameRing> FrameRing::create(std::size_t slot_size,
+                                             std::uint32_t slot_count) {
+  if (slot_size == 0 || slot_count == 0)
+    BOOST_THROW_EXCEPTION(std::invalid_argument("Invalid frame ring size"));
+
+  const auto slot_stride = page_align(slot_header_size + slot_size);
+  const auto size = page_size + slot_stride * slot_count;
+
+  auto memory = common::SharedMemory::create("anbox-camera", size);
+
+  auto header = new (memory->data()) Header;
+  header->magic = ring_magic;
+  header->version = ring_version;
+  header->slot_count = slot_count;
+  header->reserved = 0;
+  header->slot_size = slot_size;
+  header->slot_stride = slot_stride;
+
+  auto ring = std::shared_ptr<FrameRing>(new FrameRing(memory));
+  for (std::uint32_t n = 0; n < slot_count; n++) {
+    auto slot = new (ring->slot_at(n)) Slot;
+    slot->lock.reset();
+    slot->video_size = 0;
+    slot->preview_size = 0;
+  }
+  return ring;
+}
+
+std::shared_ptr<FrameRing> FrameRing::attach(const Fd &fd) {
+  auto memory = common::SharedMemory::map(fd, common::SharedMemory::Access::read_write);
+  const auto size = memory->size();
+  if (size <= page_size)
+    BOOST_THROW_EXCEPTION(std::runtime_error("Shared memory too small for a frame ring"));
+
+  const auto header = static_cast<const Header*>(memory->data());
+  if (header->magic != ring_magic || header->version != ring_version ||
+      header->slot_stride < slot_header_size + header->slot_size ||
+      page_size + header->slot_stride * header->slot_count != size)
+    BOOST_THROW_EXCEPTION(std::runtime_error("Shared memory doesn't contain a valid frame ring"));
+
+  return std::shared_ptr<FrameRing>(new FrameRing(memory));
+}
+
+FrameRing::FrameRing(const std::shared_ptr<common::SharedMemory> &memory)
+    : memory_(memory),
+      header_(static_cast<Header*>(memory->data())),
+      next_slot_(0) {}
+
+const Fd& FrameRing::fd() const { return memory_->fd(); }
+
+std::uint32_t FrameRing::slot_count() const { return header_->slot_count; }
+
+std::size_t FrameRing::slot_size() const { return header_->slot_size; }
+
+FrameRing::Slot* FrameRing::slot_at(std::uint32_t slot) const {
+  return reinterpret_cast<Slot*>(static_cast<std::uint8_t*>(memory_->data()) + page_size +
+                                 header_->slot_stride * slot);
+}
+
+std::uint32_t FrameRing::begin_write(std::uint8_t **data) {
+  const auto slot = next_slot_;
+  next_slot_ = (next_slot_ + 1) % header_->slot_count;
+
+  slot_at(slot)->lock.begin_write();
+  *data = reinterpret_cast<std::uint8_t*>(slot_at(slot)) + slot_header_size;
+  return slot;
+}
+
+void FrameRing::end_write(std::uint32_t slot, std::uint32_t video_size,
+                          std::uint32_t preview_size) {
+  auto s = slot_at(slot);
+  s->video_size = video_size;
+  s->preview_size = preview_size;
+  s->lock.end_write();
+}
+
+bool FrameRing::read(std::uint32_t slot, std::uint8_t *out, SlotInfo &info) const {
+  if (slot >= header_->slot_count) return false;
+
+  const auto s = slot_at(slot);
+  std::uint64_t before = 0;
+  if (!s->lock.begin_read(before)) return false;
+
+  info.sequence = before;
+  info.video_size = s->video_size;
+  info.preview_size = s->preview_size;
+  if (static_cast<std::uint64_t>(info.video_size) + info.preview_size > header_->slot_size)
+    return false;
+
+  std::memcpy(out, reinterpret_cast<const std::uint8_t*>(s) + slot_header_size,
+              info.video_size + info.preview_size);
+
+  return s->lock.end_read(before);
+}
+}  // namespace camera
+}  // namespace anbox
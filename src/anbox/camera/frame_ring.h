@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_CAMERA_FRAME_RING_H_
+#define ANBOX_CAMERA_FRAME_RING_H_
+
+#include "anbox/common/fd.h"
+#include "anbox/common/shared_memory.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace anbox {
+namespace camera {
+// FrameRing is a set of frame slots in a memfd which is shared with the
+// camera HAL so that frames don't have to be copied through the pipe. The
+// host fills the next slot for every frame query and only tells the HAL
+// which slot to read. Each slot is guarded by a common::SequenceLock.
+class FrameRing {
+ public:
+  static constexpr const std::uint32_t default_slot_count{3};
+
+  struct SlotInfo {
+    SlotInfo() : sequence(0), video_size(0), preview_size(0) {}
+
+    std::uint64_t sequence;
+    std::uint32_t video_size;
+    std::uint32_t preview_size;
+  };
+
+  static std::shared_ptr<FrameRing> create(
+      std::size_t slot_size, std::uint32_t slot_count = default_slot_count);
+  static std::shared_ptr<FrameRing> attach(const Fd &memory);
+
+  const Fd &fd() const;
+  std::uint32_t slot_count() const;
+  std::size_t slot_size() const;
+
+  // Returns the slot the next frame is written to and its memory.
+  std::uint32_t begin_write(std::uint8_t **data);
+  // Publishes the frame written to slot.
+  void end_write(std::uint32_t slot, std::uint32_t video_size,
+                 std::uint32_t preview_size);
+
+  // Copies the frame in slot into out which must provide slot_size() bytes.
+  // Returns false if the slot is being written or was never written.
+  bool read(std::uint32_t slot, std::uint8_t *out, SlotInfo &info) const;
+
+ private:
+  struct Header;
+  struct Slot;
+
+  explicit FrameRing(const std::shared_ptr<common::SharedMemory> &memory);
+
+  Slot *slot_at(std::uint32_t slot) const;
+
+  std::shared_ptr<common::SharedMemory> memory_;
+  Header *header_;
+  std::uint32_t next_slot_;
+};
+}  // namespace camera
+}  // namespace anbox
+
+#endif
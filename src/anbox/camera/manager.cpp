@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/camera/manager.h"
+#include "anbox/camera/synthetic_source.h"
+#include "anbox/camera/v4l2_source.h"
+#include "anbox/camera/video_file_source.h"
+#include "anbox/utils.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace anbox {
+namespace camera {
+std::shared_ptr<Manager> Manager::get() {
+  static auto instance = std::shared_ptr<Manager>(new Manager);
+  return instance;
+}
+
+std::shared_ptr<Source> Manager::create_source(const std::string &spec) {
+  if (spec == "synthetic")
+    return std::make_shared<SyntheticSource>();
+  else if (utils::string_starts_with(spec, "v4l2:"))
+    return std::make_shared<V4l2Source>(spec.substr(5));
+  else if (utils::string_starts_with(spec, "file:"))
+    return std::make_shared<VideoFileSource>(spec.substr(5));
+
+  BOOST_THROW_EXCEPTION(std::runtime_error(
+      utils::string_format("Invalid camera source '%s'", spec)));
+}
+
+void Manager::add_source(const std::shared_ptr<Source> &source) {
+  std::lock_guard<std::mutex> l(lock_);
+  const auto name = source->name();
+  if (std::any_of(sources_.begin(), sources_.end(),
+                  [&](const std::shared_ptr<Source> &s) { return s->name() == name; }))
+    BOOST_THROW_EXCEPTION(std::runtime_error(
+        utils::string_format("Camera '%s' already exists", name)));
+  sources_.push_back(source);
+}
+
+void Manager::remove_source(const std::string &name) {
+  std::lock_guard<std::mutex> l(lock_);
+  sources_.erase(std::remove_if(sources_.begin(), sources_.end(),
+                                [&](const std::shared_ptr<Source> &s) { return s->name() == name; }),
+                 sources_.end());
+}
+
+std::vector<std::shared_ptr<Source>> Manager::sources() const {
+  std::lock_guard<std::mutex> l(lock_);
+  return sources_;
+}
+
+std::shared_ptr<Source> Manager::find(const std::string &name) const {
+  std::lock_guard<std::mutex> l(lock_);
+  for (const auto &source : sources_) {
+    if (source->name() == name) return source;
+  }
+  return nullptr;
+}
+
+std::shared_ptr<Source> Manager::acquire(const std::string &name) {
+  std::lock_guard<std::mutex> l(lock_);
+  if (acquired_.count(name) > 0) return nullptr;
+
+  for (const auto &source : sources_) {
+    if (source->name() != name) continue;
+
+    acquired_.insert(name);
+    // The manager is a singleton which lives as long as the process so the
+    // lease can safely call back into it.
+    return std::shared_ptr<Source>(source.get(), [this, source, name](Source *) {
+      release(name);
+    });
+  }
+  return nullptr;
+}
+
+void Manager::release(const std::string &name) {
+  std::lock_guard<std::mutex> l(lock_);
+  acquired_.erase(name);
+}
+}  // namespace camera
+}  // namespace anbox
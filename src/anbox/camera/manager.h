@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_CAMERA_MANAGER_H_
+#define ANBOX_CAMERA_MANAGER_H_
+
+#include "anbox/camera/source.h"
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace anbox {
+namespace camera {
+// Manager holds the cameras which are exposed to Android.
+class Manager {
+ public:
+  static std::shared_ptr<Manager> get();
+
+  // Creates a source from a description as given on the command line:
+  // 'synthetic', 'v4l2:<device>' or 'file:<path>'. Throws if the
+  // description is invalid or the source can't be created.
+  static std::shared_ptr<Source> create_source(const std::string &spec);
+
+  void add_source(const std::shared_ptr<Source> &source);
+  void remove_source(const std::string &name);
+  std::vector<std::shared_ptr<Source>> sources() const;
+  std::shared_ptr<Source> find(const std::string &name) const;
+
+  // Hands out exclusive use of a source. The source is released again
+  // once the returned pointer and all its copies are gone. Returns null if
+  // the source does not exist or is already in use by another client.
+  std::shared_ptr<Source> acquire(const std::string &name);
+
+ private:
+  Manager() = default;
+
+  void release(const std::string &name);
+
+  mutable std::mutex lock_;
+  std::vector<std::shared_ptr<Source>> sources_;
+  std::set<std::string> acquired_;
+};
+}  // namespace camera
+}  // namespace anbox
+
+#endif
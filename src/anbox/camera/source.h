@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_CAMERA_SOURCE_H_
+#define ANBOX_CAMERA_SOURCE_H_
+
+#include "anbox/camera/frame.h"
+
+#include <string>
+#include <vector>
+
+namespace anbox {
+namespace camera {
+// A Source provides the images for one camera exposed to Android. Sources
+// are not thread safe; clients get exclusive use of one through
+// Manager::acquire() and only call start(), stop() and read() while they
+// hold it.
+class Source {
+ public:
+  virtual ~Source() {}
+
+  // Name the HAL uses to connect to the camera; must not contain spaces.
+  virtual std::string name() const = 0;
+  // Either 'back' or 'front'.
+  virtual std::string direction() const { return "back"; }
+  virtual std::vector<Size> frame_sizes() const = 0;
+
+  virtual bool start(const Size &size) = 0;
+  virtual void stop() = 0;
+
+  // Fills frame with the latest image in the size given to start(). Must
+  // not block as it is called from the pipe's message loop. Returns false
+  // on errors or if no image is available yet.
+  virtual bool read(Frame &frame) = 0;
+};
+}  // namespace camera
+}  // namespace anbox
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/camera/synthetic_source.h"
+#include "anbox/camera/converter.h"
+
+#include <algorithm>
+
+namespace {
+// White, yellow, cyan, green, magenta, red, blue and black
+const std::uint8_t bar_colors[8][3] = {
+    {255, 255, 255}, {255, 255, 0}, {0, 255, 255}, {0, 255, 0},
+    {255, 0, 255},   {255, 0, 0},   {0, 0, 255},   {0, 0, 0},
+};
+}  // namespace
+
+namespace anbox {
+namespace camera {
+SyntheticSource::SyntheticSource() : size_{0, 0}, frame_count_(0) {}
+
+std::string SyntheticSource::name() const { return "synthetic"; }
+
+std::vector<Size> SyntheticSource::frame_sizes() const {
+  return {{640, 480}, {352, 288}, {320, 240}, {176, 144}};
+}
+
+bool SyntheticSource::start(const Size &size) {
+  if (size.width <= 0 || size.height <= 0 || (size.width & 1) ||
+      (size.height & 1))
+    return false;
+  size_ = size;
+  frame_count_ = 0;
+  rgb_.resize(size.width * size.height * 4);
+  return true;
+}
+
+void SyntheticSource::stop() { rgb_.clear(); }
+
+bool SyntheticSource::read(Frame &frame) {
+  if (rgb_.empty()) return false;
+
+  // The bars scroll by four pixels per frame
+  const auto offset = static_cast<int>(frame_count_++ * 4);
+  const auto bar_width = std::max(size_.width / 8, 1);
+  for (int y = 0; y < size_.height; y++) {
+    auto out = rgb_.data() + y * size_.width * 4;
+    for (int x = 0; x < size_.width; x++, out += 4) {
+      const auto color = bar_colors[((x + offset) / bar_width) % 8];
+      out[0] = color[0];
+      out[1] = color[1];
+      out[2] = color[2];
+      out[3] = 0xff;
+    }
+  }
+
+  frame.resize(size_.width, size_.height);
+  rgb32_to_i420(rgb_.data(), frame);
+  return true;
+}
+}  // namespace camera
+}  // namespace anbox
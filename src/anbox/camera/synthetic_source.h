@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_CAMERA_SYNTHETIC_SOURCE_H_
+#define ANBOX_CAMERA_SYNTHETIC_SOURCE_H_
+
+#include "anbox/camera/source.h"
+
+#include <cstdint>
+
+namespace anbox {
+namespace camera {
+// SyntheticSource renders moving colour bars. It doesn't pace itself and
+// returns a new frame on every read which makes it suitable to measure the
+// cost of the frame pipeline.
+class SyntheticSource : public Source {
+ public:
+  SyntheticSource();
+
+  std::string name() const override;
+  std::vector<Size> frame_sizes() const override;
+
+  bool start(const Size &size) override;
+  void stop() override;
+  bool read(Frame &frame) override;
+
+ private:
+  Size size_;
+  std::uint32_t frame_count_;
+  std::vector<std::uint8_t> rgb_;
+};
+}  // namespace camera
+}  // namespace anbox
+
+#endif
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/camera/v4l2_source.h"
+#include "anbox/camera/converter.h"
+#include "anbox/logger.h"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+constexpr const unsigned int buffer_count{4};
+// How often the capture thread checks whether it should stop
+constexpr const int poll_timeout_ms{100};
+
+int xioctl(int fd, unsigned long request, void *arg) {
+  int ret;
+  do {
+    ret = ::ioctl(fd, request, arg);
+  } while (ret < 0 && errno == EINTR);
+  return ret;
+}
+}  // namespace
+
+namespace anbox {
+namespace camera {
+V4l2Source::V4l2Source(const std::string &device)
+    : device_(device),
+      fd_(-1),
+      size_{0, 0},
+      capture_size_{0, 0},
+      stride_(0),
+      running_(false) {}
+
+V4l2Source::~V4l2Source() { stop(); }
+
+std::string V4l2Source::name() const {
+  return boost::filesystem::path(device_).filename().string();
+}
+
+std::vector<Size> V4l2Source::frame_sizes() const {
+  std::vector<Size> sizes;
+
+  const auto fd = ::open(device_.c_str(), O_RDWR | O_CLOEXEC);
+  if (fd < 0) return sizes;
+
+  struct v4l2_frmsizeenum frame_size;
+  std::memset(&frame_size, 0, sizeof(frame_size));
+  frame_size.pixel_format = V4L2_PIX_FMT_YUYV;
+  while (xioctl(fd, VIDIOC_ENUM_FRAMESIZES, &frame_size) == 0) {
+    // Stepwise and continuous devices take any size so offer the common ones
+    if (frame_size.type != V4L2_FRMSIZE_TYPE_DISCRETE) break;
+    if ((frame_size.discrete.width & 1) == 0 && (frame_size.discrete.height & 1) == 0)
+      sizes.push_back({static_cast<int>(frame_size.discrete.width),
+                       static_cast<int>(frame_size.discrete.height)});
+    frame_size.index++;
+  }
+  ::close(fd);
+
+  if (sizes.empty()) sizes = {{640, 480}, {352, 288}, {320, 240}};
+  return sizes;
+}
+
+bool V4l2Source::start(const Size &size) {
+  stop();
+
+  fd_ = ::open(device_.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+  if (fd_ < 0) {
+    ERROR("Failed to open %s: %s", device_, std::strerror(errno));
+    return false;
+  }
+
+  struct v4l2_format format;
+  std::memset(&format, 0, sizeof(format));
+  format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  format.fmt.pix.width = size.width;
+  format.fmt.pix.height = size.height;
+  format.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
+  format.fmt.pix.field = V4L2_FIELD_NONE;
+  if (xioctl(fd_, VIDIOC_S_FMT, &format) < 0 ||
+      format.fmt.pix.pixelformat != V4L2_PIX_FMT_YUYV) {
+    ERROR("%s doesn't support YUYV capture", device_);
+    close_device();
+    return false;
+  }
+
+  // The driver may pick another size than we asked for
+  capture_size_ = Size{static_cast<int>(format.fmt.pix.width) & ~1,
+                       static_cast<int>(format.fmt.pix.height) & ~1};
+  capture_.resize(capture_size_.width, capture_size_.height);
+  stride_ = std::max<std::size_t>(format.fmt.pix.bytesperline, format.fmt.pix.width * 2);
+  size_ = size;
+
+  struct v4l2_requestbuffers request;
+  std::memset(&request, 0, sizeof(request));
+  request.count = buffer_count;
+  request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  request.memory = V4L2_MEMORY_MMAP;
+  if (xioctl(fd_, VIDIOC_REQBUFS, &request) < 0 || request.count == 0) {
+    ERROR("Failed to request capture buffers from %s", device_);
+    close_device();
+    return false;
+  }
+
+  for (unsigned int n = 0; n < request.count; n++) {
+    struct v4l2_buffer buffer;
+    std::memset(&buffer, 0, sizeof(buffer));
+    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffer.memory = V4L2_MEMORY_MMAP;
+    buffer.index = n;
+    if (xioctl(fd_, VIDIOC_QUERYBUF, &buffer) < 0) {
+      close_device();
+      return false;
+    }
+
+    auto data = ::mmap(nullptr, buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       fd_, buffer.m.offset);
+    if (data == MAP_FAILED) {
+      close_device();
+      return false;
+    }
+    buffers_.push_back({data, buffer.length});
+
+    if (xioctl(fd_, VIDIOC_QBUF, &buffer) < 0) {
+      close_device();
+      return false;
+    }
+  }
+
+  auto type = static_cast<int>(V4L2_BUF_TYPE_VIDEO_CAPTURE);
+  if (xioctl(fd_, VIDIOC_STREAMON, &type) < 0) {
+    ERROR("Failed to start capturing from %s: %s", device_, std::strerror(errno));
+    close_device();
+    return false;
+  }
+
+  // Until the device delivers its first image the client gets a black one
+  latest_.resize(size_.width, size_.height);
+  std::memset(latest_.y(), 16, size_.width * size_.height);
+  std::memset(latest_.u(), 128, latest_.byte_size() - size_.width * size_.height);
+  scaled_.resize(size_.width, size_.height);
+
+  running_ = true;
+  capture_thread_ = std::thread(&V4l2Source::capture, this);
+  return true;
+}
+
+void V4l2Source::stop() {
+  running_ = false;
+  if (capture_thread_.joinable()) capture_thread_.join();
+  close_device();
+}
+
+void V4l2Source::close_device() {
+  if (fd_ < 0) return;
+
+  auto type = static_cast<int>(V4L2_BUF_TYPE_VIDEO_CAPTURE);
+  xioctl(fd_, VIDIOC_STREAMOFF, &type);
+  for (const auto &buffer : buffers_) ::munmap(buffer.data, buffer.size);
+  buffers_.clear();
+  ::close(fd_);
+  fd_ = -1;
+}
+
+bool V4l2Source::read(Frame &frame) {
+  if (!running_) return false;
+
+  std::lock_guard<std::mutex> l(frame_lock_);
+  frame = latest_;
+  return true;
+}
+
+void V4l2Source::capture() {
+  while (running_) {
+    struct pollfd fds = {fd_, POLLIN, 0};
+    const auto ret = ::poll(&fds, 1, poll_timeout_ms);
+    if (ret < 0 && errno != EINTR) {
+      ERROR("Failed to wait for frames from %s: %s", device_, std::strerror(errno));
+      // Lets read() report the error to the client
+      running_ = false;
+      break;
+    }
+    if (ret <= 0 || !capture_frame()) continue;
+
+    std::lock_guard<std::mutex> l(frame_lock_);
+    std::swap(latest_, scaled_);
+  }
+}
+
+bool V4l2Source::capture_frame() {
+  struct v4l2_buffer buffer;
+  std::memset(&buffer, 0, sizeof(buffer));
+  buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  buffer.memory = V4L2_MEMORY_MMAP;
+  if (xioctl(fd_, VIDIOC_DQBUF, &buffer) < 0 || buffer.index >= buffers_.size())
+    return false;
+
+  const auto complete = buffer.bytesused >= stride_ * capture_size_.height;
+  if (complete)
+    yuyv_to_i420(static_cast<const std::uint8_t*>(buffers_[buffer.index].data), stride_,
+                 capture_);
+
+  xioctl(fd_, VIDIOC_QBUF, &buffer);
+  if (!complete) return false;
+
+  scale(capture_, scaled_);
+  return true;
+}
+}  // namespace camera
+}  // namespace anbox
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_CAMERA_V4L2_SOURCE_H_
+#define ANBOX_CAMERA_V4L2_SOURCE_H_
+
+#include "anbox/camera/source.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace anbox {
+namespace camera {
+// V4l2Source captures YUYV frames from a host video device like a webcam.
+// Frames are scaled if the device doesn't support the requested size.
+// Capturing happens on a separate thread between start() and stop() so
+// read() only copies the latest image and never waits for the device.
+class V4l2Source : public Source {
+ public:
+  explicit V4l2Source(const std::string &device);
+  ~V4l2Source();
+
+  std::string name() const override;
+  std::vector<Size> frame_sizes() const override;
+
+  bool start(const Size &size) override;
+  void stop() override;
+  bool read(Frame &frame) override;
+
+ private:
+  struct Buffer {
+    void *data;
+    std::size_t size;
+  };
+
+  void capture();
+  bool capture_frame();
+  void close_device();
+
+  std::string device_;
+  int fd_;
+  Size size_;
+  Size capture_size_;
+  std::size_t stride_;
+  std::vector<Buffer> buffers_;
+  Frame capture_;
+  Frame scaled_;
+
+  std::atomic<bool> running_;
+  std::thread capture_thread_;
+  std::mutex frame_lock_;
+  Frame latest_;
+};
+}  // namespace camera
+}  // namespace anbox
+
+#endif
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/camera/video_file_source.h"
+#include "anbox/camera/converter.h"
+#include "anbox/utils.h"
+
+#include <boost/filesystem.hpp>
+
+#include <boost/throw_exception.hpp>
+
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+constexpr const char *stream_magic{"YUV4MPEG2"};
+constexpr const char *frame_magic{"FRAME"};
+}  // namespace
+
+namespace anbox {
+namespace camera {
+VideoFileSource::VideoFileSource(const std::string &path)
+    : path_(path), file_(path, std::ios::binary), size_{0, 0} {
+  if (!file_)
+    BOOST_THROW_EXCEPTION(std::runtime_error(
+        utils::string_format("Failed to open video file %s", path)));
+
+  std::string header;
+  std::getline(file_, header);
+
+  std::istringstream params(header);
+  std::string param;
+  params >> param;
+  if (param != stream_magic)
+    BOOST_THROW_EXCEPTION(std::runtime_error(
+        utils::string_format("%s is not a YUV4MPEG2 video", path)));
+
+  int width = 0, height = 0;
+  while (params >> param) {
+    if (param[0] == 'W')
+      width = std::atoi(param.c_str() + 1);
+    else if (param[0] == 'H')
+      height = std::atoi(param.c_str() + 1);
+    else if (param[0] == 'C' && !utils::string_starts_with(param, "C420"))
+      BOOST_THROW_EXCEPTION(std::runtime_error(utils::string_format(
+          "Unsupported colorspace %s in %s", param.substr(1), path)));
+  }
+
+  if (width <= 0 || height <= 0 || (width & 1) || (height & 1))
+    BOOST_THROW_EXCEPTION(std::runtime_error(
+        utils::string_format("Invalid frame size in %s", path)));
+
+  video_frame_.resize(width, height);
+  first_frame_ = file_.tellg();
+}
+
+std::string VideoFileSource::name() const {
+  return boost::filesystem::path(path_).stem().string();
+}
+
+std::vector<Size> VideoFileSource::frame_sizes() const {
+  std::vector<Size> sizes{video_frame_.size()};
+  for (const auto &size : std::vector<Size>{{640, 480}, {352, 288}, {320, 240}}) {
+    if (size != video_frame_.size()) sizes.push_back(size);
+  }
+  return sizes;
+}
+
+bool VideoFileSource::start(const Size &size) {
+  if (size.width <= 0 || size.height <= 0 || (size.width & 1) ||
+      (size.height & 1))
+    return false;
+  size_ = size;
+  file_.clear();
+  file_.seekg(first_frame_);
+  return true;
+}
+
+void VideoFileSource::stop() {}
+
+bool VideoFileSource::read(Frame &frame) {
+  for (int attempt = 0; attempt < 2; attempt++) {
+    std::string header;
+    if (std::getline(file_, header) &&
+        utils::string_starts_with(header, frame_magic) &&
+        file_.read(reinterpret_cast<char *>(video_frame_.y()),
+                   video_frame_.byte_size())) {
+      frame.resize(size_.width, size_.height);
+      scale(video_frame_, frame);
+      return true;
+    }
+
+    // Start over once we reached the end of the video
+    file_.clear();
+    file_.seekg(first_frame_);
+  }
+  return false;
+}
+}  // namespace camera
+}  // namespace anbox
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_CAMERA_VIDEO_FILE_SOURCE_H_
+#define ANBOX_CAMERA_VIDEO_FILE_SOURCE_H_
+
+#include "anbox/camera/source.h"
+
+#include <fstream>
+
+namespace anbox {
+namespace camera {
+// VideoFileSource plays back an uncompressed YUV4MPEG2 (.y4m) video with
+// 4:2:0 chroma in a loop. Such files can be produced from any video with
+// e.g. 'ffmpeg -i in.mp4 -pix_fmt yuv420p out.y4m'. Frames are scaled to
+// the size requested by the camera HAL.
+class VideoFileSource : public Source {
+ public:
+  // Throws if the file can't be opened or isn't a supported video.
+  explicit VideoFileSource(const std::string &path);
+
+  std::string name() const override;
+  std::vector<Size> frame_sizes() const override;
+
+  bool start(const Size &size) override;
+  void stop() override;
+  bool read(Frame &frame) override;
+
+ private:
+  std::string path_;
+  std::ifstream file_;
+  std::streampos first_frame_;
+  Frame video_frame_;
+  Size size_;
+};
+}  // namespace camera
+}  // namespace anbox
+
+#endif
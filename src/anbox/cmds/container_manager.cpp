@@ -16,6 +16,7 @@
  */
 
 #include "anbox/cmds/container_manager.h"
+#include "anbox/common/boot_timeline.h"
 #include "anbox/container/service.h"
 #include "anbox/common/loop_device_allocator.h"
 #include "anbox/logger.h"
@@ -30,10 +31,6 @@
 
 namespace fs = boost::filesystem;
 
-namespace {
-constexpr unsigned int unprivileged_user_id{100000};
-}
-
 anbox::cmds::ContainerManager::ContainerManager()
     : CommandWithFlagsAndAction{
           cli::Name{"container-manager"}, cli::Usage{"container-manager"},
@@ -48,6 +45,12 @@ anbox::cmds::ContainerManager::ContainerManager()
   flag(cli::make_flag(cli::Name{"privileged"},
                       cli::Description{"Run Android container in privileged mode"},
                       privileged_));
+  flag(cli::make_flag(cli::Name{"max-instances"},
+                      cli::Description{"Number of Android instances which can run at the same time. All of them share the Android image"},
+                      max_instances_));
+  flag(cli::make_flag(cli::Name{"readahead"},
+                      cli::Description{"Read the parts of the Android image needed during boot ahead of time. Possible values are 'replay' to use a previously recorded profile, 'record' to record a new one during the next boot or 'off'"},
+                      readahead_mode_));
   flag(cli::make_flag(cli::Name{"daemon"},
                       cli::Description{"Mark service as being started as systemd daemon"},
                       daemon_));
@@ -79,16 +82,40 @@ anbox::cmds::ContainerManager::ContainerManager()
       if (!data_path_.empty())
         SystemConfiguration::instance().set_data_path(data_path_);
 
+      if (readahead_mode_ != "replay" && readahead_mode_ != "record" && readahead_mode_ != "off") {
+        ERROR("Invalid readahead mode '%s'", readahead_mode_);
+        return EXIT_FAILURE;
+      }
+      readahead_profile_path_ = SystemConfiguration::instance().data_dir() / "readahead.profile";
+
+      if (android_img_path_.empty())
+        android_img_path_ = (SystemConfiguration::instance().data_dir() / "android.img").string();
+
+      common::BootTimeline::get()->start("container-manager");
+
       if (!setup_mounts())
         return EXIT_FAILURE;
 
+      common::BootTimeline::get()->mark("rootfs-mounted");
+
       auto rt = Runtime::create();
-      auto service = container::Service::create(rt, privileged_);
+      auto service = container::Service::create(rt, privileged_, std::max(max_instances_, 1u));
+
+      // Recording starts only now as mounting the image reads from it as
+      // well which shouldn't count as boot I/O.
+      if (readahead_mode_ == "record") {
+        readahead_recorder_ = std::make_shared<common::ReadaheadRecorder>(
+            rt->service(), android_img_path_, readahead_profile_path_);
+        readahead_recorder_->start();
+      }
 
       rt->start();
       trap->run();
+      if (readahead_recorder_) readahead_recorder_->stop();
       rt->stop();
 
+      readahead_.reset();
+
       return EXIT_SUCCESS;
     } catch (std::exception &err) {
       ERROR("%s", err.what());
@@ -100,27 +127,23 @@ anbox::cmds::ContainerManager::ContainerManager()
 anbox::cmds::ContainerManager::~ContainerManager() {}
 
 bool anbox::cmds::ContainerManager::setup_mounts() {
-  fs::path android_img_path = android_img_path_;
-  if (android_img_path.empty())
-    android_img_path = SystemConfiguration::instance().data_dir() / "android.img";
+  const fs::path android_img_path = android_img_path_;
 
   if (!fs::exists(android_img_path)) {
     ERROR("Android image does not exist at path %s", android_img_path);
     return false;
   }
 
-  const auto android_rootfs_dir = SystemConfiguration::instance().rootfs_dir();
-  if (utils::is_mounted(android_rootfs_dir)) {
-    ERROR("Androd rootfs is already mounted!?");
+  // The image is mounted once and shared by all instances. Each of them
+  // puts its own overlay on top when its container is started.
+  const auto android_image_dir = SystemConfiguration::instance().image_dir();
+  if (utils::is_mounted(android_image_dir)) {
+    ERROR("Android image is already mounted!?");
     return false;
   }
 
-  if (!fs::exists(android_rootfs_dir))
-    fs::create_directory(android_rootfs_dir);
-
-  const auto android_overlay_dir = SystemConfiguration::instance().overlay_dir();
-  if (!fs::exists(android_overlay_dir))
-    fs::create_directory(android_overlay_dir);
+  if (!fs::exists(android_image_dir))
+    fs::create_directory(android_image_dir);
 
   std::shared_ptr<common::LoopDevice> loop_device;
 
@@ -139,49 +162,51 @@ bool anbox::cmds::ContainerManager::setup_mounts() {
     return false;
   }
 
-  auto m = common::MountEntry::create(loop_device, android_rootfs_dir, "squashfs", MS_MGC_VAL | MS_RDONLY | MS_PRIVATE);
+  start_readahead(android_img_path);
+
+  auto m = common::MountEntry::create(loop_device, android_image_dir, "squashfs", MS_MGC_VAL | MS_RDONLY | MS_PRIVATE);
   if (!m) {
-    ERROR("Failed to mount Android rootfs");
+    ERROR("Failed to mount Android image");
     return false;
   }
   mounts_.push_back(m);
 
-  std::string options = "lowerdir=" + android_rootfs_dir + ",upperdir=" + SystemConfiguration::instance().overlay_dir();
-  auto o = common::MountEntry::create("overlayfs", android_rootfs_dir, "overlayfs", MS_MGC_VAL | MS_RDONLY | MS_PRIVATE, options);
-  if(!o) {
-    ERROR("Failed to mount Android overlay");
-    return false;
-  }
-  mounts_.push_back(o);
-
-  for (const auto &dir_name : std::vector<std::string>{"cache", "data"}) {
-    auto target_dir_path = fs::path(android_rootfs_dir) / dir_name;
-    auto src_dir_path = SystemConfiguration::instance().data_dir() / dir_name;
-
-    if (!fs::exists(src_dir_path)) {
-      if (!fs::create_directory(src_dir_path)) {
-        ERROR("Failed to create Android %s directory", dir_name);
-        mounts_.clear();
-        return false;
-      }
-      if (::chown(src_dir_path.c_str(), unprivileged_user_id, unprivileged_user_id) != 0) {
-        ERROR("Failed to allow access for unprivileged user on %s directory of the rootfs", dir_name);
-        mounts_.clear();
-        return false;
-      }
-    }
+  return true;
+}
 
-    auto m = common::MountEntry::create(src_dir_path, target_dir_path, "", MS_MGC_VAL | MS_BIND | MS_PRIVATE);
-    if (!m) {
-      ERROR("Failed to mount Android %s directory", dir_name);
-      mounts_.clear();
-      return false;
-    }
-    mounts_.push_back(m);
+void anbox::cmds::ContainerManager::start_readahead(const fs::path &android_img_path) {
+  if (readahead_mode_ == "record") {
+    // Only a cold boot shows everything Android reads from the image
+    common::ImageReadahead::drop_cache(android_img_path);
+    common::BootTimeline::get()->mark("image-cache-cold");
+    return;
+  } else if (readahead_mode_ != "replay") {
+    return;
   }
 
-  // Unmounting needs to happen in reverse order
-  std::reverse(mounts_.begin(), mounts_.end());
+  std::vector<common::Extent> extents;
+  if (!common::ImageReadahead::load_profile(readahead_profile_path_, android_img_path, extents)) {
+    DEBUG("No readahead profile available for %s", android_img_path);
+    return;
+  }
 
-  return true;
+  const auto total = common::ImageReadahead::total_size(extents);
+  const auto cached = common::ImageReadahead::cached_size(
+      extents, common::ImageReadahead::cached_extents(android_img_path));
+  const auto warm = cached * 2 >= total;
+  INFO("%d of %d KiB of the Android image needed for boot are already cached (%s boot)",
+       cached / 1024, total / 1024, warm ? "warm" : "cold");
+  common::BootTimeline::get()->mark(warm ? "image-cache-warm" : "image-cache-cold");
+
+  const auto started = std::chrono::steady_clock::now();
+  readahead_ = common::ImageReadahead::start(android_img_path, extents,
+                                             common::ImageReadahead::default_thread_count,
+                                             [total, started]() {
+    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started);
+    DEBUG("Read ahead %d KiB of the Android image in %d ms", total / 1024, duration.count());
+    common::BootTimeline::get()->mark("image-readahead-finished");
+  });
+  if (!readahead_)
+    WARNING("Failed to start readahead of %s", android_img_path);
 }
@@ -24,6 +24,7 @@
 
 #include "anbox/cli.h"
 
+#include "anbox/common/image_readahead.h"
 #include "anbox/common/loop_device.h"
 #include "anbox/common/mount_entry.h"
 
@@ -36,11 +37,17 @@ class ContainerManager : public cli::CommandWithFlagsAndAction {
 
  private:
   bool setup_mounts();
+  void start_readahead(const boost::filesystem::path &android_img_path);
 
   std::string android_img_path_;
   std::string data_path_;
   std::shared_ptr<common::LoopDevice> android_img_loop_dev_;
   std::vector<std::shared_ptr<common::MountEntry>> mounts_;
+  std::string readahead_mode_ = "replay";
+  boost::filesystem::path readahead_profile_path_;
+  std::shared_ptr<common::ImageReadahead> readahead_;
+  std::shared_ptr<common::ReadaheadRecorder> readahead_recorder_;
+  unsigned int max_instances_ = 1;
   bool privileged_ = false;
   bool daemon_ = false;
 };
@@ -16,6 +16,7 @@
  */
 
 #include "anbox/cmds/launch.h"
+#include "anbox/common/boot_timeline.h"
 #include "anbox/common/wait_handle.h"
 #include "anbox/dbus/stub/application_manager.h"
 #include "anbox/common/dispatcher.h"
@@ -41,9 +42,11 @@ const std::chrono::seconds restart_interval{5};
 }
 
 bool anbox::cmds::Launch::try_launch_activity(const std::shared_ptr<dbus::stub::ApplicationManager> &stub) {
+  common::BootTimeline::get()->mark("android-ready");
   try {
     DEBUG("Sending launch intent %s to Android ..", intent_);
     stub->launch(intent_, graphics::Rect::Invalid, stack_);
+    common::BootTimeline::get()->mark("activity-launched");
   } catch (const std::exception &err) {
     ERROR("Failed to launch activity: %s", err.what());
     return false;
@@ -74,6 +77,9 @@ anbox::cmds::Launch::Launch()
   flag(cli::make_flag(cli::Name{"component"},
                       cli::Description{"Component of a package the intent should go"},
                       intent_.component));
+  flag(cli::make_flag(cli::Name{"instance"},
+                      cli::Description{"Id of the Android instance to launch the activity in"},
+                      instance_id_));
   flag(cli::make_flag(cli::Name{"stack"},
                       cli::Description{"Which window stack the activity should be started on. Possible: default, fullscreen, freeform"},
                       stack_));
@@ -85,6 +91,14 @@ anbox::cmds::Launch::Launch()
       trap->stop();
     });
 
+    if (!SystemConfiguration::is_valid_instance_id(instance_id_)) {
+      ERROR("Invalid instance id '%s'", instance_id_);
+      return EXIT_FAILURE;
+    }
+    SystemConfiguration::instance().set_instance_id(instance_id_);
+
+    common::BootTimeline::get()->start("launch");
+
     auto rt = Runtime::create();
 
     auto bus = std::make_shared<core::dbus::Bus>(core::dbus::WellKnownBus::session);
@@ -106,6 +120,7 @@ anbox::cmds::Launch::Launch()
     for (auto n = 0; n < max_restart_attempts; n++) {
       try {
         stub = dbus::stub::ApplicationManager::create_for_bus(bus);
+        common::BootTimeline::get()->mark("session-manager-connected");
         break;
       } catch (std::exception &err) {
         WARNING("Anbox session manager service isn't running, trying to start it.");
@@ -117,6 +132,8 @@ anbox::cmds::Launch::Launch()
           ss = std::make_shared<ui::SplashScreen>();
 
         std::vector<std::string> args = {"session-manager"};
+        if (instance_id_ != SystemConfiguration::default_instance_id)
+          args.push_back(utils::string_format("--instance=%s", instance_id_));
 
         std::map<std::string,std::string> env;
         core::posix::this_process::env::for_each([&](const std::string &name, const std::string &value) {
@@ -142,6 +159,7 @@ anbox::cmds::Launch::Launch()
           // direct child of the init process so it keeps running on its own and
           // indepent of our short living process here.
           child.wait_for(core::posix::wait::Flags::untraced);
+          common::BootTimeline::get()->mark("session-manager-spawned");
 
           DEBUG("Started session manager, will now try to connect ..");
         }
@@ -193,6 +211,8 @@ anbox::cmds::Launch::Launch()
     trap->run();
     rt->stop();
 
+    if (success) common::BootTimeline::get()->report();
+
     return success ? EXIT_SUCCESS : EXIT_FAILURE;
   });
 }
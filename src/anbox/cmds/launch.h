@@ -26,6 +26,7 @@
 #include "anbox/dbus/stub/application_manager.h"
 #include "anbox/wm/stack.h"
 #include "anbox/cli.h"
+#include "anbox/config.h"
 
 namespace anbox {
 namespace cmds {
@@ -38,6 +39,7 @@ class Launch : public cli::CommandWithFlagsAndAction {
 
   android::Intent intent_;
   wm::Stack::Id stack_;
+  std::string instance_id_ = SystemConfiguration::default_instance_id;
 };
 }  // namespace cmds
 }  // namespace anbox
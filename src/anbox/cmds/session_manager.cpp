@@ -27,11 +27,22 @@
 #include "anbox/bridge/android_api_stub.h"
 #include "anbox/bridge/platform_api_skeleton.h"
 #include "anbox/bridge/platform_message_processor.h"
+#include "anbox/camera/manager.h"
 #include "anbox/cmds/session_manager.h"
+#include "anbox/common/boot_timeline.h"
 #include "anbox/common/dispatcher.h"
+#include "anbox/common/tracer.h"
 #include "anbox/config.h"
 #include "anbox/container/client.h"
 #include "anbox/dbus/skeleton/service.h"
+#include "anbox/graphics/density.h"
+#include "anbox/graphics/memory_accounting.h"
+#include "anbox/graphics/render_scale.h"
+#ifndef USE_SFDROID
+#include "anbox/headless/platform_policy.h"
+#endif
+#include "anbox/input/device.h"
+#include "anbox/input/latency_tracker.h"
 #include "anbox/input/manager.h"
 #include "anbox/logger.h"
 #include "anbox/network/published_socket_connector.h"
@@ -39,7 +50,9 @@
 #include "anbox/rpc/channel.h"
 #include "anbox/rpc/connection_creator.h"
 #include "anbox/runtime.h"
+#include "anbox/sensors/manager.h"
 #include "anbox/ubuntu/platform_policy.h"
+#include "anbox/utils.h"
 #include "anbox/wm/multi_window_manager.h"
 #include "anbox/wm/single_window_manager.h"
 
@@ -57,6 +70,7 @@ namespace fs = boost::filesystem;
 
 namespace {
 const anbox::graphics::Rect default_single_window_size{0, 0, 1024, 768};
+constexpr const long input_latency_report_interval{60};
 
 class NullConnectionCreator : public anbox::network::ConnectionCreator<
                                   boost::asio::local::stream_protocol> {
@@ -104,13 +118,37 @@ anbox::cmds::SessionManager::SessionManager(const BusFactory &bus_factory)
   flag(cli::make_flag(cli::Name{"gles-driver"},
                       cli::Description{"Which GLES driver to use. Possible values are 'host' or'translator'"},
                       gles_driver_));
+  flag(cli::make_flag(cli::Name{"headless"},
+                      cli::Description{"Run without a display. Windows are rendered offscreen and published through shared memory and input is read from a socket. The display size is taken from --window-size"},
+                      headless_));
 #endif
+  flag(cli::make_flag(cli::Name{"instance"},
+                      cli::Description{"Id of the Android instance this session runs. Only needed when running multiple instances on one host"},
+                      instance_id_));
   flag(cli::make_flag(cli::Name{"single-window"},
                       cli::Description{"Start in single window mode."},
                       single_window_));
   flag(cli::make_flag(cli::Name{"window-size"},
                       cli::Description{"Size of the window in single window mode, e.g. --window-size=1024,768"},
                       window_size_));
+  flag(cli::make_flag(cli::Name{"trace"},
+                      cli::Description{"Record a trace of the whole session and write it in Chrome trace event format to the given file on exit"},
+                      trace_file_));
+  flag(cli::make_flag(cli::Name{"sensor-source"},
+                      cli::Description{"Where values for the emulated sensors come from. Possible values are 'static', 'synthetic' or 'replay:<path>'"},
+                      sensor_source_));
+  flag(cli::make_flag(cli::Name{"camera-source"},
+                      cli::Description{"Comma separated list of cameras to expose to Android. Possible values are 'synthetic', 'v4l2:<device>' or 'file:<path to y4m video>'"},
+                      camera_source_));
+  flag(cli::make_flag(cli::Name{"render-scale"},
+                      cli::Description{"Fraction of the display resolution Android renders at, e.g. --render-scale=0.5. Can be changed at runtime through the org.anbox.Display D-Bus interface"},
+                      render_scale_));
+  flag(cli::make_flag(cli::Name{"gpu-memory-soft-limit"},
+                      cli::Description{"GPU memory in MiB a single GL client of Android can use before its least recently used buffers are moved to system memory. 0 means no limit"},
+                      gpu_memory_soft_limit_));
+  flag(cli::make_flag(cli::Name{"gpu-memory-hard-limit"},
+                      cli::Description{"GPU memory in MiB a single GL client of Android can use at most, further allocations fail. 0 means no limit"},
+                      gpu_memory_hard_limit_));
 
   action([this](const cli::Command::Context &) {
     auto trap = core::posix::trap_signals_for_process(
@@ -120,6 +158,19 @@ anbox::cmds::SessionManager::SessionManager(const BusFactory &bus_factory)
       trap->stop();
     });
 
+    common::BootTimeline::get()->start("session-manager");
+    // The first frame Android renders after it reported to be booted is
+    // when the session is usable.
+    common::BootTimeline::get()->when_reached("first-frame-after-boot", []() {
+      common::BootTimeline::get()->report();
+    });
+
+    if (!SystemConfiguration::is_valid_instance_id(instance_id_)) {
+      ERROR("Invalid instance id '%s'", instance_id_);
+      return EXIT_FAILURE;
+    }
+    SystemConfiguration::instance().set_instance_id(instance_id_);
+
     if (!fs::exists("/dev/binder") || !fs::exists("/dev/ashmem")) {
       ERROR("Failed to start as either binder or ashmem kernel drivers are not loaded");
       return EXIT_FAILURE;
@@ -130,7 +181,47 @@ anbox::cmds::SessionManager::SessionManager(const BusFactory &bus_factory)
         SystemConfiguration::instance().input_device_dir(),
     });
 
+    if (!trace_file_.empty())
+      common::Tracer::get()->start();
+
+    if (!sensor_source_.empty()) {
+      try {
+        sensors::Manager::get()->set_source(sensors::Manager::create_source(sensor_source_));
+      } catch (const std::exception &err) {
+        ERROR("%s", err.what());
+        return EXIT_FAILURE;
+      }
+    }
+
+    for (const auto &spec : utils::string_split(camera_source_, ',')) {
+      if (spec.empty()) continue;
+      try {
+        camera::Manager::get()->add_source(camera::Manager::create_source(spec));
+      } catch (const std::exception &err) {
+        ERROR("%s", err.what());
+        return EXIT_FAILURE;
+      }
+    }
+
+    if (!graphics::RenderScale::get()->set(render_scale_)) {
+      ERROR("Render scale has to be between %f and %f",
+            graphics::RenderScale::min_scale, graphics::RenderScale::max_scale);
+      return EXIT_FAILURE;
+    }
+
+    if (gpu_memory_hard_limit_ > 0 && gpu_memory_soft_limit_ > gpu_memory_hard_limit_) {
+      ERROR("GPU memory soft limit has to be below the hard limit");
+      return EXIT_FAILURE;
+    }
+    graphics::MemoryAccounting::get()->set_budget(
+        {gpu_memory_soft_limit_ * 1024 * 1024, gpu_memory_hard_limit_ * 1024 * 1024});
+
     auto rt = Runtime::create();
+    // Input and audio get their own threads so that they are not delayed
+    // by slow handlers of other components. Audio stream writes block until
+    // the mixer has room, which must never happen on a SCHED_FIFO thread.
+    rt->add_executor({input::Device::executor, 1, Runtime::Priority::realtime, {}});
+    rt->add_executor({audio::Server::executor, 4, Runtime::Priority::normal, {}});
     auto dispatcher = anbox::common::create_dispatcher_for_runtime(rt);
 
     container::Client container(rt);
@@ -156,9 +247,23 @@ anbox::cmds::SessionManager::SessionManager(const BusFactory &bus_factory)
     if (single_window_)
       display_frame = window_size_;
 
-    auto policy = std::make_shared<ubuntu::PlatformPolicy>(input_manager, display_frame, single_window_);
-    // FIXME this needs to be removed and solved differently behind the scenes
-    registerDisplayManager(policy);
+    std::shared_ptr<platform::Policy> policy;
+#ifndef USE_SFDROID
+    if (headless_) {
+      // There is no display we could ask for its size
+      display_frame = window_size_;
+      auto headless_policy = std::make_shared<headless::PlatformPolicy>(rt, input_manager, display_frame);
+      // FIXME this needs to be removed and solved differently behind the scenes
+      registerDisplayManager(headless_policy);
+      policy = headless_policy;
+    } else
+#endif
+    {
+      auto ubuntu_policy = std::make_shared<ubuntu::PlatformPolicy>(input_manager, display_frame, single_window_);
+      // FIXME this needs to be removed and solved differently behind the scenes
+      registerDisplayManager(ubuntu_policy);
+      policy = ubuntu_policy;
+    }
 
     auto app_db = std::make_shared<application::Database>();
 
@@ -169,6 +274,32 @@ anbox::cmds::SessionManager::SessionManager(const BusFactory &bus_factory)
       window_manager = std::make_shared<wm::MultiWindowManager>(policy, android_api_stub, app_db);
     policy->set_window_manager(window_manager);
 
+    // Android only learns about a reduced render scale once it's booted as
+    // the window manager has to be up to apply it. Calling into Android
+    // blocks until it replied so we never do that from the bridge itself.
+    auto apply_render_scale = [&]() {
+      dispatcher->dispatch([&]() {
+        auto scale = graphics::RenderScale::get();
+        auto size = graphics::Rect::Empty;
+        auto density = 0;
+        if (scale->value() < graphics::RenderScale::max_scale) {
+          const auto info = DisplayManager::get()->display_info();
+          size = scale->guest_display_size({0, 0, info.horizontal_resolution, info.vertical_resolution});
+          density = scale->guest_density(static_cast<int>(graphics::DensityType::medium));
+        }
+        try {
+          android_api_stub->set_display_size(size, density);
+        } catch (const std::exception &err) {
+          WARNING("Failed to apply render scale: %s", err.what());
+        }
+      });
+    };
+
+    graphics::RenderScale::get()->register_change_handler([&](float) {
+      if (android_api_stub->ready().get())
+        apply_render_scale();
+    });
+
     auto audio_server = std::make_shared<audio::Server>(rt, policy);
     const auto socket_path = SystemConfiguration::instance().socket_dir();
 
@@ -190,8 +321,14 @@ anbox::cmds::SessionManager::SessionManager(const BusFactory &bus_factory)
       gles_driver_ = graphics::GLRendererServer::Config::Driver::Host;
     }
 
+    // The translator only knows how to render into X11 windows
+    if (headless_ && gles_driver_ != graphics::GLRendererServer::Config::Driver::Host) {
+      INFO("Running headless; forcing use of the host EGL driver.");
+      gles_driver_ = graphics::GLRendererServer::Config::Driver::Host;
+    }
+
     auto gl_server = std::make_shared<graphics::GLRendererServer>(
-          graphics::GLRendererServer::Config{gles_driver_, single_window_}, window_manager);
+          graphics::GLRendererServer::Config{gles_driver_, single_window_, headless_}, window_manager);
 
     policy->set_renderer(gl_server->renderer());
 
@@ -221,13 +358,16 @@ anbox::cmds::SessionManager::SessionManager(const BusFactory &bus_factory)
                   pending_calls, policy, window_manager, app_db);
               server->register_boot_finished_handler([&]() {
                 DEBUG("Android successfully booted");
+                common::BootTimeline::get()->mark_once("boot-finished");
                 android_api_stub->ready().set(true);
+                apply_render_scale();
               });
               return std::make_shared<bridge::PlatformMessageProcessor>(
                   sender, server, pending_calls);
             }));
 
     container::Configuration container_configuration;
+    container_configuration.instance = instance_id_;
     container_configuration.bind_mounts = {
     #ifdef USE_SFDROID
         {sfdroid_server->socket_file(), "/dev/sfdroid_head"},
@@ -236,27 +376,39 @@ anbox::cmds::SessionManager::SessionManager(const BusFactory &bus_factory)
         {bridge_connector->socket_file(), "/dev/anbox_bridge"},
         {audio_server->socket_file(), "/dev/anbox_audio"},
         {SystemConfiguration::instance().input_device_dir(), "/dev/input"},
-        {"/dev/binder", "/dev/binder"},
         {"/dev/ashmem", "/dev/ashmem"},
         {"/dev/fuse", "/dev/fuse"},
     };
 
-    dispatcher->dispatch([&]() { container.start(container_configuration); });
+    dispatcher->dispatch([&]() {
+      common::BootTimeline::get()->mark("container-start-requested");
+      container.start(container_configuration);
+    });
 
     auto bus = bus_factory_();
     bus->install_executor(core::dbus::asio::make_executor(bus, rt->service()));
 
-    auto skeleton = anbox::dbus::skeleton::Service::create_for_bus(bus, app_manager);
+    auto skeleton = anbox::dbus::skeleton::Service::create_for_bus(bus, app_manager, rt);
+
+    input::LatencyTracker::get()->report_periodically(
+        rt->service(), boost::posix_time::seconds(input_latency_report_interval));
 
     rt->start();
     trap->run();
 
+    input::LatencyTracker::get()->stop_reporting();
+
     // Stop the container which should close all open connections we have on
     // our side and should terminate all services.
     container.stop();
 
+    graphics::RenderScale::get()->register_change_handler(nullptr);
+
     rt->stop();
 
+    if (!trace_file_.empty() && !common::Tracer::get()->stop(trace_file_))
+      ERROR("Failed to write trace to %s", trace_file_);
+
     return EXIT_SUCCESS;
   });
 }
@@ -19,7 +19,9 @@
 #define ANBOX_CMDS_RUN_H_
 
 #include "anbox/cli.h"
+#include "anbox/config.h"
 
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -49,9 +51,17 @@ class SessionManager : public cli::CommandWithFlagsAndAction {
   std::string desktop_file_hint_;
 #ifndef USE_SFDROID
   graphics::GLRendererServer::Config::Driver gles_driver_;
+  bool headless_ = false;
 #endif
   bool single_window_ = false;
   graphics::Rect window_size_;
+  std::string trace_file_;
+  std::string sensor_source_;
+  std::string camera_source_;
+  float render_scale_ = 1.0f;
+  std::uint64_t gpu_memory_soft_limit_ = 0;
+  std::uint64_t gpu_memory_hard_limit_ = 0;
+  std::string instance_id_ = SystemConfiguration::default_instance_id;
 };
 }  // namespace cmds
 }  // namespace anbox
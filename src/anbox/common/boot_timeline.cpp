@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/common/boot_timeline.h"
+#include "anbox/logger.h"
+#include "anbox/utils.h"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace fs = boost::filesystem;
+
+namespace {
+constexpr const char *timeline_extension{".timeline"};
+constexpr const char *report_name{"report"};
+constexpr const std::size_t slowest_steps{5};
+
+using Milestone = anbox::common::BootTimeline::Milestone;
+
+// Everything before the most recent session manager start (or the launch
+// command which spawned it) belongs to an earlier session.
+std::vector<Milestone> current_session(const std::vector<Milestone> &milestones) {
+  std::int64_t session_start = -1, launch_start = -1;
+  for (const auto &m : milestones) {
+    if (m.name == "session-manager-started") session_start = m.timestamp_us;
+    else if (m.name == "launch-started") launch_start = m.timestamp_us;
+  }
+
+  auto begin = session_start;
+  if (launch_start >= 0 && (begin < 0 || launch_start < begin)) begin = launch_start;
+
+  std::vector<Milestone> session;
+  for (const auto &m : milestones) {
+    if (m.timestamp_us >= begin) session.push_back(m);
+  }
+  return session;
+}
+
+double seconds(std::int64_t us) { return us / 1e6; }
+}  // namespace
+
+namespace anbox {
+namespace common {
+constexpr const char *BootTimeline::environment_variable;
+
+std::shared_ptr<BootTimeline> BootTimeline::get() {
+  static auto instance = std::shared_ptr<BootTimeline>(new BootTimeline);
+  return instance;
+}
+
+std::int64_t BootTimeline::now() {
+  struct timespec ts;
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<std::int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+BootTimeline::BootTimeline() : enabled_{false}, fd_{-1} {}
+
+void BootTimeline::start(const std::string &process) {
+  const auto dir = utils::get_env_value(environment_variable, "");
+  if (!dir.empty()) start(dir, process);
+}
+
+void BootTimeline::start(const std::string &dir, const std::string &process) {
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    enabled_ = false;
+    if (fd_ >= 0) ::close(fd_);
+
+    boost::system::error_code err;
+    fs::create_directories(dir, err);
+
+    const auto path = (fs::path(dir) / (process + timeline_extension)).string();
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+      WARNING("Failed to open boot timeline %s: %s", path, std::strerror(errno));
+      return;
+    }
+
+    dir_ = dir;
+    process_ = process;
+    reached_.clear();
+    enabled_ = true;
+  }
+
+  mark(process + "-started");
+}
+
+std::string BootTimeline::directory() const {
+  std::lock_guard<std::mutex> l(lock_);
+  return dir_;
+}
+
+void BootTimeline::mark(const std::string &name) {
+  if (!enabled()) return;
+
+  std::vector<std::function<void()>> handlers;
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    handlers = mark_locked(name);
+  }
+
+  for (const auto &handler : handlers) handler();
+}
+
+bool BootTimeline::mark_once(const std::string &name) {
+  if (!enabled()) return false;
+
+  std::vector<std::function<void()>> handlers;
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    if (reached_.count(name) > 0) return false;
+    handlers = mark_locked(name);
+  }
+
+  for (const auto &handler : handlers) handler();
+  return true;
+}
+
+std::vector<std::function<void()>> BootTimeline::mark_locked(const std::string &name) {
+  reached_.insert(name);
+
+  std::vector<std::function<void()>> handlers;
+  const auto it = handlers_.find(name);
+  if (it != handlers_.end()) {
+    handlers = std::move(it->second);
+    handlers_.erase(it);
+  }
+
+  // A single write with O_APPEND keeps lines intact even if another
+  // process appends to the same file.
+  const auto line = utils::string_format("%d %s %s\n", now(), process_, name);
+  if (::write(fd_, line.c_str(), line.size()) < 0)
+    WARNING("Failed to record boot milestone %s: %s", name, std::strerror(errno));
+
+  return handlers;
+}
+
+bool BootTimeline::reached(const std::string &name) const {
+  std::lock_guard<std::mutex> l(lock_);
+  return reached_.count(name) > 0;
+}
+
+void BootTimeline::when_reached(const std::string &name,
+                                const std::function<void()> &handler) {
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    if (reached_.count(name) == 0) {
+      handlers_[name].push_back(handler);
+      return;
+    }
+  }
+  handler();
+}
+
+std::vector<BootTimeline::Milestone> BootTimeline::load(const std::string &dir) {
+  std::vector<Milestone> milestones;
+
+  boost::system::error_code err;
+  for (fs::directory_iterator it(dir, err), end; !err && it != end; it.increment(err)) {
+    if (it->path().extension() != timeline_extension) continue;
+
+    std::ifstream in(it->path().string());
+    std::string line;
+    while (std::getline(in, line)) {
+      std::istringstream fields(line);
+      std::int64_t timestamp = 0;
+      std::string process, name;
+      if (fields >> timestamp >> process >> name)
+        milestones.emplace_back(timestamp, process, name);
+    }
+  }
+
+  std::stable_sort(milestones.begin(), milestones.end(),
+                   [](const Milestone &a, const Milestone &b) {
+                     return a.timestamp_us < b.timestamp_us;
+                   });
+  return milestones;
+}
+
+void BootTimeline::write_report(const std::vector<Milestone> &milestones,
+                                std::ostream &out) {
+  const auto session = current_session(milestones);
+  if (session.empty()) {
+    out << "No boot milestones recorded" << std::endl;
+    return;
+  }
+
+  const auto begin = session.front().timestamp_us;
+  out << utils::string_format("Boot took %.3fs (%d milestones) from %s to %s\n",
+                              seconds(session.back().timestamp_us - begin), session.size(),
+                              session.front().name, session.back().name);
+  out << "    offset      step  milestone (process)" << std::endl;
+
+  // Each step is the time from the previous milestone to this one; as all
+  // of them are on the way to a visible app they form the critical path.
+  std::vector<std::pair<std::int64_t, std::size_t>> steps;
+  for (std::size_t n = 0; n < session.size(); n++) {
+    const auto step = n > 0 ? session[n].timestamp_us - session[n - 1].timestamp_us : 0;
+    steps.push_back({step, n});
+    out << utils::string_format("  %7.3fs  %7.3fs  %s (%s)\n",
+                                seconds(session[n].timestamp_us - begin), seconds(step),
+                                session[n].name, session[n].process);
+  }
+
+  std::stable_sort(steps.begin(), steps.end(),
+                   [](const std::pair<std::int64_t, std::size_t> &a,
+                      const std::pair<std::int64_t, std::size_t> &b) {
+                     return a.first > b.first;
+                   });
+  out << "Slowest steps:" << std::endl;
+  for (std::size_t n = 0; n < std::min(slowest_steps, steps.size()); n++) {
+    if (steps[n].first == 0) break;
+    const auto index = steps[n].second;
+    out << utils::string_format("  %7.3fs  %s -> %s\n", seconds(steps[n].first),
+                                session[index - 1].name, session[index].name);
+  }
+}
+
+void BootTimeline::report() {
+  if (!enabled()) return;
+
+  const auto dir = directory();
+  const auto milestones = load(dir);
+  const auto path = (fs::path(dir) / report_name).string();
+  std::ofstream out(path, std::ofstream::trunc);
+  write_report(milestones, out);
+  if (!out) {
+    WARNING("Failed to write boot report to %s", path);
+    return;
+  }
+
+  const auto session = current_session(milestones);
+  if (!session.empty())
+    INFO("Boot took %.3f s until %s, see %s for details",
+         seconds(session.back().timestamp_us - session.front().timestamp_us),
+         session.back().name, path);
+}
+}  // namespace common
+}  // namespace anbox
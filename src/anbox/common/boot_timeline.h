@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_COMMON_BOOT_TIMELINE_H_
+#define ANBOX_COMMON_BOOT_TIMELINE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace anbox {
+namespace common {
+// BootTimeline records when the milestones of a session start are reached
+// so that cold start time can be measured and broken down. It's enabled by
+// pointing the ANBOX_BOOT_TIMELINE environment variable to a directory
+// all anbox processes can write to. Each process appends its milestones to
+// '<process>.timeline' in there. Timestamps are taken from the monotonic
+// clock so milestones of different processes can be put in order.
+class BootTimeline {
+ public:
+  static constexpr const char *environment_variable{"ANBOX_BOOT_TIMELINE"};
+
+  struct Milestone {
+    Milestone(std::int64_t timestamp_us, const std::string &process,
+              const std::string &name)
+        : timestamp_us(timestamp_us), process(process), name(name) {}
+
+    std::int64_t timestamp_us;
+    std::string process;
+    std::string name;
+  };
+
+  static std::shared_ptr<BootTimeline> get();
+  static std::int64_t now();
+
+  // Starts recording for the given process if ANBOX_BOOT_TIMELINE is set
+  // and marks '<process>-started'. Previous milestones of the process are
+  // dropped.
+  void start(const std::string &process);
+  // Same as above but records into dir independent of the environment.
+  void start(const std::string &dir, const std::string &process);
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  std::string directory() const;
+
+  void mark(const std::string &name);
+  // Marks name only the first time it's reached. Returns true if this
+  // call recorded the milestone.
+  bool mark_once(const std::string &name);
+  bool reached(const std::string &name) const;
+
+  // Calls handler on the thread marking the milestone once it's reached.
+  void when_reached(const std::string &name, const std::function<void()> &handler);
+
+  // Reads the milestones of all processes from dir sorted by time.
+  static std::vector<Milestone> load(const std::string &dir);
+  // Writes the milestones of the most recent session start in order with
+  // the time spent between each of them and a list of the slowest steps.
+  static void write_report(const std::vector<Milestone> &milestones, std::ostream &out);
+  // Loads the timeline of all processes, writes the report to 'report' in
+  // the timeline directory and logs the total time.
+  void report();
+
+ private:
+  BootTimeline();
+
+  // Records the milestone and returns the handlers waiting for it which
+  // the caller has to run once the lock is released.
+  std::vector<std::function<void()>> mark_locked(const std::string &name);
+
+  std::atomic<bool> enabled_;
+  mutable std::mutex lock_;
+  std::string dir_;
+  std::string process_;
+  int fd_;
+  std::set<std::string> reached_;
+  std::map<std::string, std::vector<std::function<void()>>> handlers_;
+};
+}  // namespace common
+}  // namespace anbox
+
+#endif
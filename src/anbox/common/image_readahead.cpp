@@ -0,0 +1,342 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/common/image_readahead.h"
+#include "anbox/logger.h"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = boost::filesystem;
+
+namespace {
+constexpr const char *profile_magic{"anbox-readahead"};
+constexpr const int profile_version{1};
+// Upper bound for a single readahead call so that stopping doesn't have to
+// wait for a huge extent to be read.
+constexpr const std::uint64_t max_read_size{2 * 1024 * 1024};
+
+std::uint64_t to_mib(std::uint64_t bytes) { return bytes / (1024 * 1024); }
+}  // namespace
+
+namespace anbox {
+namespace common {
+constexpr const std::size_t ImageReadahead::default_thread_count;
+constexpr const std::uint64_t ImageReadahead::merge_gap;
+constexpr const std::chrono::seconds ReadaheadRecorder::sample_interval;
+constexpr const std::chrono::seconds ReadaheadRecorder::max_duration;
+constexpr const std::uint64_t ReadaheadRecorder::boot_started_threshold;
+constexpr const std::uint64_t ReadaheadRecorder::settled_threshold;
+constexpr const int ReadaheadRecorder::settled_samples;
+
+std::vector<Extent> ImageReadahead::cached_extents(const fs::path &path) {
+  std::vector<Extent> extents;
+
+  const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return extents;
+
+  struct stat st;
+  if (::fstat(fd, &st) < 0 || st.st_size == 0) {
+    ::close(fd);
+    return extents;
+  }
+
+  const auto size = static_cast<std::uint64_t>(st.st_size);
+  // Mapping the file doesn't read anything; mincore only looks at the
+  // page cache.
+  auto mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) return extents;
+
+  const std::uint64_t page_size = ::sysconf(_SC_PAGESIZE);
+  std::vector<unsigned char> pages((size + page_size - 1) / page_size);
+  if (::mincore(mapping, size, pages.data()) == 0) {
+    for (std::size_t n = 0; n < pages.size(); n++) {
+      if ((pages[n] & 1) == 0) continue;
+
+      const auto offset = n * page_size;
+      const auto length = std::min(page_size, size - offset);
+      if (!extents.empty() && extents.back().offset + extents.back().length == offset)
+        extents.back().length += length;
+      else
+        extents.emplace_back(offset, length);
+    }
+  }
+
+  ::munmap(mapping, size);
+  return extents;
+}
+
+void ImageReadahead::drop_cache(const fs::path &path) {
+  const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return;
+  ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  ::close(fd);
+}
+
+std::uint64_t ImageReadahead::total_size(const std::vector<Extent> &extents) {
+  std::uint64_t size = 0;
+  for (const auto &extent : extents) size += extent.length;
+  return size;
+}
+
+std::uint64_t ImageReadahead::cached_size(const std::vector<Extent> &extents,
+                                          const std::vector<Extent> &cached) {
+  std::uint64_t size = 0;
+  auto c = cached.begin();
+  for (const auto &extent : extents) {
+    const auto end = extent.offset + extent.length;
+    while (c != cached.end() && c->offset + c->length <= extent.offset) ++c;
+    for (auto it = c; it != cached.end() && it->offset < end; ++it) {
+      const auto overlap_begin = std::max(extent.offset, it->offset);
+      const auto overlap_end = std::min(end, it->offset + it->length);
+      size += overlap_end - overlap_begin;
+    }
+  }
+  return size;
+}
+
+std::vector<Extent> ImageReadahead::coalesce(std::vector<Extent> extents,
+                                             std::uint64_t gap) {
+  std::sort(extents.begin(), extents.end(), [](const Extent &a, const Extent &b) {
+    return a.offset < b.offset;
+  });
+
+  std::vector<Extent> merged;
+  for (const auto &extent : extents) {
+    if (extent.length == 0) continue;
+
+    if (!merged.empty()) {
+      auto &last = merged.back();
+      const auto last_end = last.offset + last.length;
+      if (extent.offset <= last_end + gap) {
+        last.length = std::max(last_end, extent.offset + extent.length) - last.offset;
+        continue;
+      }
+    }
+    merged.push_back(extent);
+  }
+  return merged;
+}
+
+std::vector<std::vector<Extent>> ImageReadahead::partition(
+    const std::vector<Extent> &extents, std::size_t count) {
+  std::vector<std::vector<Extent>> parts;
+  const auto total = total_size(extents);
+  if (total == 0 || count == 0) return parts;
+
+  const auto part_size = (total + count - 1) / count;
+  parts.emplace_back();
+  std::uint64_t filled = 0;
+  for (auto extent : extents) {
+    while (extent.length > 0) {
+      if (filled == part_size) {
+        parts.emplace_back();
+        filled = 0;
+      }
+      const auto length = std::min(extent.length, part_size - filled);
+      parts.back().emplace_back(extent.offset, length);
+      filled += length;
+      extent.offset += length;
+      extent.length -= length;
+    }
+  }
+  return parts;
+}
+
+bool ImageReadahead::save_profile(const fs::path &profile_path,
+                                  const fs::path &image_path,
+                                  const std::vector<Extent> &extents) {
+  boost::system::error_code err;
+  const auto image_size = fs::file_size(image_path, err);
+  if (err) return false;
+  const auto image_time = fs::last_write_time(image_path, err);
+  if (err) return false;
+
+  // Written to a temporary file first so that a crash doesn't leave a
+  // truncated profile behind.
+  const auto tmp_path = profile_path.string() + ".tmp";
+  {
+    std::ofstream out(tmp_path, std::ofstream::trunc);
+    out << profile_magic << " " << profile_version << " " << image_size << " "
+        << image_time << std::endl;
+    for (const auto &extent : extents) out << extent.offset << " " << extent.length << "\n";
+    if (!out) return false;
+  }
+
+  fs::rename(tmp_path, profile_path, err);
+  return !err;
+}
+
+bool ImageReadahead::load_profile(const fs::path &profile_path,
+                                  const fs::path &image_path,
+                                  std::vector<Extent> &extents) {
+  boost::system::error_code err;
+  const auto image_size = fs::file_size(image_path, err);
+  if (err) return false;
+  const auto image_time = fs::last_write_time(image_path, err);
+  if (err) return false;
+
+  std::ifstream in(profile_path.string());
+  std::string magic;
+  int version = 0;
+  std::uintmax_t size = 0;
+  std::time_t time = 0;
+  if (!(in >> magic >> version >> size >> time) || magic != profile_magic ||
+      version != profile_version)
+    return false;
+
+  if (size != image_size || time != image_time) {
+    DEBUG("Ignoring readahead profile %s as it was recorded for a different image",
+          profile_path);
+    return false;
+  }
+
+  std::vector<Extent> loaded;
+  std::uint64_t offset = 0, length = 0;
+  while (in >> offset >> length) {
+    if (offset + length > image_size) return false;
+    loaded.emplace_back(offset, length);
+  }
+  if (!in.eof()) return false;
+
+  extents = coalesce(loaded, 0);
+  return true;
+}
+
+std::shared_ptr<ImageReadahead> ImageReadahead::start(const fs::path &image_path,
+                                                      const std::vector<Extent> &extents,
+                                                      std::size_t thread_count,
+                                                      const std::function<void()> &finished) {
+  const auto fd = ::open(image_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return nullptr;
+
+  auto readahead = std::shared_ptr<ImageReadahead>(new ImageReadahead(fd, finished));
+  const auto parts = partition(extents, thread_count);
+  if (parts.empty()) {
+    if (finished) finished();
+    return readahead;
+  }
+
+  // Every thread reads a continuous part of the image in ascending order
+  // so that the disk sees mostly sequential requests.
+  readahead->running_ = parts.size();
+  for (const auto &part : parts) {
+    auto r = readahead.get();
+    readahead->threads_.emplace_back([r, part]() { r->read_extents(part); });
+  }
+  return readahead;
+}
+
+ImageReadahead::ImageReadahead(int fd, const std::function<void()> &finished)
+    : fd_{fd}, finished_{finished}, stopped_{false}, running_{0}, bytes_read_{0} {}
+
+ImageReadahead::~ImageReadahead() {
+  stopped_ = true;
+  wait();
+  ::close(fd_);
+}
+
+void ImageReadahead::wait() {
+  for (auto &thread : threads_) {
+    if (thread.joinable()) thread.join();
+  }
+}
+
+void ImageReadahead::read_extents(const std::vector<Extent> &extents) {
+  for (const auto &extent : extents) {
+    for (std::uint64_t done = 0; done < extent.length && !stopped_;) {
+      const auto length = std::min(max_read_size, extent.length - done);
+      if (::readahead(fd_, extent.offset + done, length) < 0) break;
+      done += length;
+      bytes_read_ += length;
+    }
+  }
+
+  if (running_.fetch_sub(1) == 1 && !stopped_ && finished_) finished_();
+}
+
+ReadaheadRecorder::ReadaheadRecorder(boost::asio::io_service &service,
+                                     const fs::path &image_path,
+                                     const fs::path &profile_path)
+    : timer_(service),
+      image_path_(image_path),
+      profile_path_(profile_path),
+      baseline_(0),
+      last_(0),
+      boot_started_(false),
+      quiet_samples_(0) {}
+
+void ReadaheadRecorder::start() {
+  baseline_ = last_ = ImageReadahead::total_size(ImageReadahead::cached_extents(image_path_));
+  schedule();
+}
+
+void ReadaheadRecorder::stop() { timer_.cancel(); }
+
+void ReadaheadRecorder::schedule() {
+  std::weak_ptr<ReadaheadRecorder> weak_self = shared_from_this();
+  timer_.expires_from_now(sample_interval);
+  timer_.async_wait([weak_self](const boost::system::error_code &err) {
+    if (err) return;
+    if (auto self = weak_self.lock()) self->sample();
+  });
+}
+
+void ReadaheadRecorder::sample() {
+  const auto extents = ImageReadahead::cached_extents(image_path_);
+  const auto cached = ImageReadahead::total_size(extents);
+
+  if (!boot_started_) {
+    if (cached >= baseline_ + boot_started_threshold) {
+      DEBUG("Android started to read its image, recording readahead profile");
+      boot_started_ = true;
+      boot_started_at_ = std::chrono::steady_clock::now();
+    }
+  } else {
+    quiet_samples_ = cached < last_ + settled_threshold ? quiet_samples_ + 1 : 0;
+    if (quiet_samples_ >= settled_samples ||
+        std::chrono::steady_clock::now() - boot_started_at_ >= max_duration) {
+      finish(extents);
+      return;
+    }
+  }
+
+  last_ = cached;
+  schedule();
+}
+
+void ReadaheadRecorder::finish(const std::vector<Extent> &extents) {
+  const auto profile = ImageReadahead::coalesce(extents, ImageReadahead::merge_gap);
+  if (!ImageReadahead::save_profile(profile_path_, image_path_, profile)) {
+    ERROR("Failed to write readahead profile to %s", profile_path_);
+    return;
+  }
+
+  INFO("Recorded %d MiB in %d extents of the Android image read during boot to %s",
+       to_mib(ImageReadahead::total_size(profile)), profile.size(), profile_path_);
+}
+}  // namespace common
+}  // namespace anbox
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_COMMON_IMAGE_READAHEAD_H_
+#define ANBOX_COMMON_IMAGE_READAHEAD_H_
+
+#include <boost/asio.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace anbox {
+namespace common {
+// A range of bytes within a file.
+struct Extent {
+  Extent(std::uint64_t offset, std::uint64_t length) : offset(offset), length(length) {}
+
+  bool operator==(const Extent &other) const {
+    return offset == other.offset && length == other.length;
+  }
+
+  std::uint64_t offset;
+  std::uint64_t length;
+};
+
+// ImageReadahead reads the parts of the Android image which are needed
+// while Android boots into the page cache before the container starts.
+// Otherwise squashfs issues them as many small random reads during the
+// start of zygote and system_server. The parts to read come from a profile
+// recorded by ReadaheadRecorder during an earlier cold boot.
+class ImageReadahead {
+ public:
+  static constexpr const std::size_t default_thread_count{4};
+  // Extents with a smaller gap between them are read as one.
+  static constexpr const std::uint64_t merge_gap{128 * 1024};
+
+  // Returns the parts of the file which are currently in the page cache.
+  static std::vector<Extent> cached_extents(const boost::filesystem::path &path);
+  // Evicts the file from the page cache so that a boot reads it from disk.
+  static void drop_cache(const boost::filesystem::path &path);
+
+  static std::uint64_t total_size(const std::vector<Extent> &extents);
+  // Returns the overlap of extents with the cached ones. Both have to be
+  // sorted.
+  static std::uint64_t cached_size(const std::vector<Extent> &extents,
+                                   const std::vector<Extent> &cached);
+  // Sorts extents and merges those which are less than gap bytes apart.
+  static std::vector<Extent> coalesce(std::vector<Extent> extents, std::uint64_t gap);
+  // Splits sorted extents into up to count parts of about the same number
+  // of bytes, each covering a continuous part of the file.
+  static std::vector<std::vector<Extent>> partition(const std::vector<Extent> &extents,
+                                                    std::size_t count);
+
+  // A profile is only valid for the image it was recorded for; load_profile
+  // returns false if the image changed since.
+  static bool save_profile(const boost::filesystem::path &profile_path,
+                           const boost::filesystem::path &image_path,
+                           const std::vector<Extent> &extents);
+  static bool load_profile(const boost::filesystem::path &profile_path,
+                           const boost::filesystem::path &image_path,
+                           std::vector<Extent> &extents);
+
+  // Starts reading extents of the image with thread_count threads in the
+  // background and calls finished from the last thread once everything is
+  // read. Returns nullptr if the image can't be opened.
+  static std::shared_ptr<ImageReadahead> start(const boost::filesystem::path &image_path,
+                                               const std::vector<Extent> &extents,
+                                               std::size_t thread_count = default_thread_count,
+                                               const std::function<void()> &finished = nullptr);
+
+  // Stops reading and waits for all threads to finish.
+  ~ImageReadahead();
+
+  void wait();
+  std::uint64_t bytes_read() const { return bytes_read_.load(); }
+
+ private:
+  ImageReadahead(int fd, const std::function<void()> &finished);
+
+  void read_extents(const std::vector<Extent> &extents);
+
+  int fd_;
+  std::function<void()> finished_;
+  std::atomic<bool> stopped_;
+  std::atomic<std::size_t> running_;
+  std::atomic<std::uint64_t> bytes_read_;
+  std::vector<std::thread> threads_;
+};
+
+// ReadaheadRecorder watches which parts of the image end up in the page
+// cache while Android boots and writes them to a profile once boot I/O has
+// settled. Boot is considered to have started once a significant amount of
+// the image got read and to be finished once only little is read over a
+// couple of samples in a row.
+class ReadaheadRecorder : public std::enable_shared_from_this<ReadaheadRecorder> {
+ public:
+  static constexpr const std::chrono::seconds sample_interval{2};
+  static constexpr const std::chrono::seconds max_duration{300};
+  static constexpr const std::uint64_t boot_started_threshold{8 * 1024 * 1024};
+  static constexpr const std::uint64_t settled_threshold{1024 * 1024};
+  static constexpr const int settled_samples{3};
+
+  ReadaheadRecorder(boost::asio::io_service &service,
+                    const boost::filesystem::path &image_path,
+                    const boost::filesystem::path &profile_path);
+
+  void start();
+  void stop();
+
+ private:
+  void schedule();
+  void sample();
+  void finish(const std::vector<Extent> &extents);
+
+  boost::asio::steady_timer timer_;
+  boost::filesystem::path image_path_;
+  boost::filesystem::path profile_path_;
+  std::uint64_t baseline_;
+  std::uint64_t last_;
+  bool boot_started_;
+  int quiet_samples_;
+  std::chrono::steady_clock::time_point boot_started_at_;
+};
+}  // namespace common
+}  // namespace anbox
+
+#endif
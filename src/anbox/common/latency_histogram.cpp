@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/common/latency_histogram.h"
+
+#include <boost/format.hpp>
+
+#include <algorithm>
+
+namespace anbox {
+namespace common {
+constexpr const std::size_t LatencyHistogram::num_buckets;
+
+LatencyHistogram::LatencyHistogram() { reset(); }
+
+LatencyHistogram::~LatencyHistogram() {}
+
+std::size_t LatencyHistogram::bucket_for(const std::uint64_t &us) {
+  std::size_t bucket = 0;
+  auto value = us;
+  while (value > 0 && bucket < num_buckets - 1) {
+    value >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+void LatencyHistogram::record(const std::chrono::microseconds &duration) {
+  const auto us = static_cast<std::uint64_t>(std::max<std::int64_t>(0, duration.count()));
+
+  buckets_[bucket_for(us)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_us_.fetch_add(us, std::memory_order_relaxed);
+
+  auto current_max = max_us_.load(std::memory_order_relaxed);
+  while (us > current_max &&
+         !max_us_.compare_exchange_weak(current_max, us, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset() {
+  for (auto &bucket : buckets_)
+    bucket = 0;
+  count_ = 0;
+  sum_us_ = 0;
+  max_us_ = 0;
+}
+
+std::uint64_t LatencyHistogram::count() const {
+  return count_.load(std::memory_order_relaxed);
+}
+
+std::chrono::microseconds LatencyHistogram::max() const {
+  return std::chrono::microseconds{max_us_.load(std::memory_order_relaxed)};
+}
+
+std::chrono::microseconds LatencyHistogram::mean() const {
+  const auto c = count();
+  if (c == 0) return std::chrono::microseconds{0};
+  return std::chrono::microseconds{sum_us_.load(std::memory_order_relaxed) / c};
+}
+
+std::chrono::microseconds LatencyHistogram::percentile(double p) const {
+  const auto c = count();
+  if (c == 0) return std::chrono::microseconds{0};
+
+  const auto wanted = static_cast<std::uint64_t>(c * p / 100.0 + 0.5);
+  std::uint64_t seen = 0;
+  for (std::size_t n = 0; n < num_buckets; n++) {
+    seen += buckets_[n].load(std::memory_order_relaxed);
+    if (seen >= wanted && seen > 0) {
+      const auto upper_bound = std::chrono::microseconds{n == 0 ? 0 : (1ULL << n) - 1};
+      return std::min(upper_bound, max());
+    }
+  }
+  return max();
+}
+
+std::map<std::string, std::uint64_t> LatencyHistogram::summary(const std::string &prefix) const {
+  return {
+      {prefix + "count", count()},
+      {prefix + "mean_us", static_cast<std::uint64_t>(mean().count())},
+      {prefix + "p50_us", static_cast<std::uint64_t>(percentile(50).count())},
+      {prefix + "p90_us", static_cast<std::uint64_t>(percentile(90).count())},
+      {prefix + "p99_us", static_cast<std::uint64_t>(percentile(99).count())},
+      {prefix + "max_us", static_cast<std::uint64_t>(max().count())},
+  };
+}
+
+std::string LatencyHistogram::to_string() const {
+  return (boost::format("n=%d mean=%dus p50=%dus p90=%dus p99=%dus max=%dus") %
+          count() % mean().count() % percentile(50).count() % percentile(90).count() %
+          percentile(99).count() % max().count()).str();
+}
+}  // namespace common
+}  // namespace anbox
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_COMMON_LATENCY_HISTOGRAM_H_
+#define ANBOX_COMMON_LATENCY_HISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace anbox {
+namespace common {
+// LatencyHistogram records durations into power-of-two sized microsecond
+// buckets. Recording is lock-free and can happen from any thread.
+class LatencyHistogram {
+ public:
+  // Bucket n holds all samples in [2^(n-1), 2^n) microseconds with the last
+  // one collecting everything above ~1s.
+  static constexpr const std::size_t num_buckets{21};
+
+  LatencyHistogram();
+  ~LatencyHistogram();
+
+  void record(const std::chrono::microseconds &duration);
+  void reset();
+
+  std::uint64_t count() const;
+  std::chrono::microseconds max() const;
+  std::chrono::microseconds mean() const;
+  // Returns the upper bound of the bucket the given percentile (0-100)
+  // falls into.
+  std::chrono::microseconds percentile(double p) const;
+
+  // Returns count, mean, p50, p90, p99 and max with the given prefix
+  // prepended to each key, suitable for exporting the histogram.
+  std::map<std::string, std::uint64_t> summary(const std::string &prefix) const;
+  std::string to_string() const;
+
+ private:
+  static std::size_t bucket_for(const std::uint64_t &us);
+
+  std::array<std::atomic<std::uint64_t>, num_buckets> buckets_;
+  std::atomic<std::uint64_t> count_;
+  std::atomic<std::uint64_t> sum_us_;
+  std::atomic<std::uint64_t> max_us_;
+};
+}  // namespace common
+}  // namespace anbox
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_COMMON_PREFIX_TRIE_H_
+#define ANBOX_COMMON_PREFIX_TRIE_H_
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace anbox {
+namespace common {
+// PrefixTrie maps string prefixes to values and finds the longest inserted
+// prefix of a key in a single pass over the key. It is meant for small,
+// rarely changing sets of prefixes which are matched often.
+template <typename T>
+class PrefixTrie {
+ public:
+  PrefixTrie() : nodes_(1) {}
+
+  void insert(const std::string &prefix, const T &value) {
+    std::size_t node = 0;
+    for (const auto c : prefix) {
+      auto next = child_of(node, c);
+      if (next == no_node) {
+        next = nodes_.size();
+        nodes_[node].children.push_back(std::make_pair(c, next));
+        nodes_.push_back(Node{});
+      }
+      node = next;
+    }
+
+    if (nodes_[node].value == no_value) {
+      nodes_[node].value = values_.size();
+      values_.push_back(value);
+    } else {
+      values_[nodes_[node].value] = value;
+    }
+  }
+
+  // Returns the value of the longest inserted prefix of the given key or
+  // nullptr if there is none.
+  const T* longest_prefix(const char *key, std::size_t size) const {
+    const T *match = nullptr;
+    std::size_t node = 0;
+    for (std::size_t n = 0; ; n++) {
+      if (nodes_[node].value != no_value)
+        match = &values_[nodes_[node].value];
+      if (n == size)
+        break;
+      node = child_of(node, key[n]);
+      if (node == no_node)
+        break;
+    }
+    return match;
+  }
+
+  const T* longest_prefix(const std::string &key) const {
+    return longest_prefix(key.data(), key.size());
+  }
+
+ private:
+  static constexpr const std::size_t no_node{0};
+  static constexpr const std::size_t no_value{static_cast<std::size_t>(-1)};
+
+  struct Node {
+    std::vector<std::pair<char, std::size_t>> children;
+    std::size_t value = no_value;
+  };
+
+  std::size_t child_of(std::size_t node, char c) const {
+    // The root can never be a child so we use its index to mark a missing
+    // one.
+    for (const auto &child : nodes_[node].children)
+      if (child.first == c)
+        return child.second;
+    return no_node;
+  }
+
+  std::vector<Node> nodes_;
+  std::vector<T> values_;
+};
+}  // namespace common
+}  // namespace anbox
+
+#endif
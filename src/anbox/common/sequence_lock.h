@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_COMMON_SEQUENCE_LOCK_H_
+#define ANBOX_COMMON_SEQUENCE_LOCK_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace anbox {
+namespace common {
+// SequenceLock lets a single writer update data which readers, possibly in
+// another process, copy out without ever blocking the writer. The sequence
+// is bumped before and after every write, so a reader which raced with the
+// writer sees an odd or a changed sequence and has to retry.
+//
+// It is placed in shared memory and has the layout of a u64 sequence.
+struct SequenceLock {
+  std::atomic<std::uint64_t> sequence;
+
+  void reset() { sequence.store(0); }
+
+  void begin_write() { sequence.fetch_add(1, std::memory_order_acq_rel); }
+  void end_write() { sequence.fetch_add(1, std::memory_order_release); }
+
+  // Returns false if the data is being written or was never written.
+  bool begin_read(std::uint64_t &before) const {
+    before = sequence.load(std::memory_order_acquire);
+    return before != 0 && !(before & 1);
+  }
+  // Returns false if the data was written since begin_read.
+  bool end_read(std::uint64_t before) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return sequence.load(std::memory_order_relaxed) == before;
+  }
+};
+}  // namespace common
+}  // namespace anbox
+
+#endif
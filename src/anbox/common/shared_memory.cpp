@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/common/shared_memory.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <linux/memfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+std::runtime_error error_from_errno(const std::string &what) {
+  return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+void *map_or_throw(int fd, std::size_t size, int protection) {
+  auto mapping = ::mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED)
+    BOOST_THROW_EXCEPTION(error_from_errno("Failed to map memfd"));
+  return mapping;
+}
+}
+
+namespace anbox {
+namespace common {
+std::shared_ptr<SharedMemory> SharedMemory::create(const char *name, std::size_t size) {
+  // Not every libc we build against has a wrapper for this yet.
+  Fd memory{static_cast<int>(::syscall(SYS_memfd_create, name, MFD_CLOEXEC | MFD_ALLOW_SEALING))};
+  if (memory < 0)
+    BOOST_THROW_EXCEPTION(error_from_errno("Failed to create memfd"));
+
+  if (::ftruncate(memory, size) < 0)
+    BOOST_THROW_EXCEPTION(error_from_errno("Failed to resize memfd"));
+
+  if (::fcntl(memory, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0)
+    BOOST_THROW_EXCEPTION(error_from_errno("Failed to seal memfd"));
+
+  const auto mapping = map_or_throw(memory, size, PROT_READ | PROT_WRITE);
+  return std::shared_ptr<SharedMemory>(new SharedMemory(memory, mapping, size));
+}
+
+std::shared_ptr<SharedMemory> SharedMemory::map(const Fd &memory, Access access) {
+  struct stat st;
+  if (::fstat(memory, &st) < 0)
+    BOOST_THROW_EXCEPTION(error_from_errno("Failed to query memfd"));
+
+  const auto size = static_cast<std::size_t>(st.st_size);
+  if (size == 0)
+    BOOST_THROW_EXCEPTION(std::runtime_error("Shared memory is empty"));
+
+  const auto protection = access == Access::read_write ? PROT_READ | PROT_WRITE : PROT_READ;
+  const auto mapping = map_or_throw(memory, size, protection);
+  return std::shared_ptr<SharedMemory>(new SharedMemory(memory, mapping, size));
+}
+
+SharedMemory::SharedMemory(const Fd &memory, void *mapping, std::size_t size)
+    : memory_(memory), mapping_(mapping), size_(size) {}
+
+SharedMemory::~SharedMemory() { ::munmap(mapping_, size_); }
+}  // namespace common
+}  // namespace anbox
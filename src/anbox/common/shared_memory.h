@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_COMMON_SHARED_MEMORY_H_
+#define ANBOX_COMMON_SHARED_MEMORY_H_
+
+#include "anbox/common/fd.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace anbox {
+namespace common {
+// SharedMemory is a memfd mapped into our address space which can be
+// passed on to another process. Memory we create is sealed against
+// resizing, so a peer can't make us fault by shrinking it below what we
+// mapped.
+class SharedMemory {
+ public:
+  enum class Access {
+    read_only,
+    read_write,
+  };
+
+  // Creates and maps memory of the given size. Throws if the memory can't
+  // be created, sealed or mapped.
+  static std::shared_ptr<SharedMemory> create(const char *name, std::size_t size);
+  // Maps all of the memory a peer created.
+  static std::shared_ptr<SharedMemory> map(const Fd &memory, Access access);
+
+  ~SharedMemory();
+
+  const Fd &fd() const { return memory_; }
+  void *data() const { return mapping_; }
+  std::size_t size() const { return size_; }
+
+ private:
+  SharedMemory(const Fd &memory, void *mapping, std::size_t size);
+  SharedMemory(const SharedMemory &) = delete;
+  SharedMemory &operator=(const SharedMemory &) = delete;
+
+  Fd memory_;
+  void *mapping_;
+  std::size_t size_;
+};
+}  // namespace common
+}  // namespace anbox
+
+#endif
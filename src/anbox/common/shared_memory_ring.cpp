@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/common/shared_memory_ring.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace {
+constexpr const std::uint32_t ring_magic{0x616e7272};
+constexpr const std::uint32_t ring_version{1};
+// The header lives on its own page so that the data starts page aligned.
+constexpr const std::size_t header_size{4096};
+constexpr const std::size_t cache_line_size{64};
+
+std::runtime_error error_from_errno(const std::string &what) {
+  return std::runtime_error(what + ": " + std::strerror(errno));
+}
+}
+
+namespace anbox {
+namespace common {
+struct SharedMemoryRing::Header {
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint64_t capacity;
+  // Producer and consumer positions sit on separate cache lines so that
+  // both sides don't invalidate each others cache all the time.
+  alignas(cache_line_size) std::atomic<std::uint64_t> write_pos;
+  alignas(cache_line_size) std::atomic<std::uint64_t> read_pos;
+  alignas(cache_line_size) std::atomic<std::uint32_t> reader_waiting;
+  std::atomic<std::uint32_t> writer_waiting;
+  std::atomic<std::uint32_t> closed;
+};
+
+std::shared_ptr<SharedMemoryRing> SharedMemoryRing::create(std::size_t capacity) {
+  const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  capacity = (capacity + page_size - 1) / page_size * page_size;
+  const auto size = header_size + capacity;
+
+  auto memory = SharedMemory::create("anbox-ring", size);
+
+  Fd data_event{::eventfd(0, EFD_CLOEXEC)};
+  Fd space_event{::eventfd(0, EFD_CLOEXEC)};
+  if (data_event < 0 || space_event < 0)
+    BOOST_THROW_EXCEPTION(error_from_errno("Failed to create eventfd"));
+
+  auto header = new (memory->data()) Header;
+  header->magic = ring_magic;
+  header->version = ring_version;
+  header->capacity = capacity;
+  header->write_pos.store(0);
+  header->read_pos.store(0);
+  header->reader_waiting.store(0);
+  header->writer_waiting.store(0);
+  header->closed.store(0);
+
+  return std::shared_ptr<SharedMemoryRing>(
+      new SharedMemoryRing(memory, data_event, space_event));
+}
+
+std::shared_ptr<SharedMemoryRing> SharedMemoryRing::attach(const Fd &fd,
+                                                           const Fd &data_event,
+                                                           const Fd &space_event) {
+  auto memory = SharedMemory::map(fd, SharedMemory::Access::read_write);
+  const auto size = memory->size();
+  if (size <= header_size)
+    BOOST_THROW_EXCEPTION(std::runtime_error("Shared memory too small for a ring"));
+
+  const auto header = static_cast<const Header*>(memory->data());
+  if (header->magic != ring_magic || header->version != ring_version ||
+      header->capacity != size - header_size)
+    BOOST_THROW_EXCEPTION(std::runtime_error("Shared memory doesn't contain a valid ring"));
+
+  return std::shared_ptr<SharedMemoryRing>(
+      new SharedMemoryRing(memory, data_event, space_event));
+}
+
+SharedMemoryRing::SharedMemoryRing(const std::shared_ptr<SharedMemory> &memory,
+                                   const Fd &data_event, const Fd &space_event)
+    : memory_(memory),
+      data_event_(data_event),
+      space_event_(space_event),
+      header_(static_cast<Header*>(memory->data())),
+      data_(static_cast<std::uint8_t*>(memory->data()) + header_size),
+      capacity_(memory->size() - header_size) {
+  static_assert(sizeof(Header) <= header_size, "Ring header too large");
+}
+
+SharedMemoryRing::~SharedMemoryRing() {}
+
+std::vector<Fd> SharedMemoryRing::fds() const {
+  return {memory_->fd(), data_event_, space_event_};
+}
+
+void SharedMemoryRing::wait(const Fd &event) {
+  std::uint64_t value = 0;
+  while (::read(event, &value, sizeof(value)) < 0 && errno == EINTR);
+}
+
+void SharedMemoryRing::signal(const Fd &event) {
+  const std::uint64_t value = 1;
+  while (::write(event, &value, sizeof(value)) < 0 && errno == EINTR);
+}
+
+std::size_t SharedMemoryRing::write(const void *data, std::size_t size) {
+  auto src = static_cast<const std::uint8_t*>(data);
+  std::size_t written = 0;
+
+  while (written < size) {
+    if (closed())
+      break;
+
+    const auto write_pos = header_->write_pos.load(std::memory_order_relaxed);
+    const auto read_pos = header_->read_pos.load(std::memory_order_acquire);
+    const auto used = write_pos - read_pos;
+    if (used >= capacity_) {
+      // Announce that we're waiting and check again afterwards as the
+      // consumer may have freed space in between.
+      header_->writer_waiting.store(1);
+      if (write_pos - header_->read_pos.load() >= capacity_ && !closed())
+        wait(space_event_);
+      header_->writer_waiting.store(0);
+      continue;
+    }
+
+    const auto count = std::min(size - written, capacity_ - static_cast<std::size_t>(used));
+    const auto offset = static_cast<std::size_t>(write_pos % capacity_);
+    const auto first_part = std::min(count, capacity_ - offset);
+    std::memcpy(data_ + offset, src + written, first_part);
+    std::memcpy(data_, src + written + first_part, count - first_part);
+    // This has to be sequentially consistent with the check of the waiting
+    // flag below so we can't miss a consumer which just went to sleep.
+    header_->write_pos.store(write_pos + count);
+    written += count;
+
+    if (header_->reader_waiting.exchange(0))
+      signal(data_event_);
+  }
+
+  return written;
+}
+
+std::size_t SharedMemoryRing::read(void *data, std::size_t size) {
+  auto dst = static_cast<std::uint8_t*>(data);
+
+  while (size > 0) {
+    const auto read_pos = header_->read_pos.load(std::memory_order_relaxed);
+    const auto write_pos = header_->write_pos.load(std::memory_order_acquire);
+    const auto available = write_pos - read_pos;
+
+    if (available > capacity_) {
+      // The peer wrote a position which can't be valid; don't touch
+      // anything it points at.
+      close();
+      return 0;
+    }
+
+    if (available == 0) {
+      if (closed())
+        return 0;
+      header_->reader_waiting.store(1);
+      if (header_->write_pos.load() == read_pos && !closed())
+        wait(data_event_);
+      header_->reader_waiting.store(0);
+      continue;
+    }
+
+    const auto count = std::min(size, static_cast<std::size_t>(available));
+    const auto offset = static_cast<std::size_t>(read_pos % capacity_);
+    const auto first_part = std::min(count, capacity_ - offset);
+    std::memcpy(dst, data_ + offset, first_part);
+    std::memcpy(dst + first_part, data_, count - first_part);
+    header_->read_pos.store(read_pos + count);
+
+    if (header_->writer_waiting.exchange(0))
+      signal(space_event_);
+
+    return count;
+  }
+
+  return 0;
+}
+
+void SharedMemoryRing::close() {
+  header_->closed.store(1);
+  signal(data_event_);
+  signal(space_event_);
+}
+
+bool SharedMemoryRing::closed() const {
+  return header_->closed.load() != 0;
+}
+
+std::size_t SharedMemoryRing::capacity() const {
+  return capacity_;
+}
+
+std::size_t SharedMemoryRing::available() const {
+  return header_->write_pos.load() - header_->read_pos.load();
+}
+}  // namespace common
+}  // namespace anbox
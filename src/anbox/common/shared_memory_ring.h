@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_COMMON_SHARED_MEMORY_RING_H_
+#define ANBOX_COMMON_SHARED_MEMORY_RING_H_
+
+#include "anbox/common/fd.h"
+#include "anbox/common/shared_memory.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace anbox {
+namespace common {
+// SharedMemoryRing is a single producer, single consumer byte ring placed
+// in a memfd so it can be shared with another process. Two eventfds act as
+// doorbells: one is signaled when data was written while the consumer was
+// waiting, the other when space was freed while the producer was waiting.
+// As long as there is data (or space) available no system call is made.
+//
+// The process creating the ring passes fds() to its peer (e.g. with
+// send_fds) which then attaches to the same ring. Either side may be the
+// producer. The consumer never trusts the positions written by its peer.
+class SharedMemoryRing {
+ public:
+  static std::shared_ptr<SharedMemoryRing> create(std::size_t capacity);
+  static std::shared_ptr<SharedMemoryRing> attach(const Fd &memory,
+                                                  const Fd &data_event,
+                                                  const Fd &space_event);
+
+  ~SharedMemoryRing();
+
+  // Returns the memfd and the data and space eventfds, in that order.
+  std::vector<Fd> fds() const;
+
+  // write blocks until all of data was written or the ring was closed and
+  // returns the number of bytes written.
+  std::size_t write(const void *data, std::size_t size);
+
+  // read blocks until at least one byte is available and returns up to
+  // size bytes. It returns 0 once the ring was closed and drained or the
+  // peer corrupted the ring.
+  std::size_t read(void *data, std::size_t size);
+
+  // Wakes up both sides and makes any further reads and writes fail.
+  void close();
+  bool closed() const;
+
+  std::size_t capacity() const;
+  std::size_t available() const;
+
+ private:
+  struct Header;
+
+  SharedMemoryRing(const std::shared_ptr<SharedMemory> &memory,
+                   const Fd &data_event, const Fd &space_event);
+
+  void wait(const Fd &event);
+  void signal(const Fd &event);
+
+  std::shared_ptr<SharedMemory> memory_;
+  Fd data_event_;
+  Fd space_event_;
+  Header *header_;
+  std::uint8_t *data_;
+  std::size_t capacity_;
+};
+}  // namespace common
+}  // namespace anbox
+
+#endif
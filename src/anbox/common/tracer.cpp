@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/common/tracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+// Holds the buffer of a thread for as long as the thread lives. The tracer
+// keeps its own reference so events survive the thread.
+thread_local std::shared_ptr<void> thread_buffer;
+
+void write_escaped(std::ostream &out, const std::string &str) {
+  out << '"';
+  for (const auto c : str) {
+    if (c == '"' || c == '\\')
+      out << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+      out << ' ';
+    else
+      out << c;
+  }
+  out << '"';
+}
+}
+
+namespace anbox {
+namespace common {
+constexpr const std::size_t Tracer::events_per_thread;
+std::atomic<bool> Tracer::active_{false};
+std::atomic<std::int64_t> Tracer::started_at_{0};
+
+Tracer::ThreadBuffer::ThreadBuffer()
+    : tid(static_cast<std::int32_t>(::syscall(SYS_gettid))),
+      events(events_per_thread) {
+  char thread_name[16] = {0};
+  if (pthread_getname_np(pthread_self(), thread_name, sizeof(thread_name)) == 0)
+    name = thread_name;
+}
+
+std::shared_ptr<Tracer> Tracer::get() {
+  static auto instance = std::shared_ptr<Tracer>(new Tracer);
+  return instance;
+}
+
+std::int64_t Tracer::now() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracer::start() {
+  std::lock_guard<std::mutex> l(lock_);
+  quiesce_locked();
+  for (auto &buffer : buffers_)
+    buffer->count = 0;
+  // Scopes which began before are still running and must not end up in
+  // the new trace.
+  started_at_ = now();
+  active_ = true;
+}
+
+void Tracer::stop(std::ostream &out) {
+  std::lock_guard<std::mutex> l(lock_);
+  quiesce_locked();
+  const auto pid = ::getpid();
+
+  out << "{\"traceEvents\":[";
+  bool first = true;
+  for (const auto &buffer : buffers_) {
+    const auto count = buffer->count.load(std::memory_order_acquire);
+    if (count == 0)
+      continue;
+
+    if (!first) out << ",";
+    first = false;
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+        << ",\"tid\":" << buffer->tid << ",\"args\":{\"name\":";
+    write_escaped(out, buffer->name.empty() ? std::to_string(buffer->tid) : buffer->name);
+    out << "}}";
+
+    const auto num_events = std::min<std::uint64_t>(count, events_per_thread);
+    for (auto n = count - num_events; n < count; n++) {
+      const auto &event = buffer->events[n % events_per_thread];
+      out << ",{\"name\":";
+      write_escaped(out, event.name);
+      out << ",\"cat\":";
+      write_escaped(out, event.category);
+      out << ",\"ph\":\"X\",\"ts\":" << event.begin_us
+          << ",\"dur\":" << event.duration_us << ",\"pid\":" << pid
+          << ",\"tid\":" << buffer->tid << "}";
+    }
+  }
+  out << "],\"displayTimeUnit\":\"ms\"}\n";
+
+  // Buffers of threads which are gone won't get any new events.
+  buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(),
+                                [](const std::shared_ptr<ThreadBuffer> &buffer) {
+                                  return buffer.use_count() == 1;
+                                }),
+                 buffers_.end());
+}
+
+bool Tracer::stop(const std::string &path) {
+  std::ofstream out(path, std::ofstream::out | std::ofstream::trunc);
+  if (!out.is_open()) {
+    std::lock_guard<std::mutex> l(lock_);
+    quiesce_locked();
+    return false;
+  }
+  stop(out);
+  return out.good();
+}
+
+void Tracer::record(const char *name, const char *category,
+                    std::int64_t begin_us, std::int64_t end_us) {
+  auto buffer = buffer_for_this_thread();
+
+  // Together with quiesce_locked() this makes sure that nobody reads or
+  // resets our events while we write one. Both sides store their flag
+  // before they check the one of the other side.
+  buffer->writing = true;
+  if (!active_ || begin_us < started_at_) {
+    buffer->writing.store(false, std::memory_order_release);
+    return;
+  }
+
+  const auto n = buffer->count.load(std::memory_order_relaxed);
+  buffer->events[n % events_per_thread] = Event{name, category, begin_us, end_us - begin_us};
+  buffer->count.store(n + 1, std::memory_order_release);
+  buffer->writing.store(false, std::memory_order_release);
+}
+
+void Tracer::quiesce_locked() {
+  active_ = false;
+  for (const auto &buffer : buffers_) {
+    while (buffer->writing.load(std::memory_order_acquire))
+      std::this_thread::yield();
+  }
+}
+
+Tracer::ThreadBuffer *Tracer::buffer_for_this_thread() {
+  if (!thread_buffer) {
+    auto buffer = std::make_shared<ThreadBuffer>();
+    {
+      std::lock_guard<std::mutex> l(lock_);
+      buffers_.push_back(buffer);
+    }
+    thread_buffer = buffer;
+  }
+  return static_cast<ThreadBuffer *>(thread_buffer.get());
+}
+}  // namespace common
+}  // namespace anbox
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_COMMON_TRACER_H_
+#define ANBOX_COMMON_TRACER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace anbox {
+namespace common {
+// Tracer records timed scopes from all threads so that we can see where
+// time went when frames stutter. Every thread records into its own ring
+// which keeps the most recent events; when tracing isn't active a scope
+// costs a single relaxed atomic load.
+//
+// The recorded events are exported in the Chrome trace event JSON format
+// which can be loaded into chrome://tracing or Perfetto.
+class Tracer {
+ public:
+  // Number of events kept per thread once its ring wrapped around.
+  static constexpr const std::size_t events_per_thread{16384};
+
+  static std::shared_ptr<Tracer> get();
+
+  static bool active() { return active_.load(std::memory_order_relaxed); }
+  static std::int64_t now();
+
+  // Starts recording, dropping everything recorded before.
+  void start();
+  // Stops recording and writes all events recorded since start() as JSON.
+  void stop(std::ostream &out);
+  // Same as above but writes into the file at path. Returns false if the
+  // file couldn't be written.
+  bool stop(const std::string &path);
+
+  // Name and category have to be string literals.
+  void record(const char *name, const char *category, std::int64_t begin_us,
+              std::int64_t end_us);
+
+ private:
+  struct Event {
+    const char *name;
+    const char *category;
+    std::int64_t begin_us;
+    std::int64_t duration_us;
+  };
+
+  struct ThreadBuffer {
+    ThreadBuffer();
+
+    std::int32_t tid;
+    std::string name;
+    std::vector<Event> events;
+    std::atomic<std::uint64_t> count{0};
+    // Set while the owning thread writes an event, so we can wait for it
+    // before touching the events from another thread.
+    std::atomic<bool> writing{false};
+  };
+
+  ThreadBuffer *buffer_for_this_thread();
+  // Stops recording and waits until no thread writes an event anymore.
+  void quiesce_locked();
+
+  static std::atomic<bool> active_;
+  static std::atomic<std::int64_t> started_at_;
+
+  std::mutex lock_;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+};
+
+// ScopedTrace records the time between its construction and destruction.
+class ScopedTrace {
+ public:
+  ScopedTrace(const char *category, const char *name)
+      : category_(category), name_(name), begin_(Tracer::active() ? Tracer::now() : -1) {}
+
+  ~ScopedTrace() {
+    if (begin_ >= 0)
+      Tracer::get()->record(name_, category_, begin_, Tracer::now());
+  }
+
+ private:
+  ScopedTrace(const ScopedTrace &) = delete;
+  ScopedTrace &operator=(const ScopedTrace &) = delete;
+
+  const char *category_;
+  const char *name_;
+  const std::int64_t begin_;
+};
+}  // namespace common
+}  // namespace anbox
+
+#define ANBOX_TRACE_CONCAT_IMPL(a, b) a##b
+#define ANBOX_TRACE_CONCAT(a, b) ANBOX_TRACE_CONCAT_IMPL(a, b)
+
+// Traces the enclosing scope under the given category and name.
+#define ANBOX_TRACE_SCOPE(category, name) \
+  ::anbox::common::ScopedTrace ANBOX_TRACE_CONCAT(trace_scope_, __LINE__){category, name}
+
+#endif
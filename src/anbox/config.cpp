@@ -21,11 +21,14 @@
 
 #include "external/xdg/xdg.h"
 
+#include <algorithm>
 #include <cstring>
 
 namespace fs = boost::filesystem;
 
 namespace {
+constexpr const std::size_t max_instance_id_length{32};
+
 static std::string runtime_dir() {
   static std::string path;
   if (path.empty()) {
@@ -37,10 +40,32 @@ static std::string runtime_dir() {
 }
 }
 
+constexpr const char *anbox::SystemConfiguration::default_instance_id;
+
+bool anbox::SystemConfiguration::is_valid_instance_id(const std::string &id) {
+  // D-Bus name elements must not start with a digit
+  return !id.empty() && id.size() <= max_instance_id_length &&
+         id[0] >= 'a' && id[0] <= 'z' &&
+         std::all_of(id.begin(), id.end(), [](char c) {
+           return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+         });
+}
+
 void anbox::SystemConfiguration::set_data_path(const std::string &path) {
   data_path = path;
 }
 
+void anbox::SystemConfiguration::set_instance_id(const std::string &id) {
+  if (!is_valid_instance_id(id))
+    BOOST_THROW_EXCEPTION(std::runtime_error(
+        anbox::utils::string_format("Invalid instance id '%s'", id)));
+  instance_id_ = id;
+}
+
+std::string anbox::SystemConfiguration::instance_id() const {
+  return instance_id_;
+}
+
 void anbox::SystemConfiguration::set_resource_path(const fs::path &path) {
   resource_path = path;
 }
@@ -49,12 +74,30 @@ fs::path anbox::SystemConfiguration::data_dir() const {
   return data_path;
 }
 
+std::string anbox::SystemConfiguration::image_dir() const {
+  return (data_path / "image").string();
+}
+
 std::string anbox::SystemConfiguration::rootfs_dir() const {
-  return (data_path / "rootfs").string();
+  return rootfs_dir(instance_id_);
+}
+
+std::string anbox::SystemConfiguration::rootfs_dir(const std::string &instance_id) const {
+  return (instance_data_dir(instance_id) / "rootfs").string();
 }
 
 std::string anbox::SystemConfiguration::overlay_dir() const {
-  return (data_path / "overlay").string();
+  return overlay_dir(instance_id_);
+}
+
+std::string anbox::SystemConfiguration::overlay_dir(const std::string &instance_id) const {
+  return (instance_data_dir(instance_id) / "overlay").string();
+}
+
+fs::path anbox::SystemConfiguration::instance_data_dir(const std::string &instance_id) const {
+  if (instance_id == default_instance_id)
+    return data_path;
+  return data_path / "instances" / instance_id;
 }
 
 std::string anbox::SystemConfiguration::log_dir() const {
@@ -70,13 +113,15 @@ std::string anbox::SystemConfiguration::container_socket_path() const {
 }
 
 std::string anbox::SystemConfiguration::socket_dir() const {
-  static std::string dir = anbox::utils::string_format("%s/anbox/sockets", runtime_dir());
-  return dir;
+  if (instance_id_ == default_instance_id)
+    return anbox::utils::string_format("%s/anbox/sockets", runtime_dir());
+  return anbox::utils::string_format("%s/anbox/%s/sockets", runtime_dir(), instance_id_);
 }
 
 std::string anbox::SystemConfiguration::input_device_dir() const {
-  static std::string dir = anbox::utils::string_format("%s/anbox/input", runtime_dir());
-  return dir;
+  if (instance_id_ == default_instance_id)
+    return anbox::utils::string_format("%s/anbox/input", runtime_dir());
+  return anbox::utils::string_format("%s/anbox/%s/input", runtime_dir(), instance_id_);
 }
 
 std::string anbox::SystemConfiguration::application_item_dir() const {
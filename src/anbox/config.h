@@ -26,16 +26,36 @@
 namespace anbox {
 class SystemConfiguration {
  public:
+  // Several Android instances can run side by side on one host. Each has
+  // its own id which keeps its container, sockets and writable data apart
+  // from the others. The default instance uses the same paths as before
+  // instances existed.
+  static constexpr const char *default_instance_id{"default"};
+
   static SystemConfiguration& instance();
+  // Ids have to start with a lower case letter and may only contain lower
+  // case letters, digits, '-' and '_' as they are used in paths, container
+  // names and D-Bus names.
+  static bool is_valid_instance_id(const std::string &id);
 
   virtual ~SystemConfiguration() = default;
 
   void set_data_path(const std::string &path);
   void set_resource_path(const boost::filesystem::path &path);
+  void set_instance_id(const std::string &id);
+
+  // The instance this process is working for.
+  std::string instance_id() const;
 
   boost::filesystem::path data_dir() const;
+  // Mount point of the read-only Android image all instances share.
+  std::string image_dir() const;
   std::string rootfs_dir() const;
+  std::string rootfs_dir(const std::string &instance_id) const;
   std::string overlay_dir() const;
+  std::string overlay_dir(const std::string &instance_id) const;
+  // Directory holding the data and cache directories of an instance.
+  boost::filesystem::path instance_data_dir(const std::string &instance_id) const;
   std::string log_dir() const;
   std::string socket_dir() const;
   std::string container_config_dir() const;
@@ -49,6 +69,7 @@ class SystemConfiguration {
 
   boost::filesystem::path data_path = "/var/lib/anbox";
   boost::filesystem::path resource_path = "/usr/share/anbox";
+  std::string instance_id_ = default_instance_id;
 
 };
 }  // namespace anbox
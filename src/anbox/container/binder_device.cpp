@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "anbox/container/binder_device.h"
+#include "anbox/config.h"
+#include "anbox/logger.h"
+#include "anbox/utils.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/throw_exception.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <linux/types.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = boost::filesystem;
+
+namespace {
+constexpr const char *default_binder_device{"/dev/binder"};
+constexpr const char *binderfs_dir{"/dev/binderfs"};
+constexpr const char *binder_control_name{"binder-control"};
+
+// From linux/android/binderfs.h which only comes with recent kernel headers
+constexpr const std::size_t binderfs_max_name{255};
+struct binderfs_device {
+  char name[binderfs_max_name + 1];
+  __u32 major;
+  __u32 minor;
+};
+#define BINDER_CTL_ADD _IOWR('b', 1, struct binderfs_device)
+
+bool allocate_binderfs_device(const std::string &name) {
+  const auto control_path = (fs::path(binderfs_dir) / binder_control_name).string();
+  const auto fd = ::open(control_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+
+  struct binderfs_device device;
+  std::memset(&device, 0, sizeof(device));
+  std::strncpy(device.name, name.c_str(), binderfs_max_name);
+  const auto ret = ::ioctl(fd, BINDER_CTL_ADD, &device);
+  const auto err = errno;
+  ::close(fd);
+
+  // Devices stay around until binderfs is unmounted so a previous run of
+  // the instance may have allocated it already.
+  if (ret < 0 && err != EEXIST) {
+    WARNING("Failed to allocate binder device %s: %s", name, std::strerror(err));
+    return false;
+  }
+  return true;
+}
+}  // namespace
+
+namespace anbox {
+namespace container {
+std::string binder_device(const std::string &instance_id) {
+  if (instance_id.empty() || instance_id == SystemConfiguration::default_instance_id)
+    return default_binder_device;
+
+  const auto name = utils::string_format("anbox-%s", instance_id);
+
+  const auto module_device = (fs::path("/dev") / name).string();
+  if (fs::exists(module_device)) return module_device;
+
+  const auto binderfs_device = (fs::path(binderfs_dir) / name).string();
+  if (fs::exists(binderfs_device) || allocate_binderfs_device(name)) {
+    // binderfs creates its devices only accessible for root but the
+    // container runs unprivileged.
+    if (::chmod(binderfs_device.c_str(), 0666) < 0)
+      WARNING("Failed to make %s accessible: %s", binderfs_device, std::strerror(errno));
+    return binderfs_device;
+  }
+
+  BOOST_THROW_EXCEPTION(std::runtime_error(utils::string_format(
+      "No binder device for instance %s: mount binderfs at %s or load "
+      "binder_linux with devices=binder,%s",
+      instance_id, binderfs_dir, name)));
+}
+}  // namespace container
+}  // namespace anbox
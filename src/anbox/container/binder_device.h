@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef ANBOX_CONTAINER_BINDER_DEVICE_H_
+#define ANBOX_CONTAINER_BINDER_DEVICE_H_
+
+#include <string>
+
+namespace anbox {
+namespace container {
+// Returns the host binder device the container of an instance uses as its
+// /dev/binder. Android's service manager claims the context of the device
+// so instances can't share one. The default instance keeps the host's
+// /dev/binder while every other instance gets its own 'anbox-<id>' device,
+// either one created by loading binder_linux with
+// devices=binder,anbox-<id>,... or one allocated through a binderfs
+// mounted at /dev/binderfs. Throws if neither is available.
+std::string binder_device(const std::string &instance_id);
+}  // namespace container
+}  // namespace anbox
+
+#endif
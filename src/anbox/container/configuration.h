@@ -25,6 +25,8 @@ namespace anbox {
 namespace container {
 struct Configuration {
   std::map<std::string, std::string> bind_mounts;
+  // Id of the instance the container runs; see SystemConfiguration.
+  std::string instance;
 };
 }  // namespace container
 }  // namespace anbox
@@ -20,6 +20,8 @@
 
 #include "anbox/container/configuration.h"
 
+#include <chrono>
+#include <cstdint>
 #include <map>
 #include <string>
 
@@ -34,6 +36,15 @@ class Container {
     running,
   };
 
+  // Resources the container used as accounted by its cgroups.
+  struct ResourceUsage {
+    ResourceUsage() : memory_bytes(0), max_memory_bytes(0), cpu_time(0) {}
+
+    std::uint64_t memory_bytes;
+    std::uint64_t max_memory_bytes;
+    std::chrono::nanoseconds cpu_time;
+  };
+
   // Start the container in background
   virtual void start(const Configuration &configuration) = 0;
 
@@ -42,6 +53,9 @@ class Container {
 
   // Get the current container state
   virtual State state() = 0;
+
+  // Get what the running container used so far
+  virtual ResourceUsage resource_usage() { return ResourceUsage{}; }
 };
 }  // namespace container
 }  // namespace anbox
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/container/instance_registry.h"
+#include "anbox/logger.h"
+
+namespace {
+std::uint64_t to_mib(std::uint64_t bytes) { return bytes / (1024 * 1024); }
+
+std::int64_t to_ms(const std::chrono::nanoseconds &time) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(time).count();
+}
+}  // namespace
+
+namespace anbox {
+namespace container {
+InstanceRegistry::InstanceRegistry(std::size_t max_instances)
+    : max_instances_(max_instances) {}
+
+std::size_t InstanceRegistry::size() const {
+  std::lock_guard<std::mutex> l(lock_);
+  return instances_.size();
+}
+
+bool InstanceRegistry::add(const std::string &id,
+                           const std::weak_ptr<Container> &container) {
+  std::lock_guard<std::mutex> l(lock_);
+  if (instances_.size() >= max_instances_ || instances_.count(id) > 0)
+    return false;
+  instances_.insert({id, container});
+  return true;
+}
+
+void InstanceRegistry::remove(const std::string &id) {
+  std::shared_ptr<Container> container;
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    const auto it = instances_.find(id);
+    if (it == instances_.end()) return;
+    container = it->second.lock();
+    instances_.erase(it);
+  }
+
+  if (!container) return;
+  const auto usage = container->resource_usage();
+  INFO("Instance %s used %d MiB of memory at most and %d ms of CPU time",
+       id, to_mib(usage.max_memory_bytes), to_ms(usage.cpu_time));
+}
+
+std::map<std::string, Container::ResourceUsage> InstanceRegistry::resource_usage() const {
+  std::map<std::string, std::shared_ptr<Container>> containers;
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    for (const auto &instance : instances_) {
+      if (auto container = instance.second.lock())
+        containers.insert({instance.first, container});
+    }
+  }
+
+  std::map<std::string, Container::ResourceUsage> usage;
+  for (const auto &container : containers)
+    usage.insert({container.first, container.second->resource_usage()});
+  return usage;
+}
+
+void InstanceRegistry::report_resource_usage() const {
+  for (const auto &usage : resource_usage()) {
+    DEBUG("Instance %s: memory %d MiB (max %d MiB), CPU time %d ms", usage.first,
+          to_mib(usage.second.memory_bytes), to_mib(usage.second.max_memory_bytes),
+          to_ms(usage.second.cpu_time));
+  }
+}
+}  // namespace container
+}  // namespace anbox
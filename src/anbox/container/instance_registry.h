@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_CONTAINER_INSTANCE_REGISTRY_H_
+#define ANBOX_CONTAINER_INSTANCE_REGISTRY_H_
+
+#include "anbox/container/container.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace anbox {
+namespace container {
+// InstanceRegistry keeps track of the instances the container manager is
+// running so that every instance only runs once and the resources each of
+// them uses can be accounted for.
+class InstanceRegistry {
+ public:
+  explicit InstanceRegistry(std::size_t max_instances);
+
+  std::size_t max_instances() const { return max_instances_; }
+  std::size_t size() const;
+
+  // Returns false if the instance is already running or no more instances
+  // are allowed.
+  bool add(const std::string &id, const std::weak_ptr<Container> &container);
+  // Logs what the instance used before forgetting about it.
+  void remove(const std::string &id);
+
+  std::map<std::string, Container::ResourceUsage> resource_usage() const;
+  void report_resource_usage() const;
+
+ private:
+  const std::size_t max_instances_;
+  mutable std::mutex lock_;
+  std::map<std::string, std::weak_ptr<Container>> instances_;
+};
+}  // namespace container
+}  // namespace anbox
+
+#endif
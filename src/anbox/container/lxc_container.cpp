@@ -16,10 +16,13 @@
  */
 
 #include "anbox/container/lxc_container.h"
+#include "anbox/container/binder_device.h"
+#include "anbox/common/boot_timeline.h"
 #include "anbox/config.h"
 #include "anbox/logger.h"
 #include "anbox/utils.h"
 
+#include <cstdlib>
 #include <map>
 #include <stdexcept>
 #include <fstream>
@@ -87,14 +90,23 @@ void LxcContainer::start(const Configuration &configuration) {
     container_->stop(container_);
   }
 
+  // Every instance gets its own container named after it
+  const auto name = configuration.instance.empty()
+                        ? std::string(SystemConfiguration::default_instance_id)
+                        : configuration.instance;
+  if (container_ && name != name_) {
+    lxc_container_put(container_);
+    container_ = nullptr;
+  }
+
   const auto container_config_dir = SystemConfiguration::instance().container_config_dir();
   if (!container_) {
     DEBUG("Containers are stored in %s", container_config_dir);
 
     // Remove container config to be be able to rewrite it
-    ::unlink(utils::string_format("%s/default/config", container_config_dir).c_str());
+    ::unlink(utils::string_format("%s/%s/config", container_config_dir, name).c_str());
 
-    container_ = lxc_container_new("default", container_config_dir.c_str());
+    container_ = lxc_container_new(name.c_str(), container_config_dir.c_str());
     if (!container_)
       BOOST_THROW_EXCEPTION(std::runtime_error("Failed to create LXC container instance"));
 
@@ -102,8 +114,13 @@ void LxcContainer::start(const Configuration &configuration) {
     // to ensure
     // its configuration is synchronized.
     if (container_->is_running(container_)) container_->stop(container_);
+    name_ = name;
   }
 
+  // The previous rootfs has to be gone before it can be mounted again
+  rootfs_.reset();
+  rootfs_ = Rootfs::create(name);
+
   // We can mount proc/sys as rw here as we will run the container unprivileged
   // in the end
   set_config_item("lxc.mount.auto", "proc:mixed sys:mixed cgroup:mixed");
@@ -127,13 +144,16 @@ void LxcContainer::start(const Configuration &configuration) {
   set_config_item("lxc.init_cmd", "/anbox-init.sh");
   set_config_item("lxc.rootfs.backend", "dir");
 
-  const auto rootfs_path = SystemConfiguration::instance().rootfs_dir();
+  const auto rootfs_path = rootfs_->path();
   DEBUG("Using rootfs path %s", rootfs_path);
   set_config_item("lxc.rootfs", rootfs_path);
 
   set_config_item("lxc.loglevel", "0");
   const auto log_path = SystemConfiguration::instance().log_dir();
-  set_config_item("lxc.logfile", utils::string_format("%s/container.log", log_path).c_str());
+  const auto log_name = name == SystemConfiguration::default_instance_id
+                            ? std::string("container.log")
+                            : utils::string_format("container-%s.log", name);
+  set_config_item("lxc.logfile", utils::string_format("%s/%s", log_path, log_name).c_str());
 
   if (fs::exists("/sys/class/net/anboxbr0")) {
     set_config_item("lxc.network.type", "veth");
@@ -167,7 +187,17 @@ void LxcContainer::start(const Configuration &configuration) {
   bind_mounts.insert({"/dev/urandom", "dev/urandom"});
   bind_mounts.insert({"/dev/zero", "dev/zero"});
 
-  const auto extra_bind_mounts_file_path = utils::string_format("%s/default/extra_bind_mounts", container_config_dir);
+  // Each instance needs a binder device of its own, whatever the client
+  // asked for.
+  for (auto it = bind_mounts.begin(); it != bind_mounts.end();) {
+    if (it->second == "/dev/binder" || it->second == "dev/binder")
+      it = bind_mounts.erase(it);
+    else
+      ++it;
+  }
+  bind_mounts.insert({binder_device(name), "dev/binder"});
+
+  const auto extra_bind_mounts_file_path = utils::string_format("%s/%s/extra_bind_mounts", container_config_dir, name);
   if(fs::exists(extra_bind_mounts_file_path)) {
     std::string line;
     std::ifstream in(extra_bind_mounts_file_path.c_str());
@@ -208,10 +238,13 @@ void LxcContainer::start(const Configuration &configuration) {
     BOOST_THROW_EXCEPTION(
         std::runtime_error("Failed to save container configuration"));
 
+  common::BootTimeline::get()->mark("container-config-written");
+
   if (not container_->start(container_, 0, nullptr))
     BOOST_THROW_EXCEPTION(std::runtime_error("Failed to start container"));
 
   state_ = Container::State::running;
+  common::BootTimeline::get()->mark("container-started");
 
   DEBUG("Container successfully started");
 }
@@ -224,6 +257,7 @@ void LxcContainer::stop() {
     BOOST_THROW_EXCEPTION(std::runtime_error("Failed to stop container"));
 
   state_ = Container::State::inactive;
+  rootfs_.reset();
 
   DEBUG("Container successfully stopped");
 }
@@ -234,6 +268,37 @@ void LxcContainer::set_config_item(const std::string &key,
     BOOST_THROW_EXCEPTION(std::runtime_error("Failed to configure LXC container"));
 }
 
+bool LxcContainer::get_cgroup_item(const std::string &key, std::string &value) {
+  char buffer[4096];
+  const auto size = container_->get_cgroup_item(container_, key.c_str(), buffer, sizeof(buffer));
+  if (size <= 0 || static_cast<std::size_t>(size) >= sizeof(buffer)) return false;
+  value.assign(buffer, size);
+  return true;
+}
+
+Container::ResourceUsage LxcContainer::resource_usage() {
+  ResourceUsage usage;
+  if (!container_ || !container_->is_running(container_)) return usage;
+
+  std::string value;
+  // cgroup v1 controllers first, the unified v2 hierarchy second
+  if (get_cgroup_item("memory.usage_in_bytes", value) || get_cgroup_item("memory.current", value))
+    usage.memory_bytes = std::strtoull(value.c_str(), nullptr, 10);
+  if (get_cgroup_item("memory.max_usage_in_bytes", value) || get_cgroup_item("memory.peak", value))
+    usage.max_memory_bytes = std::strtoull(value.c_str(), nullptr, 10);
+  else
+    usage.max_memory_bytes = usage.memory_bytes;
+
+  if (get_cgroup_item("cpuacct.usage", value)) {
+    usage.cpu_time = std::chrono::nanoseconds(std::strtoull(value.c_str(), nullptr, 10));
+  } else if (get_cgroup_item("cpu.stat", value)) {
+    const auto pos = value.find("usage_usec ");
+    if (pos != std::string::npos)
+      usage.cpu_time = std::chrono::microseconds(std::strtoull(value.c_str() + pos + 11, nullptr, 10));
+  }
+  return usage;
+}
+
 Container::State LxcContainer::state() { return state_; }
 }  // namespace container
 }  // namespace anbox
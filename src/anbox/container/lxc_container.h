@@ -19,8 +19,10 @@
 #define ANBOX_CONTAINER_LXC_CONTAINER_H_
 
 #include "anbox/container/container.h"
+#include "anbox/container/rootfs.h"
 #include "anbox/network/credentials.h"
 
+#include <memory>
 #include <string>
 
 #include <lxc/lxccontainer.h>
@@ -35,13 +37,17 @@ class LxcContainer : public Container {
   void start(const Configuration &configuration) override;
   void stop() override;
   State state() override;
+  ResourceUsage resource_usage() override;
 
  private:
   void set_config_item(const std::string &key, const std::string &value);
+  bool get_cgroup_item(const std::string &key, std::string &value);
   void setup_id_maps();
 
   State state_;
   lxc_container *container_;
+  std::string name_;
+  std::shared_ptr<Rootfs> rootfs_;
   bool privileged_;
   network::Credentials creds_;
 };
@@ -18,6 +18,8 @@
 #include "anbox/container/management_api_skeleton.h"
 #include "anbox/container/configuration.h"
 #include "anbox/container/container.h"
+#include "anbox/container/instance_registry.h"
+#include "anbox/config.h"
 #include "anbox/defer_action.h"
 #include "anbox/logger.h"
 #include "anbox/utils.h"
@@ -29,10 +31,14 @@ namespace anbox {
 namespace container {
 ManagementApiSkeleton::ManagementApiSkeleton(
     const std::shared_ptr<rpc::PendingCallCache> &pending_calls,
-    const std::shared_ptr<Container> &container)
-    : pending_calls_(pending_calls), container_(container) {}
+    const std::shared_ptr<Container> &container,
+    const std::shared_ptr<InstanceRegistry> &instances)
+    : pending_calls_(pending_calls), container_(container), instances_(instances) {}
 
-ManagementApiSkeleton::~ManagementApiSkeleton() {}
+ManagementApiSkeleton::~ManagementApiSkeleton() {
+  // The container itself is stopped when it goes away with us
+  if (!instance_.empty()) instances_->remove(instance_);
+}
 
 void ManagementApiSkeleton::start_container(
     anbox::protobuf::container::StartContainer const *request,
@@ -52,9 +58,29 @@ void ManagementApiSkeleton::start_container(
         {bind_mount.source(), bind_mount.target()});
   }
 
+  // Clients which don't know about instances run the default one
+  container_configuration.instance = configuration.has_instance()
+                                         ? configuration.instance()
+                                         : SystemConfiguration::default_instance_id;
+  if (!SystemConfiguration::is_valid_instance_id(container_configuration.instance)) {
+    response->set_error("Invalid instance id");
+    done->Run();
+    return;
+  }
+
+  if (!instances_->add(container_configuration.instance, container_)) {
+    response->set_error(utils::string_format(
+        "Instance %s is already running or too many instances are running",
+        container_configuration.instance));
+    done->Run();
+    return;
+  }
+
   try {
     container_->start(container_configuration);
+    instance_ = container_configuration.instance;
   } catch (std::exception &err) {
+    instances_->remove(container_configuration.instance);
     response->set_error(utils::string_format("Failed to start container: %s", err.what()));
   }
 
@@ -73,6 +99,10 @@ void ManagementApiSkeleton::stop_container(
     return;
   }
 
+  // Resource usage is only available while the container is still running
+  instances_->remove(instance_);
+  instance_.clear();
+
   try {
     container_->stop();
   } catch (std::exception &err) {
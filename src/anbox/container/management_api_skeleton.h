@@ -19,6 +19,7 @@
 #define ANBOX_CONTAINER_MANAGEMENT_API_SKELETON_H_
 
 #include <memory>
+#include <string>
 
 namespace google {
 namespace protobuf {
@@ -41,11 +42,13 @@ class PendingCallCache;
 }  // namespace rpc
 namespace container {
 class Container;
+class InstanceRegistry;
 class ManagementApiSkeleton {
  public:
   ManagementApiSkeleton(
       const std::shared_ptr<rpc::PendingCallCache> &pending_calls,
-      const std::shared_ptr<Container> &container);
+      const std::shared_ptr<Container> &container,
+      const std::shared_ptr<InstanceRegistry> &instances);
   ~ManagementApiSkeleton();
 
   void start_container(
@@ -59,6 +62,9 @@ class ManagementApiSkeleton {
  private:
   std::shared_ptr<rpc::PendingCallCache> pending_calls_;
   std::shared_ptr<Container> container_;
+  std::shared_ptr<InstanceRegistry> instances_;
+  // Instance the container was started for; empty while it's not running.
+  std::string instance_;
 };
 }  // namespace container
 }  // namespace anbox
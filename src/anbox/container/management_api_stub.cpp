@@ -42,6 +42,9 @@ void ManagementApiStub::start_container(const Configuration &configuration) {
     bind_mount_message->set_target(item.second);
   }
 
+  if (!configuration.instance.empty())
+    message_configuration->set_instance(configuration.instance);
+
   message.set_allocated_configuration(message_configuration);
 
   {
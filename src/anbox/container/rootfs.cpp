@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/container/rootfs.h"
+#include "anbox/config.h"
+#include "anbox/logger.h"
+#include "anbox/utils.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <sys/mount.h>
+#include <unistd.h>
+
+namespace fs = boost::filesystem;
+
+namespace anbox {
+namespace container {
+constexpr const unsigned int Rootfs::unprivileged_user_id;
+
+std::shared_ptr<Rootfs> Rootfs::create(const std::string &instance_id) {
+  const auto &config = SystemConfiguration::instance();
+  const auto image_dir = config.image_dir();
+  if (!utils::is_mounted(image_dir))
+    BOOST_THROW_EXCEPTION(std::runtime_error("Android image is not mounted"));
+
+  const auto rootfs_dir = config.rootfs_dir(instance_id);
+  if (utils::is_mounted(rootfs_dir))
+    BOOST_THROW_EXCEPTION(std::runtime_error(
+        utils::string_format("Rootfs of instance %s is already mounted", instance_id)));
+
+  const auto overlay_dir = config.overlay_dir(instance_id);
+  utils::ensure_paths({rootfs_dir, overlay_dir});
+
+  auto rootfs = std::shared_ptr<Rootfs>(new Rootfs(rootfs_dir));
+
+  std::string options = "lowerdir=" + image_dir + ",upperdir=" + overlay_dir;
+  auto o = common::MountEntry::create("overlayfs", rootfs_dir, "overlayfs", MS_MGC_VAL | MS_RDONLY | MS_PRIVATE, options);
+  if (!o)
+    BOOST_THROW_EXCEPTION(std::runtime_error("Failed to mount Android overlay"));
+  rootfs->mounts_.push_back(o);
+
+  for (const auto &dir_name : std::vector<std::string>{"cache", "data"}) {
+    auto target_dir_path = fs::path(rootfs_dir) / dir_name;
+    auto src_dir_path = config.instance_data_dir(instance_id) / dir_name;
+
+    if (!fs::exists(src_dir_path)) {
+      if (!fs::create_directory(src_dir_path))
+        BOOST_THROW_EXCEPTION(std::runtime_error(
+            utils::string_format("Failed to create Android %s directory", dir_name)));
+      if (::chown(src_dir_path.c_str(), unprivileged_user_id, unprivileged_user_id) != 0)
+        BOOST_THROW_EXCEPTION(std::runtime_error(utils::string_format(
+            "Failed to allow access for unprivileged user on %s directory of the rootfs", dir_name)));
+    }
+
+    auto m = common::MountEntry::create(src_dir_path, target_dir_path, "", MS_MGC_VAL | MS_BIND | MS_PRIVATE);
+    if (!m)
+      BOOST_THROW_EXCEPTION(std::runtime_error(
+          utils::string_format("Failed to mount Android %s directory", dir_name)));
+    rootfs->mounts_.push_back(m);
+  }
+
+  DEBUG("Mounted rootfs of instance %s at %s", instance_id, rootfs_dir);
+  return rootfs;
+}
+
+Rootfs::Rootfs(const std::string &path) : path_(path) {}
+
+Rootfs::~Rootfs() {
+  // Unmounting needs to happen in reverse order
+  while (!mounts_.empty()) mounts_.pop_back();
+}
+}  // namespace container
+}  // namespace anbox
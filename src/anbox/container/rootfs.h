@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_CONTAINER_ROOTFS_H_
+#define ANBOX_CONTAINER_ROOTFS_H_
+
+#include "anbox/common/mount_entry.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace anbox {
+namespace container {
+// Rootfs is the root filesystem of a single instance: an overlay with the
+// shared read-only Android image as lower and the instance's own overlay
+// directory as upper layer plus the data and cache directories of the
+// instance. All instances read from the same image and therefore share
+// its page cache. Everything is unmounted again when the Rootfs goes away.
+class Rootfs {
+ public:
+  static constexpr const unsigned int unprivileged_user_id{100000};
+
+  // Throws if the rootfs can't be set up.
+  static std::shared_ptr<Rootfs> create(const std::string &instance_id);
+
+  ~Rootfs();
+
+  std::string path() const { return path_; }
+
+ private:
+  Rootfs(const std::string &path);
+
+  std::string path_;
+  std::vector<std::shared_ptr<common::MountEntry>> mounts_;
+};
+}  // namespace container
+}  // namespace anbox
+
+#endif
@@ -30,8 +30,11 @@
 
 namespace anbox {
 namespace container {
-std::shared_ptr<Service> Service::create(const std::shared_ptr<Runtime> &rt, bool privileged) {
-  auto sp = std::shared_ptr<Service>(new Service(rt, privileged));
+constexpr const std::chrono::seconds Service::usage_report_interval;
+
+std::shared_ptr<Service> Service::create(const std::shared_ptr<Runtime> &rt, bool privileged,
+                                         std::size_t max_instances) {
+  auto sp = std::shared_ptr<Service>(new Service(rt, privileged, max_instances));
 
   auto wp = std::weak_ptr<Service>(sp);
   auto delegate_connector = std::make_shared<network::DelegateConnectionCreator<boost::asio::local::stream_protocol>>(
@@ -46,27 +49,45 @@ std::shared_ptr<Service> Service::create(const std::shared_ptr<Runtime> &rt, boo
   // Make sure others can connect to our socket
   ::chmod(container_socket_path.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
 
+  sp->schedule_usage_report();
+
   DEBUG("Everything setup. Waiting for incoming connections.");
 
   return sp;
 }
 
-Service::Service(const std::shared_ptr<Runtime> &rt, bool privileged)
+Service::Service(const std::shared_ptr<Runtime> &rt, bool privileged, std::size_t max_instances)
     : dispatcher_(anbox::common::create_dispatcher_for_runtime(rt)),
       next_connection_id_(0),
       connections_(std::make_shared<network::Connections<network::SocketConnection>>()),
-      privileged_(privileged) {
+      privileged_(privileged),
+      instances_(std::make_shared<InstanceRegistry>(max_instances)),
+      usage_report_timer_(rt->service()) {
 }
 
 Service::~Service() {
+  usage_report_timer_.cancel();
   connections_->clear();
 }
 
+void Service::schedule_usage_report() {
+  std::weak_ptr<Service> wp = shared_from_this();
+  usage_report_timer_.expires_from_now(usage_report_interval);
+  usage_report_timer_.async_wait([wp](const boost::system::error_code &err) {
+    if (err) return;
+    if (auto service = wp.lock()) {
+      service->instances_->report_resource_usage();
+      service->schedule_usage_report();
+    }
+  });
+}
+
 int Service::next_id() { return next_connection_id_++; }
 
 void Service::new_client(std::shared_ptr<boost::asio::local::stream_protocol::socket> const
         &socket) {
-  if (connections_->size() >= 1) {
+  // Every client runs one instance
+  if (connections_->size() >= instances_->max_instances()) {
     socket->close();
     return;
   }
@@ -78,7 +99,7 @@ void Service::new_client(std::shared_ptr<boost::asio::local::stream_protocol::so
   auto pending_calls = std::make_shared<rpc::PendingCallCache>();
   auto rpc_channel = std::make_shared<rpc::Channel>(pending_calls, messenger);
   auto server = std::make_shared<container::ManagementApiSkeleton>(
-      pending_calls, std::make_shared<LxcContainer>(privileged_, messenger->creds()));
+      pending_calls, std::make_shared<LxcContainer>(privileged_, messenger->creds()), instances_);
   auto processor = std::make_shared<container::ManagementApiMessageProcessor>(
       messenger, pending_calls, server);
 
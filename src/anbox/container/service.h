@@ -20,6 +20,7 @@
 
 #include "anbox/common/dispatcher.h"
 #include "anbox/container/container.h"
+#include "anbox/container/instance_registry.h"
 #include "anbox/network/connections.h"
 #include "anbox/network/credentials.h"
 #include "anbox/network/published_socket_connector.h"
@@ -30,16 +31,21 @@ namespace anbox {
 namespace container {
 class Service : public std::enable_shared_from_this<Service> {
  public:
-  static std::shared_ptr<Service> create(const std::shared_ptr<Runtime> &rt, bool privileged);
+  // How often the resource usage of all instances is logged.
+  static constexpr const std::chrono::seconds usage_report_interval{60};
+
+  static std::shared_ptr<Service> create(const std::shared_ptr<Runtime> &rt, bool privileged,
+                                         std::size_t max_instances = 1);
 
   ~Service();
 
  private:
-  Service(const std::shared_ptr<Runtime> &rt, bool privileged);
+  Service(const std::shared_ptr<Runtime> &rt, bool privileged, std::size_t max_instances);
 
   int next_id();
   void new_client(std::shared_ptr<
                   boost::asio::local::stream_protocol::socket> const &socket);
+  void schedule_usage_report();
 
   std::shared_ptr<common::Dispatcher> dispatcher_;
   std::shared_ptr<network::PublishedSocketConnector> connector_;
@@ -47,6 +53,8 @@ class Service : public std::enable_shared_from_this<Service> {
   std::shared_ptr<network::Connections<network::SocketConnection>> connections_;
   std::shared_ptr<Container> backend_;
   bool privileged_;
+  std::shared_ptr<InstanceRegistry> instances_;
+  boost::asio::steady_timer usage_report_timer_;
 };
 }  // namespace container
 }  // namespace anbox
@@ -18,10 +18,14 @@
 #ifndef ANBOX_DBUS_INTERFACE_H_
 #define ANBOX_DBUS_INTERFACE_H_
 
+#include "anbox/config.h"
+
 #include <core/dbus/macros.h>
 #include <core/dbus/property.h>
 
 #include <chrono>
+#include <cstdint>
+#include <map>
 #include <string>
 
 namespace anbox {
@@ -29,6 +33,24 @@ namespace dbus {
 namespace interface {
 struct Service {
   static inline std::string name() { return "org.anbox"; }
+  // Instances other than the default one get their own name so that
+  // several of them can share a bus. '-' isn't allowed in D-Bus names so
+  // it's escaped together with '_' to keep the names of 'a-b' and 'a_b'
+  // apart.
+  static inline std::string name(const std::string &instance_id) {
+    if (instance_id.empty() || instance_id == SystemConfiguration::default_instance_id)
+      return name();
+    std::string suffix;
+    for (const auto c : instance_id) {
+      if (c == '-')
+        suffix += "_2d";
+      else if (c == '_')
+        suffix += "_5f";
+      else
+        suffix += c;
+    }
+    return name() + ".Instance." + suffix;
+  }
   static inline std::string path() { return "/"; }
 };
 struct ApplicationManager {
@@ -47,6 +69,125 @@ struct ApplicationManager {
     DBUS_CPP_READABLE_PROPERTY_DEF(Ready, ApplicationManager, bool)
   };
 };
+struct Statistics {
+  static inline std::string name() { return "org.anbox.Statistics"; }
+  struct Methods {
+    struct GetInputLatency {
+      static inline std::string name() { return "GetInputLatency"; }
+      typedef anbox::dbus::interface::Statistics Interface;
+      typedef std::map<std::string, std::uint64_t> ResultType;
+      static inline std::chrono::milliseconds default_timeout() {
+        return std::chrono::seconds{1};
+      }
+    };
+    struct GetAudioStatistics {
+      static inline std::string name() { return "GetAudioStatistics"; }
+      typedef anbox::dbus::interface::Statistics Interface;
+      typedef std::map<std::string, std::uint64_t> ResultType;
+      static inline std::chrono::milliseconds default_timeout() {
+        return std::chrono::seconds{1};
+      }
+    };
+    struct GetRuntimeStatistics {
+      static inline std::string name() { return "GetRuntimeStatistics"; }
+      typedef anbox::dbus::interface::Statistics Interface;
+      typedef std::map<std::string, std::uint64_t> ResultType;
+      static inline std::chrono::milliseconds default_timeout() {
+        return std::chrono::seconds{1};
+      }
+    };
+    struct GetCompositionStatistics {
+      static inline std::string name() { return "GetCompositionStatistics"; }
+      typedef anbox::dbus::interface::Statistics Interface;
+      typedef std::map<std::string, std::uint64_t> ResultType;
+      static inline std::chrono::milliseconds default_timeout() {
+        return std::chrono::seconds{1};
+      }
+    };
+    struct GetBufferStatistics {
+      static inline std::string name() { return "GetBufferStatistics"; }
+      typedef anbox::dbus::interface::Statistics Interface;
+      typedef std::map<std::string, std::uint64_t> ResultType;
+      static inline std::chrono::milliseconds default_timeout() {
+        return std::chrono::seconds{1};
+      }
+    };
+    struct GetMemoryStatistics {
+      static inline std::string name() { return "GetMemoryStatistics"; }
+      typedef anbox::dbus::interface::Statistics Interface;
+      typedef std::map<std::string, std::uint64_t> ResultType;
+      static inline std::chrono::milliseconds default_timeout() {
+        return std::chrono::seconds{1};
+      }
+    };
+    struct GetPipeStatistics {
+      static inline std::string name() { return "GetPipeStatistics"; }
+      typedef anbox::dbus::interface::Statistics Interface;
+      typedef std::map<std::string, std::uint64_t> ResultType;
+      static inline std::chrono::milliseconds default_timeout() {
+        return std::chrono::seconds{1};
+      }
+    };
+    struct StartTracing {
+      static inline std::string name() { return "StartTracing"; }
+      typedef anbox::dbus::interface::Statistics Interface;
+      typedef void ResultType;
+      static inline std::chrono::milliseconds default_timeout() {
+        return std::chrono::seconds{1};
+      }
+    };
+    struct StopTracing {
+      static inline std::string name() { return "StopTracing"; }
+      typedef anbox::dbus::interface::Statistics Interface;
+      typedef void ResultType;
+      static inline std::chrono::milliseconds default_timeout() {
+        return std::chrono::seconds{10};
+      }
+    };
+  };
+};
+struct Sensors {
+  static inline std::string name() { return "org.anbox.Sensors"; }
+  struct Methods {
+    struct SetValue {
+      static inline std::string name() { return "SetValue"; }
+      typedef anbox::dbus::interface::Sensors Interface;
+      typedef void ResultType;
+      static inline std::chrono::milliseconds default_timeout() {
+        return std::chrono::seconds{1};
+      }
+    };
+    struct SetSource {
+      static inline std::string name() { return "SetSource"; }
+      typedef anbox::dbus::interface::Sensors Interface;
+      typedef void ResultType;
+      static inline std::chrono::milliseconds default_timeout() {
+        return std::chrono::seconds{5};
+      }
+    };
+  };
+};
+struct Display {
+  static inline std::string name() { return "org.anbox.Display"; }
+  struct Methods {
+    struct SetRenderScale {
+      static inline std::string name() { return "SetRenderScale"; }
+      typedef anbox::dbus::interface::Display Interface;
+      typedef void ResultType;
+      static inline std::chrono::milliseconds default_timeout() {
+        return std::chrono::seconds{1};
+      }
+    };
+    struct GetRenderScale {
+      static inline std::string name() { return "GetRenderScale"; }
+      typedef anbox::dbus::interface::Display Interface;
+      typedef double ResultType;
+      static inline std::chrono::milliseconds default_timeout() {
+        return std::chrono::seconds{1};
+      }
+    };
+  };
+};
 }  // namespace interface
 }  // namespace dbus
 }  // namespace anbox
@@ -61,6 +202,27 @@ struct Service<anbox::dbus::interface::ApplicationManager> {
     return s;
   }
 };
+template <>
+struct Service<anbox::dbus::interface::Statistics> {
+  static inline const std::string& interface_name() {
+    static const std::string s{"org.anbox.Statistics"};
+    return s;
+  }
+};
+template <>
+struct Service<anbox::dbus::interface::Sensors> {
+  static inline const std::string& interface_name() {
+    static const std::string s{"org.anbox.Sensors"};
+    return s;
+  }
+};
+template <>
+struct Service<anbox::dbus::interface::Display> {
+  static inline const std::string& interface_name() {
+    static const std::string s{"org.anbox.Display"};
+    return s;
+  }
+};
 }  // namespace traits
 }  // namespace dbus
 }  // namespace core
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/dbus/skeleton/display.h"
+#include "anbox/dbus/interface.h"
+#include "anbox/graphics/render_scale.h"
+
+namespace anbox {
+namespace dbus {
+namespace skeleton {
+Display::Display(const core::dbus::Bus::Ptr &bus,
+                 const core::dbus::Object::Ptr &object)
+    : bus_(bus), object_(object) {
+  // Takes the fraction of the host resolution Android renders at.
+  object_->install_method_handler<anbox::dbus::interface::Display::Methods::SetRenderScale>(
+      [this](const core::dbus::Message::Ptr &msg) {
+        double scale = 0.0;
+        msg->reader() >> scale;
+
+        core::dbus::Message::Ptr reply;
+        if (graphics::RenderScale::get()->set(static_cast<float>(scale)))
+          reply = core::dbus::Message::make_method_return(msg);
+        else
+          reply = core::dbus::Message::make_error(msg, "org.anbox.Error.InvalidArgument",
+                                                  "Render scale out of range");
+        bus_->send(reply);
+      });
+
+  object_->install_method_handler<anbox::dbus::interface::Display::Methods::GetRenderScale>(
+      [this](const core::dbus::Message::Ptr &msg) {
+        auto reply = core::dbus::Message::make_method_return(msg);
+        reply->writer() << static_cast<double>(graphics::RenderScale::get()->value());
+        bus_->send(reply);
+      });
+}
+
+Display::~Display() {}
+}  // namespace skeleton
+}  // namespace dbus
+}  // namespace anbox
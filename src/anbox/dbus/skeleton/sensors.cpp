@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/dbus/skeleton/sensors.h"
+#include "anbox/dbus/interface.h"
+#include "anbox/logger.h"
+#include "anbox/sensors/manager.h"
+
+namespace anbox {
+namespace dbus {
+namespace skeleton {
+Sensors::Sensors(const core::dbus::Bus::Ptr &bus,
+                 const core::dbus::Object::Ptr &object)
+    : bus_(bus), object_(object) {
+  // Takes the name of the sensor as used by the HAL and its values.
+  object_->install_method_handler<anbox::dbus::interface::Sensors::Methods::SetValue>(
+      [this](const core::dbus::Message::Ptr &msg) {
+        std::string name;
+        std::vector<double> values;
+        msg->reader() >> name >> values;
+
+        sensors::Type type;
+        if (!sensors::type_from_name(name, type) ||
+            values.size() != sensors::value_count_for(type)) {
+          bus_->send(core::dbus::Message::make_error(
+              msg, "org.anbox.Error.InvalidArgument", "Invalid sensor or values"));
+          return;
+        }
+
+        sensors::Values v{{0.0f, 0.0f, 0.0f}};
+        std::copy(values.begin(), values.end(), v.begin());
+        sensors::Manager::get()->set_value(type, v);
+        bus_->send(core::dbus::Message::make_method_return(msg));
+      });
+
+  // Takes a source description like 'synthetic' or 'replay:<path>'.
+  object_->install_method_handler<anbox::dbus::interface::Sensors::Methods::SetSource>(
+      [this](const core::dbus::Message::Ptr &msg) {
+        std::string spec;
+        msg->reader() >> spec;
+
+        core::dbus::Message::Ptr reply;
+        try {
+          sensors::Manager::get()->set_source(sensors::Manager::create_source(spec));
+          reply = core::dbus::Message::make_method_return(msg);
+        } catch (const std::exception &err) {
+          reply = core::dbus::Message::make_error(msg, "org.anbox.Error.Failed", err.what());
+        }
+        bus_->send(reply);
+      });
+}
+
+Sensors::~Sensors() {}
+}  // namespace skeleton
+}  // namespace dbus
+}  // namespace anbox
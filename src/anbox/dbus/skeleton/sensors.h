@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_DBUS_SKELETON_SENSORS_H_
+#define ANBOX_DBUS_SKELETON_SENSORS_H_
+
+#include "anbox/do_not_copy_or_move.h"
+
+#include <core/dbus/bus.h>
+#include <core/dbus/object.h>
+
+namespace anbox {
+namespace dbus {
+namespace skeleton {
+// Sensors allows to feed values for the emulated sensors of the container
+// from the outside and to switch between the available sensor sources.
+class Sensors : public DoNotCopyOrMove {
+ public:
+  Sensors(const core::dbus::Bus::Ptr &bus,
+          const core::dbus::Object::Ptr &object);
+  ~Sensors();
+
+ private:
+  core::dbus::Bus::Ptr bus_;
+  core::dbus::Object::Ptr object_;
+};
+}  // namespace skeleton
+}  // namespace dbus
+}  // namespace anbox
+
+#endif
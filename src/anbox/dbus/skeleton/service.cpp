@@ -16,28 +16,38 @@
  */
 
 #include "anbox/dbus/skeleton/service.h"
+#include "anbox/config.h"
 #include "anbox/dbus/interface.h"
 #include "anbox/dbus/skeleton/application_manager.h"
+#include "anbox/dbus/skeleton/display.h"
+#include "anbox/dbus/skeleton/sensors.h"
+#include "anbox/dbus/skeleton/statistics.h"
 
 namespace anbox {
 namespace dbus {
 namespace skeleton {
 std::shared_ptr<Service> Service::create_for_bus(
     const core::dbus::Bus::Ptr &bus,
-    const std::shared_ptr<anbox::application::Manager> &application_manager) {
-  auto service = core::dbus::Service::add_service(bus, anbox::dbus::interface::Service::name());
+    const std::shared_ptr<anbox::application::Manager> &application_manager,
+    const std::shared_ptr<Runtime> &runtime) {
+  auto service = core::dbus::Service::add_service(
+      bus, anbox::dbus::interface::Service::name(SystemConfiguration::instance().instance_id()));
   auto object = service->add_object_for_path(anbox::dbus::interface::Service::path());
-  return std::make_shared<Service>(bus, service, object, application_manager);
+  return std::make_shared<Service>(bus, service, object, application_manager, runtime);
 }
 
 Service::Service(
     const core::dbus::Bus::Ptr &bus, const core::dbus::Service::Ptr &service,
     const core::dbus::Object::Ptr &object,
-    const std::shared_ptr<anbox::application::Manager> &application_manager)
+    const std::shared_ptr<anbox::application::Manager> &application_manager,
+    const std::shared_ptr<Runtime> &runtime)
     : bus_(bus),
       service_(service),
       object_(object),
-      application_manager_(std::make_shared<ApplicationManager>(bus_, object_, application_manager)) {}
+      application_manager_(std::make_shared<ApplicationManager>(bus_, object_, application_manager)),
+      statistics_(std::make_shared<Statistics>(bus_, object_, runtime)),
+      sensors_(std::make_shared<Sensors>(bus_, object_)),
+      display_(std::make_shared<Display>(bus_, object_)) {}
 
 Service::~Service() {}
 }  // namespace skeleton
@@ -20,6 +20,7 @@
 
 #include "anbox/application/manager.h"
 #include "anbox/do_not_copy_or_move.h"
+#include "anbox/runtime.h"
 
 #include <core/dbus/bus.h>
 #include <core/dbus/object.h>
@@ -29,16 +30,21 @@ namespace anbox {
 namespace dbus {
 namespace skeleton {
 class ApplicationManager;
+class Display;
+class Sensors;
+class Statistics;
 class Service : public DoNotCopyOrMove {
  public:
   static std::shared_ptr<Service> create_for_bus(
       const core::dbus::Bus::Ptr &bus,
-      const std::shared_ptr<anbox::application::Manager> &application_manager);
+      const std::shared_ptr<anbox::application::Manager> &application_manager,
+      const std::shared_ptr<Runtime> &runtime);
 
   Service(
       const core::dbus::Bus::Ptr &bus, const core::dbus::Service::Ptr &service,
       const core::dbus::Object::Ptr &object,
-      const std::shared_ptr<anbox::application::Manager> &application_manager);
+      const std::shared_ptr<anbox::application::Manager> &application_manager,
+      const std::shared_ptr<Runtime> &runtime);
   ~Service();
 
  private:
@@ -46,6 +52,9 @@ class Service : public DoNotCopyOrMove {
   core::dbus::Service::Ptr service_;
   core::dbus::Object::Ptr object_;
   std::shared_ptr<application::Manager> application_manager_;
+  std::shared_ptr<Statistics> statistics_;
+  std::shared_ptr<Sensors> sensors_;
+  std::shared_ptr<Display> display_;
 };
 }  // namespace skeleton
 }  // namespace dbus
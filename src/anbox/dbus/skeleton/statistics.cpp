@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/dbus/skeleton/statistics.h"
+#include "anbox/audio/statistics.h"
+#include "anbox/common/tracer.h"
+#include "anbox/dbus/interface.h"
+#include "anbox/graphics/buffer_statistics.h"
+#include "anbox/graphics/composition_statistics.h"
+#include "anbox/graphics/memory_accounting.h"
+#include "anbox/input/latency_tracker.h"
+#include "anbox/qemu/pipe_statistics.h"
+
+namespace anbox {
+namespace dbus {
+namespace skeleton {
+Statistics::Statistics(const core::dbus::Bus::Ptr &bus,
+                       const core::dbus::Object::Ptr &object,
+                       const std::shared_ptr<Runtime> &runtime)
+    : bus_(bus), object_(object), runtime_(runtime) {
+  object_->install_method_handler<anbox::dbus::interface::Statistics::Methods::GetInputLatency>(
+      [this](const core::dbus::Message::Ptr &msg) {
+        auto reply = core::dbus::Message::make_method_return(msg);
+        reply->writer() << input::LatencyTracker::get()->summary();
+        bus_->send(reply);
+      });
+
+  object_->install_method_handler<anbox::dbus::interface::Statistics::Methods::GetAudioStatistics>(
+      [this](const core::dbus::Message::Ptr &msg) {
+        auto reply = core::dbus::Message::make_method_return(msg);
+        reply->writer() << audio::Statistics::get()->summary();
+        bus_->send(reply);
+      });
+
+  object_->install_method_handler<anbox::dbus::interface::Statistics::Methods::GetRuntimeStatistics>(
+      [this](const core::dbus::Message::Ptr &msg) {
+        auto reply = core::dbus::Message::make_method_return(msg);
+        reply->writer() << runtime_->statistics();
+        bus_->send(reply);
+      });
+
+  // How often the window of every task is composed or skipped while it's
+  // invisible.
+  object_->install_method_handler<anbox::dbus::interface::Statistics::Methods::GetCompositionStatistics>(
+      [this](const core::dbus::Message::Ptr &msg) {
+        auto reply = core::dbus::Message::make_method_return(msg);
+        reply->writer() << graphics::CompositionStatistics::get()->summary();
+        bus_->send(reply);
+      });
+
+  // How many color buffers the guest holds and how much memory they take.
+  object_->install_method_handler<anbox::dbus::interface::Statistics::Methods::GetBufferStatistics>(
+      [this](const core::dbus::Message::Ptr &msg) {
+        auto reply = core::dbus::Message::make_method_return(msg);
+        reply->writer() << graphics::BufferStatistics::get()->summary();
+        bus_->send(reply);
+      });
+
+  // GPU memory held by every GL client of the guest and what the budgets
+  // did about it.
+  object_->install_method_handler<anbox::dbus::interface::Statistics::Methods::GetMemoryStatistics>(
+      [this](const core::dbus::Message::Ptr &msg) {
+        auto reply = core::dbus::Message::make_method_return(msg);
+        reply->writer() << graphics::MemoryAccounting::get()->summary();
+        bus_->send(reply);
+      });
+
+  // How many clients of each type connected through the qemu pipe and how
+  // long their handshakes took.
+  object_->install_method_handler<anbox::dbus::interface::Statistics::Methods::GetPipeStatistics>(
+      [this](const core::dbus::Message::Ptr &msg) {
+        auto reply = core::dbus::Message::make_method_return(msg);
+        reply->writer() << qemu::PipeStatistics::get()->summary();
+        bus_->send(reply);
+      });
+
+  object_->install_method_handler<anbox::dbus::interface::Statistics::Methods::StartTracing>(
+      [this](const core::dbus::Message::Ptr &msg) {
+        common::Tracer::get()->start();
+        bus_->send(core::dbus::Message::make_method_return(msg));
+      });
+
+  // Stops tracing and writes the trace to the path given by the caller.
+  object_->install_method_handler<anbox::dbus::interface::Statistics::Methods::StopTracing>(
+      [this](const core::dbus::Message::Ptr &msg) {
+        std::string path;
+        msg->reader() >> path;
+
+        core::dbus::Message::Ptr reply;
+        if (common::Tracer::get()->stop(path))
+          reply = core::dbus::Message::make_method_return(msg);
+        else
+          reply = core::dbus::Message::make_error(msg, "org.anbox.Error.Failed",
+                                                  "Failed to write trace");
+        bus_->send(reply);
+      });
+}
+
+Statistics::~Statistics() {}
+}  // namespace skeleton
+}  // namespace dbus
+}  // namespace anbox
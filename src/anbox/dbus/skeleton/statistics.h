@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_DBUS_SKELETON_STATISTICS_H_
+#define ANBOX_DBUS_SKELETON_STATISTICS_H_
+
+#include "anbox/do_not_copy_or_move.h"
+#include "anbox/runtime.h"
+
+#include <core/dbus/bus.h>
+#include <core/dbus/object.h>
+
+namespace anbox {
+namespace dbus {
+namespace skeleton {
+// Statistics exposes runtime measurements of the session so that they can
+// be inspected from the outside, e.g. for regression testing.
+class Statistics : public DoNotCopyOrMove {
+ public:
+  Statistics(const core::dbus::Bus::Ptr &bus,
+             const core::dbus::Object::Ptr &object,
+             const std::shared_ptr<Runtime> &runtime);
+  ~Statistics();
+
+ private:
+  core::dbus::Bus::Ptr bus_;
+  core::dbus::Object::Ptr object_;
+  std::shared_ptr<Runtime> runtime_;
+};
+}  // namespace skeleton
+}  // namespace dbus
+}  // namespace anbox
+
+#endif
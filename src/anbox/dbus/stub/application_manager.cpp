@@ -16,6 +16,7 @@
  */
 
 #include "anbox/dbus/stub/application_manager.h"
+#include "anbox/config.h"
 #include "anbox/dbus/interface.h"
 #include "anbox/dbus/codecs.h"
 #include "anbox/logger.h"
@@ -24,7 +25,8 @@ namespace anbox {
 namespace dbus {
 namespace stub {
 std::shared_ptr<ApplicationManager> ApplicationManager::create_for_bus(const core::dbus::Bus::Ptr &bus) {
-  auto service = core::dbus::Service::use_service_or_throw_if_not_available(bus, anbox::dbus::interface::Service::name());
+  auto service = core::dbus::Service::use_service_or_throw_if_not_available(
+      bus, anbox::dbus::interface::Service::name(SystemConfiguration::instance().instance_id()));
   auto object = service->object_for_path(anbox::dbus::interface::Service::path());
   return std::make_shared<ApplicationManager>(bus, service, object);
 }
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_GRAPHICS_BUFFER_POOL_H_
+#define ANBOX_GRAPHICS_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <iterator>
+
+namespace anbox {
+namespace graphics {
+// BufferPool keeps released buffers around so that a later request for a
+// buffer of the same size and format can reuse one instead of allocating
+// it again. Once the pooled buffers take more than the budget the ones
+// released the longest time ago are dropped. The pool isn't thread-safe.
+template <typename Buffer>
+class BufferPool {
+ public:
+  struct Key {
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t format;
+
+    bool operator==(const Key &other) const {
+      return width == other.width && height == other.height && format == other.format;
+    }
+  };
+
+  explicit BufferPool(std::size_t budget) : budget_(budget), size_(0) {}
+
+  // Moves a buffer matching the key into |buffer|. Returns false if there is
+  // none.
+  bool acquire(const Key &key, Buffer &buffer) {
+    // The most recently released buffer is the most likely one to be still
+    // warm in caches.
+    for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+      if (!(it->key == key)) continue;
+      buffer = it->buffer;
+      size_ -= it->size;
+      entries_.erase(std::next(it).base());
+      return true;
+    }
+    return false;
+  }
+
+  // Takes a released buffer of the given size in bytes. Returns the number
+  // of pooled buffers dropped to stay within the budget, including the
+  // released one itself if it doesn't fit at all.
+  std::size_t release(const Key &key, const Buffer &buffer, std::size_t size) {
+    if (size > budget_) return 1;
+
+    entries_.push_back(Entry{key, buffer, size});
+    size_ += size;
+
+    std::size_t evicted = 0;
+    while (size_ > budget_) {
+      size_ -= entries_.front().size;
+      entries_.pop_front();
+      evicted++;
+    }
+    return evicted;
+  }
+
+  void clear() {
+    entries_.clear();
+    size_ = 0;
+  }
+
+  std::size_t count() const { return entries_.size(); }
+  // Size of all pooled buffers in bytes
+  std::size_t size() const { return size_; }
+
+ private:
+  struct Entry {
+    Key key;
+    Buffer buffer;
+    std::size_t size;
+  };
+
+  std::size_t budget_;
+  std::size_t size_;
+  std::list<Entry> entries_;
+};
+}  // namespace graphics
+}  // namespace anbox
+
+#endif
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/graphics/buffer_statistics.h"
+
+namespace anbox {
+namespace graphics {
+std::shared_ptr<BufferStatistics> BufferStatistics::get() {
+  static auto instance = std::make_shared<BufferStatistics>();
+  return instance;
+}
+
+BufferStatistics::BufferStatistics()
+    : buffers_(0),
+      bytes_(0),
+      evicted_buffers_(0),
+      evicted_bytes_(0),
+      pooled_buffers_(0),
+      pooled_bytes_(0),
+      pool_hits_(0),
+      pool_misses_(0),
+      pool_evictions_(0),
+      blit_flushes_(0),
+      draw_flushes_(0) {}
+
+BufferStatistics::~BufferStatistics() {}
+
+void BufferStatistics::buffer_created(std::uint64_t bytes) {
+  buffers_.fetch_add(1);
+  bytes_.fetch_add(bytes);
+}
+
+void BufferStatistics::buffer_destroyed(std::uint64_t bytes) {
+  buffers_.fetch_sub(1);
+  bytes_.fetch_sub(bytes);
+}
+
+void BufferStatistics::buffer_grown(std::uint64_t bytes) {
+  bytes_.fetch_add(bytes);
+}
+
+void BufferStatistics::buffer_evicted(std::uint64_t bytes, std::uint64_t backing) {
+  bytes_.fetch_sub(bytes);
+  evicted_buffers_.fetch_add(1);
+  evicted_bytes_.fetch_add(backing);
+}
+
+void BufferStatistics::buffer_restored(std::uint64_t bytes, std::uint64_t backing) {
+  bytes_.fetch_add(bytes);
+  evicted_buffers_.fetch_sub(1);
+  evicted_bytes_.fetch_sub(backing);
+}
+
+void BufferStatistics::set_pooled(std::uint64_t buffers, std::uint64_t bytes) {
+  pooled_buffers_.store(buffers);
+  pooled_bytes_.store(bytes);
+}
+
+void BufferStatistics::pool_hit() {
+  pool_hits_.fetch_add(1);
+}
+
+void BufferStatistics::pool_miss() {
+  pool_misses_.fetch_add(1);
+}
+
+void BufferStatistics::pool_evicted(std::uint64_t buffers) {
+  pool_evictions_.fetch_add(buffers);
+}
+
+void BufferStatistics::surface_flushed(bool framebuffer_blit) {
+  if (framebuffer_blit)
+    blit_flushes_.fetch_add(1);
+  else
+    draw_flushes_.fetch_add(1);
+}
+
+std::map<std::string, std::uint64_t> BufferStatistics::summary() const {
+  const auto buffers = buffers_.load();
+  const auto bytes = bytes_.load();
+  const auto pooled_buffers = pooled_buffers_.load();
+  const auto pooled_bytes = pooled_bytes_.load();
+
+  return {
+      {"live_buffers", buffers > pooled_buffers ? buffers - pooled_buffers : 0},
+      {"live_bytes", bytes > pooled_bytes ? bytes - pooled_bytes : 0},
+      {"pooled_buffers", pooled_buffers},
+      {"pooled_bytes", pooled_bytes},
+      {"pool_hits", pool_hits_.load()},
+      {"pool_misses", pool_misses_.load()},
+      {"pool_evictions", pool_evictions_.load()},
+      {"system_memory_buffers", evicted_buffers_.load()},
+      {"system_memory_bytes", evicted_bytes_.load()},
+      {"surface_flushes_blit", blit_flushes_.load()},
+      {"surface_flushes_draw", draw_flushes_.load()},
+  };
+}
+}  // namespace graphics
+}  // namespace anbox
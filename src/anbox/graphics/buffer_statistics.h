@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_GRAPHICS_BUFFER_STATISTICS_H_
+#define ANBOX_GRAPHICS_BUFFER_STATISTICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace anbox {
+namespace graphics {
+// BufferStatistics tracks how many color buffers exist on the host for the
+// guest and roughly how much GPU memory they take, and how well the pool of
+// released buffers works.
+class BufferStatistics {
+ public:
+  static std::shared_ptr<BufferStatistics> get();
+
+  BufferStatistics();
+  ~BufferStatistics();
+
+  void buffer_created(std::uint64_t bytes);
+  void buffer_destroyed(std::uint64_t bytes);
+  // For resources of a buffer which are allocated on first use
+  void buffer_grown(std::uint64_t bytes);
+  // Buffers moved to system memory and back. |bytes| is the GPU memory
+  // released or taken again, |backing| the system memory holding the
+  // content meanwhile.
+  void buffer_evicted(std::uint64_t bytes, std::uint64_t backing);
+  void buffer_restored(std::uint64_t bytes, std::uint64_t backing);
+
+  void set_pooled(std::uint64_t buffers, std::uint64_t bytes);
+  void pool_hit();
+  void pool_miss();
+  void pool_evicted(std::uint64_t buffers);
+
+  // Window surface content copied into its buffer, either with a single
+  // framebuffer blit or through a texture and the helper context.
+  void surface_flushed(bool framebuffer_blit);
+
+  // Buffers in use by the guest are reported as "live_buffers" and
+  // "live_bytes", the ones waiting in the pool as "pooled_buffers" and
+  // "pooled_bytes". Evicted buffers count as live but their memory as
+  // "system_memory_bytes".
+  std::map<std::string, std::uint64_t> summary() const;
+
+ private:
+  std::atomic<std::uint64_t> buffers_;
+  std::atomic<std::uint64_t> bytes_;
+  std::atomic<std::uint64_t> evicted_buffers_;
+  std::atomic<std::uint64_t> evicted_bytes_;
+  std::atomic<std::uint64_t> pooled_buffers_;
+  std::atomic<std::uint64_t> pooled_bytes_;
+  std::atomic<std::uint64_t> pool_hits_;
+  std::atomic<std::uint64_t> pool_misses_;
+  std::atomic<std::uint64_t> pool_evictions_;
+  std::atomic<std::uint64_t> blit_flushes_;
+  std::atomic<std::uint64_t> draw_flushes_;
+};
+}  // namespace graphics
+}  // namespace anbox
+
+#endif
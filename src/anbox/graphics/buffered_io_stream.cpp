@@ -22,9 +22,11 @@ namespace anbox {
 namespace graphics {
 BufferedIOStream::BufferedIOStream(
     const std::shared_ptr<anbox::network::SocketMessenger> &messenger,
-    size_t buffer_size)
+    size_t buffer_size,
+    const std::shared_ptr<common::SharedMemoryRing> &input)
     : IOStream(buffer_size),
       messenger_(messenger),
+      input_(input),
       in_queue_(1024U),
       out_queue_(16U),
       worker_thread_(&BufferedIOStream::thread_main, this) {
@@ -56,6 +58,15 @@ size_t BufferedIOStream::commitBuffer(size_t size) {
 }
 
 const unsigned char *BufferedIOStream::read(void *buf, size_t *inout_len) {
+  if (input_) {
+    // Only blocks when the ring is empty, otherwise this is just a copy out
+    // of the shared memory.
+    *inout_len = input_->read(buf, *inout_len);
+    if (*inout_len == 0)
+      return nullptr;
+    return static_cast<const unsigned char *>(buf);
+  }
+
   std::unique_lock<std::mutex> l(lock_);
   size_t wanted = *inout_len;
   size_t count = 0U;
@@ -95,6 +106,9 @@ const unsigned char *BufferedIOStream::read(void *buf, size_t *inout_len) {
 }
 
 void BufferedIOStream::forceStop() {
+  if (input_)
+    input_->close();
+
   std::lock_guard<std::mutex> l(lock_);
   in_queue_.close_locked();
   out_queue_.close_locked();
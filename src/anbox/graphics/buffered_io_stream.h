@@ -20,6 +20,7 @@
 
 #include "external/android-emugl/host/include/libOpenglRender/IOStream.h"
 
+#include "anbox/common/shared_memory_ring.h"
 #include "anbox/graphics/buffer_queue.h"
 #include "anbox/network/socket_messenger.h"
 
@@ -32,9 +33,12 @@ class BufferedIOStream : public IOStream {
  public:
   static const size_t default_buffer_size{384};
 
+  // When an input ring is given all data is read from it rather than
+  // from what gets posted through post_data.
   explicit BufferedIOStream(
       const std::shared_ptr<anbox::network::SocketMessenger> &messenger,
-      size_t buffer_size = default_buffer_size);
+      size_t buffer_size = default_buffer_size,
+      const std::shared_ptr<common::SharedMemoryRing> &input = nullptr);
 
   virtual ~BufferedIOStream();
 
@@ -50,6 +54,7 @@ class BufferedIOStream : public IOStream {
   void thread_main();
 
   std::shared_ptr<anbox::network::SocketMessenger> messenger_;
+  std::shared_ptr<common::SharedMemoryRing> input_;
   std::mutex lock_;
   std::mutex out_lock_;
   Buffer write_buffer_;
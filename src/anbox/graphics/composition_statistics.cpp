@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/graphics/composition_statistics.h"
+#include "anbox/utils.h"
+
+#include <cmath>
+
+namespace {
+// Length of the period the compose rate is measured over
+constexpr const std::chrono::seconds rate_period{1};
+// Tasks whose windows weren't seen by the composer for that long are gone
+// and dropped from the statistics.
+constexpr const std::chrono::seconds task_expiry{60};
+
+double seconds_between(const anbox::graphics::CompositionStatistics::Clock::time_point &from,
+                       const anbox::graphics::CompositionStatistics::Clock::time_point &to) {
+  return std::chrono::duration_cast<std::chrono::duration<double>>(to - from).count();
+}
+}
+
+namespace anbox {
+namespace graphics {
+std::shared_ptr<CompositionStatistics> CompositionStatistics::get() {
+  static auto instance = std::make_shared<CompositionStatistics>();
+  return instance;
+}
+
+CompositionStatistics::CompositionStatistics()
+    : throttled_frames_(0),
+      throttled_us_(0),
+      composition_passes_(0),
+      make_current_calls_(0),
+      make_current_skipped_(0),
+      make_current_max_per_pass_(0) {}
+
+CompositionStatistics::~CompositionStatistics() {}
+
+CompositionStatistics::TaskStatistics &CompositionStatistics::task_locked(
+    const wm::Task::Id &task, const Clock::time_point &now) {
+  auto it = tasks_.find(task);
+  if (it == tasks_.end()) {
+    // Forget about windows which are gone before we start tracking a new
+    // one so that we don't grow forever in long sessions.
+    for (auto t = tasks_.begin(); t != tasks_.end();) {
+      if (now - t->second.last_update > task_expiry)
+        t = tasks_.erase(t);
+      else
+        ++t;
+    }
+
+    it = tasks_.insert({task, TaskStatistics{}}).first;
+    it->second.period_start = now;
+  }
+  it->second.last_update = now;
+  return it->second;
+}
+
+double CompositionStatistics::rate_locked(const TaskStatistics &stats, const Clock::time_point &now) {
+  // If the current period is overdue nothing finished it, so the window
+  // isn't composed at the rate of the last full period anymore.
+  if (now - stats.period_start < 2 * rate_period) return stats.rate;
+  return stats.period_frames / seconds_between(stats.period_start, now);
+}
+
+void CompositionStatistics::frame_composed(const wm::Task::Id &task, const Clock::time_point &now) {
+  std::lock_guard<std::mutex> l(lock_);
+  auto &stats = task_locked(task, now);
+  stats.composed++;
+
+  if (now - stats.period_start >= rate_period) {
+    stats.rate = stats.period_frames / seconds_between(stats.period_start, now);
+    stats.period_start = now;
+    stats.period_frames = 0;
+  }
+  stats.period_frames++;
+}
+
+void CompositionStatistics::frame_skipped(const wm::Task::Id &task, const Clock::time_point &now) {
+  std::lock_guard<std::mutex> l(lock_);
+  task_locked(task, now).skipped++;
+}
+
+void CompositionStatistics::frame_throttled(const std::chrono::microseconds &delay) {
+  throttled_frames_.fetch_add(1);
+  throttled_us_.fetch_add(delay.count());
+}
+
+void CompositionStatistics::context_switches(std::uint64_t made, std::uint64_t skipped) {
+  composition_passes_.fetch_add(1);
+  make_current_calls_.fetch_add(made);
+  make_current_skipped_.fetch_add(skipped);
+
+  auto max = make_current_max_per_pass_.load();
+  while (made > max && !make_current_max_per_pass_.compare_exchange_weak(max, made)) {}
+}
+
+double CompositionStatistics::compose_rate(const wm::Task::Id &task, const Clock::time_point &now) const {
+  std::lock_guard<std::mutex> l(lock_);
+  const auto it = tasks_.find(task);
+  if (it == tasks_.end()) return 0.0;
+  return rate_locked(it->second, now);
+}
+
+std::map<std::string, std::uint64_t> CompositionStatistics::summary(const Clock::time_point &now) const {
+  std::map<std::string, std::uint64_t> summary{
+      {"throttled_frames", throttled_frames_.load()},
+      {"throttled_ms", throttled_us_.load() / 1000},
+      {"composition_passes", composition_passes_.load()},
+      {"make_current_calls", make_current_calls_.load()},
+      {"make_current_skipped", make_current_skipped_.load()},
+      {"make_current_max_per_pass", make_current_max_per_pass_.load()},
+  };
+
+  std::lock_guard<std::mutex> l(lock_);
+  for (const auto &task : tasks_) {
+    const auto prefix = utils::string_format("task.%d.", task.first);
+    summary[prefix + "composed"] = task.second.composed;
+    summary[prefix + "skipped"] = task.second.skipped;
+    summary[prefix + "fps"] = static_cast<std::uint64_t>(std::round(rate_locked(task.second, now)));
+  }
+  return summary;
+}
+}  // namespace graphics
+}  // namespace anbox
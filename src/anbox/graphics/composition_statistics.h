@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_GRAPHICS_COMPOSITION_STATISTICS_H_
+#define ANBOX_GRAPHICS_COMPOSITION_STATISTICS_H_
+
+#include "anbox/wm/task.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace anbox {
+namespace graphics {
+// CompositionStatistics counts how often the window of every task was
+// composed or skipped because nobody could see it, how long the guest
+// was held back while all of its windows were invisible and how often the
+// renderer had to switch its context to compose a frame.
+class CompositionStatistics {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  static std::shared_ptr<CompositionStatistics> get();
+
+  CompositionStatistics();
+  ~CompositionStatistics();
+
+  void frame_composed(const wm::Task::Id &task, const Clock::time_point &now = Clock::now());
+  void frame_skipped(const wm::Task::Id &task, const Clock::time_point &now = Clock::now());
+  void frame_throttled(const std::chrono::microseconds &delay);
+  // Number of eglMakeCurrent calls a composition pass needed and how many
+  // it could avoid because the context was already current.
+  void context_switches(std::uint64_t made, std::uint64_t skipped);
+
+  // Frames per second the window of the task was composed at during the
+  // last second or so.
+  double compose_rate(const wm::Task::Id &task, const Clock::time_point &now = Clock::now()) const;
+
+  // Per task counters are keyed "task.<id>.composed", "task.<id>.skipped"
+  // and "task.<id>.fps".
+  std::map<std::string, std::uint64_t> summary(const Clock::time_point &now = Clock::now()) const;
+
+ private:
+  struct TaskStatistics {
+    TaskStatistics() : composed(0), skipped(0), period_frames(0), rate(0.0) {}
+
+    std::uint64_t composed;
+    std::uint64_t skipped;
+    // Frames composed since period_start
+    std::uint64_t period_frames;
+    Clock::time_point period_start;
+    Clock::time_point last_update;
+    // Rate measured over the last full period
+    double rate;
+  };
+
+  TaskStatistics &task_locked(const wm::Task::Id &task, const Clock::time_point &now);
+  static double rate_locked(const TaskStatistics &stats, const Clock::time_point &now);
+
+  mutable std::mutex lock_;
+  std::map<wm::Task::Id, TaskStatistics> tasks_;
+  std::atomic<std::uint64_t> throttled_frames_;
+  std::atomic<std::uint64_t> throttled_us_;
+  std::atomic<std::uint64_t> composition_passes_;
+  std::atomic<std::uint64_t> make_current_calls_;
+  std::atomic<std::uint64_t> make_current_skipped_;
+  std::atomic<std::uint64_t> make_current_max_per_pass_;
+};
+}  // namespace graphics
+}  // namespace anbox
+
+#endif
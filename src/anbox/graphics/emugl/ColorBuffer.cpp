@@ -22,10 +22,26 @@
 
 #include "OpenGLESDispatch/EGLDispatch.h"
 
+#include "anbox/graphics/buffer_statistics.h"
+#include "anbox/graphics/memory_accounting.h"
 #include "anbox/logger.h"
 
 #include <stdio.h>
 
+// Used to avoid adding GLES3/gl3.h to our headers.
+#ifndef GL_READ_FRAMEBUFFER
+#define GL_READ_FRAMEBUFFER 0x8CA8
+#endif
+#ifndef GL_DRAW_FRAMEBUFFER
+#define GL_DRAW_FRAMEBUFFER 0x8CA9
+#endif
+#ifndef GL_DRAW_FRAMEBUFFER_BINDING
+#define GL_DRAW_FRAMEBUFFER_BINDING 0x8CA6
+#endif
+#ifndef GL_READ_FRAMEBUFFER_BINDING
+#define GL_READ_FRAMEBUFFER_BINDING 0x8CAA
+#endif
+
 namespace {
 
 // <EGL/egl.h> defines many types as 'void*' while they're really
@@ -116,27 +132,37 @@ class ScopedHelperContext {
 
 }  // namespace
 
-// static
-ColorBuffer* ColorBuffer::create(EGLDisplay p_display, int p_width,
-                                 int p_height, GLenum p_internalFormat,
-                                 bool has_eglimage_texture_2d, Helper* helper) {
-  GLenum texInternalFormat = 0;
-
-  switch (p_internalFormat) {
+namespace {
+GLenum textureFormatFor(GLenum internalFormat) {
+  switch (internalFormat) {
     case GL_RGB:
     case GL_RGB565_OES:
-      texInternalFormat = GL_RGB;
-      break;
+      return GL_RGB;
 
     case GL_RGBA:
     case GL_RGB5_A1_OES:
     case GL_RGBA4_OES:
-      texInternalFormat = GL_RGBA;
-      break;
+      return GL_RGBA;
 
     default:
-      return NULL;
-      break;
+      return 0;
+  }
+}
+
+size_t bytesPerPixel(GLenum textureFormat) {
+  return textureFormat == GL_RGB ? 3 : 4;
+}
+}  // namespace
+
+// static
+ColorBuffer* ColorBuffer::create(EGLDisplay p_display, int p_width,
+                                 int p_height, GLenum p_internalFormat,
+                                 bool has_eglimage_texture_2d,
+                                 bool has_framebuffer_blit, Helper* helper,
+                                 Client owner) {
+  GLenum texInternalFormat = textureFormatFor(p_internalFormat);
+  if (!texInternalFormat) {
+    return NULL;
   }
 
   ScopedHelperContext context(helper);
@@ -145,52 +171,193 @@ ColorBuffer* ColorBuffer::create(EGLDisplay p_display, int p_width,
   }
 
   ColorBuffer* cb = new ColorBuffer(p_display, helper);
+  cb->m_width = p_width;
+  cb->m_height = p_height;
+  cb->m_internalFormat = texInternalFormat;
+  cb->m_hasEglImage = has_eglimage_texture_2d;
+  cb->m_hasFramebufferBlit = has_framebuffer_blit;
+  cb->m_owner = owner;
 
-  s_gles2.glGenTextures(1, &cb->m_tex);
-  s_gles2.glBindTexture(GL_TEXTURE_2D, cb->m_tex);
+  char* zBuff = static_cast<char*>(
+      ::calloc(bytesPerPixel(texInternalFormat) * p_width * p_height, 1));
+  cb->createTexture(zBuff);
+  ::free(zBuff);
 
-  int nComp = (texInternalFormat == GL_RGB ? 3 : 4);
+  // The texture used to blit from window surfaces and the resizer are only
+  // needed by a few buffers and created once they are used.
+  cb->m_memoryUsage = memoryUsageFor(p_width, p_height, p_internalFormat);
+  anbox::graphics::BufferStatistics::get()->buffer_created(cb->m_memoryUsage);
 
-  char* zBuff = static_cast<char*>(::calloc(nComp * p_width * p_height, 1));
-  s_gles2.glTexImage2D(GL_TEXTURE_2D, 0, texInternalFormat, p_width, p_height,
-                       0, texInternalFormat, GL_UNSIGNED_BYTE, zBuff);
-  ::free(zBuff);
+  return cb;
+}
+
+// static
+size_t ColorBuffer::memoryUsageFor(int p_width, int p_height,
+                                   GLenum p_internalFormat) {
+  return bytesPerPixel(textureFormatFor(p_internalFormat)) * p_width * p_height;
+}
+
+void ColorBuffer::createTexture(const void* pixels) {
+  s_gles2.glGenTextures(1, &m_tex);
+  s_gles2.glBindTexture(GL_TEXTURE_2D, m_tex);
+  s_gles2.glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  s_gles2.glTexImage2D(GL_TEXTURE_2D, 0, m_internalFormat, m_width, m_height,
+                       0, m_internalFormat, GL_UNSIGNED_BYTE, pixels);
 
   s_gles2.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
   s_gles2.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   s_gles2.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   s_gles2.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-  //
-  // create another texture for that colorbuffer for blit
-  //
-  s_gles2.glGenTextures(1, &cb->m_blitTex);
-  s_gles2.glBindTexture(GL_TEXTURE_2D, cb->m_blitTex);
-  s_gles2.glTexImage2D(GL_TEXTURE_2D, 0, texInternalFormat, p_width, p_height,
-                       0, texInternalFormat, GL_UNSIGNED_BYTE, NULL);
+  if (m_hasEglImage) {
+    m_eglImage = s_egl.eglCreateImageKHR(
+        m_display, s_egl.eglGetCurrentContext(), EGL_GL_TEXTURE_2D_KHR,
+        reinterpret_cast<EGLClientBuffer>(SafePointerFromUInt(m_tex)), NULL);
+  }
+}
+
+void ColorBuffer::destroyResources() {
+  if (m_blitEGLImage) {
+    s_egl.eglDestroyImageKHR(m_display, m_blitEGLImage);
+    m_blitEGLImage = NULL;
+  }
+  if (m_eglImage) {
+    s_egl.eglDestroyImageKHR(m_display, m_eglImage);
+    m_eglImage = NULL;
+  }
+
+  if (m_fbo) {
+    s_gles2.glDeleteFramebuffers(1, &m_fbo);
+    m_fbo = 0;
+  }
+
+  GLuint tex[2] = {m_tex, m_blitTex};
+  s_gles2.glDeleteTextures(m_blitTex ? 2 : 1, tex);
+  m_tex = 0;
+  m_blitTex = 0;
+
+  if (m_resizer) {
+    m_helper->releaseResizer(m_resizer);
+    m_resizer = nullptr;
+  }
+}
+
+bool ColorBuffer::createBlitResources() {
+  ScopedHelperContext context(m_helper);
+  if (!context.isOk()) {
+    return false;
+  }
+
+  s_gles2.glGenTextures(1, &m_blitTex);
+  s_gles2.glBindTexture(GL_TEXTURE_2D, m_blitTex);
+  s_gles2.glTexImage2D(GL_TEXTURE_2D, 0, m_internalFormat, m_width, m_height,
+                       0, m_internalFormat, GL_UNSIGNED_BYTE, NULL);
 
   s_gles2.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   s_gles2.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   s_gles2.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   s_gles2.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-  cb->m_width = p_width;
-  cb->m_height = p_height;
-  cb->m_internalFormat = texInternalFormat;
+  if (m_hasEglImage) {
+    m_blitEGLImage = s_egl.eglCreateImageKHR(
+        m_display, s_egl.eglGetCurrentContext(), EGL_GL_TEXTURE_2D_KHR,
+        reinterpret_cast<EGLClientBuffer>(SafePointerFromUInt(m_blitTex)), NULL);
+  }
+
+  const auto bytes = bytesPerPixel(m_internalFormat) * m_width * m_height;
+  m_memoryUsage += bytes;
+  anbox::graphics::BufferStatistics::get()->buffer_grown(bytes);
+  anbox::graphics::MemoryAccounting::get()->force_charge(m_owner, bytes);
+
+  return true;
+}
 
-  if (has_eglimage_texture_2d) {
-    cb->m_eglImage = s_egl.eglCreateImageKHR(
-        p_display, s_egl.eglGetCurrentContext(), EGL_GL_TEXTURE_2D_KHR,
-        reinterpret_cast<EGLClientBuffer>(SafePointerFromUInt(cb->m_tex)), NULL);
+bool ColorBuffer::clear() {
+  if (!makeResident()) {
+    return false;
+  }
 
-    cb->m_blitEGLImage = s_egl.eglCreateImageKHR(
-        p_display, s_egl.eglGetCurrentContext(), EGL_GL_TEXTURE_2D_KHR,
-        reinterpret_cast<EGLClientBuffer>(SafePointerFromUInt(cb->m_blitTex)), NULL);
+  ScopedHelperContext context(m_helper);
+  if (!context.isOk()) {
+    return false;
   }
 
-  cb->m_resizer = new TextureResize(p_width, p_height);
+  if (!bindFbo(&m_fbo, m_tex)) {
+    return false;
+  }
 
-  return cb;
+  s_gles2.glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  s_gles2.glClear(GL_COLOR_BUFFER_BIT);
+  unbindFbo();
+
+  return true;
+}
+
+bool ColorBuffer::evict() {
+  if (!canEvict()) {
+    return false;
+  }
+
+  ScopedHelperContext context(m_helper);
+  if (!context.isOk()) {
+    return false;
+  }
+
+  m_backing.resize(m_width * m_height * 4);
+  if (!bindFbo(&m_fbo, m_tex)) {
+    m_backing.clear();
+    return false;
+  }
+  s_gles2.glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE,
+                       m_backing.data());
+  unbindFbo();
+
+  destroyResources();
+  m_evicted = true;
+
+  anbox::graphics::BufferStatistics::get()->buffer_evicted(m_memoryUsage, m_backing.size());
+  anbox::graphics::MemoryAccounting::get()->credit(m_owner, m_memoryUsage);
+  anbox::graphics::MemoryAccounting::get()->buffer_evicted(m_memoryUsage);
+  m_memoryUsage = 0;
+
+  return true;
+}
+
+bool ColorBuffer::makeResident() {
+  m_lastUse = std::chrono::steady_clock::now();
+  if (!m_evicted) {
+    return true;
+  }
+
+  ScopedHelperContext context(m_helper);
+  if (!context.isOk()) {
+    return false;
+  }
+
+  // The content was read back as RGBA
+  if (m_internalFormat == GL_RGB) {
+    for (size_t n = 0; n < m_width * m_height; n++) {
+      m_backing[n * 3 + 0] = m_backing[n * 4 + 0];
+      m_backing[n * 3 + 1] = m_backing[n * 4 + 1];
+      m_backing[n * 3 + 2] = m_backing[n * 4 + 2];
+    }
+  }
+  createTexture(m_backing.data());
+
+  const size_t backing = m_backing.size();
+  std::vector<uint8_t>().swap(m_backing);
+  m_evicted = false;
+
+  m_memoryUsage = bytesPerPixel(m_internalFormat) * m_width * m_height;
+  anbox::graphics::BufferStatistics::get()->buffer_restored(m_memoryUsage, backing);
+  anbox::graphics::MemoryAccounting::get()->force_charge(m_owner, m_memoryUsage);
+  anbox::graphics::MemoryAccounting::get()->buffer_restored();
+
+  return true;
+}
+
+void ColorBuffer::setOwner(Client owner) {
+  m_owner = owner;
 }
 
 ColorBuffer::ColorBuffer(EGLDisplay display, Helper* helper)
@@ -200,31 +367,36 @@ ColorBuffer::ColorBuffer(EGLDisplay display, Helper* helper)
       m_blitEGLImage(NULL),
       m_fbo(0),
       m_internalFormat(0),
+      m_hasEglImage(false),
+      m_hasFramebufferBlit(false),
+      m_memoryUsage(0),
+      m_owner(anbox::graphics::MemoryAccounting::host),
+      m_evicted(false),
+      m_exported(false),
+      m_lastUse(std::chrono::steady_clock::now()),
       m_display(display),
-      m_helper(helper) {}
+      m_helper(helper),
+      m_resizer(nullptr) {}
 
 ColorBuffer::~ColorBuffer() {
   ScopedHelperContext context(m_helper);
 
-  if (m_blitEGLImage) {
-    s_egl.eglDestroyImageKHR(m_display, m_blitEGLImage);
-  }
-  if (m_eglImage) {
-    s_egl.eglDestroyImageKHR(m_display, m_eglImage);
-  }
-
-  if (m_fbo) {
-    s_gles2.glDeleteFramebuffers(1, &m_fbo);
+  if (!m_evicted) {
+    destroyResources();
+  } else {
+    anbox::graphics::BufferStatistics::get()->buffer_restored(0, m_backing.size());
   }
 
-  GLuint tex[2] = {m_tex, m_blitTex};
-  s_gles2.glDeleteTextures(2, tex);
-
-  delete m_resizer;
+  anbox::graphics::BufferStatistics::get()->buffer_destroyed(m_memoryUsage);
+  anbox::graphics::MemoryAccounting::get()->credit(m_owner, m_memoryUsage);
 }
 
 void ColorBuffer::readPixels(int x, int y, int width, int height,
                              GLenum p_format, GLenum p_type, void* pixels) {
+  if (!makeResident()) {
+    return;
+  }
+
   ScopedHelperContext context(m_helper);
   if (!context.isOk()) {
     return;
@@ -238,6 +410,10 @@ void ColorBuffer::readPixels(int x, int y, int width, int height,
 
 void ColorBuffer::subUpdate(int x, int y, int width, int height,
                             GLenum p_format, GLenum p_type, void* pixels) {
+  if (!makeResident()) {
+    return;
+  }
+
   ScopedHelperContext context(m_helper);
   if (!context.isOk()) {
     return;
@@ -250,12 +426,26 @@ void ColorBuffer::subUpdate(int x, int y, int width, int height,
 }
 
 bool ColorBuffer::blitFromCurrentReadBuffer() {
+  if (!makeResident()) {
+    return false;
+  }
+
   RenderThreadInfo* tInfo = RenderThreadInfo::get();
   if (!tInfo->currContext.Ptr()) {
     // no Current context
     return false;
   }
 
+  if (blitFramebufferFromCurrentReadBuffer()) {
+    anbox::graphics::BufferStatistics::get()->surface_flushed(true);
+    return true;
+  }
+  anbox::graphics::BufferStatistics::get()->surface_flushed(false);
+
+  if (!m_blitTex && !createBlitResources()) {
+    return false;
+  }
+
   // Copy the content of the current read surface into m_blitEGLImage.
   // This is done by creating a temporary texture, bind it to the EGLImage
   // then call glCopyTexSubImage2D().
@@ -307,10 +497,80 @@ bool ColorBuffer::blitFromCurrentReadBuffer() {
   return true;
 }
 
+bool ColorBuffer::blitFramebufferFromCurrentReadBuffer() {
+  RenderThreadInfo* tInfo = RenderThreadInfo::get();
+  if (!m_hasFramebufferBlit || !m_eglImage || !tInfo->currContext->isGL2()) {
+    return false;
+  }
+
+  GLint readFbo = 0, drawFbo = 0, currTexBind = 0;
+  s_gles2.glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFbo);
+  s_gles2.glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFbo);
+
+  // A multisampled surface can't be flipped while it is resolved. The
+  // sample count is only queryable for the draw framebuffer.
+  GLint sampleBuffers = 0;
+  s_gles2.glBindFramebuffer(GL_DRAW_FRAMEBUFFER, readFbo);
+  s_gles2.glGetIntegerv(GL_SAMPLE_BUFFERS, &sampleBuffers);
+  if (sampleBuffers > 0) {
+    s_gles2.glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFbo);
+    return false;
+  }
+
+  // The guest context doesn't share any objects with ours so it gets its
+  // own view of our texture through the EGLImage.
+  GLuint tmpTex = 0, tmpFbo = 0;
+  s_gles2.glGetIntegerv(GL_TEXTURE_BINDING_2D, &currTexBind);
+  s_gles2.glGenTextures(1, &tmpTex);
+  s_gles2.glBindTexture(GL_TEXTURE_2D, tmpTex);
+  s_gles2.glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, m_eglImage);
+
+  s_gles2.glGenFramebuffers(1, &tmpFbo);
+  s_gles2.glBindFramebuffer(GL_DRAW_FRAMEBUFFER, tmpFbo);
+  s_gles2.glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0_OES,
+                                 GL_TEXTURE_2D, tmpTex, 0);
+
+  const bool complete =
+      s_gles2.glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE_OES;
+  if (complete) {
+    // The scissor test is the only state of the guest which applies to
+    // blits.
+    const GLboolean scissorTest = s_gles2.glIsEnabled(GL_SCISSOR_TEST);
+    if (scissorTest) {
+      s_gles2.glDisable(GL_SCISSOR_TEST);
+    }
+
+    // Surfaces store their bottom row first, color buffers their top row.
+    s_gles2.glBlitFramebuffer(0, 0, m_width, m_height, 0, m_height, m_width, 0,
+                              GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+    if (scissorTest) {
+      s_gles2.glEnable(GL_SCISSOR_TEST);
+    }
+
+    // Other contexts only see the result once it is submitted.
+    s_gles2.glFlush();
+  }
+
+  s_gles2.glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFbo);
+  s_gles2.glDeleteFramebuffers(1, &tmpFbo);
+  s_gles2.glBindTexture(GL_TEXTURE_2D, currTexBind);
+  s_gles2.glDeleteTextures(1, &tmpTex);
+
+  return complete;
+}
+
 bool ColorBuffer::bindToTexture() {
+  if (!makeResident()) {
+    return false;
+  }
+
   if (!m_eglImage) {
     return false;
   }
+  // The guest texture shares the storage now which we can't move away
+  // anymore.
+  m_exported = true;
   RenderThreadInfo* tInfo = RenderThreadInfo::get();
   if (!tInfo->currContext.Ptr()) {
     return false;
@@ -324,9 +584,14 @@ bool ColorBuffer::bindToTexture() {
 }
 
 bool ColorBuffer::bindToRenderbuffer() {
+  if (!makeResident()) {
+    return false;
+  }
+
   if (!m_eglImage) {
     return false;
   }
+  m_exported = true;
   RenderThreadInfo* tInfo = RenderThreadInfo::get();
   if (!tInfo->currContext.Ptr()) {
     return false;
@@ -342,6 +607,10 @@ bool ColorBuffer::bindToRenderbuffer() {
 }
 
 void ColorBuffer::readback(unsigned char* img) {
+  if (!makeResident()) {
+    return;
+  }
+
   ScopedHelperContext context(m_helper);
   if (!context.isOk()) {
     return;
@@ -354,6 +623,13 @@ void ColorBuffer::readback(unsigned char* img) {
 }
 
 void ColorBuffer::bind() {
+  if (!makeResident()) {
+    return;
+  }
+
+  // Created with the context of the compositor which is the only one
+  // using it.
+  if (!m_resizer) m_resizer = new TextureResize(m_width, m_height);
   const auto id = m_resizer->update(m_tex);
   s_gles2.glBindTexture(GL_TEXTURE_2D, id);
 }
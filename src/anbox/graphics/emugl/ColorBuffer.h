@@ -21,7 +21,11 @@
 #include <GLES/gl.h>
 #include "emugl/common/smart_ptr.h"
 
+#include "anbox/graphics/memory_accounting.h"
+
+#include <chrono>
 #include <memory>
+#include <vector>
 
 class TextureDraw;
 class TextureResize;
@@ -65,8 +69,13 @@ class ColorBuffer {
     virtual bool setupContext() = 0;
     virtual void teardownContext() = 0;
     virtual TextureDraw* getTextureDraw() const = 0;
+    // Takes ownership of a resizer created by bind(). Its framebuffers
+    // belong to the compositor context, so it must be deleted there.
+    virtual void releaseResizer(TextureResize* resizer) = 0;
   };
 
+  typedef anbox::graphics::MemoryAccounting::Client Client;
+
   // Create a new ColorBuffer instance.
   // |p_display| is the host EGLDisplay handle.
   // |p_width| and |p_height| are the buffer's dimensions in pixels.
@@ -75,10 +84,20 @@ class ColorBuffer {
   // Implementation is free to use something else though.
   // |has_eglimage_texture_2d| should be true iff the display supports
   // the EGL_KHR_gl_texture_2D_image extension.
+  // |has_framebuffer_blit| should be true iff GLESv2 contexts of the display
+  // provide glBlitFramebuffer().
+  // |owner| is the client the memory of the buffer is accounted to. The
+  // caller is expected to have charged memoryUsageFor() to it already.
   // Returns NULL on failure.
   static ColorBuffer* create(EGLDisplay p_display, int p_width, int p_height,
                              GLenum p_internalFormat,
-                             bool has_eglimage_texture_2d, Helper* helper);
+                             bool has_eglimage_texture_2d,
+                             bool has_framebuffer_blit, Helper* helper,
+                             Client owner = anbox::graphics::MemoryAccounting::host);
+
+  // Return the GPU memory a new ColorBuffer of the given size and format
+  // takes.
+  static size_t memoryUsageFor(int p_width, int p_height, GLenum p_internalFormat);
 
   // Destructor.
   ~ColorBuffer();
@@ -87,6 +106,33 @@ class ColorBuffer {
   GLuint getWidth() const { return m_width; }
   GLuint getHeight() const { return m_height; }
 
+  // Return the internal format of the texture, either GL_RGB or GL_RGBA.
+  GLenum getInternalFormat() const { return m_internalFormat; }
+
+  // Return the estimated amount of GPU memory used by this instance in
+  // bytes. Grows once resources only needed by some buffers are allocated.
+  size_t getMemoryUsage() const { return m_memoryUsage; }
+
+  // Reset all pixels to transparent black, e.g. before the buffer is
+  // handed out again for a different guest buffer.
+  bool clear();
+
+  // Client the GPU memory of this buffer is accounted to. Changing it
+  // doesn't move any charges, that's up to the caller.
+  Client getOwner() const { return m_owner; }
+  void setOwner(Client owner);
+
+  // Move the content into system memory and release all GPU resources.
+  // The buffer is brought back transparently on its next use. Not possible
+  // once the guest bound a texture or renderbuffer to it as those share
+  // the storage with us.
+  bool evict();
+  bool canEvict() const { return !m_evicted && !m_exported; }
+  bool isResident() const { return !m_evicted; }
+  // Whether a guest texture or renderbuffer shares the storage.
+  bool isExported() const { return m_exported; }
+  std::chrono::steady_clock::time_point getLastUse() const { return m_lastUse; }
+
   // Read the ColorBuffer instance's pixel values into host memory.
   void readPixels(int x, int y, int width, int height, GLenum p_format,
                   GLenum p_type, void* pixels);
@@ -108,6 +154,9 @@ class ColorBuffer {
   // Copy the content of the current context's read surface to this
   // ColorBuffer. This is used from WindowSurface::flushColorBuffer().
   // Return true on success, false on failure (e.g. no current context).
+  // Where possible the surface is blitted straight into the buffer from
+  // the current context, otherwise it is copied into a separate texture
+  // first which is then drawn into the buffer from the helper context.
   bool blitFromCurrentReadBuffer();
 
   // Read the content of the whole ColorBuffer as 32-bit RGBA pixels.
@@ -121,6 +170,12 @@ class ColorBuffer {
 
   explicit ColorBuffer(EGLDisplay display, Helper* helper);
 
+  void createTexture(const void* pixels);
+  void destroyResources();
+  bool createBlitResources();
+  bool blitFramebufferFromCurrentReadBuffer();
+  bool makeResident();
+
  private:
   GLuint m_tex;
   GLuint m_blitTex;
@@ -130,6 +185,15 @@ class ColorBuffer {
   GLuint m_height;
   GLuint m_fbo;
   GLenum m_internalFormat;
+  bool m_hasEglImage;
+  bool m_hasFramebufferBlit;
+  size_t m_memoryUsage;
+  Client m_owner;
+  bool m_evicted;
+  bool m_exported;
+  std::chrono::steady_clock::time_point m_lastUse;
+  // Content while evicted, always RGBA
+  std::vector<uint8_t> m_backing;
   EGLDisplay m_display;
   Helper* m_helper;
   TextureResize* m_resizer;
@@ -21,6 +21,7 @@
 #include "anbox/logger.h"
 
 ReadBuffer::ReadBuffer(size_t bufsize) {
+  m_initialSize = bufsize;
   m_size = bufsize;
   m_buf = static_cast<unsigned char*>(malloc(m_size * sizeof(unsigned char)));
   m_validData = 0;
@@ -66,3 +67,15 @@ void ReadBuffer::consume(size_t amount) {
   m_validData -= amount;
   m_readPtr += amount;
 }
+
+void ReadBuffer::reset() {
+  m_validData = 0;
+  if (m_size > m_initialSize) {
+    auto new_buf = static_cast<unsigned char*>(realloc(m_buf, m_initialSize));
+    if (new_buf) {
+      m_buf = new_buf;
+      m_size = m_initialSize;
+    }
+  }
+  m_readPtr = m_buf;
+}
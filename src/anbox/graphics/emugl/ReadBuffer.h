@@ -28,9 +28,11 @@ class ReadBuffer {
     return m_validData;
   }                             // return the amount of valid data in readptr
   void consume(size_t amount);  // notify that 'amount' data has been consumed;
+  void reset();  // drop any data left and shrink back to the initial size
  private:
   unsigned char *m_buf;
   unsigned char *m_readPtr;
+  size_t m_initialSize;
   size_t m_size;
   size_t m_validData;
 };
@@ -24,9 +24,12 @@
 
 #include "OpenGLESDispatch/EGLDispatch.h"
 
+#include "anbox/common/boot_timeline.h"
 #include "anbox/graphics/layer_composer.h"
+#include "anbox/graphics/layer_registry.h"
 #include "anbox/logger.h"
 
+#include <atomic>
 #include <map>
 #include <string>
 
@@ -385,34 +388,47 @@ int rcGetDisplayVsyncPeriod(uint32_t display_id) {
 
 static std::vector<Renderable> frame_layers;
 
-bool is_layer_blacklisted(const std::string &name) {
-  static std::vector<std::string> blacklist = {
-      // The 'Sprite' layer is the mouse cursor Android uses as soon
-      // as it has a pointer input device available. We don't want to
-      // display this layer at all but don't have a good way of disabling
-      // the cursor on the Android side yet.
-      "Sprite",
-  };
-  return std::find(blacklist.begin(), blacklist.end(), name) != blacklist.end();
-}
-
 void rcPostLayer(const char *name, uint32_t color_buffer,
                  int32_t sourceCropLeft, int32_t sourceCropTop,
                  int32_t sourceCropRight, int32_t sourceCropBottom,
                  int32_t displayFrameLeft, int32_t displayFrameTop,
                  int32_t displayFrameRight, int32_t displayFrameBottom) {
-  Renderable r{
-      name,
+  // Layer names are interned so that the strategies don't need to parse
+  // them again for every single frame.
+  frame_layers.emplace_back(
+      anbox::graphics::LayerRegistry::get()->intern(name),
       color_buffer,
-      {displayFrameLeft, displayFrameTop, displayFrameRight, displayFrameBottom},
-      {sourceCropLeft, sourceCropTop, sourceCropRight, sourceCropBottom}};
-  frame_layers.push_back(r);
+      anbox::graphics::Rect{displayFrameLeft, displayFrameTop, displayFrameRight, displayFrameBottom},
+      anbox::graphics::Rect{sourceCropLeft, sourceCropTop, sourceCropRight, sourceCropBottom});
+}
+
+// Records the first frame and the first one after Android finished booting
+// in the boot timeline. Returns true once there is nothing left to record.
+static bool record_boot_frame() {
+  auto timeline = anbox::common::BootTimeline::get();
+  if (!timeline->enabled()) return true;
+
+  timeline->mark_once("first-frame");
+  if (!timeline->reached("boot-finished")) return false;
+  timeline->mark_once("first-frame-after-boot");
+  return true;
 }
 
 void rcPostAllLayersDone() {
-  if (composer) composer->submit_layers(frame_layers);
+  // The render thread holds back the compositor once it released the
+  // decoder lock
+  if (composer) {
+    auto tInfo = RenderThreadInfo::get();
+    const auto hold_back_until = composer->submit_layers(frame_layers);
+    if (tInfo) tInfo->m_holdBackUntil = hold_back_until;
+  }
 
   frame_layers.clear();
+
+  // Several render threads post frames at the same time
+  static std::atomic<bool> boot_frames_recorded{false};
+  if (!boot_frames_recorded.load(std::memory_order_relaxed) && record_boot_frame())
+    boot_frames_recorded = true;
 }
 
 void initRenderControlContext(renderControl_decoder_context_t *dec) {
@@ -26,27 +26,48 @@
 #include "OpenGLESDispatch/GLESv1Dispatch.h"
 #include "OpenGLESDispatch/GLESv2Dispatch.h"
 
+#include "anbox/common/tracer.h"
+#include "anbox/graphics/memory_accounting.h"
 #include "anbox/logger.h"
 
+#include <chrono>
+#include <thread>
+
 #define STREAM_BUFFER_SIZE 4 * 1024 * 1024
 
-RenderThread::RenderThread(const std::shared_ptr<Renderer> &renderer, IOStream *stream, emugl::Mutex *lock)
-    : emugl::Thread(), renderer_(renderer), m_lock(lock), m_stream(stream) {}
+RenderThread::RenderThread()
+    : emugl::Thread(), m_lock(NULL), m_stream(NULL), m_exit(false) {}
+
+RenderThread::~RenderThread() {}
+
+void RenderThread::serve(const std::shared_ptr<Renderer> &renderer, IOStream *stream, emugl::Mutex *lock) {
+  emugl::Mutex::AutoLock l(m_stateLock);
+  renderer_ = renderer;
+  m_lock = lock;
+  m_stream = stream;
+  m_work.signal();
+}
 
-RenderThread::~RenderThread() {
-  forceStop();
+void RenderThread::forceStop() {
+  emugl::Mutex::AutoLock l(m_stateLock);
+  if (m_stream) m_stream->forceStop();
 }
 
-RenderThread *RenderThread::create(const std::shared_ptr<Renderer> &renderer, IOStream *stream, emugl::Mutex *lock) {
-  return new RenderThread(renderer, stream, lock);
+void RenderThread::waitIdle() {
+  emugl::Mutex::AutoLock l(m_stateLock);
+  while (m_stream) m_idle.wait(&m_stateLock);
 }
 
-void RenderThread::forceStop() { m_stream->forceStop(); }
+void RenderThread::exit() {
+  emugl::Mutex::AutoLock l(m_stateLock);
+  m_exit = true;
+  m_work.signal();
+}
 
 intptr_t RenderThread::main() {
+  // Resolving the GL entry points of the decoders and allocating the read
+  // buffer is only done once for all the clients the thread serves.
   RenderThreadInfo threadInfo;
-  ChecksumCalculatorThreadInfo threadChecksumInfo;
-
   threadInfo.m_glDec.initGL(gles1_dispatch_get_proc_func, NULL);
   threadInfo.m_gl2Dec.initGL(gles2_dispatch_get_proc_func, NULL);
   initRenderControlContext(&threadInfo.m_rcDec);
@@ -54,47 +75,158 @@ intptr_t RenderThread::main() {
   ReadBuffer readBuf(STREAM_BUFFER_SIZE);
 
   while (true) {
-    int stat = readBuf.getData(m_stream);
-    if (stat <= 0)
-      break;
-
-    bool progress;
-    do {
-      progress = false;
-
-      m_lock->lock();
-      size_t last =
-          threadInfo.m_glDec.decode(readBuf.buf(), readBuf.validData(), m_stream);
-      if (last > 0) {
-        progress = true;
-        readBuf.consume(last);
-      }
-
-      last =
-          threadInfo.m_gl2Dec.decode(readBuf.buf(), readBuf.validData(), m_stream);
-      if (last > 0) {
-        progress = true;
-        readBuf.consume(last);
-      }
-
-      last = threadInfo.m_rcDec.decode(readBuf.buf(), readBuf.validData(), m_stream);
-      if (last > 0) {
-        readBuf.consume(last);
-        progress = true;
-      }
-
-      m_lock->unlock();
-
-    } while (progress);
+    std::shared_ptr<Renderer> renderer;
+    emugl::Mutex *lock = NULL;
+    IOStream *stream = NULL;
+    {
+      emugl::Mutex::AutoLock l(m_stateLock);
+      while (!m_stream && !m_exit) m_work.wait(&m_stateLock);
+      if (!m_stream) break;
+      renderer = renderer_;
+      lock = m_lock;
+      stream = m_stream;
+    }
+
+    ChecksumCalculatorThreadInfo threadChecksumInfo;
+    auto accounting = anbox::graphics::MemoryAccounting::get();
+    threadInfo.m_client = accounting->register_client();
+    threadInfo.m_holdBackUntil = std::chrono::steady_clock::time_point{};
+    readBuf.reset();
+
+    while (true) {
+      int stat = readBuf.getData(stream);
+      if (stat <= 0)
+        break;
+
+      bool progress;
+      do {
+        ANBOX_TRACE_SCOPE("gl", "RenderThread::decode");
+        progress = false;
+
+        lock->lock();
+        size_t last =
+            threadInfo.m_glDec.decode(readBuf.buf(), readBuf.validData(), stream);
+        if (last > 0) {
+          progress = true;
+          readBuf.consume(last);
+        }
+
+        last =
+            threadInfo.m_gl2Dec.decode(readBuf.buf(), readBuf.validData(), stream);
+        if (last > 0) {
+          progress = true;
+          readBuf.consume(last);
+        }
+
+        last = threadInfo.m_rcDec.decode(readBuf.buf(), readBuf.validData(), stream);
+        if (last > 0) {
+          readBuf.consume(last);
+          progress = true;
+        }
+
+        lock->unlock();
+
+        if (threadInfo.m_holdBackUntil > std::chrono::steady_clock::now()) {
+          ANBOX_TRACE_SCOPE("gl", "RenderThread::holdBack");
+          std::this_thread::sleep_until(threadInfo.m_holdBackUntil);
+        }
+      } while (progress);
+    }
+
+    // Release references to the current thread's context/surfaces if any
+    renderer->bindContext(0, 0, 0);
+    if (threadInfo.currContext || threadInfo.currDrawSurf || threadInfo.currReadSurf)
+      ERROR("RenderThread exiting with current context/surfaces");
+
+    renderer->drainWindowSurface();
+    renderer->drainRenderContext();
+
+    accounting->unregister_client(threadInfo.m_client);
+    threadInfo.m_client = anbox::graphics::MemoryAccounting::host;
+
+    emugl::Mutex::AutoLock l(m_stateLock);
+    renderer_.reset();
+    m_lock = NULL;
+    m_stream = NULL;
+    m_idle.signal();
   }
 
-  // Release references to the current thread's context/surfaces if any
-  renderer_->bindContext(0, 0, 0);
-  if (threadInfo.currContext || threadInfo.currDrawSurf || threadInfo.currReadSurf)
-    ERROR("RenderThread exiting with current context/surfaces");
+  return 0;
+}
 
-  renderer_->drainWindowSurface();
-  renderer_->drainRenderContext();
+constexpr const std::size_t RenderThreadPool::default_max_idle_threads;
 
-  return 0;
+RenderThreadPool::RenderThreadPool(std::size_t max_idle_threads)
+    : m_maxIdleThreads(max_idle_threads),
+      m_threadsCreated(0),
+      m_threadsReused(0) {}
+
+RenderThreadPool::~RenderThreadPool() {
+  // Threads still serving a client keep the pool alive, so only idle ones
+  // are left here.
+  for (auto thread : m_idleThreads) {
+    thread->exit();
+    thread->wait(NULL);
+    delete thread;
+  }
+}
+
+std::shared_ptr<RenderThread> RenderThreadPool::acquire(const std::shared_ptr<Renderer> &renderer,
+                                                        IOStream *stream, emugl::Mutex *mutex) {
+  RenderThread *thread = NULL;
+  {
+    emugl::Mutex::AutoLock l(m_lock);
+    if (!m_idleThreads.empty()) {
+      thread = m_idleThreads.back();
+      m_idleThreads.pop_back();
+      m_threadsReused++;
+    }
+  }
+
+  if (!thread) {
+    thread = new RenderThread();
+    if (!thread->start()) {
+      delete thread;
+      return nullptr;
+    }
+    emugl::Mutex::AutoLock l(m_lock);
+    m_threadsCreated++;
+  }
+
+  thread->serve(renderer, stream, mutex);
+
+  auto self = shared_from_this();
+  return std::shared_ptr<RenderThread>(thread, [self](RenderThread *t) { self->release(t); });
+}
+
+void RenderThreadPool::release(RenderThread *thread) {
+  thread->forceStop();
+  thread->waitIdle();
+
+  {
+    emugl::Mutex::AutoLock l(m_lock);
+    if (m_idleThreads.size() < m_maxIdleThreads) {
+      m_idleThreads.push_back(thread);
+      return;
+    }
+  }
+
+  thread->exit();
+  thread->wait(NULL);
+  delete thread;
+}
+
+std::size_t RenderThreadPool::idleThreads() {
+  emugl::Mutex::AutoLock l(m_lock);
+  return m_idleThreads.size();
+}
+
+std::uint64_t RenderThreadPool::threadsCreated() {
+  emugl::Mutex::AutoLock l(m_lock);
+  return m_threadsCreated;
+}
+
+std::uint64_t RenderThreadPool::threadsReused() {
+  emugl::Mutex::AutoLock l(m_lock);
+  return m_threadsReused;
 }
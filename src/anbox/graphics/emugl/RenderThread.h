@@ -18,26 +18,22 @@
 
 #include "IOStream.h"
 
+#include "emugl/common/condition_variable.h"
 #include "emugl/common/mutex.h"
 #include "emugl/common/thread.h"
 
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 class Renderer;
+class RenderThreadPool;
 
 // A class used to model a thread of the RenderServer. Each one of them
-// handles a single guest client / protocol byte stream.
+// handles a single guest client / protocol byte stream at a time and
+// goes back to the RenderThreadPool it came from once the client is gone.
 class RenderThread : public emugl::Thread {
  public:
-  // Create a new RenderThread instance.
-  // |stream| is an input stream that will be read from the thread,
-  // and deleted by it when it exits.
-  // |mutex| is a pointer to a shared mutex used to serialize
-  // decoding operations between all threads.
-  // TODO(digit): Why is this needed here? Shouldn't this be handled
-  //              by the decoders themselves or at a lower-level?
-  static RenderThread* create(const std::shared_ptr<Renderer>& renderer, IOStream* stream, emugl::Mutex* mutex);
-
   // Destructor.
   virtual ~RenderThread();
 
@@ -45,19 +41,70 @@ class RenderThread : public emugl::Thread {
   // Note that this also means that the thread's stack has been
   bool isFinished() { return tryWait(NULL); }
 
-  // Force a thread to stop.
+  // Force the thread to stop serving its current stream.
   void forceStop();
 
  private:
-  RenderThread();  // No default constructor
+  friend class RenderThreadPool;
 
-  RenderThread(const std::shared_ptr<Renderer>& renderer, IOStream* stream, emugl::Mutex* mutex);
+  RenderThread();
+
+  // Serve |stream| until it ends. |mutex| is a pointer to a shared mutex
+  // used to serialize decoding operations between all threads.
+  // TODO(digit): Why is this needed here? Shouldn't this be handled
+  //              by the decoders themselves or at a lower-level?
+  void serve(const std::shared_ptr<Renderer>& renderer, IOStream* stream,
+             emugl::Mutex* mutex);
+
+  // Block until the thread is done with its current stream.
+  void waitIdle();
+
+  // Let the thread exit once it is idle.
+  void exit();
 
   virtual intptr_t main();
 
+  emugl::Mutex m_stateLock;
+  emugl::ConditionVariable m_work;
+  emugl::ConditionVariable m_idle;
   std::shared_ptr<Renderer> renderer_;
   emugl::Mutex* m_lock;
   IOStream* m_stream;
+  bool m_exit;
+};
+
+// RenderThreadPool keeps the threads of guest clients which are gone around,
+// together with their decoders and read buffer which are already set up, so
+// that the next clients can start right away. Android opens and closes many
+// connections, e.g. whenever a process initializes EGL.
+class RenderThreadPool : public std::enable_shared_from_this<RenderThreadPool> {
+ public:
+  static constexpr const std::size_t default_max_idle_threads{4};
+
+  // At most |max_idle_threads| threads are kept around while no client uses
+  // them.
+  explicit RenderThreadPool(std::size_t max_idle_threads = default_max_idle_threads);
+  ~RenderThreadPool();
+
+  // Serve |stream| from an idle thread or a new one if there is none. Once
+  // the last reference to the returned thread is gone it stops serving the
+  // stream and goes back to the pool. Returns NULL if no thread could be
+  // started.
+  std::shared_ptr<RenderThread> acquire(const std::shared_ptr<Renderer>& renderer,
+                                        IOStream* stream, emugl::Mutex* mutex);
+
+  std::size_t idleThreads();
+  std::uint64_t threadsCreated();
+  std::uint64_t threadsReused();
+
+ private:
+  void release(RenderThread* thread);
+
+  emugl::Mutex m_lock;
+  std::size_t m_maxIdleThreads;
+  std::vector<RenderThread*> m_idleThreads;
+  std::uint64_t m_threadsCreated;
+  std::uint64_t m_threadsReused;
 };
 
 #endif
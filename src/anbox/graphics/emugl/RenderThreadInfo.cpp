@@ -19,6 +19,8 @@
 #include "emugl/common/lazy_instance.h"
 #include "emugl/common/thread_store.h"
 
+#include "anbox/graphics/memory_accounting.h"
+
 namespace {
 class ThreadInfoStore : public ::emugl::ThreadStore {
  public:
@@ -28,9 +30,14 @@ class ThreadInfoStore : public ::emugl::ThreadStore {
 
 static ::emugl::LazyInstance<ThreadInfoStore> s_tls = LAZY_INSTANCE_INIT;
 
-RenderThreadInfo::RenderThreadInfo() { s_tls->set(this); }
+RenderThreadInfo::RenderThreadInfo()
+    : m_client(anbox::graphics::MemoryAccounting::host) {
+  s_tls->set(this);
+}
 
-RenderThreadInfo::~RenderThreadInfo() { s_tls->set(NULL); }
+RenderThreadInfo::~RenderThreadInfo() {
+  s_tls->set(NULL);
+}
 
 RenderThreadInfo* RenderThreadInfo::get() {
   return static_cast<RenderThreadInfo*>(s_tls->get());
@@ -22,6 +22,7 @@
 #include "WindowSurface.h"
 #include "renderControl_dec.h"
 
+#include <chrono>
 #include <set>
 
 typedef uint32_t HandleType;
@@ -55,6 +56,14 @@ struct RenderThreadInfo {
   ThreadContextSet m_contextSet;
   // all the window surfaces that are created by this render thread
   WindowSurfaceSet m_windowSet;
+
+  // GPU memory of everything created by this render thread is accounted
+  // to this client
+  ColorBuffer::Client m_client;
+
+  // The thread stops decoding the client's commands until then, without
+  // holding the decoder lock.
+  std::chrono::steady_clock::time_point m_holdBackUntil;
 };
 
 #endif
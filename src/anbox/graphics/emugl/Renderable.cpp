@@ -16,11 +16,19 @@
 
 #include "Renderable.h"
 
-Renderable::Renderable(const std::string &name, const std::uint32_t &buffer,
+Renderable::Renderable(const char *name, const std::uint32_t &buffer,
                        const anbox::graphics::Rect &screen_position,
                        const anbox::graphics::Rect &crop,
                        const glm::mat4 &transformation, const float &alpha)
-    : name_(name),
+    : Renderable(anbox::graphics::LayerRegistry::get()->intern(name), buffer,
+                 screen_position, crop, transformation, alpha) {}
+
+Renderable::Renderable(const anbox::graphics::LayerRegistry::Info &layer,
+                       const std::uint32_t &buffer,
+                       const anbox::graphics::Rect &screen_position,
+                       const anbox::graphics::Rect &crop,
+                       const glm::mat4 &transformation, const float &alpha)
+    : layer_(layer),
       buffer_(buffer),
       screen_position_(screen_position),
       crop_(crop),
@@ -29,7 +37,9 @@ Renderable::Renderable(const std::string &name, const std::uint32_t &buffer,
 
 Renderable::~Renderable() {}
 
-std::string Renderable::name() const { return name_; }
+std::string Renderable::name() const {
+  return anbox::graphics::LayerRegistry::get()->name_of(layer_.id);
+}
 
 std::uint32_t Renderable::buffer() const { return buffer_; }
 
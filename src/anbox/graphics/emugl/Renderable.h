@@ -17,6 +17,7 @@
 #ifndef ANBOX_GRAPHICS_EMUGL_RENDERABLE_H_
 #define ANBOX_GRAPHICS_EMUGL_RENDERABLE_H_
 
+#include "anbox/graphics/layer_registry.h"
 #include "anbox/graphics/rect.h"
 
 #include <string>
@@ -28,13 +29,19 @@
 
 class Renderable {
  public:
-  Renderable(const std::string &name, const std::uint32_t &buffer,
+  Renderable(const char *name, const std::uint32_t &buffer,
+             const anbox::graphics::Rect &screen_position,
+             const anbox::graphics::Rect &crop = {},
+             const glm::mat4 &transformation = {}, const float &alpha = 1.0f);
+  Renderable(const anbox::graphics::LayerRegistry::Info &layer,
+             const std::uint32_t &buffer,
              const anbox::graphics::Rect &screen_position,
              const anbox::graphics::Rect &crop = {},
              const glm::mat4 &transformation = {}, const float &alpha = 1.0f);
   ~Renderable();
 
   std::string name() const;
+  const anbox::graphics::LayerRegistry::Info &layer() const { return layer_; }
   std::uint32_t buffer() const;
   anbox::graphics::Rect screen_position() const;
   anbox::graphics::Rect crop() const;
@@ -44,7 +51,7 @@ class Renderable {
   void set_screen_position(const anbox::graphics::Rect &screen_position);
 
   inline bool operator==(const Renderable &rhs) const {
-    return (name_ == rhs.name() && buffer_ == rhs.buffer() &&
+    return (layer_.id == rhs.layer().id && buffer_ == rhs.buffer() &&
             screen_position_ == rhs.screen_position() && crop_ == rhs.crop() &&
             transformation_ == rhs.transformation() && alpha_ == rhs.alpha());
   }
@@ -54,7 +61,7 @@ class Renderable {
   }
 
  private:
-  std::string name_;
+  anbox::graphics::LayerRegistry::Info layer_;
   std::uint32_t buffer_;
   anbox::graphics::Rect screen_position_;
   anbox::graphics::Rect crop_;
@@ -18,22 +18,64 @@
 
 #include "DispatchTables.h"
 #include "RenderThreadInfo.h"
+#include "TextureResize.h"
 #include "TimeUtils.h"
 #include "gles2_dec.h"
 
 #include "OpenGLESDispatch/EGLDispatch.h"
 
+#include "anbox/common/tracer.h"
+#include "anbox/graphics/buffer_statistics.h"
+#include "anbox/graphics/composition_statistics.h"
 #include "anbox/graphics/gl_extensions.h"
+#include "anbox/graphics/memory_accounting.h"
 
 #include "anbox/logger.h"
 
 #include <stdio.h>
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/transform.hpp>
 
 namespace {
+// Color buffers released by the guest are kept around up to this size to
+// be reused when apps reallocate their buffers, e.g. while a window is
+// resized or rotated.
+constexpr const std::size_t colorBufferPoolBudget{32 * 1024 * 1024};
+
+// Client GPU memory allocated from the calling thread is accounted to.
+ColorBuffer::Client currentClient() {
+  RenderThreadInfo *tinfo = RenderThreadInfo::get();
+  return tinfo ? tinfo->m_client : anbox::graphics::MemoryAccounting::host;
+}
+
+struct ContextState {
+  EGLContext context;
+  EGLSurface draw;
+  EGLSurface read;
+
+  bool operator==(const ContextState &other) const {
+    return context == other.context && draw == other.draw && read == other.read;
+  }
+};
+
+// Context the calling thread had current before each nested bind of one of
+// our own contexts, innermost last. As long as it isn't empty t_current
+// tracks what is current on the thread so that we neither have to ask EGL
+// for it nor make current what already is.
+thread_local std::vector<ContextState> t_saved;
+thread_local ContextState t_current{EGL_NO_CONTEXT, EGL_NO_SURFACE, EGL_NO_SURFACE};
+// Set while the thread composes all windows in a row
+thread_local bool t_composing = false;
+thread_local std::uint64_t t_make_current_calls = 0;
+thread_local std::uint64_t t_make_current_skipped = 0;
+thread_local std::uint64_t t_composition_calls = 0;
+thread_local std::uint64_t t_composition_skipped = 0;
 
 // Helper class to call the bind_locked() / unbind_locked() properly.
 class ScopedBind {
@@ -77,6 +119,10 @@ class ColorBufferHelper : public ColorBuffer::Helper {
 
   virtual TextureDraw *getTextureDraw() const { return mFb->getTextureDraw(); }
 
+  virtual void releaseResizer(TextureResize *resizer) {
+    mFb->releaseResizer(resizer);
+  }
+
  private:
   Renderer *mFb;
 };
@@ -86,15 +132,20 @@ HandleType Renderer::s_nextHandle = 0;
 
 void Renderer::finalize() {
   m_colorbuffers.clear();
+  m_colorBufferPool.clear();
   m_windows.clear();
   m_contexts.clear();
+  if (saveAndMakeCurrent(m_pbufSurface, m_pbufSurface, m_eglContext)) {
+    destroyReleasedResizers();
+    restoreContext();
+  }
   s_egl.eglMakeCurrent(m_eglDisplay, NULL, NULL, NULL);
   s_egl.eglDestroyContext(m_eglDisplay, m_eglContext);
   s_egl.eglDestroyContext(m_eglDisplay, m_pbufContext);
   s_egl.eglDestroySurface(m_eglDisplay, m_pbufSurface);
 }
 
-bool Renderer::initialize(EGLNativeDisplayType nativeDisplay) {
+bool Renderer::initialize(EGLNativeDisplayType nativeDisplay, bool offscreen) {
   m_eglDisplay = s_egl.eglGetDisplay(nativeDisplay);
   if (m_eglDisplay == EGL_NO_DISPLAY) {
     ERROR("Failed to Initialize backend EGL display");
@@ -115,7 +166,9 @@ bool Renderer::initialize(EGLNativeDisplayType nativeDisplay) {
   s_egl.eglBindAPI(EGL_OPENGL_ES_API);
 
   // Create EGL context for framebuffer post rendering.
-  GLint surfaceType = EGL_WINDOW_BIT | EGL_PBUFFER_BIT;
+  // Offscreen platforms (e.g. Mesa's surfaceless one) don't offer any
+  // configs for window surfaces.
+  GLint surfaceType = offscreen ? EGL_PBUFFER_BIT : EGL_WINDOW_BIT | EGL_PBUFFER_BIT;
   const GLint configAttribs[] = {EGL_RED_SIZE, 1,
                                  EGL_GREEN_SIZE, 1,
                                  EGL_BLUE_SIZE, 1,
@@ -234,6 +287,16 @@ bool Renderer::initialize(EGLNativeDisplayType nativeDisplay) {
   m_glRenderer = reinterpret_cast<const char *>(s_gles2.glGetString(GL_RENDERER));
   m_glVersion = reinterpret_cast<const char *>(s_gles2.glGetString(GL_VERSION));
 
+  // Guest GLESv2 contexts are created just like ours, so the version we got
+  // tells what they will support. Setting ANBOX_NO_FRAMEBUFFER_BLIT forces
+  // the slower copy through the helper context for window surfaces.
+  m_caps.has_framebuffer_blit =
+      s_gles2.glBlitFramebuffer != nullptr && m_glVersion != nullptr &&
+      std::string(m_glVersion).find("OpenGL ES 3") == 0 &&
+      getenv("ANBOX_NO_FRAMEBUFFER_BLIT") == nullptr;
+  DEBUG("Framebuffer blits for window surfaces %s",
+        m_caps.has_framebuffer_blit ? "enabled" : "disabled");
+
   m_textureDraw = new TextureDraw(m_eglDisplay);
   if (!m_textureDraw) {
     ERROR("Failed: creation of TextureDraw instance");
@@ -269,11 +332,9 @@ Renderer::Renderer()
     : m_configs(NULL),
       m_eglDisplay(EGL_NO_DISPLAY),
       m_colorBufferHelper(new ColorBufferHelper(this)),
+      m_colorBufferPool(colorBufferPoolBudget),
       m_eglContext(EGL_NO_CONTEXT),
       m_pbufContext(EGL_NO_CONTEXT),
-      m_prevContext(EGL_NO_CONTEXT),
-      m_prevReadSurf(EGL_NO_SURFACE),
-      m_prevDrawSurf(EGL_NO_SURFACE),
       m_textureDraw(NULL),
       m_lastPostedColorBuffer(0),
       m_statsNumFrames(0),
@@ -293,6 +354,10 @@ Renderer::~Renderer() {
 struct RendererWindow {
   EGLNativeWindowType native_window = 0;
   EGLSurface surface = EGL_NO_SURFACE;
+  // Only set for offscreen windows
+  anbox::graphics::FrameSink *sink = nullptr;
+  int width = 0;
+  int height = 0;
   anbox::graphics::Rect viewport;
   glm::mat4 screen_to_gl_coords;
   glm::mat4 display_transform;
@@ -332,12 +397,66 @@ RendererWindow *Renderer::createNativeWindow(
   return window;
 }
 
+RendererWindow *Renderer::createOffscreenWindow(
+    EGLNativeWindowType id, int width, int height,
+    anbox::graphics::FrameSink *sink) {
+  emugl::Mutex::AutoLock mutex(m_lock);
+
+  auto window = new RendererWindow;
+  window->native_window = id;
+  window->sink = sink;
+  // glReadPixels returns the bottom row first so we compose the window
+  // upside down to hand out the rows in the order everyone else expects.
+  window->display_transform =
+      glm::scale(glm::mat4(1.0f), glm::vec3{1.0f, -1.0f, 1.0f});
+
+  if (!resizeOffscreenWindow_locked(window, width, height)) {
+    delete window;
+    return nullptr;
+  }
+
+  m_nativeWindows.insert({id, window});
+  return window;
+}
+
+bool Renderer::resizeOffscreenWindow_locked(RendererWindow *window, int width,
+                                            int height) {
+  if (window->surface != EGL_NO_SURFACE)
+    s_egl.eglDestroySurface(m_eglDisplay, window->surface);
+
+  const EGLint attribs[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+  window->surface = s_egl.eglCreatePbufferSurface(m_eglDisplay, m_eglConfig, attribs);
+  if (window->surface == EGL_NO_SURFACE) {
+    ERROR("Failed to create %dx%d pbuffer for offscreen window: error=0x%x",
+          width, height, s_egl.eglGetError());
+    return false;
+  }
+
+  window->width = width;
+  window->height = height;
+  return true;
+}
+
+void Renderer::readOffscreenWindow(RendererWindow *window) {
+  ANBOX_TRACE_SCOPE("gl", "Renderer::readOffscreenWindow");
+  const auto width = static_cast<std::uint32_t>(window->width);
+  const auto height = static_cast<std::uint32_t>(window->height);
+
+  auto pixels = window->sink->begin_frame(width, height);
+  if (!pixels) return;
+
+  s_gles2.glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  s_gles2.glReadPixels(0, 0, window->width, window->height, GL_RGBA,
+                       GL_UNSIGNED_BYTE, pixels);
+  window->sink->end_frame(width, height);
+}
+
 void Renderer::destroyNativeWindow(EGLNativeWindowType native_window) {
+  emugl::Mutex::AutoLock mutex(m_lock);
+
   auto w = m_nativeWindows.find(native_window);
   if (w == m_nativeWindows.end()) return;
 
-  m_lock.lock();
-
   s_egl.eglMakeCurrent(m_eglDisplay, nullptr, nullptr, nullptr);
 
   if (w->second->surface != EGL_NO_SURFACE)
@@ -345,8 +464,6 @@ void Renderer::destroyNativeWindow(EGLNativeWindowType native_window) {
 
   delete w->second;
   m_nativeWindows.erase(w);
-
-  m_lock.unlock();
 }
 
 HandleType Renderer::genHandle() {
@@ -364,9 +481,35 @@ HandleType Renderer::createColorBuffer(int p_width, int p_height,
   emugl::Mutex::AutoLock mutex(m_lock);
   HandleType ret = 0;
 
-  ColorBufferPtr cb(ColorBuffer::create(
-      getDisplay(), p_width, p_height, p_internalFormat,
-      getCaps().has_eglimage_texture_2d, m_colorBufferHelper));
+  auto accounting = anbox::graphics::MemoryAccounting::get();
+  const auto client = currentClient();
+  const auto memoryUsage = ColorBuffer::memoryUsageFor(p_width, p_height, p_internalFormat);
+  if (!accounting->charge(client, memoryUsage)) {
+    return ret;
+  }
+  enforceSoftBudget_locked(client);
+
+  ColorBufferPtr cb;
+  const auto key = colorBufferPoolKey(p_width, p_height, p_internalFormat);
+  if (m_colorBufferPool.acquire(key, cb) && cb->clear()) {
+    anbox::graphics::BufferStatistics::get()->pool_hit();
+    // Pooled buffers may carry blit resources on top of the texture.
+    accounting->force_charge(client, cb->getMemoryUsage() - memoryUsage);
+    accounting->credit(cb->getOwner(), cb->getMemoryUsage());
+    cb->setOwner(client);
+  } else {
+    anbox::graphics::BufferStatistics::get()->pool_miss();
+    cb = ColorBufferPtr(ColorBuffer::create(
+        getDisplay(), p_width, p_height, p_internalFormat,
+        getCaps().has_eglimage_texture_2d, getCaps().has_framebuffer_blit,
+        m_colorBufferHelper, client));
+    if (cb.Ptr() == NULL) {
+      accounting->credit(client, memoryUsage);
+    }
+  }
+  anbox::graphics::BufferStatistics::get()->set_pooled(
+      m_colorBufferPool.count(), m_colorBufferPool.size());
+
   if (cb.Ptr() != NULL) {
     ret = genHandle();
     m_colorbuffers[ret].cb = cb;
@@ -419,7 +562,7 @@ HandleType Renderer::createWindowSurface(int p_config, int p_width,
   }
 
   WindowSurfacePtr win(WindowSurface::create(
-      getDisplay(), config->getEglConfig(), p_width, p_height));
+      getDisplay(), config->getEglConfig(), p_width, p_height, currentClient()));
   if (win.Ptr() != NULL) {
     ret = genHandle();
     m_windows[ret] = std::pair<WindowSurfacePtr, HandleType>(win, 0);
@@ -455,7 +598,7 @@ void Renderer::drainWindowSurface() {
         ColorBufferMap::iterator cit(m_colorbuffers.find(oldColorBufferHandle));
         if (cit != m_colorbuffers.end()) {
           if (--(*cit).second.refcount == 0) {
-            m_colorbuffers.erase(cit);
+            releaseColorBuffer_locked(cit);
           }
         }
       }
@@ -506,7 +649,63 @@ void Renderer::closeColorBuffer(HandleType p_colorbuffer) {
     return;
   }
   if (--(*c).second.refcount == 0) {
-    m_colorbuffers.erase(c);
+    releaseColorBuffer_locked(c);
+  }
+}
+
+anbox::graphics::BufferPool<ColorBufferPtr>::Key Renderer::colorBufferPoolKey(
+    int width, int height, GLenum internalFormat) {
+  // Formats which end up with the same texture are interchangeable.
+  switch (internalFormat) {
+    case GL_RGB565_OES:
+      internalFormat = GL_RGB;
+      break;
+    case GL_RGB5_A1_OES:
+    case GL_RGBA4_OES:
+      internalFormat = GL_RGBA;
+      break;
+    default:
+      break;
+  }
+  return {static_cast<uint32_t>(width), static_cast<uint32_t>(height), internalFormat};
+}
+
+void Renderer::releaseColorBuffer_locked(ColorBufferMap::iterator c) {
+  auto cb = c->second.cb;
+  m_colorbuffers.erase(c);
+
+  // Window surfaces can still hold on to the buffer and draw into it so we
+  // can only reuse it if nobody else has a reference. Guest textures and
+  // renderbuffers bound to it keep sharing its storage, so an exported
+  // buffer can't be handed out again either and is destroyed.
+  if (cb.getRefCount() != 1 || !cb->isResident() || cb->isExported()) return;
+
+  // Until it is handed out again the memory is ours.
+  auto accounting = anbox::graphics::MemoryAccounting::get();
+  accounting->credit(cb->getOwner(), cb->getMemoryUsage());
+  accounting->force_charge(anbox::graphics::MemoryAccounting::host, cb->getMemoryUsage());
+  cb->setOwner(anbox::graphics::MemoryAccounting::host);
+
+  const auto key = colorBufferPoolKey(cb->getWidth(), cb->getHeight(), cb->getInternalFormat());
+  const auto evicted = m_colorBufferPool.release(key, cb, cb->getMemoryUsage());
+
+  auto statistics = anbox::graphics::BufferStatistics::get();
+  if (evicted > 0) statistics->pool_evicted(evicted);
+  statistics->set_pooled(m_colorBufferPool.count(), m_colorBufferPool.size());
+}
+
+void Renderer::enforceSoftBudget_locked(ColorBuffer::Client client) {
+  auto accounting = anbox::graphics::MemoryAccounting::get();
+  while (accounting->over_soft_budget(client)) {
+    // Only buffers nothing but the guest's handle refers to can go, the
+    // others are attached to a surface which may draw into them any time.
+    ColorBufferMap::iterator lru = m_colorbuffers.end();
+    for (auto c = m_colorbuffers.begin(); c != m_colorbuffers.end(); ++c) {
+      const auto &cb = c->second.cb;
+      if (cb->getOwner() != client || !cb->canEvict() || cb.getRefCount() != 1) continue;
+      if (lru == m_colorbuffers.end() || cb->getLastUse() < lru->second.cb->getLastUse()) lru = c;
+    }
+    if (lru == m_colorbuffers.end() || !lru->second.cb->evict()) break;
   }
 }
 
@@ -720,50 +919,107 @@ EGLBoolean Renderer::destroyClientImage(HandleType image) {
 //
 // The framebuffer lock should be held when calling this function !
 //
-bool Renderer::bind_locked() {
-  EGLContext prevContext = s_egl.eglGetCurrentContext();
-  EGLSurface prevReadSurf = s_egl.eglGetCurrentSurface(EGL_READ);
-  EGLSurface prevDrawSurf = s_egl.eglGetCurrentSurface(EGL_DRAW);
+bool Renderer::makeCurrent(EGLSurface draw, EGLSurface read, EGLContext context) {
+  const ContextState state{context, draw, read};
+  if (!t_saved.empty() && t_current == state) {
+    t_make_current_skipped++;
+    return true;
+  }
 
-  if (!s_egl.eglMakeCurrent(m_eglDisplay, m_pbufSurface, m_pbufSurface,
-                            m_pbufContext)) {
+  t_make_current_calls++;
+  if (!s_egl.eglMakeCurrent(m_eglDisplay, draw, read, context)) {
     ERROR("eglMakeCurrent failed");
+    // We don't know anymore what is current
+    t_current = ContextState{s_egl.eglGetCurrentContext(),
+                             s_egl.eglGetCurrentSurface(EGL_DRAW),
+                             s_egl.eglGetCurrentSurface(EGL_READ)};
     return false;
   }
 
-  m_prevContext = prevContext;
-  m_prevReadSurf = prevReadSurf;
-  m_prevDrawSurf = prevDrawSurf;
+  t_current = state;
   return true;
 }
 
-bool Renderer::bindWindow_locked(RendererWindow *window) {
-  EGLContext prevContext = s_egl.eglGetCurrentContext();
-  EGLSurface prevReadSurf = s_egl.eglGetCurrentSurface(EGL_READ);
-  EGLSurface prevDrawSurf = s_egl.eglGetCurrentSurface(EGL_DRAW);
+bool Renderer::saveAndMakeCurrent(EGLSurface draw, EGLSurface read, EGLContext context) {
+  if (t_saved.empty())
+    t_current = ContextState{s_egl.eglGetCurrentContext(),
+                             s_egl.eglGetCurrentSurface(EGL_DRAW),
+                             s_egl.eglGetCurrentSurface(EGL_READ)};
 
-  if (!s_egl.eglMakeCurrent(m_eglDisplay, window->surface, window->surface,
-                            m_eglContext)) {
-    ERROR("eglMakeCurrent failed");
+  t_saved.push_back(t_current);
+  if (!makeCurrent(draw, read, context)) {
+    t_saved.pop_back();
     return false;
   }
-
-  m_prevContext = prevContext;
-  m_prevReadSurf = prevReadSurf;
-  m_prevDrawSurf = prevDrawSurf;
   return true;
 }
 
-bool Renderer::unbind_locked() {
-  if (!s_egl.eglMakeCurrent(m_eglDisplay, m_prevDrawSurf, m_prevReadSurf,
-                            m_prevContext)) {
-    return false;
+void Renderer::releaseResizer(TextureResize *resizer) {
+  emugl::Mutex::AutoLock lock(m_resizerLock);
+  m_releasedResizers.push_back(resizer);
+}
+
+// The compositor context has to be current when calling this function.
+void Renderer::destroyReleasedResizers() {
+  std::vector<TextureResize *> resizers;
+  {
+    emugl::Mutex::AutoLock lock(m_resizerLock);
+    resizers.swap(m_releasedResizers);
   }
+  for (auto resizer : resizers) delete resizer;
+}
 
-  m_prevContext = EGL_NO_CONTEXT;
-  m_prevReadSurf = EGL_NO_SURFACE;
-  m_prevDrawSurf = EGL_NO_SURFACE;
-  return true;
+bool Renderer::restoreContext() {
+  if (t_saved.empty()) return false;
+
+  const auto previous = t_saved.back();
+  const auto success = makeCurrent(previous.draw, previous.read, previous.context);
+  t_saved.pop_back();
+  return success;
+}
+
+//
+// The framebuffer lock should be held when calling this function !
+//
+bool Renderer::bind_locked() {
+  return saveAndMakeCurrent(m_pbufSurface, m_pbufSurface, m_pbufContext);
+}
+
+bool Renderer::bindWindow_locked(RendererWindow *window) {
+  // The context the thread had before composing is restored once all
+  // windows are drawn.
+  if (t_composing)
+    return makeCurrent(window->surface, window->surface, m_eglContext);
+  return saveAndMakeCurrent(window->surface, window->surface, m_eglContext);
+}
+
+bool Renderer::unbind_locked() {
+  return restoreContext();
+}
+
+void Renderer::begin_composition() {
+  if (t_composing) return;
+
+  if (t_saved.empty())
+    t_current = ContextState{s_egl.eglGetCurrentContext(),
+                             s_egl.eglGetCurrentSurface(EGL_DRAW),
+                             s_egl.eglGetCurrentSurface(EGL_READ)};
+  t_saved.push_back(t_current);
+
+  t_composing = true;
+  t_composition_calls = t_make_current_calls;
+  t_composition_skipped = t_make_current_skipped;
+}
+
+void Renderer::end_composition() {
+  if (!t_composing) return;
+
+  t_composing = false;
+  restoreContext();
+
+  anbox::graphics::CompositionStatistics::get()->context_switches(
+      t_make_current_calls - t_composition_calls,
+      t_make_current_skipped - t_composition_skipped);
 }
 
 const GLchar *const Renderer::vshader = {
@@ -928,14 +1184,27 @@ void Renderer::draw(RendererWindow *window, const Renderable &renderable,
 bool Renderer::draw(EGLNativeWindowType native_window,
                     const anbox::graphics::Rect &window_frame,
                     const RenderableList &renderables) {
+  ANBOX_TRACE_SCOPE("gl", "Renderer::draw");
+  emugl::Mutex::AutoLock mutex(m_lock);
+
   auto w = m_nativeWindows.find(native_window);
   if (w == m_nativeWindows.end()) return false;
 
-  if (!bindWindow_locked(w->second)) {
-    m_lock.unlock();
-    return false;
+  const auto offscreen = w->second->sink != nullptr;
+  if (offscreen) {
+    if (window_frame.width() <= 0 || window_frame.height() <= 0) return false;
+
+    if ((w->second->width != window_frame.width() ||
+         w->second->height != window_frame.height()) &&
+        !resizeOffscreenWindow_locked(w->second, window_frame.width(),
+                                      window_frame.height()))
+      return false;
   }
 
+  if (!bindWindow_locked(w->second)) return false;
+
+  destroyReleasedResizers();
+
   setupViewport(w->second, window_frame);
   s_gles2.glViewport(0, 0, window_frame.width(), window_frame.height());
   s_gles2.glClearColor(0.0, 0.0, 0.0, 1.0);
@@ -945,13 +1214,15 @@ bool Renderer::draw(EGLNativeWindowType native_window,
   for (const auto &r : renderables)
     draw(w->second, r, r.alpha() < 1.0f ? m_alphaProgram : m_defaultProgram);
 
-  s_egl.eglSwapBuffers(m_eglDisplay, w->second->surface);
-
-  unbind_locked();
-
-  m_lock.lock();
+  if (offscreen) {
+    readOffscreenWindow(w->second);
+  } else {
+    ANBOX_TRACE_SCOPE("gl", "eglSwapBuffers");
+    s_egl.eglSwapBuffers(m_eglDisplay, w->second->surface);
+  }
 
-  m_lock.unlock();
+  if (!t_composing)
+    unbind_locked();
 
   return false;
 }
@@ -25,6 +25,8 @@
 
 #include "Renderable.h"
 
+#include "anbox/graphics/buffer_pool.h"
+#include "anbox/graphics/frame_sink.h"
 #include "anbox/graphics/primitives.h"
 #include "anbox/graphics/program_family.h"
 #include "anbox/graphics/renderer.h"
@@ -32,6 +34,7 @@
 #include <EGL/egl.h>
 
 #include <map>
+#include <vector>
 
 #include <stdint.h>
 
@@ -54,11 +57,14 @@ typedef std::map<HandleType, ColorBufferRef> ColorBufferMap;
 // extension is supported.
 // |has_eglimage_renderbuffer| is true iff the EGL_KHR_gl_renderbuffer_image
 // extension is supported.
+// |has_framebuffer_blit| is true iff GLESv2 contexts are at least GLES 3.0
+// and provide glBlitFramebuffer().
 // |eglMajor| and |eglMinor| are the major and minor version numbers of
 // the underlying EGL implementation.
 struct RendererCaps {
   bool has_eglimage_texture_2d;
   bool has_eglimage_renderbuffer;
+  bool has_framebuffer_blit;
   EGLint eglMajor;
   EGLint eglMinor;
 };
@@ -84,7 +90,9 @@ class Renderer : public anbox::graphics::Renderer {
   // own sub-windows. If false, this means the caller will use
   // setPostCallback() instead to retrieve the content.
   // Returns true on success, false otherwise.
-  bool initialize(EGLNativeDisplayType nativeDisplay);
+  // |offscreen| is true when there is no native window system and all
+  // windows are created with createOffscreenWindow().
+  bool initialize(EGLNativeDisplayType nativeDisplay, bool offscreen = false);
 
   // Finalize the instance.
   void finalize();
@@ -109,6 +117,14 @@ class Renderer : public anbox::graphics::Renderer {
   void destroyNativeWindow(RendererWindow* window);
   void destroyNativeWindow(EGLNativeWindowType native_window);
 
+  // Create a window which is rendered into a pbuffer instead of a native
+  // window. |id| identifies the window in draw() and destroyNativeWindow().
+  // After every frame the window content is read back into |sink| with the
+  // top row first. The pbuffer follows the size of the window frame.
+  RendererWindow* createOffscreenWindow(EGLNativeWindowType id, int width,
+                                        int height,
+                                        anbox::graphics::FrameSink* sink);
+
   // Create a new RenderContext instance for this display instance.
   // |p_config| is the index of one of the configs returned by getConfigs().
   // |p_share| is either EGL_NO_CONTEXT or the handle of a shared context.
@@ -226,6 +242,11 @@ class Renderer : public anbox::graphics::Renderer {
             const anbox::graphics::Rect& window_frame,
             const RenderableList& renderables) override;
 
+  // Keeps the compositor context current on the calling thread for all
+  // windows drawn until end_composition() restores the previous one.
+  void begin_composition() override;
+  void end_composition() override;
+
   // Return the host EGLDisplay used by this instance.
   EGLDisplay getDisplay() const { return m_eglDisplay; }
 
@@ -240,11 +261,25 @@ class Renderer : public anbox::graphics::Renderer {
   // Used internally.
   bool bind_locked();
   bool unbind_locked();
+  void releaseResizer(TextureResize* resizer);
 
  private:
   HandleType genHandle();
 
   bool bindWindow_locked(RendererWindow* window);
+  static anbox::graphics::BufferPool<ColorBufferPtr>::Key colorBufferPoolKey(
+      int width, int height, GLenum internalFormat);
+  void releaseColorBuffer_locked(ColorBufferMap::iterator c);
+  // Evict the least recently used buffers of |client| until it is within
+  // its soft memory budget again.
+  void enforceSoftBudget_locked(ColorBuffer::Client client);
+  bool makeCurrent(EGLSurface draw, EGLSurface read, EGLContext context);
+  bool saveAndMakeCurrent(EGLSurface draw, EGLSurface read, EGLContext context);
+  bool restoreContext();
+  void destroyReleasedResizers();
+  bool resizeOffscreenWindow_locked(RendererWindow* window, int width,
+                                    int height);
+  void readOffscreenWindow(RendererWindow* window);
 
   void setupViewport(RendererWindow* window, const anbox::graphics::Rect& rect);
   struct Program;
@@ -265,14 +300,16 @@ class Renderer : public anbox::graphics::Renderer {
   WindowSurfaceMap m_windows;
   ColorBufferMap m_colorbuffers;
   ColorBuffer::Helper* m_colorBufferHelper;
+  anbox::graphics::BufferPool<ColorBufferPtr> m_colorBufferPool;
+  // Resizers of destroyed or evicted color buffers waiting for the
+  // compositor context to become current.
+  emugl::Mutex m_resizerLock;
+  std::vector<TextureResize*> m_releasedResizers;
 
   EGLContext m_eglContext;
   EGLSurface m_pbufSurface;
   EGLContext m_pbufContext;
 
-  EGLContext m_prevContext;
-  EGLSurface m_prevReadSurf;
-  EGLSurface m_prevDrawSurf;
   TextureDraw* m_textureDraw;
   EGLConfig m_eglConfig;
   HandleType m_lastPostedColorBuffer;
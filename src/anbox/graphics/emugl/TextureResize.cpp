@@ -214,6 +214,8 @@ TextureResize::TextureResize(GLuint width, GLuint height)
   s_gles2.glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
   s_gles2.glBufferData(GL_ARRAY_BUFFER, sizeof(kVertexData), kVertexData,
                        GL_STATIC_DRAW);
+  // Created while composing, which draws from client side arrays.
+  s_gles2.glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 TextureResize::~TextureResize() {
@@ -23,9 +23,19 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "anbox/graphics/memory_accounting.h"
 #include "anbox/logger.h"
 
-WindowSurface::WindowSurface(EGLDisplay display, EGLConfig config)
+namespace {
+// The config isn't known in detail here, so assume 32 bit per pixel which
+// is what the guest asks for in practice.
+size_t pbufferMemoryUsage(unsigned int width, unsigned int height) {
+  return static_cast<size_t>(width) * height * 4;
+}
+}  // namespace
+
+WindowSurface::WindowSurface(EGLDisplay display, EGLConfig config,
+                             ColorBuffer::Client owner)
     : mSurface(NULL),
       mAttachedColorBuffer(NULL),
       mReadContext(NULL),
@@ -33,21 +43,32 @@ WindowSurface::WindowSurface(EGLDisplay display, EGLConfig config)
       mWidth(0),
       mHeight(0),
       mConfig(config),
-      mDisplay(display) {}
+      mDisplay(display),
+      mOwner(owner),
+      mMemoryUsage(0) {}
 
 WindowSurface::~WindowSurface() {
   if (mSurface) {
     s_egl.eglDestroySurface(mDisplay, mSurface);
   }
+  anbox::graphics::MemoryAccounting::get()->credit(mOwner, mMemoryUsage);
 }
 
 WindowSurface *WindowSurface::create(EGLDisplay display, EGLConfig config,
-                                     int p_width, int p_height) {
+                                     int p_width, int p_height,
+                                     ColorBuffer::Client owner) {
+  const size_t memoryUsage = pbufferMemoryUsage(p_width, p_height);
+  if (!anbox::graphics::MemoryAccounting::get()->charge(owner, memoryUsage)) {
+    return NULL;
+  }
+
   // allocate space for the WindowSurface object
-  WindowSurface *win = new WindowSurface(display, config);
+  WindowSurface *win = new WindowSurface(display, config, owner);
   if (!win) {
+    anbox::graphics::MemoryAccounting::get()->credit(owner, memoryUsage);
     return NULL;
   }
+  win->mMemoryUsage = memoryUsage;
 
   // Create a pbuffer to be used as the egl surface
   // for that window.
@@ -160,6 +181,16 @@ bool WindowSurface::resize(unsigned int p_width, unsigned int p_height) {
   mWidth = p_width;
   mHeight = p_height;
 
+  // Resizes follow the attached color buffer which was accounted already,
+  // so they can't be refused anymore.
+  const size_t memoryUsage = pbufferMemoryUsage(p_width, p_height);
+  if (memoryUsage > mMemoryUsage) {
+    anbox::graphics::MemoryAccounting::get()->force_charge(mOwner, memoryUsage - mMemoryUsage);
+  } else {
+    anbox::graphics::MemoryAccounting::get()->credit(mOwner, mMemoryUsage - memoryUsage);
+  }
+  mMemoryUsage = memoryUsage;
+
   if (needRebindContext) {
     s_egl.eglMakeCurrent(
         mDisplay, (prevDrawSurf == prevPbuf) ? mSurface : prevDrawSurf,
@@ -32,9 +32,11 @@ class WindowSurface {
   // |display| is the host EGLDisplay value.
   // |config| is the host EGLConfig value.
   // |width| and |height| are the initial size of the Pbuffer.
-  // Return a new WindowSurface instance on success, or NULL on failure.
+  // |owner| is the client the memory of the Pbuffer is accounted to.
+  // Return a new WindowSurface instance on success, or NULL on failure
+  // or if the owner can't afford the Pbuffer.
   static WindowSurface* create(EGLDisplay display, EGLConfig config, int width,
-                               int height);
+                               int height, ColorBuffer::Client owner);
 
   // Destructor.
   ~WindowSurface();
@@ -79,7 +81,8 @@ class WindowSurface {
   WindowSurface();
   WindowSurface(const WindowSurface& other);
 
-  explicit WindowSurface(EGLDisplay display, EGLConfig config);
+  explicit WindowSurface(EGLDisplay display, EGLConfig config,
+                         ColorBuffer::Client owner);
 
   bool resize(unsigned int p_width, unsigned int p_height);
 
@@ -92,6 +95,8 @@ class WindowSurface {
   GLuint mHeight;
   EGLConfig mConfig;
   EGLDisplay mDisplay;
+  ColorBuffer::Client mOwner;
+  size_t mMemoryUsage;
 };
 
 typedef emugl::SmartPtr<WindowSurface> WindowSurfacePtr;
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_GRAPHICS_FRAME_SINK_H_
+#define ANBOX_GRAPHICS_FRAME_SINK_H_
+
+#include <cstdint>
+
+namespace anbox {
+namespace graphics {
+// A FrameSink receives the composed content of a window which is rendered
+// offscreen instead of into a native window.
+class FrameSink {
+ public:
+  virtual ~FrameSink() {}
+
+  // Returns the memory a frame of width x height RGBA pixels with rows of
+  // width * 4 bytes is read back into, or nullptr to drop the frame.
+  virtual std::uint8_t* begin_frame(std::uint32_t width, std::uint32_t height) = 0;
+  // Called once the frame returned by begin_frame was written.
+  virtual void end_frame(std::uint32_t width, std::uint32_t height) = 0;
+};
+}  // namespace graphics
+}  // namespace anbox
+
+#endif
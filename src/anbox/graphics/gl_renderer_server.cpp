@@ -28,6 +28,7 @@
 #include <boost/throw_exception.hpp>
 #include <boost/filesystem.hpp>
 #include <cstdarg>
+#include <cstdlib>
 #include <stdexcept>
 
 namespace {
@@ -86,6 +87,13 @@ GLRendererServer::GLRendererServer(const Config &config, const std::shared_ptr<w
     gl_libs.push_back(emugl::GLLibrary{emugl::GLLibrary::Type::GLESv2, (translator_dir / "libGLES_V2_translator.so")});
   }
 
+  if (config.offscreen) {
+    // Without a display Mesa can still render through its surfaceless
+    // platform, with llvmpipe if there is no GPU. Users can still pick a
+    // different platform through the environment.
+    ::setenv("EGL_PLATFORM", "surfaceless", 0);
+  }
+
   emugl_logger_struct log_funcs;
   log_funcs.coarse = logger_write;
   log_funcs.fine = logger_write;
@@ -93,7 +101,7 @@ GLRendererServer::GLRendererServer(const Config &config, const std::shared_ptr<w
   if (!emugl::initialize(gl_libs, &log_funcs, nullptr))
     BOOST_THROW_EXCEPTION(std::runtime_error("Failed to initialize OpenGL renderer"));
 
-  renderer_->initialize(0);
+  renderer_->initialize(0, config.offscreen);
 
   registerRenderer(renderer_);
   registerLayerComposer(composer_);
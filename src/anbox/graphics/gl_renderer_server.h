@@ -38,6 +38,8 @@ class GLRendererServer {
     enum class Driver { Translator, Host };
     Driver driver;
     bool single_window;
+    // Render all windows offscreen as there is no display to show them on.
+    bool offscreen;
   };
 
   GLRendererServer(const Config &config, const std::shared_ptr<wm::Manager> &wm);
@@ -16,24 +16,89 @@
  */
 
 #include "anbox/graphics/layer_composer.h"
+#include "anbox/common/tracer.h"
+#include "anbox/graphics/composition_statistics.h"
 #include "anbox/graphics/renderer.h"
+#include "anbox/input/latency_tracker.h"
 #include "anbox/logger.h"
 #include "anbox/wm/manager.h"
 
+#include <algorithm>
+
 namespace anbox {
 namespace graphics {
-LayerComposer::LayerComposer(const std::shared_ptr<Renderer> renderer, const std::shared_ptr<Strategy> &strategy)
-    : renderer_(renderer), strategy_(strategy) {}
+constexpr const std::chrono::milliseconds LayerComposer::default_hidden_frame_interval;
+
+LayerComposer::LayerComposer(const std::shared_ptr<Renderer> renderer, const std::shared_ptr<Strategy> &strategy,
+                             const std::chrono::milliseconds &hidden_frame_interval)
+    : renderer_(renderer), strategy_(strategy), hidden_frame_interval_(hidden_frame_interval) {}
 
 LayerComposer::~LayerComposer() {}
 
-void LayerComposer::submit_layers(const RenderableList &renderables) {
-  auto win_layers = strategy_->process_layers(renderables);
+RenderableList &LayerComposer::Strategy::renderables_for_window(WindowRenderableList &win_layers,
+                                                                const std::shared_ptr<wm::Window> &window) {
   for (auto &w : win_layers) {
+    if (w.first == window) return w.second;
+  }
+  win_layers.emplace_back(window, RenderableList{});
+  return win_layers.back().second;
+}
+
+std::chrono::steady_clock::time_point LayerComposer::submit_layers(const RenderableList &renderables) {
+  ANBOX_TRACE_SCOPE("composer", "LayerComposer::submit_layers");
+  input::LatencyTracker::get()->frame_submitted();
+
+  for (auto &w : win_layers_)
+    w.second.clear();
+
+  strategy_->process_layers(renderables, win_layers_);
+
+  auto statistics = CompositionStatistics::get();
+  auto any_layers = false;
+  auto any_visible = false;
+  for (const auto &w : win_layers_) {
+    if (!w.second.empty()) any_layers = true;
+
+    if (!w.first->visible()) {
+      if (!w.second.empty()) statistics->frame_skipped(w.first->task());
+      continue;
+    }
+
+    // A window whose last layer went away is drawn once more without any
+    // layers so its old content doesn't stay on screen.
+    if (!any_visible) renderer_->begin_composition();
+    any_visible = true;
     renderer_->draw(w.first->native_handle(),
                     Rect{0, 0, w.first->frame().width(), w.first->frame().height()},
                     w.second);
+    statistics->frame_composed(w.first->task());
+  }
+
+  if (any_visible) renderer_->end_composition();
+
+  // Windows which didn't get any layers for this frame are dropped so that
+  // we don't keep a reference to windows which are already gone.
+  win_layers_.erase(std::remove_if(win_layers_.begin(), win_layers_.end(),
+                                   [](const Strategy::WindowRenderableList::value_type &w) {
+                                     return w.second.empty();
+                                   }),
+                    win_layers_.end());
+
+  // Nobody can see what Android renders right now so its compositor
+  // doesn't need to produce frames at full rate. Holding it back keeps
+  // it from waking up and composing again for nothing.
+  const auto now = std::chrono::steady_clock::now();
+  if (any_layers && !any_visible) {
+    const auto next_submit = last_submit_ + hidden_frame_interval_;
+    if (next_submit > now) {
+      statistics->frame_throttled(
+          std::chrono::duration_cast<std::chrono::microseconds>(next_submit - now));
+      last_submit_ = next_submit;
+      return next_submit;
+    }
   }
+  last_submit_ = now;
+  return now;
 }
 }  // namespace graphics
 }  // namespace anbox
@@ -24,8 +24,10 @@
 #include "anbox/graphics/emugl/Renderer.h"
 #endif
 
+#include <chrono>
 #include <memory>
-#include <map>
+#include <utility>
+#include <vector>
 
 namespace anbox {
 namespace wm {
@@ -37,21 +39,42 @@ class LayerComposer {
  public:
   class Strategy {
    public:
-    typedef std::map<std::shared_ptr<wm::Window>, RenderableList> WindowRenderableList;
+    typedef std::vector<std::pair<std::shared_ptr<wm::Window>, RenderableList>> WindowRenderableList;
 
     virtual ~Strategy() {}
-    virtual WindowRenderableList process_layers(const RenderableList &renderables) = 0;
+
+    // The list of windows is owned by the composer and reused for every
+    // frame. When called all per window lists are empty but keep their
+    // storage around so that composing a frame doesn't allocate.
+    virtual void process_layers(const RenderableList &renderables,
+                                WindowRenderableList &win_layers) = 0;
+
+   protected:
+    static RenderableList &renderables_for_window(WindowRenderableList &win_layers,
+                                                  const std::shared_ptr<wm::Window> &window);
   };
 
+  // While none of the windows Android renders into is visible the guest's
+  // compositor is held back to one frame per this interval.
+  static constexpr const std::chrono::milliseconds default_hidden_frame_interval{200};
+
   LayerComposer(const std::shared_ptr<Renderer> renderer,
-                const std::shared_ptr<Strategy> &strategy);
+                const std::shared_ptr<Strategy> &strategy,
+                const std::chrono::milliseconds &hidden_frame_interval = default_hidden_frame_interval);
   ~LayerComposer();
 
-  void submit_layers(const RenderableList &renderables);
+  // Returns the time until which the caller should hold back the guest's
+  // compositor before it accepts the next frame. This is in the past
+  // unless the frame was throttled. The composer never waits itself as
+  // it's called with the decoder lock held which all GL clients share.
+  std::chrono::steady_clock::time_point submit_layers(const RenderableList &renderables);
 
  private:
   std::shared_ptr<Renderer> renderer_;
   std::shared_ptr<Strategy> strategy_;
+  Strategy::WindowRenderableList win_layers_;
+  std::chrono::milliseconds hidden_frame_interval_;
+  std::chrono::steady_clock::time_point last_submit_;
 };
 }  // namespace graphics
 }  // namespace anbox
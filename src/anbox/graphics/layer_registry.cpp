@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/graphics/layer_registry.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+constexpr const char *task_layer_prefix{"org.anbox.surface."};
+constexpr const std::size_t initial_slot_count{64};
+
+const char *blacklisted_layers[] = {
+    // The 'Sprite' layer is the mouse cursor Android uses as soon
+    // as it has a pointer input device available. We don't want to
+    // display this layer at all but don't have a good way of disabling
+    // the cursor on the Android side yet.
+    "Sprite",
+};
+}  // namespace
+
+namespace anbox {
+namespace graphics {
+const LayerRegistry::Index LayerRegistry::invalid_slot{0xffffffff};
+constexpr const std::size_t LayerRegistry::default_max_entries;
+
+std::shared_ptr<LayerRegistry> LayerRegistry::get() {
+  static auto registry = std::make_shared<LayerRegistry>();
+  return registry;
+}
+
+LayerRegistry::LayerRegistry(std::size_t max_entries)
+    : max_entries_(max_entries),
+      live_entries_(0),
+      uses_(0),
+      next_id_(0),
+      slots_(initial_slot_count, Slot{0, invalid_slot}) {}
+
+LayerRegistry::~LayerRegistry() {}
+
+std::uint64_t LayerRegistry::hash_of(const char *name) {
+  // FNV-1a
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (; *name; name++) {
+    hash ^= static_cast<std::uint8_t>(*name);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+LayerRegistry::Info LayerRegistry::parse(const Id &id, const char *name) {
+  Info info;
+  info.id = id;
+
+  const auto prefix_length = std::strlen(task_layer_prefix);
+  if (std::strncmp(name, task_layer_prefix, prefix_length) == 0) {
+    wm::Task::Id task = 0;
+    if (std::sscanf(name + prefix_length, "%d", &task) == 1 && task > 0)
+      info.task = task;
+  }
+
+  for (const auto &blacklisted : blacklisted_layers) {
+    if (std::strcmp(name, blacklisted) == 0) {
+      info.blacklisted = true;
+      break;
+    }
+  }
+
+  return info;
+}
+
+LayerRegistry::Info LayerRegistry::intern(const char *name) {
+  if (!name) name = "";
+
+  const auto hash = hash_of(name);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  uses_++;
+
+  auto mask = slots_.size() - 1;
+  auto n = static_cast<std::size_t>(hash) & mask;
+  while (slots_[n].entry != invalid_slot) {
+    auto &entry = entries_[slots_[n].entry];
+    if (entry.hash == hash && entry.name == name) {
+      entry.last_used = uses_;
+      return entry.info;
+    }
+    n = (n + 1) & mask;
+  }
+
+  if (live_entries_ >= max_entries_) {
+    sweep_locked();
+    // The slots were rebuilt, find a free one again
+    mask = slots_.size() - 1;
+    n = static_cast<std::size_t>(hash) & mask;
+    while (slots_[n].entry != invalid_slot)
+      n = (n + 1) & mask;
+  }
+
+  Index index;
+  if (!free_entries_.empty()) {
+    index = free_entries_.back();
+    free_entries_.pop_back();
+  } else {
+    index = static_cast<Index>(entries_.size());
+    entries_.push_back(Entry{});
+  }
+
+  const auto id = next_id_++;
+  auto &entry = entries_[index];
+  entry.hash = hash;
+  entry.name = name;
+  entry.info = parse(id, name);
+  entry.live = true;
+  entry.last_used = uses_;
+  slots_[n] = Slot{hash, index};
+  entry_of_[id] = index;
+  live_entries_++;
+
+  // Keep the load factor below 50% so probe sequences stay short.
+  if (live_entries_ * 2 > slots_.size())
+    rebuild_slots_locked(slots_.size() * 2);
+
+  return entry.info;
+}
+
+void LayerRegistry::sweep_locked() {
+  // Layers are posted with every frame so the ones which are still around
+  // are among the most recently used ones.
+  std::vector<Index> live;
+  live.reserve(live_entries_);
+  for (Index index = 0; index < entries_.size(); index++) {
+    if (entries_[index].live)
+      live.push_back(index);
+  }
+
+  const auto evict = live.size() - live.size() / 2;
+  std::nth_element(live.begin(), live.begin() + evict, live.end(), [&](const Index &a, const Index &b) {
+    return entries_[a].last_used < entries_[b].last_used;
+  });
+
+  for (auto it = live.begin(); it != live.begin() + evict; ++it) {
+    auto &entry = entries_[*it];
+    entry.live = false;
+    entry.name.clear();
+    entry.name.shrink_to_fit();
+    entry_of_.erase(entry.info.id);
+    free_entries_.push_back(*it);
+  }
+  live_entries_ -= evict;
+
+  rebuild_slots_locked(slots_.size());
+}
+
+void LayerRegistry::rebuild_slots_locked(std::size_t slot_count) {
+  std::vector<Slot> slots(slot_count, Slot{0, invalid_slot});
+  const auto mask = slots.size() - 1;
+  for (Index index = 0; index < entries_.size(); index++) {
+    const auto &entry = entries_[index];
+    if (!entry.live)
+      continue;
+    auto n = static_cast<std::size_t>(entry.hash) & mask;
+    while (slots[n].entry != invalid_slot)
+      n = (n + 1) & mask;
+    slots[n] = Slot{entry.hash, index};
+  }
+  slots_.swap(slots);
+}
+
+std::string LayerRegistry::name_of(const Id &id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto entry = entry_of_.find(id);
+  if (entry == entry_of_.end())
+    return "";
+  return entries_[entry->second].name;
+}
+
+std::size_t LayerRegistry::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return live_entries_;
+}
+}  // namespace graphics
+}  // namespace anbox
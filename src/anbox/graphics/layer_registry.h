@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_GRAPHICS_LAYER_REGISTRY_H_
+#define ANBOX_GRAPHICS_LAYER_REGISTRY_H_
+
+#include "anbox/wm/task.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace anbox {
+namespace graphics {
+// LayerRegistry interns the layer names Android passes with every posted
+// layer. A name is only parsed once, when it is seen for the first time,
+// and all later frames resolve it to the cached information without any
+// string processing or heap allocation.
+//
+// Android doesn't tell us when a layer goes away. Once the registry is
+// full, the half of the names which were posted least recently is dropped.
+// Ids are never handed out twice, so a renderable which still holds the id
+// of a dropped name can't be mistaken for a newer layer.
+class LayerRegistry {
+ public:
+  typedef std::uint64_t Id;
+
+  static constexpr const std::size_t default_max_entries{1024};
+
+  struct Info {
+    Id id = 0;
+    // The task the layer belongs to or 0 if the layer isn't one of the
+    // org.anbox.surface.<task> layers.
+    wm::Task::Id task = 0;
+    // Blacklisted layers (e.g. the mouse cursor) are never composed.
+    bool blacklisted = false;
+  };
+
+  static std::shared_ptr<LayerRegistry> get();
+
+  explicit LayerRegistry(std::size_t max_entries = default_max_entries);
+  ~LayerRegistry();
+
+  Info intern(const char *name);
+  std::string name_of(const Id &id) const;
+  std::size_t size() const;
+
+ private:
+  typedef std::uint32_t Index;
+
+  struct Slot {
+    std::uint64_t hash;
+    Index entry;
+  };
+
+  struct Entry {
+    std::uint64_t hash;
+    std::string name;
+    Info info;
+    bool live;
+    std::uint64_t last_used;
+  };
+
+  static const Index invalid_slot;
+
+  static std::uint64_t hash_of(const char *name);
+  static Info parse(const Id &id, const char *name);
+
+  void rebuild_slots_locked(std::size_t slot_count);
+  void sweep_locked();
+
+  mutable std::mutex mutex_;
+  std::size_t max_entries_;
+  std::size_t live_entries_;
+  std::uint64_t uses_;
+  Id next_id_;
+  std::vector<Slot> slots_;
+  std::vector<Entry> entries_;
+  std::vector<Index> free_entries_;
+  std::unordered_map<Id, Index> entry_of_;
+};
+}  // namespace graphics
+}  // namespace anbox
+
+#endif
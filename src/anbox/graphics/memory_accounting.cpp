@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/graphics/memory_accounting.h"
+#include "anbox/logger.h"
+#include "anbox/utils.h"
+
+#include <algorithm>
+
+namespace anbox {
+namespace graphics {
+constexpr MemoryAccounting::Client MemoryAccounting::host;
+
+std::shared_ptr<MemoryAccounting> MemoryAccounting::get() {
+  static auto instance = std::make_shared<MemoryAccounting>();
+  return instance;
+}
+
+MemoryAccounting::MemoryAccounting()
+    : budget_{0, 0},
+      next_client_(host + 1),
+      rejected_(0),
+      evicted_buffers_(0),
+      evicted_bytes_(0),
+      restored_buffers_(0) {
+  clients_[host] = Usage{};
+}
+
+MemoryAccounting::~MemoryAccounting() {}
+
+void MemoryAccounting::set_budget(const Budget &budget) {
+  std::lock_guard<decltype(lock_)> l(lock_);
+  budget_ = budget;
+}
+
+MemoryAccounting::Budget MemoryAccounting::budget() const {
+  std::lock_guard<decltype(lock_)> l(lock_);
+  return budget_;
+}
+
+MemoryAccounting::Client MemoryAccounting::register_client() {
+  std::lock_guard<decltype(lock_)> l(lock_);
+  const auto client = next_client_++;
+  clients_[client] = Usage{};
+  return client;
+}
+
+void MemoryAccounting::unregister_client(const Client &client) {
+  std::lock_guard<decltype(lock_)> l(lock_);
+  auto it = clients_.find(client);
+  if (it == clients_.end() || client == host) return;
+
+  if (it->second.bytes == 0)
+    clients_.erase(it);
+  else
+    it->second.registered = false;
+}
+
+void MemoryAccounting::charge_locked(Usage &usage, std::uint64_t bytes) {
+  usage.bytes += bytes;
+  usage.peak = std::max(usage.peak, usage.bytes);
+}
+
+bool MemoryAccounting::charge(const Client &client, std::uint64_t bytes) {
+  std::lock_guard<decltype(lock_)> l(lock_);
+  auto &usage = clients_[client];
+  if (client != host && budget_.hard > 0 && usage.bytes + bytes > budget_.hard) {
+    usage.rejected++;
+    rejected_++;
+    WARNING("GL client %d exceeds its memory budget of %d bytes", client, budget_.hard);
+    return false;
+  }
+  charge_locked(usage, bytes);
+  return true;
+}
+
+void MemoryAccounting::force_charge(const Client &client, std::uint64_t bytes) {
+  std::lock_guard<decltype(lock_)> l(lock_);
+  charge_locked(clients_[client], bytes);
+}
+
+void MemoryAccounting::credit(const Client &client, std::uint64_t bytes) {
+  std::lock_guard<decltype(lock_)> l(lock_);
+  auto it = clients_.find(client);
+  if (it == clients_.end()) return;
+
+  auto &usage = it->second;
+  usage.bytes -= std::min(usage.bytes, bytes);
+  if (!usage.registered && usage.bytes == 0)
+    clients_.erase(it);
+}
+
+std::uint64_t MemoryAccounting::usage(const Client &client) const {
+  std::lock_guard<decltype(lock_)> l(lock_);
+  const auto it = clients_.find(client);
+  return it != clients_.end() ? it->second.bytes : 0;
+}
+
+bool MemoryAccounting::over_soft_budget(const Client &client) const {
+  std::lock_guard<decltype(lock_)> l(lock_);
+  if (client == host || budget_.soft == 0) return false;
+  const auto it = clients_.find(client);
+  return it != clients_.end() && it->second.bytes > budget_.soft;
+}
+
+void MemoryAccounting::buffer_evicted(std::uint64_t bytes) {
+  std::lock_guard<decltype(lock_)> l(lock_);
+  evicted_buffers_++;
+  evicted_bytes_ += bytes;
+}
+
+void MemoryAccounting::buffer_restored() {
+  std::lock_guard<decltype(lock_)> l(lock_);
+  restored_buffers_++;
+}
+
+std::map<std::string, std::uint64_t> MemoryAccounting::summary() const {
+  std::lock_guard<decltype(lock_)> l(lock_);
+  std::map<std::string, std::uint64_t> summary{
+      {"soft_budget", budget_.soft},
+      {"hard_budget", budget_.hard},
+      {"rejected_allocations", rejected_},
+      {"evicted_buffers", evicted_buffers_},
+      {"evicted_bytes", evicted_bytes_},
+      {"restored_buffers", restored_buffers_},
+  };
+
+  std::uint64_t total = 0;
+  for (const auto &client : clients_) {
+    const auto prefix = utils::string_format("client.%d.", client.first);
+    summary[prefix + "bytes"] = client.second.bytes;
+    summary[prefix + "peak_bytes"] = client.second.peak;
+    summary[prefix + "rejected"] = client.second.rejected;
+    total += client.second.bytes;
+  }
+  summary["total_bytes"] = total;
+  return summary;
+}
+}  // namespace graphics
+}  // namespace anbox
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_GRAPHICS_MEMORY_ACCOUNTING_H_
+#define ANBOX_GRAPHICS_MEMORY_ACCOUNTING_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace anbox {
+namespace graphics {
+// MemoryAccounting tracks how much GPU memory every GL client of the guest
+// holds through the buffers and surfaces it created and enforces the
+// budgets each of them has.
+class MemoryAccounting {
+ public:
+  typedef std::uint32_t Client;
+  // Used for everything the host allocates on its own behalf
+  static constexpr Client host{0};
+
+  struct Budget {
+    // Once a client holds more than this its least recently used buffers
+    // are moved out of GPU memory. Zero disables the limit.
+    std::uint64_t soft;
+    // Allocations which would take a client beyond this fail. Zero
+    // disables the limit.
+    std::uint64_t hard;
+  };
+
+  static std::shared_ptr<MemoryAccounting> get();
+
+  MemoryAccounting();
+  ~MemoryAccounting();
+
+  void set_budget(const Budget &budget);
+  Budget budget() const;
+
+  Client register_client();
+  // The client stays known as long as memory is charged to it.
+  void unregister_client(const Client &client);
+
+  // Returns false without charging anything if the client would exceed
+  // its hard budget.
+  bool charge(const Client &client, std::uint64_t bytes);
+  // Charges the memory even beyond the hard budget. Used when memory the
+  // client already had has to be brought back.
+  void force_charge(const Client &client, std::uint64_t bytes);
+  void credit(const Client &client, std::uint64_t bytes);
+
+  std::uint64_t usage(const Client &client) const;
+  bool over_soft_budget(const Client &client) const;
+
+  void buffer_evicted(std::uint64_t bytes);
+  void buffer_restored();
+
+  // Per client values are keyed "client.<id>.bytes", "client.<id>.peak_bytes"
+  // and "client.<id>.rejected".
+  std::map<std::string, std::uint64_t> summary() const;
+
+ private:
+  struct Usage {
+    Usage() : bytes(0), peak(0), rejected(0), registered(true) {}
+
+    std::uint64_t bytes;
+    std::uint64_t peak;
+    std::uint64_t rejected;
+    bool registered;
+  };
+
+  void charge_locked(Usage &usage, std::uint64_t bytes);
+
+  mutable std::mutex lock_;
+  Budget budget_;
+  Client next_client_;
+  std::map<Client, Usage> clients_;
+  std::uint64_t rejected_;
+  std::uint64_t evicted_buffers_;
+  std::uint64_t evicted_bytes_;
+  std::uint64_t restored_buffers_;
+};
+}  // namespace graphics
+}  // namespace anbox
+
+#endif
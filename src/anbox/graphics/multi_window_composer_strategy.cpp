@@ -17,41 +17,41 @@
 
 #include "anbox/graphics/multi_window_composer_strategy.h"
 #include "anbox/wm/manager.h"
-#include "anbox/utils.h"
 
 namespace anbox {
 namespace graphics {
 MultiWindowComposerStrategy::MultiWindowComposerStrategy(const std::shared_ptr<wm::Manager> &wm) : wm_(wm) {}
 
-std::map<std::shared_ptr<wm::Window>, RenderableList> MultiWindowComposerStrategy::process_layers(const RenderableList &renderables) {
-  WindowRenderableList win_layers;
+void MultiWindowComposerStrategy::process_layers(const RenderableList &renderables,
+                                                 WindowRenderableList &win_layers) {
+  // Layers of the same task are posted next to each other so we only have
+  // to ask the window manager again when the task changes.
+  wm::Task::Id current_task = 0;
+  RenderableList *current_layers = nullptr;
+
   for (const auto &renderable : renderables) {
     // Ignore all surfaces which are not meant for a task
-    if (!utils::string_starts_with(renderable.name(), "org.anbox.surface."))
-      continue;
-
-    wm::Task::Id task_id = 0;
-    if (sscanf(renderable.name().c_str(), "org.anbox.surface.%d", &task_id) != 1 || !task_id)
+    const auto task_id = renderable.layer().task;
+    if (!task_id)
       continue;
 
-    auto w = wm_->find_window_for_task(task_id);
-    if (!w) continue;
-
-    if (win_layers.find(w) == win_layers.end()) {
-      win_layers.insert({w, {renderable}});
-      continue;
+    if (task_id != current_task) {
+      current_task = task_id;
+      auto w = wm_->find_window_for_task(task_id);
+      current_layers = w ? &renderables_for_window(win_layers, w) : nullptr;
     }
 
-    win_layers[w].push_back(renderable);
+    if (!current_layers) continue;
+
+    current_layers->push_back(renderable);
   }
 
   for (auto &w : win_layers) {
-    const auto &renderables = w.second;
-    RenderableList final_renderables;
+    auto &renderables = w.second;
     auto new_window_frame = Rect::Invalid;
     auto max_layer_area = -1;
 
-    for (auto &r : renderables) {
+    for (const auto &r : renderables) {
       const auto layer_area = r.screen_position().width() * r.screen_position().height();
       // We always prioritize layers which are lower in the list we got
       // from SurfaceFlinger as they are already ordered.
@@ -72,15 +72,9 @@ std::map<std::shared_ptr<wm::Window>, RenderableList> MultiWindowComposerStrateg
           r.screen_position().right() - new_window_frame.left() + r.crop().left(),
           r.screen_position().bottom() - new_window_frame.top() + r.crop().top()};
 
-      auto new_renderable = r;
-      new_renderable.set_screen_position(rect);
-      final_renderables.push_back(new_renderable);
+      r.set_screen_position(rect);
     }
-
-    w.second = final_renderables;
   }
-
-  return win_layers;
 }
 }  // namespace graphics
 }  // namespace anbox
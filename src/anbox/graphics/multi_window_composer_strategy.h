@@ -29,7 +29,8 @@ class MultiWindowComposerStrategy : public LayerComposer::Strategy {
   MultiWindowComposerStrategy(const std::shared_ptr<wm::Manager> &wm);
   ~MultiWindowComposerStrategy() = default;
 
-  WindowRenderableList process_layers(const RenderableList &renderables) override;
+  void process_layers(const RenderableList &renderables,
+                      WindowRenderableList &win_layers) override;
 
 private:
   std::shared_ptr<wm::Manager> wm_;
@@ -30,32 +30,51 @@
 namespace anbox {
 namespace graphics {
 emugl::Mutex OpenGlesMessageProcessor::global_lock{};
+constexpr const std::size_t OpenGlesMessageProcessor::shared_memory_ring_size;
 
 OpenGlesMessageProcessor::OpenGlesMessageProcessor(
     const std::shared_ptr<Renderer> &renderer,
-    const std::shared_ptr<network::SocketMessenger> &messenger)
+    const std::shared_ptr<RenderThreadPool> &render_threads,
+    const std::shared_ptr<network::SocketMessenger> &messenger,
+    std::uint32_t client_flags)
     : messenger_(messenger),
-      stream_(std::make_shared<BufferedIOStream>(messenger_)) {
-  // We have to read the client flags first before we can continue
-  // processing the actual commands
-  unsigned int client_flags = 0;
-  auto err = messenger_->receive_msg(
-      boost::asio::buffer(&client_flags, sizeof(unsigned int)));
-  if (err) ERROR("%s", err.message());
-
-  render_thread_.reset(RenderThread::create(renderer, stream_.get(), &global_lock));
-  if (!render_thread_->start())
+      input_(client_flags & IOSTREAM_CLIENT_SHARED_MEMORY ? create_input_ring() : nullptr),
+      stream_(std::make_shared<BufferedIOStream>(messenger_, BufferedIOStream::default_buffer_size, input_)) {
+  render_thread_ = render_threads->acquire(renderer, stream_.get(), &global_lock);
+  if (!render_thread_)
     BOOST_THROW_EXCEPTION(
         std::runtime_error("Failed to start renderer thread"));
 }
 
 OpenGlesMessageProcessor::~OpenGlesMessageProcessor() {
-  render_thread_->forceStop();
-  render_thread_->wait(nullptr);
+  // Stops serving our stream and hands the thread back to its pool
+  render_thread_.reset();
+}
+
+std::shared_ptr<common::SharedMemoryRing> OpenGlesMessageProcessor::create_input_ring() {
+  // The client waits for our reply before it continues. Without any file
+  // descriptors attached it falls back to sending everything through the
+  // socket.
+  try {
+    auto ring = common::SharedMemoryRing::create(shared_memory_ring_size);
+    messenger_->send_fds(ring->fds());
+    return ring;
+  } catch (const std::exception &err) {
+    WARNING("Failed to set up shared memory transport: %s", err.what());
+  }
+
+  const char reply = 0;
+  messenger_->send(&reply, sizeof(reply));
+  return nullptr;
 }
 
 bool OpenGlesMessageProcessor::process_data(
     const std::vector<std::uint8_t> &data) {
+  if (input_) {
+    ERROR("Client uses shared memory but sent %d bytes through the socket", data.size());
+    return false;
+  }
+
   auto stream = std::static_pointer_cast<BufferedIOStream>(stream_);
   Buffer buffer{data.data(), data.data() + data.size()};
   stream->post_data(std::move(buffer));
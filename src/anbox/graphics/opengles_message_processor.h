@@ -22,6 +22,7 @@
 
 #include <boost/asio.hpp>
 
+#include "anbox/common/shared_memory_ring.h"
 #include "anbox/network/message_processor.h"
 #include "anbox/network/socket_connection.h"
 #include "anbox/network/socket_messenger.h"
@@ -31,15 +32,23 @@
 
 class IOStream;
 class RenderThread;
+class RenderThreadPool;
 class Renderer;
 
 namespace anbox {
 namespace graphics {
 class OpenGlesMessageProcessor : public network::MessageProcessor {
  public:
+  // Size of the ring used for clients which asked for shared memory.
+  static constexpr const std::size_t shared_memory_ring_size{4 * 1024 * 1024};
+
+  // client_flags are the IOSTREAM_CLIENT_* flags a client sends right
+  // after its identifier.
   OpenGlesMessageProcessor(
       const std::shared_ptr<Renderer> &renderer,
-      const std::shared_ptr<network::SocketMessenger> &messenger);
+      const std::shared_ptr<RenderThreadPool> &render_threads,
+      const std::shared_ptr<network::SocketMessenger> &messenger,
+      std::uint32_t client_flags = 0);
   ~OpenGlesMessageProcessor();
 
   bool process_data(const std::vector<std::uint8_t> &data) override;
@@ -47,7 +56,10 @@ class OpenGlesMessageProcessor : public network::MessageProcessor {
  private:
   static emugl::Mutex global_lock;
 
+  std::shared_ptr<common::SharedMemoryRing> create_input_ring();
+
   std::shared_ptr<network::SocketMessenger> messenger_;
+  std::shared_ptr<common::SharedMemoryRing> input_;
   std::shared_ptr<IOStream> stream_;
   std::shared_ptr<RenderThread> render_thread_;
 };
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/graphics/render_scale.h"
+#include "anbox/logger.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace anbox {
+namespace graphics {
+constexpr float RenderScale::min_scale;
+constexpr float RenderScale::max_scale;
+
+std::shared_ptr<RenderScale> RenderScale::get() {
+  static auto instance = std::make_shared<RenderScale>();
+  return instance;
+}
+
+RenderScale::RenderScale() : scale_(max_scale) {}
+
+RenderScale::~RenderScale() {}
+
+bool RenderScale::set(float scale) {
+  if (!std::isfinite(scale) || scale < min_scale || scale > max_scale)
+    return false;
+
+  std::function<void(float)> handler;
+  {
+    std::lock_guard<decltype(lock_)> l(lock_);
+    if (scale == scale_) return true;
+    scale_ = scale;
+    handler = change_handler_;
+  }
+
+  DEBUG("Render scale changed to %f", scale);
+
+  if (handler) handler(scale);
+  return true;
+}
+
+float RenderScale::value() const {
+  std::lock_guard<decltype(lock_)> l(lock_);
+  return scale_;
+}
+
+void RenderScale::register_change_handler(const std::function<void(float)> &handler) {
+  std::lock_guard<decltype(lock_)> l(lock_);
+  change_handler_ = handler;
+}
+
+Rect RenderScale::guest_display_size(const Rect &display) const {
+  const auto scale = value();
+  auto scaled = [scale](std::int32_t length) {
+    return std::max<std::int32_t>(2, static_cast<std::int32_t>(std::lround(length * scale / 2.0f)) * 2);
+  };
+  return {0, 0, scaled(display.width()), scaled(display.height())};
+}
+
+int RenderScale::guest_density(int density) const {
+  return std::max(1, static_cast<int>(std::lround(density * value())));
+}
+
+namespace {
+// Maps rect from a display of size from to one of size to
+Rect map_rect(const Rect &rect, const Rect &from, const Rect &to) {
+  if (rect == Rect::Invalid || from.width() <= 0 || from.height() <= 0)
+    return rect;
+
+  const auto x = static_cast<double>(to.width()) / from.width();
+  const auto y = static_cast<double>(to.height()) / from.height();
+  return {static_cast<std::int32_t>(std::lround(rect.left() * x)),
+          static_cast<std::int32_t>(std::lround(rect.top() * y)),
+          static_cast<std::int32_t>(std::lround(rect.right() * x)),
+          static_cast<std::int32_t>(std::lround(rect.bottom() * y))};
+}
+}  // namespace
+
+Rect RenderScale::to_guest(const Rect &rect, const Rect &display) const {
+  return map_rect(rect, display, guest_display_size(display));
+}
+
+Rect RenderScale::to_host(const Rect &rect, const Rect &display) const {
+  return map_rect(rect, guest_display_size(display), display);
+}
+}  // namespace graphics
+}  // namespace anbox
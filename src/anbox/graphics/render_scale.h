@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_GRAPHICS_RENDER_SCALE_H_
+#define ANBOX_GRAPHICS_RENDER_SCALE_H_
+
+#include "anbox/graphics/rect.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace anbox {
+namespace graphics {
+// RenderScale defines how many pixels Android renders for every pixel of
+// the host display. Below 1 Android lays out and renders its windows at a
+// reduced resolution with an accordingly reduced density so that everything
+// keeps its size, and the buffers are upscaled when they are composed on the
+// host.
+class RenderScale {
+ public:
+  static constexpr float min_scale{0.25f};
+  static constexpr float max_scale{1.0f};
+
+  static std::shared_ptr<RenderScale> get();
+
+  RenderScale();
+  ~RenderScale();
+
+  // Returns false and leaves the scale untouched if it's out of range.
+  bool set(float scale);
+  float value() const;
+
+  // Called with the new scale whenever it changes.
+  void register_change_handler(const std::function<void(float)> &handler);
+
+  // Size of the display Android should use for a host display of the given
+  // size. Always a multiple of two to keep buffer strides aligned.
+  Rect guest_display_size(const Rect &display) const;
+  // Density Android should use to keep elements at the size they'd have
+  // with the given density at full resolution.
+  int guest_density(int density) const;
+
+  // Android lays out its tasks in the coordinates of the scaled display
+  // while host windows use the ones of the physical display. These convert
+  // rectangles between both for a host display of the given size.
+  // Rect::Invalid is passed through untouched.
+  Rect to_guest(const Rect &rect, const Rect &display) const;
+  Rect to_host(const Rect &rect, const Rect &display) const;
+
+ private:
+  mutable std::mutex lock_;
+  float scale_;
+  std::function<void(float)> change_handler_;
+};
+}  // namespace graphics
+}  // namespace anbox
+
+#endif
@@ -35,6 +35,12 @@ class Renderer {
   virtual bool draw(EGLNativeWindowType native_window,
                     const anbox::graphics::Rect& window_frame,
                     const RenderableList& renderables) = 0;
+
+  // All draw() calls between these two belong to the same frame and come
+  // from the same thread, which allows the renderer to stay on its context
+  // for all windows.
+  virtual void begin_composition() {}
+  virtual void end_composition() {}
 };
 }  // namespace graphics
 }  // namespace anbox
@@ -25,10 +25,11 @@
 
 #include <sys/socket.h>
 #include <cstdlib>
-#include <iostream>
 #include <string.h>
 #include <unistd.h>
 
+#include <thread>
+
 #define HWC_LAYER_NAME_MAX_LENGTH 128
 
 using namespace std;
@@ -101,7 +102,7 @@ int recv_native_handle(int fd, native_handle_t **handle, struct buffer_info_t *i
 
     if(recvmsg(fd, &socket_message, MSG_CMSG_CLOEXEC) < 0)
     {
-        if(errno != ETIMEDOUT && errno != EAGAIN) cerr << "recvmsg failed: " << strerror(errno) << endl;
+        if(errno != ETIMEDOUT && errno != EAGAIN) ERROR("recvmsg failed: %s", strerror(errno));
         free(*handle);
         *handle = NULL;
         return -1;
@@ -113,7 +114,7 @@ int recv_native_handle(int fd, native_handle_t **handle, struct buffer_info_t *i
 
     if((unsigned int)(*handle)->numFds > MAX_NUM_FDS)
     {
-        cerr << "too less space reserved for fds: " << (*handle)->numFds << " > " << MAX_NUM_FDS << endl;
+        ERROR("too less space reserved for fds: %d > %d", (*handle)->numFds, MAX_NUM_FDS);
         free(*handle);
         *handle = NULL;
         return -1;
@@ -121,7 +122,7 @@ int recv_native_handle(int fd, native_handle_t **handle, struct buffer_info_t *i
 
     if((unsigned int)(*handle)->numInts > MAX_NUM_INTS)
     {
-        cerr << "too less space reserved for ints: " << (*handle)->numInts << " > " << MAX_NUM_INTS << endl;
+        ERROR("too less space reserved for ints: %d > %d", (*handle)->numInts, MAX_NUM_INTS);
         free(*handle);
         *handle = NULL;
         return -1;
@@ -129,19 +130,19 @@ int recv_native_handle(int fd, native_handle_t **handle, struct buffer_info_t *i
 
     if(ints != (*handle)->numInts)
     {
-        cerr << "received wrong number of ints" << endl;
+        WARNING("received wrong number of ints");
     }
 
     if(fds != (*handle)->numFds)
     {
-        cerr << "received wrong number of fds" << endl;
+        WARNING("received wrong number of fds");
     }
 
     *handle = (native_handle_t*)realloc(*handle, sizeof(native_handle_t) + sizeof(int)*((*handle)->numFds + (*handle)->numInts));
 
     if(*handle == NULL)
     {
-        cerr << "not enough memory" << endl;
+        ERROR("not enough memory");
         return -1;
     }
 
@@ -149,7 +150,7 @@ int recv_native_handle(int fd, native_handle_t **handle, struct buffer_info_t *i
 
     if(socket_message.msg_flags & MSG_CTRUNC)
     {
-        cerr << "not enough space in the ancillary buffer" << endl;
+        ERROR("not enough space in the ancillary buffer");
         free(*handle);
         *handle = NULL;
         return -1;
@@ -182,14 +183,14 @@ intptr_t RenderThread::main() {
     if(fd >= 0) {
       while(!force_stop_) {
         if(recv(fd, &syncbyte, 1, 0) != 1) {
-            std::cout << "failed to read sync byte" << endl;
+            ERROR("failed to read sync byte");
             close(fd);
             fd = -1;
             break;
         }
 
         if(syncbyte != 0xAA) {
-            std::cout << "invalid sync byte" << endl;
+            ERROR("invalid sync byte");
             close(fd);
             fd = -1;
             break;
@@ -197,33 +198,33 @@ intptr_t RenderThread::main() {
 
         if(recv(fd, &num_of_fdsints[0], 2, 0) != 2)
         {
-            std::cout << "failed to read payload size" << endl;
+            ERROR("failed to read payload size");
             close(fd);
             fd = -1;
             break;
         }
 
         if(recv_native_handle(fd, &handle, &info, num_of_fdsints[0], num_of_fdsints[1]) == 0) {
-          std::cout << handle << std::endl;
           std::vector<Renderable> frame_layers;
           info.layer_name[HWC_LAYER_NAME_MAX_LENGTH - 1] = 0;
           frame_layers.push_back({info.layer_name, handle, info.width, info.height, info.stride, info.format});
 
           if (composer) {
-            std::cout << "submitting layer" << info.layer_name << std::endl;
-            composer->submit_layers(frame_layers);
+            TRACE("submitting layer %s", info.layer_name);
+            // Holding back our reply holds back the hwcomposer
+            std::this_thread::sleep_until(composer->submit_layers(frame_layers));
           }
 
           native_handle_close(handle);
 
           if(send(fd, &syncbyte, 1, 0) != 1) {
-              std::cout << "failed to tell hwcomposer that we're done" << std::endl;
+              ERROR("failed to tell hwcomposer that we're done");
               close(fd);
               fd = -1;
               break;
           }
         } else {
-            std::cout << "failed to recv native handle" << endl;
+            ERROR("failed to recv native handle");
             close(fd);
             fd = -1;
         }
@@ -16,8 +16,8 @@
 
 #include "Renderable.h"
 
-Renderable::Renderable(const std::string &name, void *buffer, int width, int height, int stride, int format)
-    : name_(name),
+Renderable::Renderable(const char *name, void *buffer, int width, int height, int stride, int format)
+    : layer_(anbox::graphics::LayerRegistry::get()->intern(name)),
       buffer_(buffer),
       width_(width),
       height_(height),
@@ -26,7 +26,9 @@ Renderable::Renderable(const std::string &name, void *buffer, int width, int hei
 
 Renderable::~Renderable() {}
 
-std::string Renderable::name() const { return name_; }
+std::string Renderable::name() const {
+  return anbox::graphics::LayerRegistry::get()->name_of(layer_.id);
+}
 
 void *Renderable::buffer() const { return buffer_; }
 
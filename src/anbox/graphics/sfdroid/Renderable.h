@@ -17,6 +17,7 @@
 #ifndef ANBOX_GRAPHICS_EMUGL_RENDERABLE_H_
 #define ANBOX_GRAPHICS_EMUGL_RENDERABLE_H_
 
+#include "anbox/graphics/layer_registry.h"
 #include "anbox/graphics/rect.h"
 
 #include <string>
@@ -26,10 +27,11 @@
 
 class Renderable {
  public:
-  Renderable(const std::string &name, void *buffer, int width, int height, int stride, int format);
+  Renderable(const char *name, void *buffer, int width, int height, int stride, int format);
   ~Renderable();
 
   std::string name() const;
+  const anbox::graphics::LayerRegistry::Info &layer() const { return layer_; }
   int width() const;
   int height() const;
   int stride() const;
@@ -43,7 +45,7 @@ class Renderable {
 
 
   inline bool operator==(const Renderable &rhs) const {
-    return (name_ == rhs.name() && buffer_ == rhs.buffer());
+    return (layer_.id == rhs.layer().id && buffer_ == rhs.buffer());
   }
 
   inline bool operator!=(const Renderable &rhs) const {
@@ -51,7 +53,7 @@ class Renderable {
   }
 
  private:
-  std::string name_;
+  anbox::graphics::LayerRegistry::Info layer_;
   anbox::graphics::Rect screen_position_;
   void *buffer_;
   int width_;
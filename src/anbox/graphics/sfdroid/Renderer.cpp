@@ -1,11 +1,10 @@
 #include "anbox/graphics/sfdroid/Renderer.h"
+#include "anbox/logger.h"
 
 #include <EGL/egl.h>
 
 #include "wayland-android-client-protocol.h"
 
-#include <iostream>
-
 using namespace std;
 
 struct RendererWindow {
@@ -160,7 +159,6 @@ bool Renderer::draw(EGLNativeWindowType native_window,
     buffer->handle = (native_handle_t*)renderables[0].buffer();
     buffer->common.incRef = dummy_f;
     buffer->common.decRef = dummy_f;
-    std::cout << " aaa " << renderables[0].buffer() << std::endl;
     static int (*pfn_eglHybrisWaylandPostBuffer)(EGLNativeWindowType, void*) = (int (*)(EGLNativeWindowType, void *))eglGetProcAddress("eglHybrisWaylandPostBuffer");
     pfn_eglHybrisWaylandPostBuffer(native_window, buffer);
 #endif
@@ -171,7 +169,7 @@ bool Renderer::draw(EGLNativeWindowType native_window,
     if((it = m_nativeWindows.find(native_window)) != m_nativeWindows.end()) {
         w_surface = it->second->surface;
     } else {
-        std::cerr << "surface not found" << std::endl;
+        ERROR("surface not found");
         return 1;
     }
 
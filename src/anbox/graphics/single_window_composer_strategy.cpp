@@ -17,34 +17,27 @@
 
 #include "anbox/graphics/single_window_composer_strategy.h"
 #include "anbox/wm/manager.h"
-#include "anbox/utils.h"
 #include "anbox/logger.h"
 
-namespace {
-const constexpr char *sprite_name{"Sprite"};
-}
-
 namespace anbox {
 namespace graphics {
 SingleWindowComposerStrategy::SingleWindowComposerStrategy(const std::shared_ptr<wm::Manager> &wm) : wm_(wm) {}
 
-std::map<std::shared_ptr<wm::Window>, RenderableList> SingleWindowComposerStrategy::process_layers(const RenderableList &renderables) {
-  WindowRenderableList win_layers;
+void SingleWindowComposerStrategy::process_layers(const RenderableList &renderables,
+                                                  WindowRenderableList &win_layers) {
   // FIXME there will be only one window in single-window mode ever so it
   // doesn't matter which task
   auto window = wm_->find_window_for_task(0);
+  if (!window) return;
 
   // Filter out any unwanted layers like the one responsible for the mouse
   // cursor which we don't want to render.
-  RenderableList final_renderables;
+  auto &final_renderables = renderables_for_window(win_layers, window);
   for (const auto &r : renderables) {
-    if (r.name() == sprite_name)
+    if (r.layer().blacklisted)
       continue;
     final_renderables.push_back(r);
   }
-
-  win_layers.insert({window, final_renderables});
-  return win_layers;
 }
 }  // namespace graphics
 }  // namespace anbox
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/headless/frame_ring.h"
+#include "anbox/common/sequence_lock.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <stdexcept>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+constexpr const std::uint32_t ring_magic{0x616e6662};
+constexpr const std::uint32_t ring_version{1};
+// Header and every slot start on their own page.
+constexpr const std::size_t page_size{4096};
+constexpr const std::size_t slot_header_size{64};
+constexpr const std::uint32_t bytes_per_pixel{4};
+// How often a consumer retries to read the latest frame when it raced
+// with the writer.
+constexpr const unsigned int max_read_attempts{3};
+
+std::size_t page_align(std::size_t size) {
+  return (size + page_size - 1) / page_size * page_size;
+}
+
+long futex(const std::atomic<std::uint32_t> *word, int op, std::uint32_t value,
+           const struct timespec *timeout) {
+  // The ring is shared between processes so we must not use the private
+  // futex operations here.
+  return ::syscall(SYS_futex, reinterpret_cast<const std::uint32_t*>(word), op,
+                   value, timeout, nullptr, 0);
+}
+}
+
+namespace anbox {
+namespace headless {
+constexpr const std::uint32_t FrameRing::default_slot_count;
+constexpr const std::uint32_t FrameRing::no_frame;
+
+struct FrameRing::Header {
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t slot_count;
+  Format format;
+  std::uint32_t max_width;
+  std::uint32_t max_height;
+  std::uint64_t slot_size;
+  std::uint64_t slot_stride;
+  std::atomic<std::uint32_t> latest_slot;
+  std::atomic<std::uint32_t> frame_count;
+};
+
+struct FrameRing::Slot {
+  common::SequenceLock lock;
+  std::int32_t x;
+  std::int32_t y;
+  std::uint32_t width;
+  std::uint32_t height;
+  std::uint32_t stride;
+  std::uint32_t reserved;
+  std::uint64_t timestamp;
+};
+
+std::shared_ptr<FrameRing> FrameRing::create(std::uint32_t max_width,
+                                             std::uint32_t max_height,
+                                             std::uint32_t slot_count) {
+  if (max_width == 0 || max_height == 0 || slot_count < 2)
+    BOOST_THROW_EXCEPTION(std::invalid_argument("Invalid frame ring size"));
+
+  const auto slot_size = static_cast<std::size_t>(max_width) * max_height * bytes_per_pixel;
+  const auto slot_stride = page_align(slot_header_size + slot_size);
+  const auto size = page_size + slot_stride * slot_count;
+
+  auto memory = common::SharedMemory::create("anbox-frames", size);
+
+  auto header = new (memory->data()) Header;
+  header->magic = ring_magic;
+  header->version = ring_version;
+  header->slot_count = slot_count;
+  header->format = Format::RGBA8888;
+  header->max_width = max_width;
+  header->max_height = max_height;
+  header->slot_size = slot_size;
+  header->slot_stride = slot_stride;
+  header->latest_slot.store(no_frame);
+  header->frame_count.store(0);
+
+  auto ring = std::shared_ptr<FrameRing>(new FrameRing(memory));
+  for (std::uint32_t n = 0; n < slot_count; n++) {
+    auto slot = new (ring->slot_at(n)) Slot;
+    slot->lock.reset();
+  }
+  return ring;
+}
+
+std::shared_ptr<FrameRing> FrameRing::attach(const Fd &fd) {
+  auto memory = common::SharedMemory::map(fd, common::SharedMemory::Access::read_only);
+  const auto size = memory->size();
+  if (size <= page_size)
+    BOOST_THROW_EXCEPTION(std::runtime_error("Shared memory too small for a frame ring"));
+
+  const auto header = static_cast<const Header*>(memory->data());
+  if (header->magic != ring_magic || header->version != ring_version ||
+      header->slot_count < 2 ||
+      header->slot_size != static_cast<std::uint64_t>(header->max_width) *
+                               header->max_height * bytes_per_pixel ||
+      header->slot_stride < slot_header_size + header->slot_size ||
+      page_size + header->slot_stride * header->slot_count != size)
+    BOOST_THROW_EXCEPTION(std::runtime_error("Shared memory doesn't contain a valid frame ring"));
+
+  return std::shared_ptr<FrameRing>(new FrameRing(memory));
+}
+
+FrameRing::FrameRing(const std::shared_ptr<common::SharedMemory> &memory)
+    : memory_(memory),
+      header_(static_cast<Header*>(memory->data())) {}
+
+const Fd& FrameRing::fd() const { return memory_->fd(); }
+
+std::uint32_t FrameRing::slot_count() const { return header_->slot_count; }
+
+std::size_t FrameRing::slot_size() const { return header_->slot_size; }
+
+std::uint32_t FrameRing::max_width() const { return header_->max_width; }
+
+std::uint32_t FrameRing::max_height() const { return header_->max_height; }
+
+std::uint32_t FrameRing::frame_count() const {
+  return header_->frame_count.load(std::memory_order_acquire);
+}
+
+FrameRing::Slot* FrameRing::slot_at(std::uint32_t slot) const {
+  return reinterpret_cast<Slot*>(static_cast<std::uint8_t*>(memory_->data()) + page_size +
+                                 header_->slot_stride * slot);
+}
+
+std::uint8_t* FrameRing::begin_write() {
+  // The slot after the latest one is the one consumers are least likely
+  // to still read from.
+  const auto latest = header_->latest_slot.load(std::memory_order_relaxed);
+  const auto slot = latest == no_frame ? 0 : (latest + 1) % header_->slot_count;
+
+  slot_at(slot)->lock.begin_write();
+  return reinterpret_cast<std::uint8_t*>(slot_at(slot)) + slot_header_size;
+}
+
+void FrameRing::end_write(std::int32_t x, std::int32_t y, std::uint32_t width,
+                          std::uint32_t height, std::uint32_t stride) {
+  const auto latest = header_->latest_slot.load(std::memory_order_relaxed);
+  const auto slot = latest == no_frame ? 0 : (latest + 1) % header_->slot_count;
+
+  struct timespec now;
+  ::clock_gettime(CLOCK_MONOTONIC, &now);
+
+  auto s = slot_at(slot);
+  s->x = x;
+  s->y = y;
+  s->width = width;
+  s->height = height;
+  s->stride = stride;
+  s->timestamp = static_cast<std::uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec;
+  s->lock.end_write();
+
+  header_->latest_slot.store(slot, std::memory_order_release);
+  header_->frame_count.fetch_add(1, std::memory_order_release);
+  futex(&header_->frame_count, FUTEX_WAKE, INT_MAX, nullptr);
+}
+
+bool FrameRing::read_slot(std::uint32_t slot, std::uint8_t *out, FrameInfo &info) const {
+  const auto s = slot_at(slot);
+  std::uint64_t before = 0;
+  if (!s->lock.begin_read(before)) return false;
+
+  info.sequence = before;
+  info.x = s->x;
+  info.y = s->y;
+  info.width = s->width;
+  info.height = s->height;
+  info.stride = s->stride;
+  info.timestamp = std::chrono::nanoseconds{s->timestamp};
+
+  const auto size = static_cast<std::uint64_t>(info.stride) * info.height;
+  if (info.stride < info.width * bytes_per_pixel || size > header_->slot_size)
+    return false;
+
+  std::memcpy(out, reinterpret_cast<const std::uint8_t*>(s) + slot_header_size, size);
+
+  return s->lock.end_read(before);
+}
+
+bool FrameRing::read_latest(std::uint8_t *out, FrameInfo &info) const {
+  for (unsigned int n = 0; n < max_read_attempts; n++) {
+    const auto slot = header_->latest_slot.load(std::memory_order_acquire);
+    if (slot >= header_->slot_count) return false;
+    if (read_slot(slot, out, info)) return true;
+  }
+  return false;
+}
+
+std::uint32_t FrameRing::wait_for_frame(std::uint32_t last_count,
+                                        const std::chrono::milliseconds &timeout) const {
+  struct timespec ts;
+  ts.tv_sec = timeout.count() / 1000;
+  ts.tv_nsec = (timeout.count() % 1000) * 1000000;
+
+  // A changed frame count makes the kernel return right away, so we can't
+  // miss a frame published between our check and the wait.
+  if (frame_count() == last_count)
+    futex(&header_->frame_count, FUTEX_WAIT, last_count, &ts);
+  return frame_count();
+}
+}  // namespace headless
+}  // namespace anbox
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_HEADLESS_FRAME_RING_H_
+#define ANBOX_HEADLESS_FRAME_RING_H_
+
+#include "anbox/common/fd.h"
+#include "anbox/common/shared_memory.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace anbox {
+namespace headless {
+// FrameRing publishes the composed frames of a window through a memfd which
+// consumers map read-only into their own process. It holds three slots so
+// the renderer never waits for a consumer: it always writes the slot after
+// the latest published one while consumers read the latest one. Each slot
+// is guarded by a common::SequenceLock, so a slow consumer which raced with
+// the writer notices it and retries. Consumers wait for new frames with a
+// futex on the frame counter in the ring header.
+//
+// Memory layout (all integers in host byte order):
+//   page 0: header { u32 magic 'anfb', u32 version, u32 slot_count,
+//                    u32 format, u32 max_width, u32 max_height,
+//                    u64 slot_size, u64 slot_stride,
+//                    u32 latest_slot, u32 frame_count }
+//   slot n at 4096 + n * slot_stride:
+//           { u64 sequence, i32 x, i32 y, u32 width, u32 height,
+//             u32 stride, u32 reserved, u64 timestamp_ns }
+//           pixels start 64 bytes into the slot
+class FrameRing {
+ public:
+  static constexpr const std::uint32_t default_slot_count{3};
+  static constexpr const std::uint32_t no_frame{0xffffffff};
+
+  enum class Format : std::uint32_t {
+    RGBA8888 = 1,
+  };
+
+  struct FrameInfo {
+    FrameInfo() : sequence(0), x(0), y(0), width(0), height(0), stride(0), timestamp(0) {}
+
+    std::uint64_t sequence;
+    std::int32_t x;
+    std::int32_t y;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t stride;
+    // CLOCK_MONOTONIC time the frame was published at
+    std::chrono::nanoseconds timestamp;
+  };
+
+  static std::shared_ptr<FrameRing> create(
+      std::uint32_t max_width, std::uint32_t max_height,
+      std::uint32_t slot_count = default_slot_count);
+  // Maps an existing ring read-only as consumers do.
+  static std::shared_ptr<FrameRing> attach(const Fd &memory);
+
+  const Fd &fd() const;
+  std::uint32_t slot_count() const;
+  std::size_t slot_size() const;
+  std::uint32_t max_width() const;
+  std::uint32_t max_height() const;
+
+  // Number of frames published so far. Wraps around.
+  std::uint32_t frame_count() const;
+
+  // Returns the memory the next frame is written to. Rows of it are
+  // max_width() * 4 bytes apart at most.
+  std::uint8_t* begin_write();
+  // Publishes the frame written since begin_write and wakes up waiting
+  // consumers.
+  void end_write(std::int32_t x, std::int32_t y, std::uint32_t width,
+                 std::uint32_t height, std::uint32_t stride);
+
+  // Copies the latest frame into out which must provide slot_size() bytes.
+  // Returns false if no frame was published yet or the writer kept
+  // overwriting the frame while it was copied.
+  bool read_latest(std::uint8_t *out, FrameInfo &info) const;
+
+  // Blocks until frame_count() differs from last_count or the timeout
+  // expired. Returns the current frame count.
+  std::uint32_t wait_for_frame(std::uint32_t last_count,
+                               const std::chrono::milliseconds &timeout) const;
+
+ private:
+  struct Header;
+  struct Slot;
+
+  explicit FrameRing(const std::shared_ptr<common::SharedMemory> &memory);
+
+  Slot *slot_at(std::uint32_t slot) const;
+  bool read_slot(std::uint32_t slot, std::uint8_t *out, FrameInfo &info) const;
+
+  std::shared_ptr<common::SharedMemory> memory_;
+  Header *header_;
+};
+}  // namespace headless
+}  // namespace anbox
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/headless/frame_server.h"
+#include "anbox/headless/frame_ring.h"
+#include "anbox/network/delegate_connection_creator.h"
+#include "anbox/network/local_socket_messenger.h"
+#include "anbox/network/published_socket_connector.h"
+#include "anbox/config.h"
+#include "anbox/logger.h"
+#include "anbox/utils.h"
+
+#include <algorithm>
+
+using namespace std::placeholders;
+
+namespace anbox {
+namespace headless {
+FrameServer::FrameServer(const std::shared_ptr<Runtime> &rt,
+                         std::uint32_t display_width,
+                         std::uint32_t display_height)
+    : display_width_(display_width),
+      display_height_(display_height),
+      socket_file_(utils::string_format("%s/anbox_frames", SystemConfiguration::instance().socket_dir())),
+      connector_(std::make_shared<network::PublishedSocketConnector>(
+          socket_file_, rt,
+          std::make_shared<network::DelegateConnectionCreator<boost::asio::local::stream_protocol>>(
+              std::bind(&FrameServer::create_connection_for, this, _1)))) {}
+
+FrameServer::~FrameServer() {}
+
+namespace {
+// Messages are small enough for the socket buffer to take them at once.
+// A consumer which doesn't keep up fills its buffer and instead of waiting
+// for it while everyone else is blocked on the lock it gets disconnected.
+// This is also what happens if only a part of a message was sent as the
+// stream is no longer usable then.
+bool send_message(network::LocalSocketMessenger &client, const FrameServer::Message &message) {
+  return client.send_raw(reinterpret_cast<const char*>(&message), sizeof(message)) ==
+         static_cast<ssize_t>(sizeof(message));
+}
+}  // namespace
+
+void FrameServer::create_connection_for(std::shared_ptr<boost::asio::basic_stream_socket<
+                                        boost::asio::local::stream_protocol>> const& socket) {
+  auto client = std::make_shared<network::LocalSocketMessenger>(socket);
+
+  std::lock_guard<std::mutex> l(lock_);
+  const Message display{Message::Type::display, 0, wm::Task::Invalid,
+                        display_width_, display_height_, 0};
+  if (!send_message(*client, display)) {
+    WARNING("Failed to send display to frame consumer");
+    client->close();
+    return;
+  }
+
+  for (const auto &window : windows_) {
+    if (!send_window_added(*client, window.first, window.second)) {
+      client->close();
+      return;
+    }
+  }
+
+  clients_.push_back(client);
+}
+
+bool FrameServer::send_window_added(network::LocalSocketMessenger &client, std::uint32_t id,
+                                    const WindowInfo &info) {
+  const Message message{Message::Type::window_added, id, info.task,
+                        info.ring->max_width(), info.ring->max_height(), 0};
+  try {
+    if (send_message(client, message)) {
+      // A single sendmsg() which fails instead of blocking on a full socket
+      client.send_fds({info.ring->fd()});
+      return true;
+    }
+  } catch (const std::exception &err) {
+    WARNING("Failed to hand the frame ring of window %d to frame consumer: %s", id, err.what());
+    return false;
+  }
+  WARNING("Failed to announce window %d to frame consumer", id);
+  return false;
+}
+
+void FrameServer::broadcast_locked(const std::function<bool(network::LocalSocketMessenger&)> &send) {
+  // Consumers which went away or are too slow are only noticed when we
+  // fail to send to them
+  clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+                                [&](const std::shared_ptr<network::LocalSocketMessenger> &client) {
+                                  if (send(*client)) return false;
+                                  client->close();
+                                  return true;
+                                }),
+                 clients_.end());
+}
+
+void FrameServer::add_window(std::uint32_t id, const wm::Task::Id &task,
+                             const std::shared_ptr<FrameRing> &ring) {
+  std::lock_guard<std::mutex> l(lock_);
+  const auto info = WindowInfo{task, ring};
+  windows_[id] = info;
+  broadcast_locked([&](network::LocalSocketMessenger &client) {
+    return send_window_added(client, id, info);
+  });
+}
+
+void FrameServer::remove_window(std::uint32_t id) {
+  std::lock_guard<std::mutex> l(lock_);
+  if (windows_.erase(id) == 0) return;
+
+  const Message message{Message::Type::window_removed, id, wm::Task::Invalid, 0, 0, 0};
+  broadcast_locked([&](network::LocalSocketMessenger &client) {
+    return send_message(client, message);
+  });
+}
+}  // namespace headless
+}  // namespace anbox
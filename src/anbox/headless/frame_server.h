@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_HEADLESS_FRAME_SERVER_H_
+#define ANBOX_HEADLESS_FRAME_SERVER_H_
+
+#include "anbox/runtime.h"
+#include "anbox/wm/task.h"
+
+#include <boost/asio/local/stream_protocol.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace anbox {
+namespace network {
+class LocalSocketMessenger;
+class PublishedSocketConnector;
+}  // namespace network
+namespace headless {
+class FrameRing;
+// FrameServer tells consumers connected to its socket which windows exist
+// and hands them the frame ring of every window. Frames themselves never
+// go through the socket: consumers wait on the ring for new ones.
+//
+// Every message is a Message struct. On connect the server sends a display
+// message and a window_added message for every existing window. Each
+// window_added message is followed by a single byte carrying the memfd of
+// the window's frame ring as SCM_RIGHTS ancillary data.
+class FrameServer {
+ public:
+  struct Message {
+    enum class Type : std::uint32_t {
+      display = 1,
+      window_added = 2,
+      window_removed = 3,
+    };
+
+    Type type;
+    std::uint32_t window;
+    std::int32_t task;
+    // Size of the display for display messages, the maximum frame size for
+    // window_added messages.
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t reserved;
+  };
+
+  FrameServer(const std::shared_ptr<Runtime> &rt, std::uint32_t display_width,
+              std::uint32_t display_height);
+  ~FrameServer();
+
+  std::string socket_file() const { return socket_file_; }
+
+  void add_window(std::uint32_t id, const wm::Task::Id &task,
+                  const std::shared_ptr<FrameRing> &ring);
+  void remove_window(std::uint32_t id);
+
+ private:
+  struct WindowInfo {
+    wm::Task::Id task;
+    std::shared_ptr<FrameRing> ring;
+  };
+
+  void create_connection_for(std::shared_ptr<boost::asio::basic_stream_socket<
+                             boost::asio::local::stream_protocol>> const& socket);
+  bool send_window_added(network::LocalSocketMessenger &client, std::uint32_t id,
+                         const WindowInfo &info);
+  void broadcast_locked(const std::function<bool(network::LocalSocketMessenger&)> &send);
+
+  const std::uint32_t display_width_;
+  const std::uint32_t display_height_;
+  std::string socket_file_;
+  std::shared_ptr<network::PublishedSocketConnector> connector_;
+  std::mutex lock_;
+  std::map<std::uint32_t, WindowInfo> windows_;
+  std::vector<std::shared_ptr<network::LocalSocketMessenger>> clients_;
+};
+}  // namespace headless
+}  // namespace anbox
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/headless/input_server.h"
+#include "anbox/headless/input_translator.h"
+#include "anbox/input/device.h"
+#include "anbox/network/delegate_connection_creator.h"
+#include "anbox/network/local_socket_messenger.h"
+#include "anbox/network/message_processor.h"
+#include "anbox/network/published_socket_connector.h"
+#include "anbox/config.h"
+#include "anbox/logger.h"
+#include "anbox/utils.h"
+
+using namespace std::placeholders;
+
+namespace {
+// Longest line we accept before we consider the client broken
+constexpr const std::size_t max_line_length{256};
+
+class InputCommandProcessor : public anbox::network::MessageProcessor {
+ public:
+  InputCommandProcessor(const std::shared_ptr<anbox::input::Device> &pointer,
+                        const std::shared_ptr<anbox::input::Device> &keyboard) :
+    pointer_(pointer), keyboard_(keyboard) {}
+
+  bool process_data(const std::vector<std::uint8_t> &data) override {
+    for (const auto c : data) {
+      if (c != '\n') {
+        line_.push_back(static_cast<char>(c));
+        if (line_.size() > max_line_length) {
+          ERROR("Input command too long; dropping client");
+          return false;
+        }
+        continue;
+      }
+
+      if (!translator_.translate(line_, pointer_events_, keyboard_events_))
+        WARNING("Ignoring invalid input command '%s'", line_);
+      line_.clear();
+    }
+
+    // Everything a single read returned is sent in one batch
+    if (!pointer_events_.empty())
+      pointer_->send_events(pointer_events_);
+    if (!keyboard_events_.empty())
+      keyboard_->send_events(keyboard_events_);
+    pointer_events_.clear();
+    keyboard_events_.clear();
+    return true;
+  }
+
+ private:
+  std::shared_ptr<anbox::input::Device> pointer_;
+  std::shared_ptr<anbox::input::Device> keyboard_;
+  anbox::headless::InputTranslator translator_;
+  std::string line_;
+  std::vector<anbox::input::Event> pointer_events_;
+  std::vector<anbox::input::Event> keyboard_events_;
+};
+}
+
+namespace anbox {
+namespace headless {
+InputServer::InputServer(const std::shared_ptr<Runtime> &rt,
+                         const std::shared_ptr<input::Device> &pointer,
+                         const std::shared_ptr<input::Device> &keyboard)
+    : pointer_(pointer),
+      keyboard_(keyboard),
+      socket_file_(utils::string_format("%s/anbox_input", SystemConfiguration::instance().socket_dir())),
+      connector_(std::make_shared<network::PublishedSocketConnector>(
+          socket_file_, rt,
+          std::make_shared<network::DelegateConnectionCreator<boost::asio::local::stream_protocol>>(
+              std::bind(&InputServer::create_connection_for, this, _1)))),
+      connections_(std::make_shared<network::Connections<network::SocketConnection>>()),
+      next_id_(0) {}
+
+InputServer::~InputServer() {}
+
+void InputServer::create_connection_for(std::shared_ptr<boost::asio::basic_stream_socket<
+                                        boost::asio::local::stream_protocol>> const& socket) {
+  auto const messenger = std::make_shared<network::LocalSocketMessenger>(socket);
+  auto const processor = std::make_shared<InputCommandProcessor>(pointer_, keyboard_);
+  auto const connection = std::make_shared<network::SocketConnection>(
+      messenger, messenger, next_id_.fetch_add(1), connections_, processor);
+  connection->set_name("headless-input");
+  connections_->add(connection);
+  connection->read_next_message();
+}
+}  // namespace headless
+}  // namespace anbox
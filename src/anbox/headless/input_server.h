@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_HEADLESS_INPUT_SERVER_H_
+#define ANBOX_HEADLESS_INPUT_SERVER_H_
+
+#include "anbox/runtime.h"
+#include "anbox/network/socket_connection.h"
+
+#include <boost/asio/local/stream_protocol.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace anbox {
+namespace input {
+class Device;
+}  // namespace input
+namespace network {
+class PublishedSocketConnector;
+}  // namespace network
+namespace headless {
+// InputServer lets clients inject input into a headless session by writing
+// the commands understood by InputTranslator to its socket.
+class InputServer {
+ public:
+  InputServer(const std::shared_ptr<Runtime> &rt,
+              const std::shared_ptr<input::Device> &pointer,
+              const std::shared_ptr<input::Device> &keyboard);
+  ~InputServer();
+
+  std::string socket_file() const { return socket_file_; }
+
+ private:
+  void create_connection_for(std::shared_ptr<boost::asio::basic_stream_socket<
+                             boost::asio::local::stream_protocol>> const& socket);
+
+  std::shared_ptr<input::Device> pointer_;
+  std::shared_ptr<input::Device> keyboard_;
+  std::string socket_file_;
+  std::shared_ptr<network::PublishedSocketConnector> connector_;
+  std::shared_ptr<network::Connections<network::SocketConnection>> const connections_;
+  std::atomic<int> next_id_;
+};
+}  // namespace headless
+}  // namespace anbox
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/headless/input_translator.h"
+
+#include <linux/input.h>
+
+#include <sstream>
+
+namespace anbox {
+namespace headless {
+InputTranslator::InputTranslator() : x_(0), y_(0) {}
+
+void InputTranslator::move_to(std::int32_t x, std::int32_t y,
+                              std::vector<input::Event> &events) {
+  // Same as for the SDL based platform: the absolute position is what
+  // counts, the relative one just tells InputReader the cursor moved.
+  events.push_back({EV_ABS, ABS_X, x});
+  events.push_back({EV_ABS, ABS_Y, y});
+  events.push_back({EV_REL, REL_X, x - x_});
+  events.push_back({EV_REL, REL_Y, y - y_});
+  x_ = x;
+  y_ = y;
+}
+
+bool InputTranslator::translate(const std::string &line,
+                                std::vector<input::Event> &pointer_events,
+                                std::vector<input::Event> &keyboard_events) {
+  std::istringstream in{line};
+  std::string command;
+  if (!(in >> command)) return false;
+
+  std::int32_t first = 0, second = 0;
+  if (command == "move" || command == "down" || command == "up" || command == "tap") {
+    if (!(in >> first >> second) || first < 0 || second < 0) return false;
+
+    move_to(first, second, pointer_events);
+    if (command == "down" || command == "tap")
+      pointer_events.push_back({EV_KEY, BTN_LEFT, 1});
+    if (command == "tap")
+      pointer_events.push_back({EV_SYN, SYN_REPORT, 0});
+    if (command == "up" || command == "tap")
+      pointer_events.push_back({EV_KEY, BTN_LEFT, 0});
+    pointer_events.push_back({EV_SYN, SYN_REPORT, 0});
+    return true;
+  }
+
+  if (command == "wheel") {
+    if (!(in >> first)) return false;
+    pointer_events.push_back({EV_REL, REL_WHEEL, first});
+    pointer_events.push_back({EV_SYN, SYN_REPORT, 0});
+    return true;
+  }
+
+  if (command == "key" || command == "keydown" || command == "keyup") {
+    if (!(in >> first) || first <= KEY_RESERVED || first > KEY_MAX) return false;
+
+    const auto code = static_cast<std::uint16_t>(first);
+    if (command != "keyup")
+      keyboard_events.push_back({EV_KEY, code, 1});
+    if (command != "keydown")
+      keyboard_events.push_back({EV_KEY, code, 0});
+    return true;
+  }
+
+  return false;
+}
+}  // namespace headless
+}  // namespace anbox
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_HEADLESS_INPUT_TRANSLATOR_H_
+#define ANBOX_HEADLESS_INPUT_TRANSLATOR_H_
+
+#include "anbox/input/event_queue.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace anbox {
+namespace headless {
+// InputTranslator turns the text commands clients write to the input socket
+// of a headless session into evdev events for the pointer and keyboard
+// devices. Every line holds one command:
+//
+//   move <x> <y>        move the pointer to the given display position
+//   down <x> <y>        move the pointer and press the button
+//   up <x> <y>          move the pointer and release the button
+//   tap <x> <y>         down followed by up
+//   wheel <steps>       scroll vertically
+//   key <code>          press and release a linux key code
+//   keydown <code>      press a linux key code
+//   keyup <code>        release a linux key code
+class InputTranslator {
+ public:
+  InputTranslator();
+
+  // Returns false if the line isn't a valid command. Events are only
+  // added for valid commands.
+  bool translate(const std::string &line, std::vector<input::Event> &pointer_events,
+                 std::vector<input::Event> &keyboard_events);
+
+ private:
+  void move_to(std::int32_t x, std::int32_t y, std::vector<input::Event> &events);
+
+  std::int32_t x_;
+  std::int32_t y_;
+};
+}  // namespace headless
+}  // namespace anbox
+
+#endif
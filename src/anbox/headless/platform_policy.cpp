@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/headless/platform_policy.h"
+#include "anbox/headless/frame_ring.h"
+#include "anbox/headless/frame_server.h"
+#include "anbox/headless/input_server.h"
+#include "anbox/headless/window.h"
+#include "anbox/audio/client_info.h"
+#include "anbox/audio/sink.h"
+#include "anbox/input/device.h"
+#include "anbox/input/manager.h"
+#include "anbox/logger.h"
+
+#include <chrono>
+#include <thread>
+
+namespace {
+// Nobody listens to a headless session, but the audio still has to be
+// consumed at the rate it plays at. Otherwise Android's mixer would run as
+// fast as it can.
+class DiscardingAudioSink : public anbox::audio::Sink {
+ public:
+  explicit DiscardingAudioSink(const anbox::audio::StreamConfig &config) :
+    bytes_per_second_(config.sample_rate * config.channels * bytes_per_sample(config.format)),
+    deadline_(std::chrono::steady_clock::now()) {}
+
+  void write_data(const std::vector<std::uint8_t> &data) override {
+    const auto now = std::chrono::steady_clock::now();
+    if (deadline_ < now) deadline_ = now;
+    deadline_ += std::chrono::microseconds{
+        static_cast<std::int64_t>(data.size()) * 1000000 / bytes_per_second_};
+    std::this_thread::sleep_until(deadline_);
+  }
+
+ private:
+  static std::uint32_t bytes_per_sample(anbox::audio::StreamConfig::Format format) {
+    switch (format) {
+    case anbox::audio::StreamConfig::Format::U8:
+      return 1;
+    case anbox::audio::StreamConfig::Format::S32:
+    case anbox::audio::StreamConfig::Format::Float:
+      return 4;
+    default:
+      return 2;
+    }
+  }
+
+  const std::int64_t bytes_per_second_;
+  std::chrono::steady_clock::time_point deadline_;
+};
+}
+
+namespace anbox {
+namespace headless {
+PlatformPolicy::PlatformPolicy(const std::shared_ptr<Runtime> &rt,
+                               const std::shared_ptr<input::Manager> &input_manager,
+                               const graphics::Rect &display_frame)
+    : display_frame_(display_frame),
+      next_window_id_(0) {
+  pointer_ = input_manager->create_device();
+  pointer_->set_name("anbox-pointer");
+  pointer_->set_driver_version(1);
+  pointer_->set_input_id({BUS_VIRTUAL, 2, 2, 2});
+  pointer_->set_physical_location("none");
+  pointer_->set_key_bit(BTN_MOUSE);
+  pointer_->set_rel_bit(REL_X);
+  pointer_->set_rel_bit(REL_Y);
+  pointer_->set_rel_bit(REL_HWHEEL);
+  pointer_->set_rel_bit(REL_WHEEL);
+  pointer_->set_prop_bit(INPUT_PROP_POINTER);
+
+  keyboard_ = input_manager->create_device();
+  keyboard_->set_name("anbox-keyboard");
+  keyboard_->set_driver_version(1);
+  keyboard_->set_input_id({BUS_VIRTUAL, 3, 3, 3});
+  keyboard_->set_physical_location("none");
+  keyboard_->set_key_bit(BTN_MISC);
+  keyboard_->set_key_bit(KEY_OK);
+
+  frame_server_ = std::make_shared<FrameServer>(rt, display_frame_.width(), display_frame_.height());
+  input_server_ = std::make_shared<InputServer>(rt, pointer_, keyboard_);
+
+  INFO("Running headless with a %dx%d display; frames are published on %s and input is read from %s",
+       display_frame_.width(), display_frame_.height(),
+       frame_server_->socket_file(), input_server_->socket_file());
+}
+
+PlatformPolicy::~PlatformPolicy() {}
+
+void PlatformPolicy::set_renderer(const std::shared_ptr<Renderer> &renderer) {
+  renderer_ = renderer;
+}
+
+std::shared_ptr<wm::Window> PlatformPolicy::create_window(
+    const anbox::wm::Task::Id &task, const anbox::graphics::Rect &frame, const std::string &title) {
+  if (!renderer_) {
+    ERROR("Can't create window without a renderer set");
+    return nullptr;
+  }
+
+  try {
+    const auto ring = FrameRing::create(display_frame_.width(), display_frame_.height());
+    return std::make_shared<Window>(renderer_, next_window_id_.fetch_add(1), task,
+                                    frame, title, ring, frame_server_);
+  } catch (const std::exception &err) {
+    ERROR("Failed to create window for task %d: %s", task, err.what());
+  }
+  return nullptr;
+}
+
+DisplayManager::DisplayInfo PlatformPolicy::display_info() const {
+  DisplayManager::DisplayInfo info;
+  info.horizontal_resolution = display_frame_.width();
+  info.vertical_resolution = display_frame_.height();
+  return info;
+}
+
+void PlatformPolicy::set_clipboard_data(const ClipboardData &data) {
+  std::lock_guard<std::mutex> l(clipboard_lock_);
+  clipboard_ = data;
+}
+
+PlatformPolicy::ClipboardData PlatformPolicy::get_clipboard_data() {
+  std::lock_guard<std::mutex> l(clipboard_lock_);
+  return clipboard_;
+}
+
+std::shared_ptr<audio::Sink> PlatformPolicy::create_audio_sink(const audio::StreamConfig &config) {
+  return std::make_shared<DiscardingAudioSink>(config);
+}
+
+std::shared_ptr<audio::Source> PlatformPolicy::create_audio_source() {
+  ERROR("Not implemented");
+  return nullptr;
+}
+}  // namespace headless
+}  // namespace anbox
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_HEADLESS_PLATFORM_POLICY_H_
+#define ANBOX_HEADLESS_PLATFORM_POLICY_H_
+
+#include "anbox/graphics/emugl/DisplayManager.h"
+#include "anbox/platform/policy.h"
+#include "anbox/runtime.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace anbox {
+namespace input {
+class Device;
+class Manager;
+}  // namespace input
+namespace headless {
+class FrameServer;
+class InputServer;
+// PlatformPolicy for sessions without a display. Windows are rendered
+// offscreen and published through the FrameServer socket, input comes in
+// through the InputServer socket. Both sockets live in the socket directory
+// of the instance so many headless sessions can run on one host.
+class PlatformPolicy : public platform::Policy,
+                       public DisplayManager {
+ public:
+  PlatformPolicy(const std::shared_ptr<Runtime> &rt,
+                 const std::shared_ptr<input::Manager> &input_manager,
+                 const graphics::Rect &display_frame);
+  ~PlatformPolicy();
+
+  std::shared_ptr<wm::Window> create_window(
+      const anbox::wm::Task::Id &task,
+      const anbox::graphics::Rect &frame,
+      const std::string &title) override;
+
+  void set_renderer(const std::shared_ptr<Renderer> &renderer) override;
+
+  DisplayInfo display_info() const override;
+
+  void set_clipboard_data(const ClipboardData &data) override;
+  ClipboardData get_clipboard_data() override;
+
+  std::shared_ptr<audio::Sink> create_audio_sink(const audio::StreamConfig &config) override;
+  std::shared_ptr<audio::Source> create_audio_source() override;
+
+ private:
+  std::shared_ptr<Renderer> renderer_;
+  graphics::Rect display_frame_;
+  std::shared_ptr<input::Device> pointer_;
+  std::shared_ptr<input::Device> keyboard_;
+  std::shared_ptr<FrameServer> frame_server_;
+  std::shared_ptr<InputServer> input_server_;
+  std::atomic<std::uint32_t> next_window_id_;
+  std::mutex clipboard_lock_;
+  ClipboardData clipboard_;
+};
+}  // namespace headless
+}  // namespace anbox
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/headless/window.h"
+#include "anbox/headless/frame_ring.h"
+#include "anbox/headless/frame_server.h"
+#include "anbox/graphics/emugl/Renderer.h"
+#include "anbox/logger.h"
+
+namespace {
+constexpr const std::uint32_t bytes_per_pixel{4};
+}
+
+namespace anbox {
+namespace headless {
+Window::Window(const std::shared_ptr<Renderer> &renderer, const Id &id,
+               const wm::Task::Id &task, const graphics::Rect &frame,
+               const std::string &title, const std::shared_ptr<FrameRing> &ring,
+               const std::shared_ptr<FrameServer> &server)
+    : wm::Window(renderer, task, frame, title),
+      renderer_(renderer),
+      id_(id),
+      ring_(ring),
+      server_(server) {
+  server_->add_window(id_, task, ring_);
+}
+
+Window::~Window() {
+  release();
+  server_->remove_window(id_);
+}
+
+bool Window::attach() {
+  if (!renderer_) return false;
+  attached_ = renderer_->createOffscreenWindow(native_handle(), frame().width(),
+                                               frame().height(), this) != nullptr;
+  return attached_;
+}
+
+void Window::release() {
+  if (!renderer_ || !attached_) return;
+  renderer_->destroyNativeWindow(native_handle());
+  attached_ = false;
+}
+
+EGLNativeWindowType Window::native_handle() const {
+  // There is no native window behind us, the renderer only needs a handle
+  // which is unique for every window. Zero is used for no window.
+  return (EGLNativeWindowType) static_cast<std::uintptr_t>(id_ + 1);
+}
+
+std::uint8_t* Window::begin_frame(std::uint32_t width, std::uint32_t height) {
+  if (width > ring_->max_width() || height > ring_->max_height()) {
+    if (!oversized_frame_reported_)
+      WARNING("Window %d is larger than the display (%dx%d); dropping its frames",
+              id_, width, height);
+    oversized_frame_reported_ = true;
+    return nullptr;
+  }
+  oversized_frame_reported_ = false;
+  return ring_->begin_write();
+}
+
+void Window::end_frame(std::uint32_t width, std::uint32_t height) {
+  const auto position = frame();
+  ring_->end_write(position.left(), position.top(), width, height,
+                   width * bytes_per_pixel);
+}
+}  // namespace headless
+}  // namespace anbox
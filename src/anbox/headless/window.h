@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_HEADLESS_WINDOW_H_
+#define ANBOX_HEADLESS_WINDOW_H_
+
+#include "anbox/graphics/frame_sink.h"
+#include "anbox/wm/window.h"
+
+#include <memory>
+
+class Renderer;
+
+namespace anbox {
+namespace headless {
+class FrameRing;
+class FrameServer;
+// A Window of a headless session is rendered offscreen and every composed
+// frame is published through its frame ring.
+class Window : public wm::Window, public graphics::FrameSink {
+ public:
+  typedef std::uint32_t Id;
+
+  Window(const std::shared_ptr<Renderer> &renderer, const Id &id,
+         const wm::Task::Id &task, const graphics::Rect &frame,
+         const std::string &title, const std::shared_ptr<FrameRing> &ring,
+         const std::shared_ptr<FrameServer> &server);
+  ~Window();
+
+  bool attach() override;
+  void release() override;
+
+  EGLNativeWindowType native_handle() const override;
+
+  std::uint8_t* begin_frame(std::uint32_t width, std::uint32_t height) override;
+  void end_frame(std::uint32_t width, std::uint32_t height) override;
+
+  Id id() const { return id_; }
+
+ private:
+  std::shared_ptr<Renderer> renderer_;
+  Id id_;
+  std::shared_ptr<FrameRing> ring_;
+  std::shared_ptr<FrameServer> server_;
+  bool attached_ = false;
+  bool oversized_frame_reported_ = false;
+};
+}  // namespace headless
+}  // namespace anbox
+
+#endif
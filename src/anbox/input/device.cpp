@@ -16,19 +16,24 @@
  */
 
 #include "anbox/input/device.h"
+#include "anbox/common/tracer.h"
+#include "anbox/input/latency_tracker.h"
 #include "anbox/logger.h"
 #include "anbox/network/delegate_connection_creator.h"
 #include "anbox/network/delegate_message_processor.h"
 #include "anbox/network/local_socket_messenger.h"
 #include "anbox/qemu/null_message_processor.h"
 
-#include <time.h>
+#include <errno.h>
 
 namespace anbox {
 namespace input {
+constexpr const char *Device::executor;
+constexpr const std::size_t Device::max_client_backlog;
+
 std::shared_ptr<Device> Device::create(
     const std::string &path, const std::shared_ptr<Runtime> &runtime) {
-  auto sp = std::make_shared<Device>();
+  auto sp = std::make_shared<Device>(runtime);
 
   auto delegate_connector = std::make_shared<
       network::DelegateConnectionCreator<boost::asio::local::stream_protocol>>(
@@ -36,50 +41,141 @@ std::shared_ptr<Device> Device::create(
                &socket) { sp->new_client(socket); });
 
   sp->connector_ = std::make_shared<network::PublishedSocketConnector>(
-      path, runtime, delegate_connector);
+      path, runtime, delegate_connector, executor);
 
   return sp;
 }
 
-Device::Device()
-    : next_connection_id_(0),
+Device::Device(const std::shared_ptr<Runtime> &runtime)
+    : runtime_(runtime),
+      executor_(runtime->executor(executor)),
+      strand_(executor_->service()),
+      next_connection_id_(0),
       connections_(
-          std::make_shared<network::Connections<network::SocketConnection>>()) {
+          std::make_shared<network::Connections<network::SocketConnection>>()),
+      delivery_pending_(false),
+      pending_events_(queue_.capacity()),
+      pending_times_(queue_.capacity()),
+      compat_events_(queue_.capacity()) {
   ::memset(&info_, 0, sizeof(info_));
 }
 
 Device::~Device() {}
 
-void Device::send_events(const std::vector<Event> &events) {
-  struct CompatEvent {
-    // NOTE: A bit dirty but as we're running currently a 64 bit container
-    // struct input_event has a different size. We rebuild the struct here
-    // to reach the correct size.
-    std::uint64_t sec;
-    std::uint64_t usec;
-    std::uint16_t type;
-    std::uint16_t code;
-    std::uint32_t value;
-  };
-
-  struct timespec spec;
-  clock_gettime(CLOCK_MONOTONIC, &spec);
-
-  auto data = new CompatEvent[events.size()];
-  int n = 0;
-  for (const auto &event : events) {
-    data[n].sec = spec.tv_sec;
-    data[n].usec = spec.tv_nsec / 1000;
-    data[n].type = event.type;
-    data[n].code = event.code;
-    data[n].value = event.value;
-    n++;
+void Device::send_events(const std::vector<Event> &events, const Timestamp &time) {
+  send_events(events.data(), events.size(), time);
+}
+
+void Device::send_events(const Event *events, std::size_t count, const Timestamp &time) {
+  ANBOX_TRACE_SCOPE("input", "Device::send_events");
+  if (!queue_.push(events, count, time))
+    WARNING("Input event queue is full, dropped %d events", count);
+
+  // If a delivery is already scheduled it will pick up the new events too
+  // and further motion events are merged into the queued ones until then.
+  if (delivery_pending_.exchange(true))
+    return;
+
+  auto sp = shared_from_this();
+  executor_->post(strand_, [sp]() { sp->deliver_events(); });
+}
+
+void Device::deliver_events() {
+  delivery_pending_ = false;
+
+  Timestamp oldest;
+  const auto count = queue_.drain(pending_events_.data(), pending_times_.data(),
+                                  pending_events_.size(), &oldest);
+  if (count == 0)
+    return;
+
+  for (std::size_t n = 0; n < count; n++) {
+    // The steady clock is based on CLOCK_MONOTONIC which is what the
+    // Android side expects for input event timestamps.
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+        pending_times_[n].time_since_epoch()).count();
+    auto &data = compat_events_[n];
+    data.sec = us / 1000000;
+    data.usec = us % 1000000;
+    data.type = pending_events_[n].type;
+    data.code = pending_events_[n].code;
+    data.value = pending_events_[n].value;
   }
 
-  for (unsigned n = 0; n < connections_->size(); n++) {
-    connections_->at(n)->send(reinterpret_cast<const char *>(data),
-                              events.size() * sizeof(struct CompatEvent));
+  const auto data = reinterpret_cast<const char *>(compat_events_.data());
+  const auto size = count * sizeof(CompatEvent);
+
+  bool delivered = false;
+  for (auto it = clients_.begin(); it != clients_.end();) {
+    const auto client = it->second;
+    ++it;
+    if (!connections_->includes(client->id)) {
+      clients_.erase(client->id);
+      continue;
+    }
+    delivered = write_to(client, data, size) || delivered;
   }
+
+  if (delivered)
+    LatencyTracker::get()->events_written(oldest);
+}
+
+bool Device::write_to(const std::shared_ptr<Client> &client, const char *data, std::size_t size) {
+  // Events have to follow what is still queued for the client or we would
+  // corrupt its event stream.
+  if (!client->writing.empty()) {
+    if (client->writing.size() + client->pending.size() + size > max_client_backlog) {
+      WARNING("Input client %d doesn't read its events, disconnecting it", client->id);
+      drop_client(client);
+      return false;
+    }
+    client->pending.insert(client->pending.end(), data, data + size);
+    return true;
+  }
+
+  // The socket is non-blocking and this succeeds in nearly all cases as
+  // input events are small.
+  boost::system::error_code err;
+  const auto written = client->socket->write_some(boost::asio::buffer(data, size), err);
+  if (err && err != boost::asio::error::would_block) {
+    drop_client(client);
+    return false;
+  }
+
+  if (written < size) {
+    client->pending.assign(data + written, data + size);
+    start_write(client);
+  }
+  return true;
+}
+
+void Device::start_write(const std::shared_ptr<Client> &client) {
+  client->writing.swap(client->pending);
+  client->pending.clear();
+
+  auto sp = shared_from_this();
+  boost::asio::async_write(
+      *client->socket, boost::asio::buffer(client->writing),
+      strand_.wrap([sp, client](const boost::system::error_code &err, std::size_t) {
+        client->writing.clear();
+        if (err) {
+          sp->drop_client(client);
+          return;
+        }
+        if (!client->pending.empty())
+          sp->start_write(client);
+      }));
+}
+
+void Device::drop_client(const std::shared_ptr<Client> &client) {
+  if (clients_.erase(client->id) == 0)
+    return;
+
+  // Pending writes fail and the socket is closed once the last reference
+  // to it is gone.
+  boost::system::error_code err;
+  client->socket->shutdown(boost::asio::local::stream_protocol::socket::shutdown_both, err);
+  connections_->remove(client->id);
 }
 
 void Device::set_name(const std::string &name) {
@@ -152,6 +248,13 @@ int Device::next_id() { return next_connection_id_++; }
 void Device::new_client(
     std::shared_ptr<boost::asio::local::stream_protocol::socket> const
         &socket) {
+  auto sp = shared_from_this();
+  executor_->post(strand_, [sp, socket]() { sp->add_client(socket); });
+}
+
+void Device::add_client(
+    std::shared_ptr<boost::asio::local::stream_protocol::socket> const
+        &socket) {
   auto const messenger =
       std::make_shared<network::LocalSocketMessenger>(socket);
   auto const &connection = std::make_shared<network::SocketConnection>(
@@ -160,9 +263,15 @@ void Device::new_client(
   connection->set_name("input-device");
   connections_->add(connection);
 
+  auto client = std::make_shared<Client>();
+  client->id = connection->id();
+  client->socket = socket;
+  clients_.insert({client->id, client});
+
   // Send all necessary information about our device so that the remote
-  // side can properly configure itself for this input device
-  connection->send(reinterpret_cast<char const *>(&info_), sizeof(info_));
+  // side can properly configure itself for this input device. Events only
+  // go out behind it.
+  write_to(client, reinterpret_cast<char const *>(&info_), sizeof(info_));
 }
 }  // namespace input
 }  // namespace anbox
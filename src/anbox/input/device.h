@@ -18,32 +18,37 @@
 #ifndef ANBOX_INPUT_DEVICE_H_
 #define ANBOX_INPUT_DEVICE_H_
 
+#include "anbox/input/event_queue.h"
 #include "anbox/network/connections.h"
 #include "anbox/network/published_socket_connector.h"
 #include "anbox/network/socket_connection.h"
 #include "anbox/runtime.h"
 
+#include <map>
 #include <vector>
 
 #include <linux/input.h>
 
 namespace anbox {
 namespace input {
-struct Event {
-  std::uint16_t type;
-  std::uint16_t code;
-  std::int32_t value;
-};
-
 class Device : public std::enable_shared_from_this<Device> {
  public:
+  // Name of the runtime executor delivering events to clients.
+  static constexpr const char *executor{"input"};
+
   static std::shared_ptr<Device> create(
       const std::string &path, const std::shared_ptr<Runtime> &runtime);
 
-  Device();
+  Device(const std::shared_ptr<Runtime> &runtime);
   ~Device();
 
-  void send_events(const std::vector<Event> &events);
+  // Events are queued and delivered to all connected clients
+  // asynchronously from the runtime. This never blocks the caller. The
+  // given time is when the events occured and is passed on to the clients.
+  void send_events(const Event *events, std::size_t count,
+                   const Timestamp &time = Timestamp::clock::now());
+  void send_events(const std::vector<Event> &events,
+                   const Timestamp &time = Timestamp::clock::now());
   void send_event(const std::uint16_t &code, const std::uint16_t &event,
                   const std::int32_t &value);
 
@@ -66,9 +71,39 @@ class Device : public std::enable_shared_from_this<Device> {
   std::string socket_path() const;
 
  private:
+  // NOTE: A bit dirty but as we're running currently a 64 bit container
+  // struct input_event has a different size. We rebuild the struct here
+  // to reach the correct size.
+  struct CompatEvent {
+    std::uint64_t sec;
+    std::uint64_t usec;
+    std::uint16_t type;
+    std::uint16_t code;
+    std::uint32_t value;
+  };
+
+  // A connected client. Only touched from the strand.
+  struct Client {
+    int id;
+    std::shared_ptr<boost::asio::local::stream_protocol::socket> socket;
+    // Data which is currently written asynchronously and what has to
+    // follow it because the client didn't keep up.
+    std::vector<char> writing;
+    std::vector<char> pending;
+  };
+
+  // Clients which have this much data queued are disconnected.
+  static constexpr const std::size_t max_client_backlog{256 * 1024};
+
   int next_id();
+  void deliver_events();
   void new_client(std::shared_ptr<
                   boost::asio::local::stream_protocol::socket> const &socket);
+  void add_client(std::shared_ptr<
+                  boost::asio::local::stream_protocol::socket> const &socket);
+  bool write_to(const std::shared_ptr<Client> &client, const char *data, std::size_t size);
+  void start_write(const std::shared_ptr<Client> &client);
+  void drop_client(const std::shared_ptr<Client> &client);
 
   // NOTE: If you modify this struct you have to modify the version on
   // the Android side too. See
@@ -92,10 +127,19 @@ class Device : public std::enable_shared_from_this<Device> {
 
   void set_bit(std::uint8_t *array, const std::uint64_t &bit);
 
+  std::shared_ptr<Runtime> runtime_;
+  std::shared_ptr<Runtime::Executor> executor_;
+  boost::asio::io_service::strand strand_;
   std::shared_ptr<network::PublishedSocketConnector> connector_;
   std::atomic<int> next_connection_id_;
   std::shared_ptr<network::Connections<network::SocketConnection>> connections_;
+  std::map<int, std::shared_ptr<Client>> clients_;
   Info info_;
+  EventQueue queue_;
+  std::atomic<bool> delivery_pending_;
+  std::vector<Event> pending_events_;
+  std::vector<Timestamp> pending_times_;
+  std::vector<CompatEvent> compat_events_;
 };
 }  // namespace input
 }  // namespace anbox
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/input/event_queue.h"
+
+#include <algorithm>
+
+#include <linux/input.h>
+
+namespace anbox {
+namespace input {
+constexpr const std::size_t EventQueue::default_capacity;
+
+EventQueue::EventQueue(std::size_t capacity)
+    : events_(capacity), times_(capacity), last_motion_report_(capacity) {}
+
+EventQueue::~EventQueue() {}
+
+bool EventQueue::is_motion_report(const Event *events, std::size_t count) {
+  if (count < 2)
+    return false;
+
+  const auto &last = events[count - 1];
+  if (last.type != EV_SYN || last.code != SYN_REPORT)
+    return false;
+
+  for (std::size_t n = 0; n < count - 1; n++) {
+    if (events[n].type != EV_ABS && events[n].type != EV_REL)
+      return false;
+  }
+  return true;
+}
+
+bool EventQueue::merge_motion_report_locked(const Event *events, std::size_t count,
+                                            const Timestamp &time) {
+  if (last_motion_report_ >= size_)
+    return false;
+
+  auto find_axis = [&](const Event &event) {
+    auto end = events_.begin() + size_ - 1;
+    auto iter = std::find_if(events_.begin() + last_motion_report_, end,
+                             [&](const Event &e) {
+                               return e.type == event.type && e.code == event.code;
+                             });
+    return iter != end ? iter : events_.end();
+  };
+
+  // Make sure we have enough space left for all axes which are not yet
+  // part of the queued report before we start to modify it.
+  std::size_t new_axes = 0;
+  for (std::size_t n = 0; n < count - 1; n++) {
+    if (find_axis(events[n]) == events_.end())
+      new_axes++;
+  }
+  if (size_ + new_axes > events_.size())
+    return false;
+
+  for (std::size_t n = 0; n < count - 1; n++) {
+    const auto &event = events[n];
+    auto existing = find_axis(event);
+    if (existing != events_.end()) {
+      if (event.type == EV_ABS)
+        existing->value = event.value;
+      else
+        existing->value += event.value;
+      times_[existing - events_.begin()] = time;
+      continue;
+    }
+
+    // The axis isn't part of the queued report yet so we add it in front
+    // of the terminating SYN_REPORT.
+    events_[size_] = events_[size_ - 1];
+    events_[size_ - 1] = event;
+    times_[size_ - 1] = time;
+    size_++;
+  }
+
+  // The merged report now describes the most recent state.
+  times_[size_ - 1] = time;
+  return true;
+}
+
+bool EventQueue::push(const Event *events, std::size_t count, const Timestamp &time) {
+  if (count == 0)
+    return true;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const auto motion = is_motion_report(events, count);
+  if (motion && merge_motion_report_locked(events, count, time)) {
+    coalesced_++;
+    return true;
+  }
+
+  if (size_ + count > events_.size()) {
+    dropped_ += count;
+    return false;
+  }
+
+  if (size_ == 0 || time < oldest_)
+    oldest_ = time;
+
+  std::copy(events, events + count, events_.begin() + size_);
+  std::fill(times_.begin() + size_, times_.begin() + size_ + count, time);
+  last_motion_report_ = motion ? size_ : events_.size();
+  size_ += count;
+  return true;
+}
+
+std::size_t EventQueue::drain(Event *events, Timestamp *times, std::size_t max_count,
+                              Timestamp *oldest) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const auto count = std::min(size_, max_count);
+  std::copy(events_.begin(), events_.begin() + count, events);
+  std::copy(times_.begin(), times_.begin() + count, times);
+  std::copy(events_.begin() + count, events_.begin() + size_, events_.begin());
+  std::copy(times_.begin() + count, times_.begin() + size_, times_.begin());
+  size_ -= count;
+
+  if (oldest)
+    *oldest = oldest_;
+  if (size_ > 0)
+    oldest_ = *std::min_element(times_.begin(), times_.begin() + size_);
+
+  // Whatever is left over is already on its way and must not be modified
+  // anymore.
+  last_motion_report_ = events_.size();
+  return count;
+}
+
+bool EventQueue::empty() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_ == 0;
+}
+
+std::size_t EventQueue::capacity() const {
+  return events_.size();
+}
+
+std::uint64_t EventQueue::coalesced() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return coalesced_;
+}
+
+std::uint64_t EventQueue::dropped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_;
+}
+}  // namespace input
+}  // namespace anbox
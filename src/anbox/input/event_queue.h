@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_INPUT_EVENT_QUEUE_H_
+#define ANBOX_INPUT_EVENT_QUEUE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace anbox {
+namespace input {
+struct Event {
+  std::uint16_t type;
+  std::uint16_t code;
+  std::int32_t value;
+};
+
+// Timestamps of input events are taken from the monotonic clock which is
+// also what the Android side expects.
+typedef std::chrono::steady_clock::time_point Timestamp;
+
+// EventQueue buffers input events between the thread producing them and the
+// one delivering them to the connected clients. All storage is allocated
+// upfront so queueing events never touches the heap.
+//
+// Consecutive pointer motion reports (a set of EV_ABS/EV_REL events
+// terminated by EV_SYN/SYN_REPORT) which are queued while an earlier motion
+// report wasn't delivered yet are merged into that one. Absolute values are
+// replaced and relative ones accumulated so that only the most recent
+// position ends up being delivered.
+class EventQueue {
+ public:
+  static constexpr const std::size_t default_capacity{512};
+
+  explicit EventQueue(std::size_t capacity = default_capacity);
+  ~EventQueue();
+
+  // push queues the given events which happened at the given time. If the
+  // queue doesn't have enough space left the events are dropped and false
+  // is returned.
+  bool push(const Event *events, std::size_t count, const Timestamp &time);
+
+  // drain moves up to max_count queued events and their timestamps into the
+  // given arrays and returns how many were moved. If oldest is given it is
+  // set to the time of the oldest event which entered the queue since the
+  // last drain, including those which were merged into others.
+  std::size_t drain(Event *events, Timestamp *times, std::size_t max_count,
+                    Timestamp *oldest = nullptr);
+
+  bool empty() const;
+  std::size_t capacity() const;
+
+  // Number of motion reports which were merged into an already queued one.
+  std::uint64_t coalesced() const;
+  std::uint64_t dropped() const;
+
+ private:
+  static bool is_motion_report(const Event *events, std::size_t count);
+  bool merge_motion_report_locked(const Event *events, std::size_t count,
+                                  const Timestamp &time);
+
+  mutable std::mutex mutex_;
+  std::vector<Event> events_;
+  std::vector<Timestamp> times_;
+  std::size_t size_ = 0;
+  Timestamp oldest_;
+  // Start of the last queued report if it is a motion report which can
+  // still be merged with, otherwise equal to the capacity.
+  std::size_t last_motion_report_;
+  std::uint64_t coalesced_ = 0;
+  std::uint64_t dropped_ = 0;
+};
+}  // namespace input
+}  // namespace anbox
+
+#endif
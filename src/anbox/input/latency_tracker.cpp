@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/input/latency_tracker.h"
+#include "anbox/logger.h"
+
+namespace anbox {
+namespace input {
+std::shared_ptr<LatencyTracker> LatencyTracker::get() {
+  static auto tracker = std::make_shared<LatencyTracker>();
+  return tracker;
+}
+
+LatencyTracker::LatencyTracker() : pending_input_(0), last_reported_count_(0) {}
+
+LatencyTracker::~LatencyTracker() {}
+
+void LatencyTracker::events_written(const Timestamp &event_time) {
+  const auto now = Timestamp::clock::now();
+  socket_write_.record(std::chrono::duration_cast<std::chrono::microseconds>(now - event_time));
+
+  // We only remember the oldest event which didn't make it into a frame yet.
+  Timestamp::rep expected = 0;
+  pending_input_.compare_exchange_strong(expected, event_time.time_since_epoch().count());
+}
+
+void LatencyTracker::frame_submitted() {
+  const auto pending = pending_input_.exchange(0);
+  if (pending == 0)
+    return;
+
+  const auto event_time = Timestamp{Timestamp::duration{pending}};
+  next_frame_.record(std::chrono::duration_cast<std::chrono::microseconds>(
+      Timestamp::clock::now() - event_time));
+}
+
+const common::LatencyHistogram& LatencyTracker::socket_write() const {
+  return socket_write_;
+}
+
+const common::LatencyHistogram& LatencyTracker::next_frame() const {
+  return next_frame_;
+}
+
+std::map<std::string, std::uint64_t> LatencyTracker::summary() const {
+  auto result = socket_write_.summary("socket_write.");
+  const auto frame = next_frame_.summary("next_frame.");
+  result.insert(frame.begin(), frame.end());
+  return result;
+}
+
+void LatencyTracker::report_periodically(boost::asio::io_service &service,
+                                         const boost::posix_time::time_duration &interval) {
+  auto report = std::make_shared<Report>(service, interval);
+  std::shared_ptr<Report> previous;
+  {
+    std::lock_guard<std::mutex> lock(report_lock_);
+    previous = report_;
+    report_ = report;
+  }
+  cancel(previous);
+
+  std::weak_ptr<LatencyTracker> weak_self = shared_from_this();
+  report->strand.post([weak_self, report]() {
+    if (auto self = weak_self.lock())
+      self->schedule_report(report);
+  });
+}
+
+void LatencyTracker::stop_reporting() {
+  std::shared_ptr<Report> report;
+  {
+    std::lock_guard<std::mutex> lock(report_lock_);
+    report.swap(report_);
+  }
+  cancel(report);
+}
+
+void LatencyTracker::cancel(const std::shared_ptr<Report> &report) {
+  if (!report)
+    return;
+
+  // A report might be running right now, so the timer can only be
+  // cancelled from its strand.
+  report->strand.post([report]() {
+    report->stopped = true;
+    report->timer.cancel();
+  });
+}
+
+void LatencyTracker::schedule_report(const std::shared_ptr<Report> &report) {
+  if (report->stopped)
+    return;
+
+  std::weak_ptr<LatencyTracker> weak_self = shared_from_this();
+  report->timer.expires_from_now(report->interval);
+  report->timer.async_wait(report->strand.wrap([weak_self, report](const boost::system::error_code &err) {
+    auto self = weak_self.lock();
+    if (!self || err == boost::asio::error::operation_aborted || report->stopped)
+      return;
+
+    self->report();
+    self->schedule_report(report);
+  }));
+}
+
+void LatencyTracker::report() {
+  const auto count = socket_write_.count();
+  if (count == last_reported_count_)
+    return;
+
+  INFO("Input latency: event->socket %s, event->frame %s",
+       socket_write_.to_string(), next_frame_.to_string());
+  last_reported_count_ = count;
+}
+}  // namespace input
+}  // namespace anbox
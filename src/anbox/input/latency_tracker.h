@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_INPUT_LATENCY_TRACKER_H_
+#define ANBOX_INPUT_LATENCY_TRACKER_H_
+
+#include "anbox/common/latency_histogram.h"
+#include "anbox/input/event_queue.h"
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace anbox {
+namespace input {
+// LatencyTracker measures how long it takes from the time an input event
+// was generated on the host until it was written to the socket of the
+// Android input device and until the next frame was submitted for
+// composition afterwards.
+class LatencyTracker : public std::enable_shared_from_this<LatencyTracker> {
+ public:
+  static std::shared_ptr<LatencyTracker> get();
+
+  LatencyTracker();
+  ~LatencyTracker();
+
+  // Called once a batch of events was written to the clients of an input
+  // device. The time given is the one of the oldest event in the batch.
+  void events_written(const Timestamp &event_time);
+  // Called for every frame which is submitted for composition.
+  void frame_submitted();
+
+  const common::LatencyHistogram& socket_write() const;
+  const common::LatencyHistogram& next_frame() const;
+
+  std::map<std::string, std::uint64_t> summary() const;
+
+  // Logs the current state of the histograms in the given interval if new
+  // samples were recorded since the last time. Both can be called from any
+  // thread, the timer is only ever touched from the given service.
+  void report_periodically(boost::asio::io_service &service,
+                           const boost::posix_time::time_duration &interval);
+  void stop_reporting();
+
+ private:
+  struct Report {
+    Report(boost::asio::io_service &service, const boost::posix_time::time_duration &interval)
+        : strand(service), timer(service), interval(interval) {}
+
+    boost::asio::io_service::strand strand;
+    boost::asio::deadline_timer timer;
+    boost::posix_time::time_duration interval;
+    bool stopped = false;
+  };
+
+  static void cancel(const std::shared_ptr<Report> &report);
+  void schedule_report(const std::shared_ptr<Report> &report);
+  void report();
+
+  common::LatencyHistogram socket_write_;
+  common::LatencyHistogram next_frame_;
+  // Time of the oldest input event written since the last frame was
+  // submitted or zero if there is none.
+  std::atomic<Timestamp::rep> pending_input_;
+  std::mutex report_lock_;
+  std::shared_ptr<Report> report_;
+  std::atomic<std::uint64_t> last_reported_count_;
+};
+}  // namespace input
+}  // namespace anbox
+
+#endif
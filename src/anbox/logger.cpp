@@ -15,8 +15,15 @@
  *
  */
 
+#include <algorithm>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
 #include <thread>
 
+#include <pthread.h>
+#include <time.h>
+
 #define BOOST_LOG_DYN_LINK
 #include <boost/date_time.hpp>
 #include <boost/filesystem.hpp>
@@ -36,7 +43,7 @@ BOOST_LOG_ATTRIBUTE_KEYWORD(Timestamp, "Timestamp", boost::posix_time::ptime)
 }
 
 struct BoostLogLogger : public anbox::Logger {
-  BoostLogLogger() : initialized_(false) {}
+  explicit BoostLogLogger(std::ostream& out) : out_(out), initialized_(false) {}
 
   void Init(const anbox::Logger::Severity& severity = anbox::Logger::Severity::kWarning) override {
     if (initialized_) return;
@@ -53,25 +60,25 @@ struct BoostLogLogger : public anbox::Logger {
         << boost::log::expressions::smessage;
 
     boost::log::core::get()->remove_all_sinks();
-    auto logger = boost::log::add_console_log(std::cout);
+    auto logger = boost::log::add_console_log(out_);
     logger->set_formatter(formatter);
 
-    severity_ = severity;
+    threshold_ = severity;
     initialized_ = true;
   }
 
   void SetSeverity(const Severity& severity) override {
-    severity_ = severity;
+    threshold_ = severity;
   }
 
   void Log(Severity severity, const std::string& message, const boost::optional<Location>& loc) override {
-    if (!initialized_) Init();
+    if (!initialized_) Init(threshold_);
 
     // FIXME somehow set_filter doesn't work with the trivial logger. If
     // we set a filter based on the severity attribute open_record will
     // not return a new record. Because of that we do a poor man filtering
     // here until we have a proper way to do this via boost.
-    if (severity < severity_)
+    if (!IsEnabled(severity))
       return;
 
     if (auto rec = boost::log::trivial::logger::get().open_record()) {
@@ -92,12 +99,339 @@ struct BoostLogLogger : public anbox::Logger {
   }
 
  private:
-  Severity severity_;
+  std::ostream& out_;
   bool initialized_;
 };
 
+// Set in the child after a fork() as the writer thread doesn't exist there.
+std::atomic<bool> in_forked_child{false};
+
+std::size_t align_entry(std::size_t size) { return (size + 7) & ~std::size_t{7}; }
+
+// ThreadRing is a single producer, single consumer ring of records owned
+// by one logging thread and drained by the writer. Records are stored
+// contiguously; one that doesn't fit at the end of the ring is preceded
+// by a marker telling the reader to continue at the start.
+class ThreadRing {
+ public:
+  static constexpr const std::size_t capacity{64 * 1024};
+  static constexpr const std::uint32_t wrap_marker{0xffffffff};
+
+  ThreadRing() : data_(new std::uint64_t[capacity / sizeof(std::uint64_t)]) {}
+
+  enum class PushResult { ok, full, too_large };
+
+  // Records which don't fit right now are rejected with full, the ones
+  // which can never fit into the ring with too_large.
+  PushResult push(const std::uint8_t* data, std::size_t size) {
+    const auto entry = align_entry(size);
+    if (entry > capacity / 4)
+      return PushResult::too_large;
+
+    auto head = head_.load(std::memory_order_relaxed);
+    const auto tail = tail_.load(std::memory_order_acquire);
+    auto pos = head % capacity;
+    const auto contiguous = capacity - pos;
+    const auto needed = entry > contiguous ? entry + contiguous : entry;
+    if (capacity - (head - tail) < needed)
+      return PushResult::full;
+
+    if (entry > contiguous) {
+      ::memcpy(bytes() + pos, &wrap_marker, sizeof(wrap_marker));
+      head += contiguous;
+      pos = 0;
+    }
+
+    ::memcpy(bytes() + pos, data, size);
+    head_.store(head + entry, std::memory_order_release);
+    return PushResult::ok;
+  }
+
+  template <typename F>
+  std::size_t drain(const F& f) {
+    std::size_t count = 0;
+    auto tail = tail_.load(std::memory_order_relaxed);
+    const auto head = head_.load(std::memory_order_acquire);
+    while (tail != head) {
+      const auto pos = tail % capacity;
+      std::uint32_t size = 0;
+      ::memcpy(&size, bytes() + pos, sizeof(size));
+      if (size == wrap_marker) {
+        tail += capacity - pos;
+        continue;
+      }
+      f(bytes() + pos, size);
+      tail += align_entry(size);
+      tail_.store(tail, std::memory_order_release);
+      count++;
+    }
+    tail_.store(tail, std::memory_order_release);
+    return count;
+  }
+
+  std::atomic<bool> orphaned{false};
+  std::atomic<std::uint64_t> dropped{0};
+
+ private:
+  std::uint8_t* bytes() { return reinterpret_cast<std::uint8_t*>(data_.get()); }
+
+  std::unique_ptr<std::uint64_t[]> data_;
+  std::atomic<std::size_t> head_{0};
+  std::atomic<std::size_t> tail_{0};
+};
+
+constexpr const std::size_t ThreadRing::capacity;
+constexpr const std::uint32_t ThreadRing::wrap_marker;
+
+// The rings a thread has with each of the async loggers it logged to.
+struct ThreadRings {
+  ~ThreadRings() {
+    for (auto& ring : rings)
+      ring.second->orphaned = true;
+  }
+
+  std::shared_ptr<ThreadRing> find(std::uint64_t logger) {
+    for (const auto& ring : rings)
+      if (ring.first == logger)
+        return ring.second;
+    return nullptr;
+  }
+
+  std::vector<std::pair<std::uint64_t, std::shared_ptr<ThreadRing>>> rings;
+};
+
+thread_local ThreadRings thread_rings;
+
+std::string format_line(const std::uint8_t* data, std::size_t size) {
+  anbox::logging::Record::Header header;
+  ::memcpy(&header, data, sizeof(header));
+
+  const time_t seconds = header.timestamp_us / 1000000;
+  struct tm tm;
+  gmtime_r(&seconds, &tm);
+  char timestamp[32];
+  strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &tm);
+
+  std::ostringstream out;
+  out << "[" << header.severity << " " << timestamp << "] ";
+  if (header.file) {
+    const auto slash = ::strrchr(header.file, '/');
+    out << "[" << (slash ? slash + 1 : header.file) << ":" << header.line
+        << "@" << header.function << "] ";
+  }
+  out << anbox::logging::Record::format(data, size) << "\n";
+  return out.str();
+}
+
+class AsyncLogger : public anbox::Logger {
+ public:
+  explicit AsyncLogger(std::ostream& out) : out_(out), id_(next_id()) {
+    static std::once_flag atfork_registered;
+    std::call_once(atfork_registered, []() {
+      pthread_atfork(nullptr, nullptr, []() { in_forked_child = true; });
+    });
+
+    writer_ = std::thread(&AsyncLogger::run, this);
+  }
+
+  ~AsyncLogger() {
+    {
+      std::lock_guard<std::mutex> l(lock_);
+      stopping_ = true;
+    }
+    wakeup_.notify_all();
+    if (writer_.joinable())
+      writer_.join();
+  }
+
+  void Init(const Severity& severity = Severity::kWarning) override {
+    threshold_ = severity;
+  }
+
+  void SetSeverity(const Severity& severity) override {
+    threshold_ = severity;
+  }
+
+  void Log(Severity severity, const std::string& message, const boost::optional<Location>& loc) override {
+    if (!IsEnabled(severity))
+      return;
+
+    // The location isn't made of literals here, so it has to go into the
+    // message itself.
+    static const std::string pattern{"%s"};
+    anbox::logging::Record record{severity, nullptr, nullptr, 0, pattern.data(), pattern.size()};
+    if (loc)
+      record.add(anbox::utils::string_format("[%s] %s", *loc, message));
+    else
+      record.add(message);
+    Submit(record);
+  }
+
+  void Submit(const anbox::logging::Record& record) override {
+    if (in_forked_child) {
+      write(format_line(record.data(), record.size()));
+    } else {
+      auto ring = this->ring();
+      auto result = ring->push(record.data(), record.size());
+      if (result == ThreadRing::PushResult::full) {
+        // The writer is behind; rather than losing the record we wait for
+        // it to catch up and only drop the record if it doesn't.
+        Flush();
+        result = ring->push(record.data(), record.size());
+      }
+
+      if (result == ThreadRing::PushResult::too_large)
+        write(format_line(record.data(), record.size()));
+      else if (result == ThreadRing::PushResult::full)
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+      else
+        wake_writer();
+    }
+
+    if (record.header().severity == Severity::kFatal)
+      Flush();
+  }
+
+  void Flush() override {
+    if (in_forked_child)
+      return;
+
+    std::unique_lock<std::mutex> l(lock_);
+    const auto target = ++flush_requested_;
+    wakeup_.notify_one();
+    flushed_.wait_for(l, std::chrono::seconds{1}, [&]() { return flush_completed_ >= target; });
+  }
+
+ private:
+  static std::uint64_t next_id() {
+    static std::atomic<std::uint64_t> id{0};
+    return ++id;
+  }
+
+  std::shared_ptr<ThreadRing> ring() {
+    auto ring = thread_rings.find(id_);
+    if (ring)
+      return ring;
+
+    ring = std::make_shared<ThreadRing>();
+    thread_rings.rings.push_back({id_, ring});
+    std::lock_guard<std::mutex> l(lock_);
+    rings_.push_back(ring);
+    return ring;
+  }
+
+  // The writer checks pending_ after announcing it goes to sleep and we
+  // check sleeping_ after setting pending_, so one of us always sees the
+  // other and the lock is only taken if the writer really sleeps.
+  void wake_writer() {
+    pending_ = true;
+    if (!sleeping_)
+      return;
+
+    std::lock_guard<std::mutex> l(lock_);
+    wakeup_.notify_one();
+  }
+
+  void write(const std::string& text) {
+    std::lock_guard<std::mutex> l(out_lock_);
+    out_ << text << std::flush;
+  }
+
+  void run() {
+    while (true) {
+      std::uint64_t flush_target = 0;
+      std::vector<std::shared_ptr<ThreadRing>> rings;
+      std::vector<std::shared_ptr<ThreadRing>> orphaned;
+      bool stopping = false;
+      {
+        std::lock_guard<std::mutex> l(lock_);
+        flush_target = flush_requested_;
+        stopping = stopping_;
+        rings = rings_;
+      }
+
+      // Rings of exited threads don't get any new records so we can drop
+      // them after this pass.
+      for (const auto& ring : rings)
+        if (ring->orphaned)
+          orphaned.push_back(ring);
+
+      pending_ = false;
+      const auto written = drain(rings);
+
+      {
+        std::lock_guard<std::mutex> l(lock_);
+        flush_completed_ = flush_target;
+        for (const auto& ring : orphaned)
+          rings_.erase(std::remove(rings_.begin(), rings_.end(), ring), rings_.end());
+      }
+      flushed_.notify_all();
+
+      if (stopping && written == 0)
+        break;
+
+      if (written > 0)
+        continue;
+
+      std::unique_lock<std::mutex> l(lock_);
+      sleeping_ = true;
+      wakeup_.wait_for(l, std::chrono::milliseconds{50}, [&]() {
+        return stopping_ || pending_ || flush_requested_ != flush_completed_;
+      });
+      sleeping_ = false;
+    }
+  }
+
+  std::size_t drain(const std::vector<std::shared_ptr<ThreadRing>>& rings) {
+    std::vector<std::pair<std::int64_t, std::string>> lines;
+    std::uint64_t dropped = 0;
+    for (const auto& ring : rings) {
+      ring->drain([&](const std::uint8_t* data, std::size_t size) {
+        anbox::logging::Record::Header header;
+        ::memcpy(&header, data, sizeof(header));
+        lines.push_back({header.timestamp_us, format_line(data, size)});
+      });
+      dropped += ring->dropped.exchange(0);
+    }
+
+    if (lines.empty() && dropped == 0)
+      return 0;
+
+    // Records of different threads are merged by time; the sort is
+    // stable so the order within a thread is kept.
+    std::stable_sort(lines.begin(), lines.end(),
+                     [](const std::pair<std::int64_t, std::string>& lhs,
+                        const std::pair<std::int64_t, std::string>& rhs) {
+                       return lhs.first < rhs.first;
+                     });
+
+    std::lock_guard<std::mutex> l(out_lock_);
+    for (const auto& line : lines)
+      out_ << line.second;
+    if (dropped > 0)
+      out_ << "[" << Severity::kWarning << "] Dropped " << dropped
+           << " log messages as the writer couldn't keep up\n";
+    out_ << std::flush;
+    return lines.size() + dropped;
+  }
+
+  std::ostream& out_;
+  const std::uint64_t id_;
+  std::mutex out_lock_;
+  std::mutex lock_;
+  std::condition_variable wakeup_;
+  std::condition_variable flushed_;
+  std::vector<std::shared_ptr<ThreadRing>> rings_;
+  std::atomic<bool> sleeping_{false};
+  std::atomic<bool> pending_{false};
+  bool stopping_ = false;
+  std::uint64_t flush_requested_ = 0;
+  std::uint64_t flush_completed_ = 0;
+  std::thread writer_;
+};
+
 std::shared_ptr<anbox::Logger>& MutableInstance() {
-  static std::shared_ptr<anbox::Logger> instance{new BoostLogLogger()};
+  static std::shared_ptr<anbox::Logger> instance{anbox::CreateAsyncLogger(std::cout)};
   return instance;
 }
 
@@ -106,6 +440,126 @@ void SetInstance(const std::shared_ptr<anbox::Logger>& logger) {
 }
 }
 namespace anbox {
+namespace logging {
+constexpr const std::size_t Record::max_string_size;
+
+Record::Record(Logger::Severity severity, const char* file, const char* function,
+               std::uint32_t line, const char* pattern, std::size_t pattern_size) {
+  Header header;
+  header.size = sizeof(Header);
+  header.severity = severity;
+  header.line = line;
+  header.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  header.file = file;
+  header.function = function;
+  ::memcpy(inline_.data(), &header, sizeof(header));
+  size_ = sizeof(header);
+
+  add_string(pattern, pattern_size);
+}
+
+void Record::add_string(const char* str, std::size_t size) {
+  const auto length = static_cast<std::uint32_t>(std::min(size, max_string_size));
+  auto dst = reserve(1 + sizeof(length) + length);
+  *dst = static_cast<std::uint8_t>(Type::kString);
+  ::memcpy(dst + 1, &length, sizeof(length));
+  ::memcpy(dst + 1 + sizeof(length), str, length);
+}
+
+std::uint8_t* Record::reserve(std::size_t size) {
+  if (heap_.empty() && size_ + size > inline_.size())
+    heap_.assign(inline_.begin(), inline_.begin() + size_);
+  if (!heap_.empty())
+    heap_.resize(size_ + size);
+
+  auto base = heap_.empty() ? inline_.data() : heap_.data();
+  auto dst = base + size_;
+  size_ += size;
+  const auto header_size = static_cast<std::uint32_t>(size_);
+  ::memcpy(base + offsetof(Header, size), &header_size, sizeof(header_size));
+  return dst;
+}
+
+std::string Record::format(const std::uint8_t* data, std::size_t size) {
+  Header header;
+  ::memcpy(&header, data, sizeof(header));
+
+  auto pos = data + sizeof(header);
+  const auto end = data + size;
+
+  auto read_string = [&]() {
+    std::uint32_t length = 0;
+    ::memcpy(&length, pos, sizeof(length));
+    pos += sizeof(length);
+    std::string str(reinterpret_cast<const char*>(pos), length);
+    pos += length;
+    return str;
+  };
+
+  pos++;
+  const auto pattern = read_string();
+
+  try {
+    boost::format f(pattern);
+    while (pos < end) {
+      const auto type = static_cast<Type>(*pos++);
+      switch (type) {
+        case Type::kSigned: {
+          std::int64_t value;
+          ::memcpy(&value, pos, sizeof(value));
+          pos += sizeof(value);
+          f % value;
+          break;
+        }
+        case Type::kUnsigned: {
+          std::uint64_t value;
+          ::memcpy(&value, pos, sizeof(value));
+          pos += sizeof(value);
+          f % value;
+          break;
+        }
+        case Type::kDouble: {
+          double value;
+          ::memcpy(&value, pos, sizeof(value));
+          pos += sizeof(value);
+          f % value;
+          break;
+        }
+        case Type::kBool:
+          f % static_cast<bool>(*pos++);
+          break;
+        case Type::kChar:
+          f % static_cast<char>(*pos++);
+          break;
+        case Type::kString:
+          f % read_string();
+          break;
+        case Type::kPointer: {
+          std::uintptr_t value;
+          ::memcpy(&value, pos, sizeof(value));
+          pos += sizeof(value);
+          f % reinterpret_cast<const void*>(value);
+          break;
+        }
+        default:
+          return pattern + " (corrupted log record)";
+      }
+    }
+    return f.str();
+  } catch (const std::exception& err) {
+    return pattern + " (" + err.what() + ")";
+  }
+}
+}  // namespace logging
+
+void Logger::Submit(const logging::Record& record) {
+  const auto& header = record.header();
+  boost::optional<Location> location;
+  if (header.file)
+    location = Location{header.file, header.function, header.line};
+  Log(header.severity, logging::Record::format(record.data(), record.size()), location);
+}
 
 bool Logger::SetSeverityFromString(const std::string& severity) {
   if (severity == "trace")
@@ -185,4 +639,12 @@ Logger& Log() { return *MutableInstance(); }
 
 void SetLogger(const std::shared_ptr<Logger>& logger) { SetInstance(logger); }
 
+std::shared_ptr<Logger> CreateAsyncLogger(std::ostream& out) {
+  return std::make_shared<AsyncLogger>(out);
+}
+
+std::shared_ptr<Logger> CreateSynchronousLogger(std::ostream& out) {
+  return std::make_shared<BoostLogLogger>(out);
+}
+
 }  // namespace anbox
@@ -21,24 +21,42 @@
 #include <boost/optional.hpp>
 
 #include <memory.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "anbox/do_not_copy_or_move.h"
 #include "anbox/utils.h"
 
+// Messages below this severity are compiled out entirely. Defaults to
+// keeping everything; release builds can raise it to drop trace and debug
+// messages without any runtime cost.
+#ifndef ANBOX_LOG_MIN_SEVERITY
+#define ANBOX_LOG_MIN_SEVERITY 0
+#endif
+
 namespace anbox {
+namespace logging {
+class Record;
+}  // namespace logging
+
 // A Logger enables persisting of messages describing & explaining the
 // state of the system.
 class Logger : public DoNotCopyOrMove {
  public:
   // Severity enumerates all known severity levels
   // applicable to log messages.
-  enum class Severity { kTrace,
-                        kDebug,
-                        kInfo,
-                        kWarning,
-                        kError,
-                        kFatal };
+  enum class Severity : std::uint8_t { kTrace,
+                                       kDebug,
+                                       kInfo,
+                                       kWarning,
+                                       kError,
+                                       kFatal };
 
   // A Location describes the origin of a log message.
   struct Location {
@@ -47,14 +65,28 @@ class Logger : public DoNotCopyOrMove {
     std::uint32_t line;    // The line in file that resulted in the log message.
   };
 
+  virtual ~Logger() = default;
+
   virtual void Init(const Severity& severity = Severity::kWarning) = 0;
 
   bool SetSeverityFromString(const std::string &severity);
   virtual void SetSeverity(const Severity& severity) = 0;
 
+  // IsEnabled is cheap enough to be checked before a message is built.
+  bool IsEnabled(const Severity& severity) const {
+    return severity >= threshold_.load(std::memory_order_relaxed);
+  }
+
   virtual void Log(Severity severity, const std::string& message,
                    const boost::optional<Location>& location) = 0;
 
+  // Submit takes a message in its binary form. The default implementation
+  // formats it right away and passes it on to Log().
+  virtual void Submit(const logging::Record& record);
+
+  // Flush blocks until all messages submitted so far are written.
+  virtual void Flush() {}
+
   virtual void Trace(
       const std::string& message,
       const boost::optional<Location>& location = boost::optional<Location>{});
@@ -74,6 +106,16 @@ class Logger : public DoNotCopyOrMove {
       const std::string& message,
       const boost::optional<Location>& location = boost::optional<Location>{});
 
+  // Logf records the pattern and arguments in binary form and leaves the
+  // formatting to the logger. The pattern is copied as we can't tell a
+  // literal from any other array. file and function have to be literals.
+  template <std::size_t N, typename... T>
+  void Logf(Severity severity, const char* file, const char* function,
+            std::uint32_t line, const char (&pattern)[N], T&&... args);
+  template <typename... T>
+  void Logf(Severity severity, const char* file, const char* function,
+            std::uint32_t line, const std::string& pattern, T&&... args);
+
   template <typename... T>
   void Tracef(const boost::optional<Location>& location,
               const std::string& pattern, T&&... args) {
@@ -112,7 +154,166 @@ class Logger : public DoNotCopyOrMove {
 
  protected:
   Logger() = default;
+
+  std::atomic<Severity> threshold_{Severity::kWarning};
+};
+
+namespace logging {
+// Record is the binary form of a log message. The header is followed by
+// the arguments, each stored as a type tag and its value. Nothing is
+// formatted until the record is written out.
+class Record {
+ public:
+  enum class Type : std::uint8_t {
+    kSigned,
+    kUnsigned,
+    kDouble,
+    kBool,
+    kChar,
+    kString,
+    kPointer,
+  };
+
+  struct Header {
+    std::uint32_t size;
+    Logger::Severity severity;
+    std::uint32_t line;
+    std::int64_t timestamp_us;
+    const char* file;
+    const char* function;
+  };
+
+  // Longer string arguments are cut off to keep records bounded.
+  static constexpr const std::size_t max_string_size{4096};
+
+  // The pattern is stored as first argument.
+  Record(Logger::Severity severity, const char* file, const char* function,
+         std::uint32_t line, const char* pattern, std::size_t pattern_size);
+
+  const std::uint8_t* data() const { return heap_.empty() ? inline_.data() : heap_.data(); }
+  std::size_t size() const { return size_; }
+  const Header& header() const { return *reinterpret_cast<const Header*>(data()); }
+
+  void add() {}
+  template <typename Head, typename... Tail>
+  void add(Head&& head, Tail&&... tail) {
+    add_value(head);
+    add(std::forward<Tail>(tail)...);
+  }
+
+  // Formats a record given in binary form the same way utils::string_format
+  // would have done with the original arguments.
+  static std::string format(const std::uint8_t* data, std::size_t size);
+
+ private:
+  template <typename T>
+  struct Classify
+      : std::integral_constant<
+            int, std::is_same<T, bool>::value
+                     ? 0
+                     : (std::is_same<T, char>::value ||
+                        std::is_same<T, signed char>::value ||
+                        std::is_same<T, unsigned char>::value)
+                           ? 1
+                           : std::is_integral<T>::value
+                                 ? 2
+                                 : std::is_floating_point<T>::value
+                                       ? 3
+                                       : (std::is_same<T, const char*>::value ||
+                                          std::is_same<T, char*>::value)
+                                             ? 4
+                                             : std::is_same<T, std::string>::value
+                                                   ? 5
+                                                   : std::is_pointer<T>::value ? 6 : 7> {};
+
+  template <typename T>
+  void add_value(const T& value) {
+    typedef typename std::decay<T>::type Type;
+    add_value(static_cast<const Type&>(value), Classify<Type>{});
+  }
+  template <std::size_t N>
+  void add_value(const char (&value)[N]) { add_string(value, ::strnlen(value, N)); }
+  template <std::size_t N>
+  void add_value(char (&value)[N]) { add_string(value, ::strnlen(value, N)); }
+
+  template <typename T>
+  void add_value(const T& value, std::integral_constant<int, 0>) {
+    put(Type::kBool, static_cast<std::uint8_t>(value));
+  }
+  template <typename T>
+  void add_value(const T& value, std::integral_constant<int, 1>) {
+    put(Type::kChar, static_cast<char>(value));
+  }
+  template <typename T>
+  void add_value(const T& value, std::integral_constant<int, 2>) {
+    if (std::is_signed<T>::value)
+      put(Type::kSigned, static_cast<std::int64_t>(value));
+    else
+      put(Type::kUnsigned, static_cast<std::uint64_t>(value));
+  }
+  template <typename T>
+  void add_value(const T& value, std::integral_constant<int, 3>) {
+    put(Type::kDouble, static_cast<double>(value));
+  }
+  template <typename T>
+  void add_value(const T& value, std::integral_constant<int, 4>) {
+    if (value)
+      add_string(value, ::strlen(value));
+    else
+      add_string("(null)", 6);
+  }
+  template <typename T>
+  void add_value(const T& value, std::integral_constant<int, 5>) {
+    add_string(value.data(), value.size());
+  }
+  template <typename T>
+  void add_value(const T& value, std::integral_constant<int, 6>) {
+    put(Type::kPointer, reinterpret_cast<std::uintptr_t>(value));
+  }
+  // Everything else is turned into text right away as we can't know
+  // whether the value is still valid once the record is written.
+  template <typename T>
+  void add_value(const T& value, std::integral_constant<int, 7>) {
+    std::ostringstream out;
+    out << value;
+    const auto str = out.str();
+    add_string(str.data(), str.size());
+  }
+
+  template <typename T>
+  void put(Type type, const T& value) {
+    auto dst = reserve(1 + sizeof(T));
+    *dst = static_cast<std::uint8_t>(type);
+    ::memcpy(dst + 1, &value, sizeof(T));
+  }
+  void add_string(const char* str, std::size_t size);
+  std::uint8_t* reserve(std::size_t size);
+
+  alignas(8) std::array<std::uint8_t, 256> inline_;
+  std::vector<std::uint8_t> heap_;
+  std::size_t size_ = 0;
 };
+}  // namespace logging
+
+template <std::size_t N, typename... T>
+void Logger::Logf(Severity severity, const char* file, const char* function,
+                  std::uint32_t line, const char (&pattern)[N], T&&... args) {
+  if (!IsEnabled(severity))
+    return;
+  logging::Record record{severity, file, function, line, pattern, ::strnlen(pattern, N)};
+  record.add(std::forward<T>(args)...);
+  Submit(record);
+}
+
+template <typename... T>
+void Logger::Logf(Severity severity, const char* file, const char* function,
+                  std::uint32_t line, const std::string& pattern, T&&... args) {
+  if (!IsEnabled(severity))
+    return;
+  logging::Record record{severity, file, function, line, pattern.data(), pattern.size()};
+  record.add(std::forward<T>(args)...);
+  Submit(record);
+}
 
 // operator<< inserts severity into out.
 std::ostream& operator<<(std::ostream& out, Logger::Severity severity);
@@ -125,25 +326,31 @@ std::ostream& operator<<(std::ostream& out, const Logger::Location& location);
 Logger& Log();
 // SetLog installs the given logger as mcs-wide default logger.
 void SetLogger(const std::shared_ptr<Logger>& logger);
+
+// CreateAsyncLogger returns a logger which queues messages in per-thread
+// lock-free rings from where a single background thread formats and writes
+// them to out. Logging threads don't block on I/O unless their ring is
+// full, in which case they wait for the writer to catch up instead of
+// losing messages. This is the default.
+std::shared_ptr<Logger> CreateAsyncLogger(std::ostream& out);
+// CreateSynchronousLogger returns a logger formatting and writing messages
+// through boost::log on the calling thread.
+std::shared_ptr<Logger> CreateSynchronousLogger(std::ostream& out);
 }
 
-#define TRACE(...)     \
-  anbox::Log().Tracef( \
-      anbox::Logger::Location{__FILE__, __FUNCTION__, __LINE__}, __VA_ARGS__)
-#define DEBUG(...)     \
-  anbox::Log().Debugf( \
-      anbox::Logger::Location{__FILE__, __FUNCTION__, __LINE__}, __VA_ARGS__)
-#define INFO(...)     \
-  anbox::Log().Infof( \
-      anbox::Logger::Location{__FILE__, __FUNCTION__, __LINE__}, __VA_ARGS__)
-#define WARNING(...)     \
-  anbox::Log().Warningf( \
-      anbox::Logger::Location{__FILE__, __FUNCTION__, __LINE__}, __VA_ARGS__)
-#define ERROR(...)     \
-  anbox::Log().Errorf( \
-      anbox::Logger::Location{__FILE__, __FUNCTION__, __LINE__}, __VA_ARGS__)
-#define FATAL(...)     \
-  anbox::Log().Fatalf( \
-      anbox::Logger::Location{__FILE__, __FUNCTION__, __LINE__}, __VA_ARGS__)
+#define ANBOX_LOG(severity, ...)                                             \
+  do {                                                                       \
+    if (static_cast<int>(severity) >= ANBOX_LOG_MIN_SEVERITY &&              \
+        anbox::Log().IsEnabled(severity))                                    \
+      anbox::Log().Logf(severity, __FILE__, __FUNCTION__, __LINE__,          \
+                        __VA_ARGS__);                                        \
+  } while (0)
+
+#define TRACE(...) ANBOX_LOG(anbox::Logger::Severity::kTrace, __VA_ARGS__)
+#define DEBUG(...) ANBOX_LOG(anbox::Logger::Severity::kDebug, __VA_ARGS__)
+#define INFO(...) ANBOX_LOG(anbox::Logger::Severity::kInfo, __VA_ARGS__)
+#define WARNING(...) ANBOX_LOG(anbox::Logger::Severity::kWarning, __VA_ARGS__)
+#define ERROR(...) ANBOX_LOG(anbox::Logger::Severity::kError, __VA_ARGS__)
+#define FATAL(...) ANBOX_LOG(anbox::Logger::Severity::kFatal, __VA_ARGS__)
 
 #endif
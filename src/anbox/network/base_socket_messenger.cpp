@@ -18,14 +18,21 @@
 
 #include "anbox/network/base_socket_messenger.h"
 #include "anbox/common/variable_length_array.h"
+#include "anbox/network/fd_socket_transmission.h"
 #include "anbox/logger.h"
 
 #include <boost/throw_exception.hpp>
 
 #include <errno.h>
+#include <limits.h>
+#include <poll.h>
 #include <string.h>
+#include <sys/socket.h>
 
+#include <algorithm>
+#include <chrono>
 #include <stdexcept>
+#include <vector>
 
 namespace bs = boost::system;
 namespace ba = boost::asio;
@@ -33,6 +40,8 @@ namespace ba = boost::asio;
 namespace {
 /// Buffers need to be big enough to support messages
 unsigned int const serialization_buffer_size = 2048;
+/// Time a peer gets to drain its socket before we consider it stuck
+std::chrono::milliseconds const send_timeout{5000};
 }
 
 namespace anbox {
@@ -76,13 +85,21 @@ Credentials BaseSocketMessenger<stream_protocol>::creds() const {
 template <typename stream_protocol>
 ssize_t BaseSocketMessenger<stream_protocol>::send_raw(char const* data,
                                                        size_t length) {
-  VariableLengthArray<serialization_buffer_size> whole_message{length};
-  std::copy(data, data + length, whole_message.data());
-
   std::unique_lock<std::mutex> lg(message_lock);
   return ::send(socket_fd, data, length, MSG_NOSIGNAL);
 }
 
+template <typename stream_protocol>
+void BaseSocketMessenger<stream_protocol>::send_fds(std::vector<Fd> const& fds) {
+  std::unique_lock<std::mutex> lg(message_lock);
+  anbox::send_fds(socket_fd, fds);
+}
+
+template <typename stream_protocol>
+int BaseSocketMessenger<stream_protocol>::native_handle() const {
+  return socket_fd;
+}
+
 template <typename stream_protocol>
 void BaseSocketMessenger<stream_protocol>::send(char const* data,
                                                 size_t length) {
@@ -102,6 +119,56 @@ void BaseSocketMessenger<stream_protocol>::send(char const* data,
   }
 }
 
+template <typename stream_protocol>
+void BaseSocketMessenger<stream_protocol>::send_vectored(
+    struct iovec const* buffers, size_t count) {
+  std::vector<struct iovec> pending{buffers, buffers + count};
+  auto current = pending.begin();
+
+  std::unique_lock<std::mutex> lg(message_lock);
+  const auto deadline = std::chrono::steady_clock::now() + send_timeout;
+  while (current != pending.end()) {
+    struct msghdr msg;
+    ::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &(*current);
+    msg.msg_iovlen = std::min<size_t>(pending.end() - current, IOV_MAX);
+
+    auto written = ::sendmsg(socket_fd, &msg, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        // The socket is non-blocking so wait until the peer drained enough
+        // to let us continue with the rest of the message. Other senders
+        // queue up on the lock meanwhile, so a peer which stopped reading
+        // gets disconnected rather than stalling them forever.
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        struct pollfd fds = {socket_fd, POLLOUT, 0};
+        if (remaining.count() <= 0 || ::poll(&fds, 1, remaining.count()) == 0) {
+          ::shutdown(socket_fd, SHUT_RDWR);
+          BOOST_THROW_EXCEPTION(
+              bs::system_error(ETIMEDOUT, bs::system_category(), "sendmsg"));
+        }
+        continue;
+      }
+      BOOST_THROW_EXCEPTION(
+          bs::system_error(errno, bs::system_category(), "sendmsg"));
+    }
+
+    // Skip over everything which was fully written and adjust the first
+    // buffer which was only written partially.
+    while (current != pending.end() &&
+           static_cast<size_t>(written) >= current->iov_len) {
+      written -= current->iov_len;
+      ++current;
+    }
+    if (current != pending.end()) {
+      current->iov_base = static_cast<char*>(current->iov_base) + written;
+      current->iov_len -= written;
+    }
+  }
+}
+
 template <typename stream_protocol>
 void BaseSocketMessenger<stream_protocol>::async_receive_msg(
     AnboxReadHandler const& handler, ba::mutable_buffers_1 const& buffer) {
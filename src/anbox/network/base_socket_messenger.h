@@ -40,6 +40,7 @@ class BaseSocketMessenger : public SocketMessenger {
 
   void send(char const* data, size_t length) override;
   ssize_t send_raw(char const* data, size_t length) override;
+  void send_vectored(struct iovec const* buffers, size_t count) override;
   void async_receive_msg(AnboxReadHandler const& handle,
                          boost::asio::mutable_buffers_1 const& buffer) override;
   boost::system::error_code receive_msg(
@@ -48,6 +49,8 @@ class BaseSocketMessenger : public SocketMessenger {
 
   void set_no_delay() override;
   void close() override;
+  void send_fds(std::vector<Fd> const& fds) override;
+  int native_handle() const override;
 
  protected:
   BaseSocketMessenger();
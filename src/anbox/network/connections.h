@@ -51,15 +51,25 @@ class Connections {
     connections.clear();
   }
 
-  size_t size() { return connections.size(); }
+  size_t size() const {
+    std::unique_lock<std::mutex> lock(mutex);
+    return connections.size();
+  }
 
-  std::shared_ptr<Connection> at(size_t n) { return connections.at(n); }
+  // for_each calls the given function for all connections. The connection
+  // list is locked while doing so and must not be modified by the function.
+  template <typename Function>
+  void for_each(Function const& f) const {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (const auto& connection : connections)
+      f(connection.second);
+  }
 
  private:
   Connections(Connections const&) = delete;
   Connections& operator=(Connections const&) = delete;
 
-  std::mutex mutex;
+  mutable std::mutex mutex;
   std::map<int, std::shared_ptr<Connection>> connections;
 };
 }  // namespace anbox
@@ -19,6 +19,7 @@
 #define ANBOX_NETWORK_MESSAGE_PROCESSOR_H
 
 #include <cstdint>
+#include <functional>
 #include <vector>
 
 namespace anbox {
@@ -27,6 +28,15 @@ class MessageProcessor {
  public:
   virtual ~MessageProcessor() {}
   virtual bool process_data(const std::vector<std::uint8_t> &data) = 0;
+
+  // Called by the connection after process_data returned true. A processor
+  // which wants to move the data of the socket on its own (e.g. kernel-side
+  // with splice) returns true here. The connection then stops reading from
+  // the socket and is closed once the processor calls the given handler.
+  virtual bool took_over_socket(const std::function<void()> &done) {
+    (void)done;
+    return false;
+  }
 };
 }  // namespace network
 }  // namespace anbox
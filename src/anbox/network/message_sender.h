@@ -20,6 +20,7 @@
 #define ANBOX_NETWORK_MESSAGE_SENDER_H_
 
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <cstddef>
 
 namespace anbox {
@@ -28,6 +29,8 @@ class MessageSender {
  public:
   virtual void send(char const* data, size_t length) = 0;
   virtual ssize_t send_raw(char const* data, size_t length) = 0;
+  // Writes all buffers out as one message with a single writev where possible
+  virtual void send_vectored(struct iovec const* buffers, size_t count) = 0;
 
  protected:
   MessageSender() = default;
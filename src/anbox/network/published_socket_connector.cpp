@@ -25,18 +25,20 @@ namespace network {
 PublishedSocketConnector::PublishedSocketConnector(
     const std::string& socket_file, const std::shared_ptr<Runtime>& rt,
     const std::shared_ptr<ConnectionCreator<
-        boost::asio::local::stream_protocol>>& connection_creator)
+        boost::asio::local::stream_protocol>>& connection_creator,
+    const std::string& executor)
     : socket_file_(remove_socket_if_stale(socket_file)),
       runtime_(rt),
+      executor_(rt->executor(executor)),
       connection_creator_(connection_creator),
-      acceptor_(rt->service(), socket_file_) {
+      acceptor_(executor_->service(), socket_file_) {
   start_accept();
 }
 
 PublishedSocketConnector::~PublishedSocketConnector() {}
 
 void PublishedSocketConnector::start_accept() {
-  auto socket = std::make_shared<boost::asio::local::stream_protocol::socket>(runtime_->service());
+  auto socket = std::make_shared<boost::asio::local::stream_protocol::socket>(executor_->service());
 
   acceptor_.async_accept(*socket,
                          [this, socket](boost::system::error_code const& err) {
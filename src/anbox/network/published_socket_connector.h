@@ -33,7 +33,8 @@ class PublishedSocketConnector : public DoNotCopyOrMove, public Connector {
   explicit PublishedSocketConnector(
       const std::string& socket_file, const std::shared_ptr<Runtime>& rt,
       const std::shared_ptr<ConnectionCreator<
-          boost::asio::local::stream_protocol>>& connection_creator);
+          boost::asio::local::stream_protocol>>& connection_creator,
+      const std::string& executor = Runtime::default_executor);
   ~PublishedSocketConnector() noexcept;
 
   std::string socket_file() const { return socket_file_; }
@@ -46,6 +47,7 @@ class PublishedSocketConnector : public DoNotCopyOrMove, public Connector {
 
   const std::string socket_file_;
   std::shared_ptr<Runtime> runtime_;
+  std::shared_ptr<Runtime::Executor> executor_;
   std::shared_ptr<ConnectionCreator<boost::asio::local::stream_protocol>>
       connection_creator_;
   boost::asio::local::stream_protocol::acceptor acceptor_;
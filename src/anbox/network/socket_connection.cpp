@@ -52,6 +52,10 @@ void SocketConnection::send(char const* data, size_t length) {
   message_sender_->send(data, length);
 }
 
+ssize_t SocketConnection::send_raw(char const* data, size_t length) {
+  return message_sender_->send_raw(data, length);
+}
+
 void SocketConnection::read_next_message() {
   auto callback = std::bind(&SocketConnection::on_read_size, this, std::placeholders::_1, std::placeholders::_2);
   message_receiver_->async_receive_msg(callback, ba::buffer(buffer_));
@@ -66,10 +70,17 @@ void SocketConnection::on_read_size(const boost::system::error_code& error, std:
   std::vector<std::uint8_t> data(bytes_read);
   std::copy(buffer_.data(), buffer_.data() + bytes_read, data.data());
 
-  if (processor_->process_data(data))
-    read_next_message();
-  else
-      connections_->remove(id());
+  if (!processor_->process_data(data)) {
+    connections_->remove(id());
+    return;
+  }
+
+  auto connections = connections_;
+  auto id = id_;
+  if (processor_->took_over_socket([connections, id]() { connections->remove(id); }))
+    return;
+
+  read_next_message();
 }
 }  // namespace anbox
 }  // namespace network
@@ -45,6 +45,9 @@ class SocketConnection {
   int id() const { return id_; }
 
   void send(char const* data, size_t length);
+  // send_raw tries to write the data without blocking and returns the
+  // number of bytes written or -1 with errno set on failure.
+  ssize_t send_raw(char const* data, size_t length);
   void read_next_message();
 
  private:
@@ -20,7 +20,9 @@
 #define ANBOX_NETWORK_SOCKET_MESSENGER_H_
 
 #include <mutex>
+#include <vector>
 
+#include "anbox/common/fd.h"
 #include "anbox/network/credentials.h"
 #include "anbox/network/message_receiver.h"
 #include "anbox/network/message_sender.h"
@@ -33,6 +35,12 @@ class SocketMessenger : public MessageSender, public MessageReceiver {
   virtual unsigned short local_port() const = 0;
   virtual void set_no_delay() = 0;
   virtual void close() = 0;
+  // Sends the given file descriptors together with a single byte of
+  // payload to the peer.
+  virtual void send_fds(std::vector<Fd> const& fds) = 0;
+  // Returns the underlying socket descriptor. It stays owned by the
+  // messenger and must not be closed by the caller.
+  virtual int native_handle() const = 0;
 };
 }  // namespace network
 }  // namespace anbox
@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/network/splice_proxy.h"
+#include "anbox/logger.h"
+#include "anbox/utils.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+// Number of splice rounds a direction may do before it yields to other
+// handlers queued on the runtime.
+constexpr const unsigned int max_rounds_per_run{16};
+constexpr const std::size_t default_pipe_capacity{64 * 1024};
+
+int duplicate(int fd) {
+  const auto dup_fd = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if (dup_fd < 0)
+    BOOST_THROW_EXCEPTION(std::runtime_error(
+        anbox::utils::string_format("Failed to duplicate socket: %s", strerror(errno))));
+  return dup_fd;
+}
+
+// Other than send() splice() has no way to suppress SIGPIPE when the peer
+// of the destination socket is gone. We block it on the calling thread
+// while splicing and discard a signal raised by it so that it doesn't
+// terminate the process.
+class ScopedSigpipeBlock {
+ public:
+  ScopedSigpipeBlock() {
+    sigemptyset(&sigpipe_);
+    sigaddset(&sigpipe_, SIGPIPE);
+    sigset_t pending;
+    sigpending(&pending);
+    already_pending_ = sigismember(&pending, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigpipe_, &old_mask_);
+  }
+
+  ~ScopedSigpipeBlock() {
+    if (!already_pending_) {
+      sigset_t pending;
+      sigpending(&pending);
+      if (sigismember(&pending, SIGPIPE)) {
+        const struct timespec no_wait{0, 0};
+        while (sigtimedwait(&sigpipe_, nullptr, &no_wait) == -1 && errno == EINTR);
+      }
+    }
+    pthread_sigmask(SIG_SETMASK, &old_mask_, nullptr);
+  }
+
+ private:
+  sigset_t sigpipe_;
+  sigset_t old_mask_;
+  bool already_pending_ = false;
+};
+}
+
+namespace anbox {
+namespace network {
+constexpr const std::size_t SpliceProxy::pipe_size;
+
+SpliceProxy::SpliceProxy(const std::shared_ptr<Runtime> &rt, int first, int second)
+    : strand_(rt->service()),
+      first_(rt->service(), duplicate(first)),
+      second_(rt->service(), duplicate(second)) {
+  // Both pumps rely on the sockets never blocking the runtime threads.
+  first_.non_blocking(true);
+  second_.non_blocking(true);
+
+  first_to_second_.from = &first_;
+  first_to_second_.to = &second_;
+  setup_pipe(first_to_second_);
+
+  second_to_first_.from = &second_;
+  second_to_first_.to = &first_;
+  setup_pipe(second_to_first_);
+}
+
+SpliceProxy::~SpliceProxy() {}
+
+void SpliceProxy::setup_pipe(Direction &direction) {
+  int fds[2];
+  if (::pipe2(fds, O_CLOEXEC | O_NONBLOCK) < 0)
+    BOOST_THROW_EXCEPTION(std::runtime_error(
+        utils::string_format("Failed to create pipe: %s", strerror(errno))));
+
+  direction.pipe_read = Fd{fds[0]};
+  direction.pipe_write = Fd{fds[1]};
+
+  // Not being able to grow the pipe only costs throughput so we continue
+  // with whatever size the kernel gives us.
+  ::fcntl(fds[1], F_SETPIPE_SZ, static_cast<int>(pipe_size));
+  const auto capacity = ::fcntl(fds[1], F_GETPIPE_SZ);
+  const auto pipe_capacity = capacity > 0 ? static_cast<std::size_t>(capacity) : default_pipe_capacity;
+  pipe_capacity_ = pipe_capacity_ == 0 ? pipe_capacity : std::min(pipe_capacity_, pipe_capacity);
+}
+
+void SpliceProxy::start(const std::function<void()> &done) {
+  {
+    std::lock_guard<std::mutex> l(done_lock_);
+    done_ = done;
+  }
+
+  auto self = shared_from_this();
+  strand_.post([self]() { self->pump(self->first_to_second_); });
+  strand_.post([self]() { self->pump(self->second_to_first_); });
+}
+
+void SpliceProxy::stop() {
+  {
+    std::lock_guard<std::mutex> l(done_lock_);
+    done_ = nullptr;
+  }
+
+  auto self = shared_from_this();
+  strand_.dispatch([self]() { self->finish(false); });
+}
+
+void SpliceProxy::pump(Direction &direction) {
+  if (finished_ || direction.done)
+    return;
+
+  ScopedSigpipeBlock sigpipe_block;
+
+  for (unsigned int round = 0; round < max_rounds_per_run; ++round) {
+    bool progress = false;
+    bool output_blocked = false;
+
+    if (!direction.eof && direction.in_pipe < pipe_capacity_) {
+      const auto n = ::splice(direction.from->native_handle(), nullptr,
+                              direction.pipe_write, nullptr,
+                              pipe_capacity_ - direction.in_pipe,
+                              SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if (n > 0) {
+        direction.in_pipe += n;
+        progress = true;
+      } else if (n == 0) {
+        direction.eof = true;
+      } else if (errno != EAGAIN && errno != EINTR) {
+        DEBUG("Failed to read from socket: %s", strerror(errno));
+        finish(true);
+        return;
+      }
+    }
+
+    if (direction.in_pipe > 0) {
+      const auto n = ::splice(direction.pipe_read, nullptr,
+                              direction.to->native_handle(), nullptr,
+                              direction.in_pipe,
+                              SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if (n > 0) {
+        direction.in_pipe -= n;
+        direction.forwarded += n;
+        progress = true;
+      } else if (n < 0 && errno == EAGAIN) {
+        output_blocked = true;
+      } else if (n < 0 && errno != EINTR) {
+        DEBUG("Failed to write to socket: %s", strerror(errno));
+        finish(true);
+        return;
+      }
+    }
+
+    if (direction.eof && direction.in_pipe == 0) {
+      // Everything the peer sent before it shut down its side is
+      // forwarded; pass the shutdown on and keep the other direction
+      // going as the peer may still wait for a reply.
+      direction.done = true;
+      ::shutdown(direction.to->native_handle(), SHUT_WR);
+      if (first_to_second_.done && second_to_first_.done)
+        finish(true);
+      return;
+    }
+
+    if (!progress) {
+      // A full pipe means the destination is the bottleneck; stop reading
+      // from the source until it accepts data again.
+      wait(direction, output_blocked || direction.in_pipe == pipe_capacity_);
+      return;
+    }
+  }
+
+  auto self = shared_from_this();
+  strand_.post([self, &direction]() { self->pump(direction); });
+}
+
+void SpliceProxy::wait(Direction &direction, bool for_output) {
+  auto self = shared_from_this();
+  auto handler = strand_.wrap([self, &direction](const boost::system::error_code &err, std::size_t) {
+    if (err == boost::asio::error::operation_aborted)
+      return;
+    self->pump(direction);
+  });
+
+  if (for_output)
+    direction.to->async_write_some(boost::asio::null_buffers(), handler);
+  else
+    direction.from->async_read_some(boost::asio::null_buffers(), handler);
+}
+
+void SpliceProxy::finish(bool notify) {
+  if (finished_)
+    return;
+
+  finished_ = true;
+
+  DEBUG("Proxy finished after forwarding %d bytes to the first and %d bytes to the second peer",
+        forwarded_to_first(), forwarded_to_second());
+
+  boost::system::error_code err;
+  first_.close(err);
+  second_.close(err);
+
+  if (!notify)
+    return;
+
+  std::function<void()> done;
+  {
+    std::lock_guard<std::mutex> l(done_lock_);
+    std::swap(done, done_);
+  }
+
+  if (done)
+    done();
+}
+}  // namespace network
+}  // namespace anbox
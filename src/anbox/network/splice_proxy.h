@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_NETWORK_SPLICE_PROXY_H_
+#define ANBOX_NETWORK_SPLICE_PROXY_H_
+
+#include "anbox/common/fd.h"
+#include "anbox/runtime.h"
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace anbox {
+namespace network {
+// SpliceProxy forwards all data between two connected sockets in both
+// directions without copying it through user space. Each direction moves
+// the data with splice() from its source socket into a pipe and from there
+// into the destination socket.
+//
+// The pipe of a direction is the only buffer the proxy has. Once it is full
+// because the destination doesn't take more data, the proxy stops reading
+// from the source until the destination becomes writable again. The kernel
+// socket buffers then fill up and the sending peer is blocked, so a slow
+// reader throttles the writer on the other side.
+//
+// When a peer shuts down its sending side, the data still in flight is
+// forwarded and the other peer's socket is shut down for writing, so a
+// peer can half-close its connection and still receive a reply. The proxy
+// finishes once both directions reached their end or one of the peers
+// fails.
+// The descriptors given are duplicated, so the callers keep ownership of
+// theirs and are responsible for closing them.
+class SpliceProxy : public std::enable_shared_from_this<SpliceProxy> {
+ public:
+  // Size we ask the kernel for for each of the pipes. It bounds the amount
+  // of data in flight in each direction on top of the socket buffers.
+  static constexpr const std::size_t pipe_size{256 * 1024};
+
+  SpliceProxy(const std::shared_ptr<Runtime> &rt, int first, int second);
+  ~SpliceProxy();
+
+  // Starts forwarding data. The done handler is called once from one of
+  // the runtime threads when the proxy finished because both peers closed
+  // their side or one of them failed.
+  void start(const std::function<void()> &done);
+
+  // Stops forwarding data without calling the done handler.
+  void stop();
+
+  std::uint64_t forwarded_to_first() const { return second_to_first_.forwarded; }
+  std::uint64_t forwarded_to_second() const { return first_to_second_.forwarded; }
+
+ private:
+  struct Direction {
+    boost::asio::posix::stream_descriptor *from;
+    boost::asio::posix::stream_descriptor *to;
+    Fd pipe_read;
+    Fd pipe_write;
+    std::size_t in_pipe = 0;
+    bool eof = false;
+    // All data was forwarded after the source reached its end.
+    bool done = false;
+    std::atomic<std::uint64_t> forwarded{0};
+  };
+
+  void setup_pipe(Direction &direction);
+  void pump(Direction &direction);
+  void wait(Direction &direction, bool for_output);
+  void finish(bool notify);
+
+  boost::asio::io_service::strand strand_;
+  boost::asio::posix::stream_descriptor first_;
+  boost::asio::posix::stream_descriptor second_;
+  Direction first_to_second_;
+  Direction second_to_first_;
+  std::size_t pipe_capacity_ = 0;
+  bool finished_ = false;
+  std::mutex done_lock_;
+  std::function<void()> done_;
+};
+}  // namespace network
+}  // namespace anbox
+
+#endif
@@ -25,12 +25,14 @@ TcpSocketConnector::TcpSocketConnector(
     const boost::asio::ip::address_v4& address, unsigned short port,
     const std::shared_ptr<Runtime>& rt,
     const std::shared_ptr<ConnectionCreator<boost::asio::ip::tcp>>&
-        connection_creator)
+        connection_creator,
+    const std::string& executor)
     : address_(address),
       port_(port),
       runtime_(rt),
+      executor_(rt->executor(executor)),
       connection_creator_(connection_creator),
-      acceptor_(rt->service(), boost::asio::ip::tcp::endpoint(address, port)) {
+      acceptor_(executor_->service(), boost::asio::ip::tcp::endpoint(address, port)) {
   start_accept();
 }
 
@@ -38,7 +40,7 @@ TcpSocketConnector::~TcpSocketConnector() { acceptor_.cancel(); }
 
 void TcpSocketConnector::start_accept() {
   auto socket =
-      std::make_shared<boost::asio::ip::tcp::socket>(runtime_->service());
+      std::make_shared<boost::asio::ip::tcp::socket>(executor_->service());
 
   acceptor_.async_accept(*socket,
                          [this, socket](boost::system::error_code const& err) {
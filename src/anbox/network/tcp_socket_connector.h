@@ -34,7 +34,8 @@ class TcpSocketConnector : public DoNotCopyOrMove, public Connector {
       const boost::asio::ip::address_v4 &address, unsigned short port,
       const std::shared_ptr<Runtime> &rt,
       const std::shared_ptr<ConnectionCreator<boost::asio::ip::tcp>>
-          &connection_creator);
+          &connection_creator,
+      const std::string &executor = Runtime::default_executor);
   ~TcpSocketConnector() noexcept;
 
   unsigned short port() const { return port_; }
@@ -48,6 +49,7 @@ class TcpSocketConnector : public DoNotCopyOrMove, public Connector {
   boost::asio::ip::address_v4 address_;
   unsigned short port_;
   std::shared_ptr<Runtime> runtime_;
+  std::shared_ptr<Runtime::Executor> executor_;
   std::shared_ptr<ConnectionCreator<boost::asio::ip::tcp>> connection_creator_;
   boost::asio::ip::tcp::acceptor acceptor_;
 };
@@ -48,7 +48,8 @@ DefaultPolicy::ClipboardData DefaultPolicy::get_clipboard_data() {
   return ClipboardData{};
 }
 
-std::shared_ptr<audio::Sink> DefaultPolicy::create_audio_sink() {
+std::shared_ptr<audio::Sink> DefaultPolicy::create_audio_sink(const audio::StreamConfig &config) {
+  (void)config;
   ERROR("Not implemented");
   return nullptr;
 }
@@ -31,7 +31,7 @@ class DefaultPolicy : public Policy {
       const std::string &title) override;
   void set_clipboard_data(const ClipboardData &data) override;
   ClipboardData get_clipboard_data() override;
-  std::shared_ptr<audio::Sink> create_audio_sink() override;
+  std::shared_ptr<audio::Sink> create_audio_sink(const audio::StreamConfig &config) override;
   std::shared_ptr<audio::Source> create_audio_source() override;
 };
 }  // namespace wm
@@ -23,12 +23,16 @@
 
 #include <memory>
 
+class Renderer;
+
 namespace anbox {
 namespace audio {
 class Sink;
 class Source;
+struct StreamConfig;
 } // namespace audio
 namespace wm {
+class Manager;
 class Window;
 } // namespace wm
 namespace platform {
@@ -38,6 +42,11 @@ class Policy {
 
   virtual std::shared_ptr<wm::Window> create_window(const anbox::wm::Task::Id &task, const anbox::graphics::Rect &frame, const std::string &title) = 0;
 
+  // Policies which create windows need the renderer to draw into them and
+  // the window manager to report what the user did with them.
+  virtual void set_renderer(const std::shared_ptr<Renderer> &renderer) { (void)renderer; }
+  virtual void set_window_manager(const std::shared_ptr<wm::Manager> &window_manager) { (void)window_manager; }
+
   struct ClipboardData {
     std::string text;
   };
@@ -45,7 +54,7 @@ class Policy {
   virtual void set_clipboard_data(const ClipboardData &data) = 0;
   virtual ClipboardData get_clipboard_data() = 0;
 
-  virtual std::shared_ptr<audio::Sink> create_audio_sink() = 0;
+  virtual std::shared_ptr<audio::Sink> create_audio_sink(const audio::StreamConfig &config) = 0;
   virtual std::shared_ptr<audio::Source> create_audio_source() = 0;
 };
 }  // namespace wm
@@ -50,6 +50,8 @@ AdbMessageProcessor::AdbMessageProcessor(
 
 AdbMessageProcessor::~AdbMessageProcessor() {
   state_ = closed_by_host;
+  if (proxy_)
+    proxy_->stop();
   host_connector_.reset();
   active_instance.unlock();
 }
@@ -78,7 +80,7 @@ void AdbMessageProcessor::advance_state() {
       break;
     case waiting_for_guest_start_command:
       state_ = proxying_data;
-      read_next_host_message();
+      start_proxying();
       break;
     case proxying_data:
       break;
@@ -99,6 +101,44 @@ void AdbMessageProcessor::advance_state() {
   }
 }
 
+void AdbMessageProcessor::start_proxying() {
+  // Anything the guest sent together with the start command is already
+  // read from its socket and has to go out before the proxy takes over.
+  if (!buffer_.empty()) {
+    host_messenger_->send(reinterpret_cast<const char *>(buffer_.data()), buffer_.size());
+    buffer_.clear();
+  }
+
+  try {
+    proxy_ = std::make_shared<network::SpliceProxy>(
+        runtime_, messenger_->native_handle(), host_messenger_->native_handle());
+  } catch (std::exception &err) {
+    WARNING("Failed to setup zero-copy proxy, copying data instead: %s", err.what());
+    read_next_host_message();
+  }
+}
+
+bool AdbMessageProcessor::took_over_socket(const std::function<void()> &done) {
+  if (state_ != proxying_data || !proxy_ || proxy_started_)
+    return false;
+
+  // From here on the proxy moves all data between the guest and the host
+  // adb and the socket connection doesn't read from the guest anymore.
+  proxy_started_ = true;
+  auto messenger = messenger_;
+  auto host_messenger = host_messenger_;
+  proxy_->start([this, messenger, host_messenger, done]() {
+    state_ = closed_by_host;
+    host_messenger->close();
+    messenger->close();
+    // Removes the socket connection which owns us; nothing may touch
+    // this instance afterwards.
+    done();
+  });
+
+  return true;
+}
+
 void AdbMessageProcessor::wait_for_host_connection() {
   if (!host_connector_) {
     host_connector_ = std::make_shared<network::TcpSocketConnector>(
@@ -21,6 +21,7 @@
 #include "anbox/network/message_processor.h"
 #include "anbox/network/socket_connection.h"
 #include "anbox/network/socket_messenger.h"
+#include "anbox/network/splice_proxy.h"
 #include "anbox/network/tcp_socket_connector.h"
 #include "anbox/network/tcp_socket_messenger.h"
 #include "anbox/runtime.h"
@@ -37,6 +38,7 @@ class AdbMessageProcessor : public network::MessageProcessor {
   ~AdbMessageProcessor();
 
   bool process_data(const std::vector<std::uint8_t> &data) override;
+  bool took_over_socket(const std::function<void()> &done) override;
 
  private:
   enum State {
@@ -49,6 +51,7 @@ class AdbMessageProcessor : public network::MessageProcessor {
   };
 
   void advance_state();
+  void start_proxying();
 
   void wait_for_host_connection();
   void on_host_connection(std::shared_ptr<boost::asio::basic_stream_socket<
@@ -65,6 +68,8 @@ class AdbMessageProcessor : public network::MessageProcessor {
   std::shared_ptr<network::TcpSocketConnector> host_connector_;
   std::shared_ptr<network::TcpSocketMessenger> host_messenger_;
   std::array<std::uint8_t, 8192> host_buffer_;
+  std::shared_ptr<network::SpliceProxy> proxy_;
+  bool proxy_started_ = false;
   boost::asio::deadline_timer host_notify_timer_;
 };
 }  // namespace graphics
@@ -15,51 +15,41 @@
  *
  */
 
-#include "anbox/qemu//at_parser.h"
+#include "anbox/qemu/at_parser.h"
 #include "anbox/logger.h"
-#include "anbox/utils.h"
 
 namespace anbox {
 namespace qemu {
-AtParser::AtParser() {}
+AtParser::AtParser() : parser_(FrameParser::delimited("\r\n")) {}
 
 void AtParser::register_command(const std::string &command,
                                 CommandHandler handler) {
   handlers_.insert({command, handler});
 }
 
-void AtParser::process_data(std::vector<std::uint8_t> &data) {
-  size_t bytes_processed = 0;
-  for (size_t pos = 0; pos < data.size();) {
-    const auto byte = data.at(pos);
-    if (byte == '\n' || byte == '\r') {
-      std::string command;
-      command.insert(
-          0, reinterpret_cast<const char *>(data.data()) + bytes_processed,
-          pos - bytes_processed);
-      bytes_processed += (pos - bytes_processed) + 1;
-      processs_command(command);
-    }
-    pos++;
-  }
-
-  data.erase(data.begin(), data.begin() + bytes_processed);
+void AtParser::process_data(const std::vector<std::uint8_t> &data) {
+  if (!parser_.feed(data, [&](const boost::string_view &command) {
+        // Commands are terminated by \r, \n or both so skip the empty
+        // lines in between.
+        if (!command.empty()) process_command(command);
+      }))
+    WARNING("Dropping oversized AT command");
 }
 
-void AtParser::processs_command(const std::string &command) {
-  if (!utils::string_starts_with(command, "AT")) {
+void AtParser::process_command(const boost::string_view &command) {
+  if (!command.starts_with("AT")) {
     WARNING("Invalid AT command: '%s'", command);
     return;
   }
 
   // Strip AT prefix from command
-  auto real_command = command.substr(2, command.length() - 2);
+  const auto real_command = command.substr(2);
 
   DEBUG("command: %s", real_command);
 
   CommandHandler handler = nullptr;
   for (const auto &iter : handlers_) {
-    if (utils::string_starts_with(real_command, iter.first)) {
+    if (real_command.starts_with(iter.first)) {
       handler = iter.second;
       break;
     }
@@ -18,6 +18,9 @@
 #ifndef ANBOX_QEMU_AT_PARSER_H_
 #define ANBOX_QEMU_AT_PARSER_H_
 
+#include "anbox/qemu/frame_parser.h"
+
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -29,18 +32,19 @@ namespace anbox {
 namespace qemu {
 class AtParser {
  public:
-  typedef std::function<void(const std::string &)> CommandHandler;
+  typedef std::function<void(const boost::string_view &)> CommandHandler;
 
   AtParser();
 
   void register_command(const std::string &command, CommandHandler handler);
 
-  void process_data(std::vector<std::uint8_t> &data);
+  void process_data(const std::vector<std::uint8_t> &data);
 
  private:
-  void processs_command(const std::string &command);
+  void process_command(const boost::string_view &command);
 
   std::map<std::string, CommandHandler> handlers_;
+  FrameParser parser_;
 };
 }  // namespace qemu
 }  // namespace anbox
@@ -28,7 +28,7 @@ BootPropertiesMessageProcessor::BootPropertiesMessageProcessor(
 BootPropertiesMessageProcessor::~BootPropertiesMessageProcessor() {}
 
 void BootPropertiesMessageProcessor::handle_command(
-    const std::string &command) {
+    const boost::string_view &command) {
   if (command == "list") list_properties();
 }
 
@@ -41,12 +41,7 @@ void BootPropertiesMessageProcessor::list_properties() {
                            static_cast<int>(graphics::DensityType::medium)),
   };
 
-  for (const auto &prop : properties) {
-    send_header(prop.length());
-    messenger_->send(prop.c_str(), prop.length());
-  }
-
-  finish_message();
+  send_messages({properties.begin(), properties.end()});
 }
 }  // namespace qemu
 }  // namespace anbox
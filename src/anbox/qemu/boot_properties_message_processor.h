@@ -29,7 +29,7 @@ class BootPropertiesMessageProcessor : public QemudMessageProcessor {
   ~BootPropertiesMessageProcessor();
 
  protected:
-  void handle_command(const std::string &command) override;
+  void handle_command(const boost::string_view &command) override;
 
  private:
   void list_properties();
@@ -29,7 +29,8 @@ BootAnimationMessageProcessor::BootAnimationMessageProcessor(
 
 BootAnimationMessageProcessor::~BootAnimationMessageProcessor() {}
 
-void BootAnimationMessageProcessor::handle_command(const std::string &command) {
+void BootAnimationMessageProcessor::handle_command(
+    const boost::string_view &command) {
   if (command == "retrieve-icon") retrieve_icon();
 }
 
@@ -30,7 +30,7 @@ class BootAnimationMessageProcessor : public QemudMessageProcessor {
   ~BootAnimationMessageProcessor();
 
  protected:
-  void handle_command(const std::string &command) override;
+  void handle_command(const boost::string_view &command) override;
 
  private:
   void retrieve_icon();
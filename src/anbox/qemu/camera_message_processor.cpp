@@ -15,50 +15,306 @@
  *
  */
 
+
 #include "anbox/qemu/camera_message_processor.h"
+#include "anbox/camera/frame_ring.h"
+#include "anbox/camera/manager.h"
 #include "anbox/logger.h"
+#include "anbox/utils.h"
+
+#include <sys/uio.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+constexpr const char *camera_name_param{"name"};
+
+// Splits 'key=value key2' into its parts; parameters without a value are
+// stored with an empty one.
+std::map<std::string, std::string> parse_parameters(const boost::string_view &text) {
+  std::map<std::string, std::string> params;
+  for (const auto &token : anbox::utils::string_split(text.to_string(), ' ')) {
+    if (token.empty()) continue;
+    const auto pos = token.find('=');
+    if (pos == std::string::npos)
+      params[token] = "";
+    else
+      params[token.substr(0, pos)] = token.substr(pos + 1);
+  }
+  return params;
+}
+
+std::size_t size_parameter(const std::map<std::string, std::string> &params,
+                           const std::string &name) {
+  const auto it = params.find(name);
+  if (it == params.end()) return 0;
+  return std::strtoul(it->second.c_str(), nullptr, 10);
+}
+
+std::string frame_dimensions(const std::vector<anbox::camera::Size> &sizes) {
+  std::string dims;
+  for (const auto &size : sizes) {
+    if (!dims.empty()) dims += ",";
+    dims += anbox::utils::string_format("%dx%d", size.width, size.height);
+  }
+  return dims;
+}
+}  // namespace
 
 namespace anbox {
 namespace qemu {
 CameraMessageProcessor::CameraMessageProcessor(
-    const std::shared_ptr<network::SocketMessenger> &messenger)
-    : messenger_(messenger) {}
+    const std::shared_ptr<network::SocketMessenger> &messenger,
+    const std::string &arguments)
+    : messenger_(messenger),
+      parser_(FrameParser::nul_delimited()),
+      started_(false),
+      pixel_format_(camera::PixelFormat::yuv420) {
+  const auto params = parse_parameters(arguments);
+  const auto it = params.find(camera_name_param);
+  if (it != params.end()) camera_name_ = it->second;
+}
 
-CameraMessageProcessor::~CameraMessageProcessor() {}
+CameraMessageProcessor::~CameraMessageProcessor() {
+  if (started_) source_->stop();
+}
 
 bool CameraMessageProcessor::process_data(
     const std::vector<std::uint8_t> &data) {
-  for (const auto &byte : data) buffer_.push_back(byte);
-
-  process_commands();
+  if (!parser_.feed(data, [&](const boost::string_view &command) {
+        handle_command(command);
+      }))
+    WARNING("Dropping oversized camera command");
 
   return true;
 }
 
-void CameraMessageProcessor::process_commands() {
-  while (buffer_.size() > 0) {
-    size_t size = 0;
-    while (size < buffer_.size()) {
-      if (buffer_.at(size) == 0x0) break;
-      size++;
-    }
+void CameraMessageProcessor::handle_command(
+    const boost::string_view &command) {
+  const auto pos = command.find(' ');
+  const auto name = command.substr(0, pos);
+  const auto params = pos == boost::string_view::npos
+                          ? Parameters{}
+                          : parse_parameters(command.substr(pos + 1));
+
+  // The factory client connects without a camera name and may only ask
+  // for the list of cameras.
+  if (camera_name_.empty()) {
+    if (name == "list")
+      list();
+    else
+      reply_ko("Unknown factory query");
+    return;
+  }
+
+  if (name == "connect")
+    connect();
+  else if (name == "disconnect")
+    disconnect();
+  else if (name == "start")
+    start(params);
+  else if (name == "stop")
+    stop();
+  else if (name == "frame")
+    frame(params);
+  else
+    reply_ko(utils::string_format("Unknown query '%s'", name.to_string()));
+}
+
+void CameraMessageProcessor::list() {
+  std::string cameras;
+  int channel = 0;
+  for (const auto &source : camera::Manager::get()->sources()) {
+    cameras += utils::string_format(
+        "name=%s channel=%d pix=%d dir=%s framedims=%s\n", source->name(),
+        channel++, static_cast<std::uint32_t>(camera::PixelFormat::yuv420),
+        source->direction(), frame_dimensions(source->frame_sizes()));
+  }
+  // An empty line tells the HAL that there are no cameras.
+  reply_ok(cameras.empty() ? "\n" : cameras);
+}
+
+void CameraMessageProcessor::connect() {
+  if (source_) {
+    reply_ko("Camera is already connected");
+    return;
+  }
 
-    std::string command;
-    command.insert(0, reinterpret_cast<const char *>(buffer_.data()), size);
-    buffer_.erase(buffer_.begin(), buffer_.begin() + size + 1);
+  const auto manager = camera::Manager::get();
+  if (!manager->find(camera_name_)) {
+    reply_ko(utils::string_format("Camera '%s' does not exist", camera_name_));
+    return;
+  }
 
-    handle_command(command);
+  source_ = manager->acquire(camera_name_);
+  if (!source_) {
+    reply_ko(utils::string_format("Camera '%s' is already in use", camera_name_));
+    return;
   }
+  reply_ok();
 }
 
-void CameraMessageProcessor::handle_command(const std::string &command) {
-  if (command == "list") list();
+void CameraMessageProcessor::disconnect() {
+  if (started_) stop();
+  source_.reset();
+  reply_ok();
 }
 
-void CameraMessageProcessor::list() {
-  char buf[5];
-  snprintf(buf, 5, "\n");
-  messenger_->send(buf, strlen(buf));
+void CameraMessageProcessor::start(const Parameters &params) {
+  if (!source_) {
+    reply_ko("Camera is not connected");
+    return;
+  }
+  if (started_) {
+    reply_ko("Camera is already started");
+    return;
+  }
+
+  const auto dim = params.find("dim");
+  int width = 0, height = 0;
+  if (dim == params.end() ||
+      std::sscanf(dim->second.c_str(), "%dx%d", &width, &height) != 2 ||
+      width <= 0 || height <= 0 || (width & 1) || (height & 1)) {
+    reply_ko("Invalid frame dimensions");
+    return;
+  }
+
+  const auto pix = static_cast<std::uint32_t>(size_parameter(params, "pix"));
+  if (!camera::pixel_format_from_fourcc(pix, pixel_format_)) {
+    reply_ko("Unsupported pixel format");
+    return;
+  }
+
+  if (!source_->start(camera::Size{width, height})) {
+    reply_ko("Failed to start camera");
+    return;
+  }
+
+  started_ = true;
+  frame_.resize(width, height);
+
+  const auto video_size = camera::frame_size(pixel_format_, width, height);
+  const auto preview_size =
+      camera::frame_size(camera::PixelFormat::rgb32, width, height);
+
+  if (params.count("shm") == 0) {
+    video_.resize(video_size);
+    preview_.resize(preview_size);
+    reply_ok();
+    return;
+  }
+
+  try {
+    ring_ = camera::FrameRing::create(video_size + preview_size);
+  } catch (std::exception &err) {
+    ERROR("Failed to create camera frame ring: %s", err.what());
+    stop();
+    reply_ko("Failed to create frame ring");
+    return;
+  }
+
+  reply_ok(utils::string_format("shm=%d,%d", ring_->slot_count(),
+                                ring_->slot_size()));
+  messenger_->send_fds({ring_->fd()});
+}
+
+void CameraMessageProcessor::stop() {
+  if (!started_) {
+    reply_ko("Camera is not started");
+    return;
+  }
+
+  source_->stop();
+  started_ = false;
+  ring_.reset();
+  video_.clear();
+  preview_.clear();
+  reply_ok();
+}
+
+void CameraMessageProcessor::frame(const Parameters &params) {
+  if (!started_) {
+    reply_ko("Camera is not started");
+    return;
+  }
+
+  // White balance and exposure compensation the HAL passes as well are
+  // not applied; sources deliver their frames as they are.
+  const auto video_size = size_parameter(params, "video");
+  const auto preview_size = size_parameter(params, "preview");
+  const auto expected_video_size =
+      camera::frame_size(pixel_format_, frame_.width(), frame_.height());
+  const auto expected_preview_size = camera::frame_size(
+      camera::PixelFormat::rgb32, frame_.width(), frame_.height());
+  if ((video_size > 0 && video_size != expected_video_size) ||
+      (preview_size > 0 && preview_size != expected_preview_size)) {
+    reply_ko("Invalid frame size");
+    return;
+  }
+
+  if (!source_->read(frame_)) {
+    reply_ko("Failed to read frame");
+    return;
+  }
+
+  if (ring_) {
+    std::uint8_t *data = nullptr;
+    const auto slot = ring_->begin_write(&data);
+    if (video_size > 0) camera::convert(frame_, pixel_format_, data);
+    if (preview_size > 0) camera::i420_to_rgb32(frame_, data + video_size);
+    ring_->end_write(slot, video_size, preview_size);
+    reply_ok(utils::string_format("slot=%d,%d,%d", slot, video_size, preview_size));
+    return;
+  }
+
+  std::vector<struct iovec> buffers;
+  if (video_size > 0) {
+    camera::convert(frame_, pixel_format_, video_.data());
+    buffers.push_back({video_.data(), video_size});
+  }
+  if (preview_size > 0) {
+    camera::i420_to_rgb32(frame_, preview_.data());
+    buffers.push_back({preview_.data(), preview_size});
+  }
+  reply(true, buffers.data(), buffers.size());
+}
+
+void CameraMessageProcessor::reply_ok(const std::string &data) {
+  if (data.empty()) {
+    reply(true, nullptr, 0);
+    return;
+  }
+  // Textual reply data is sent including its terminating null byte.
+  struct iovec buffer { const_cast<char *>(data.c_str()), data.size() + 1 };
+  reply(true, &buffer, 1);
+}
+
+void CameraMessageProcessor::reply_ko(const std::string &reason) {
+  WARNING("Camera query failed: %s", reason);
+  struct iovec buffer { const_cast<char *>(reason.c_str()), reason.size() + 1 };
+  reply(false, &buffer, 1);
+}
+
+void CameraMessageProcessor::reply(bool ok, const struct iovec *data,
+                                   std::size_t count) {
+  std::size_t data_size = 0;
+  for (std::size_t n = 0; n < count; n++) data_size += data[n].iov_len;
+
+  // The status is always three bytes: either followed by ':' and the data
+  // or by a null byte if there is none.
+  const char *status = ok ? (data_size > 0 ? "ok:" : "ok") :
+                            (data_size > 0 ? "ko:" : "ko");
+
+  char header[9];
+  std::snprintf(header, sizeof(header), "%08zx", data_size + 3);
+
+  std::vector<struct iovec> buffers;
+  buffers.reserve(count + 2);
+  buffers.push_back({header, 8});
+  buffers.push_back({const_cast<char *>(status), 3});
+  buffers.insert(buffers.end(), data, data + count);
+  messenger_->send_vectored(buffers.data(), buffers.size());
 }
 }  // namespace qemu
 }  // namespace anbox
@@ -15,32 +15,76 @@
  *
  */
 
+
 #ifndef ANBOX_QEMU_CAMERA_MESSAGE_PROCESSOR_H_
 #define ANBOX_QEMU_CAMERA_MESSAGE_PROCESSOR_H_
 
+#include "anbox/camera/converter.h"
+#include "anbox/camera/frame.h"
 #include "anbox/network/message_processor.h"
 #include "anbox/network/socket_messenger.h"
+#include "anbox/qemu/frame_parser.h"
+
+#include <map>
 
 namespace anbox {
+namespace camera {
+class FrameRing;
+class Source;
+}  // namespace camera
 namespace qemu {
+// CameraMessageProcessor implements the qemu camera service the emulated
+// camera HAL talks to. Without arguments the client is the camera factory
+// which only asks for the list of cameras. A client connecting with
+// 'name=<camera>' as argument drives that camera through the
+// connect/start/frame/stop queries.
+//
+// Every reply is the payload size as 8 hex digits followed by the payload
+// which is 'ok' or 'ko', optionally followed by ':' and reply data.
+//
+// A client passing 'shm' to the start query receives frames through a
+// camera::FrameRing instead of the frame reply. The start reply is then
+// 'ok:shm=<slots>,<slot size>' followed by the memfd of the ring, sent with
+// SCM_RIGHTS along with a single dummy byte the client has to consume with
+// it, and frame replies only name the slot:
+// 'ok:slot=<slot>,<video size>,<preview size>'. The camera HAL in
+// android/camera/QemuClient.cpp is the client doing so.
 class CameraMessageProcessor : public network::MessageProcessor {
  public:
   CameraMessageProcessor(
-      const std::shared_ptr<network::SocketMessenger> &messenger);
+      const std::shared_ptr<network::SocketMessenger> &messenger,
+      const std::string &arguments = "");
   ~CameraMessageProcessor();
 
   bool process_data(const std::vector<std::uint8_t> &data) override;
 
  private:
-  void process_commands();
+  typedef std::map<std::string, std::string> Parameters;
 
-  void handle_command(const std::string &command);
+  void handle_command(const boost::string_view &command);
   void list();
+  void connect();
+  void disconnect();
+  void start(const Parameters &params);
+  void stop();
+  void frame(const Parameters &params);
+
+  void reply_ok(const std::string &data = "");
+  void reply_ko(const std::string &reason);
+  void reply(bool ok, const struct iovec *data, std::size_t count);
 
   std::shared_ptr<network::SocketMessenger> messenger_;
-  std::vector<std::uint8_t> buffer_;
+  FrameParser parser_;
+  std::string camera_name_;
+  std::shared_ptr<camera::Source> source_;
+  bool started_;
+  camera::PixelFormat pixel_format_;
+  camera::Frame frame_;
+  std::vector<std::uint8_t> video_;
+  std::vector<std::uint8_t> preview_;
+  std::shared_ptr<camera::FrameRing> ring_;
 };
-}  // namespace graphics
+}  // namespace qemu
 }  // namespace anbox
 
 #endif
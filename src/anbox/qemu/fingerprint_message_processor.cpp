@@ -26,16 +26,15 @@ FingerprintMessageProcessor::FingerprintMessageProcessor(
 
 FingerprintMessageProcessor::~FingerprintMessageProcessor() {}
 
-void FingerprintMessageProcessor::handle_command(const std::string &command) {
+void FingerprintMessageProcessor::handle_command(
+    const boost::string_view &command) {
   if (command == "listen") listen();
 }
 
 void FingerprintMessageProcessor::listen() {
   char buf[12];
   snprintf(buf, sizeof(buf), "off");
-  send_header(strlen(buf));
-  messenger_->send(buf, strlen(buf));
-  finish_message();
+  send_messages({buf});
 }
 }  // namespace qemu
 }  // namespace anbox
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/qemu/frame_parser.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+int hex_value(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+bool decode_length(const char *header, std::size_t &length) {
+  length = 0;
+  for (std::size_t n = 0; n < anbox::qemu::FrameParser::length_header_size;
+       n++) {
+    const auto value = hex_value(header[n]);
+    if (value < 0) return false;
+    length = (length << 4) | static_cast<std::size_t>(value);
+  }
+  return true;
+}
+}  // namespace
+
+namespace anbox {
+namespace qemu {
+constexpr std::size_t FrameParser::length_header_size;
+constexpr std::size_t FrameParser::max_frame_size;
+
+FrameParser FrameParser::length_prefixed() {
+  return FrameParser(Framing::length_prefixed, "");
+}
+
+FrameParser FrameParser::nul_delimited() {
+  return FrameParser(Framing::delimited, std::string(1, '\0'));
+}
+
+FrameParser FrameParser::delimited(const std::string &delimiters) {
+  return FrameParser(Framing::delimited, delimiters);
+}
+
+FrameParser::FrameParser(Framing framing, const std::string &delimiters)
+    : framing_(framing), delimiters_(delimiters) {}
+
+bool FrameParser::feed(const std::vector<std::uint8_t> &data,
+                       const FrameHandler &handler) {
+  return feed(data.data(), data.size(), handler);
+}
+
+bool FrameParser::feed(const std::uint8_t *data, std::size_t size,
+                       const FrameHandler &handler) {
+  const auto bytes = reinterpret_cast<const char *>(data);
+  std::size_t offset = 0;
+
+  // Complete a frame left over from a previous chunk first. We only copy as
+  // many bytes as are needed to finish it so the rest of the chunk can be
+  // parsed in place.
+  while (head_ != tail_ && offset < size) {
+    std::size_t missing = size - offset;
+    if (framing_ == Framing::length_prefixed) {
+      const auto buffered = tail_ - head_;
+      std::size_t length = 0;
+      if (buffered < length_header_size)
+        missing = length_header_size - buffered;
+      else if (decode_length(buffer_.data() + head_, length))
+        missing = length_header_size + length - buffered;
+      else
+        missing = 0;
+    } else {
+      const auto end = std::find_if(bytes + offset, bytes + size,
+                                    [&](char c) { return is_delimiter(c); });
+      if (end != bytes + size) missing = end - (bytes + offset) + 1;
+    }
+    missing = std::min(missing, size - offset);
+
+    append(bytes + offset, missing);
+    offset += missing;
+
+    const auto consumed = parse(buffer_.data() + head_, tail_ - head_, handler);
+    if (consumed < 0) {
+      reset();
+      return false;
+    }
+    head_ += consumed;
+    if (head_ == tail_) head_ = tail_ = 0;
+  }
+
+  if (offset < size) {
+    const auto consumed = parse(bytes + offset, size - offset, handler);
+    if (consumed < 0) {
+      reset();
+      return false;
+    }
+    append(bytes + offset + consumed, size - offset - consumed);
+  }
+
+  if (framing_ == Framing::delimited && pending() > max_frame_size) {
+    reset();
+    return false;
+  }
+
+  return true;
+}
+
+std::ptrdiff_t FrameParser::parse(const char *data, std::size_t size,
+                                  const FrameHandler &handler) const {
+  std::size_t pos = 0;
+  if (framing_ == Framing::length_prefixed) {
+    while (size - pos >= length_header_size) {
+      std::size_t length = 0;
+      if (!decode_length(data + pos, length)) return -1;
+      if (size - pos - length_header_size < length) break;
+      handler(boost::string_view(data + pos + length_header_size, length));
+      pos += length_header_size + length;
+    }
+  } else {
+    while (pos < size) {
+      const auto end = std::find_if(data + pos, data + size,
+                                    [&](char c) { return is_delimiter(c); });
+      if (end == data + size) break;
+      handler(boost::string_view(data + pos, end - (data + pos)));
+      pos = end - data + 1;
+    }
+  }
+  return static_cast<std::ptrdiff_t>(pos);
+}
+
+bool FrameParser::is_delimiter(char c) const {
+  return delimiters_.find(c) != std::string::npos;
+}
+
+void FrameParser::append(const char *data, std::size_t size) {
+  if (size == 0) return;
+
+  if (buffer_.size() - tail_ < size) {
+    // Move the unconsumed data to the front before we grow the buffer
+    if (head_ > 0) {
+      ::memmove(buffer_.data(), buffer_.data() + head_, tail_ - head_);
+      tail_ -= head_;
+      head_ = 0;
+    }
+    if (buffer_.size() - tail_ < size) buffer_.resize(tail_ + size);
+  }
+
+  ::memcpy(buffer_.data() + tail_, data, size);
+  tail_ += size;
+}
+
+void FrameParser::reset() { head_ = tail_ = 0; }
+
+std::size_t FrameParser::pending() const { return tail_ - head_; }
+}  // namespace qemu
+}  // namespace anbox
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_QEMU_FRAME_PARSER_H_
+#define ANBOX_QEMU_FRAME_PARSER_H_
+
+#include <boost/utility/string_view.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace anbox {
+namespace qemu {
+// Incremental parser for the framings used by the qemud style pipes. Incoming
+// data is split into frames without copying whenever a frame is completely
+// contained in the chunk passed to feed(). Only incomplete trailing frames are
+// kept in an internal buffer which is compacted instead of erased from the
+// front, so consumed data never has to be shifted per frame.
+class FrameParser {
+ public:
+  enum class Framing {
+    // Every frame is prefixed with its size as four hex digits
+    length_prefixed,
+    // Frames are terminated by any of the configured delimiter characters
+    delimited,
+  };
+
+  // The view passed to the handler is only valid until the handler returns.
+  typedef std::function<void(const boost::string_view &)> FrameHandler;
+
+  static constexpr std::size_t length_header_size{4};
+  static constexpr std::size_t max_frame_size{0xffff};
+
+  static FrameParser length_prefixed();
+  static FrameParser nul_delimited();
+  static FrameParser delimited(const std::string &delimiters);
+
+  // Splits the given data into frames and calls handler for each complete
+  // one. Returns false when the stream is malformed; the parser drops all
+  // pending data in that case and starts over with the next chunk.
+  bool feed(const std::uint8_t *data, std::size_t size,
+            const FrameHandler &handler);
+  bool feed(const std::vector<std::uint8_t> &data, const FrameHandler &handler);
+
+  // Drops all pending data.
+  void reset();
+
+  // Number of bytes buffered which don't form a complete frame yet.
+  std::size_t pending() const;
+
+ private:
+  FrameParser(Framing framing, const std::string &delimiters);
+
+  // Parses as many frames as possible out of [data, data + size) and returns
+  // the number of bytes consumed or -1 when the data is malformed.
+  std::ptrdiff_t parse(const char *data, std::size_t size,
+                       const FrameHandler &handler) const;
+  bool is_delimiter(char c) const;
+  void append(const char *data, std::size_t size);
+
+  Framing framing_;
+  std::string delimiters_;
+  std::vector<char> buffer_;
+  std::size_t head_ = 0;
+  std::size_t tail_ = 0;
+};
+}  // namespace qemu
+}  // namespace anbox
+
+#endif
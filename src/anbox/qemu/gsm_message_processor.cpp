@@ -29,7 +29,7 @@ namespace qemu {
 GsmMessageProcessor::GsmMessageProcessor(
     const std::shared_ptr<network::SocketMessenger> &messenger)
     : messenger_(messenger), parser_(std::make_shared<AtParser>()) {
-  auto ok_reply = [&](const std::string &) { send_reply("OK"); };
+  auto ok_reply = [&](const boost::string_view &) { send_reply("OK"); };
 
   parser_->register_command("E0Q0V1", ok_reply);
   parser_->register_command("S0=0", ok_reply);
@@ -59,20 +59,20 @@ GsmMessageProcessor::GsmMessageProcessor(
 GsmMessageProcessor::~GsmMessageProcessor() {}
 
 bool GsmMessageProcessor::process_data(const std::vector<std::uint8_t> &data) {
-  for (const auto &byte : data) buffer_.push_back(byte);
-
-  parser_->process_data(buffer_);
+  parser_->process_data(data);
   return true;
 }
 
 void GsmMessageProcessor::send_reply(const std::string &message) {
-  auto reply = utils::string_format("%s\rOK\n", message);
-  std::vector<std::uint8_t> data;
-  std::copy(reply.begin(), reply.end(), std::back_inserter(data));
-  messenger_->send(reinterpret_cast<const char *>(data.data()), data.size());
+  static char terminator[] = "\rOK\n";
+  struct iovec buffers[] = {
+      {const_cast<char *>(message.data()), message.size()},
+      {terminator, sizeof(terminator) - 1},
+  };
+  messenger_->send_vectored(buffers, 2);
 }
 
-void GsmMessageProcessor::handle_ctec(const std::string &command) {
+void GsmMessageProcessor::handle_ctec(const boost::string_view &command) {
   if (command == "+CTEC=?")
     send_reply("+CTEC: 0,1,2,3");
   else if (command == "+CTEC?")
@@ -80,32 +80,32 @@ void GsmMessageProcessor::handle_ctec(const std::string &command) {
         "+CTEC: %d,%x", static_cast<unsigned int>(technology::gsm), 0x0f));
 }
 
-void GsmMessageProcessor::handle_cmgf(const std::string &command) {
+void GsmMessageProcessor::handle_cmgf(const boost::string_view &command) {
   if (command == "+CMGF=0") send_reply("");
 }
 
-void GsmMessageProcessor::handle_creg(const std::string &command) {
+void GsmMessageProcessor::handle_creg(const boost::string_view &command) {
   if (command == "+CREG=?")
     send_reply("+CREG: (0-2)");
   else if (command == "+CREG?")
     send_reply(utils::string_format("+CREF: %d,%d", 0, 0));
-  else if (utils::string_starts_with(command, "+CREG="))
+  else if (command.starts_with("+CREG="))
     send_reply("");
 }
 
-void GsmMessageProcessor::handle_cgreg(const std::string &command) {
+void GsmMessageProcessor::handle_cgreg(const boost::string_view &command) {
   if (command == "+CGREG=?")
     send_reply("+CGREG: (0-2)");
   else if (command == "+CGREG?")
     send_reply(utils::string_format("+CGREG: %d,%d", 0, 0));
-  else if (utils::string_starts_with(command, "+CGREG="))
+  else if (command.starts_with("+CGREG="))
     send_reply("");
 }
 
-void GsmMessageProcessor::handle_cfun(const std::string &command) {
+void GsmMessageProcessor::handle_cfun(const boost::string_view &command) {
   if (command == "+CFUN?")
     send_reply(utils::string_format("+CFUN: %d", 1));
-  else if (utils::string_starts_with(command, "+CFUN="))
+  else if (command.starts_with("+CFUN="))
     send_reply("");
 }
 }  // namespace qemu
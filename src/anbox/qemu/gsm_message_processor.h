@@ -21,6 +21,8 @@
 #include "anbox/network/message_processor.h"
 #include "anbox/network/socket_messenger.h"
 
+#include <boost/utility/string_view.hpp>
+
 namespace anbox {
 namespace qemu {
 class AtParser;
@@ -44,14 +46,13 @@ class GsmMessageProcessor : public network::MessageProcessor {
 
   void send_reply(const std::string &message);
 
-  void handle_ctec(const std::string &command);
-  void handle_cmgf(const std::string &command);
-  void handle_creg(const std::string &command);
-  void handle_cgreg(const std::string &command);
-  void handle_cfun(const std::string &command);
+  void handle_ctec(const boost::string_view &command);
+  void handle_cmgf(const boost::string_view &command);
+  void handle_creg(const boost::string_view &command);
+  void handle_cgreg(const boost::string_view &command);
+  void handle_cfun(const boost::string_view &command);
 
   std::shared_ptr<network::SocketMessenger> messenger_;
-  std::vector<std::uint8_t> buffer_;
   std::shared_ptr<AtParser> parser_;
 };
 }  // namespace graphics
@@ -26,7 +26,8 @@ HwControlMessageProcessor::HwControlMessageProcessor(
 
 HwControlMessageProcessor::~HwControlMessageProcessor() {}
 
-void HwControlMessageProcessor::handle_command(const std::string &command) {
+void HwControlMessageProcessor::handle_command(
+    const boost::string_view &command) {
 #if 0
     if (command == "power:screen_state:wake")
         DEBUG("Got screen wake command");
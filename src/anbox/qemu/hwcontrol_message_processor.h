@@ -29,7 +29,7 @@ class HwControlMessageProcessor : public QemudMessageProcessor {
   ~HwControlMessageProcessor();
 
  protected:
-  void handle_command(const std::string &command) override;
+  void handle_command(const boost::string_view &command) override;
 };
 }  // namespace graphics
 }  // namespace anbox
@@ -15,8 +15,15 @@
  *
  */
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 
+#include "anbox/common/boot_timeline.h"
+#include "anbox/common/prefix_trie.h"
+#ifndef USE_SFDROID
+#include "anbox/graphics/emugl/RenderThread.h"
+#endif
 #include "anbox/graphics/opengles_message_processor.h"
 #include "anbox/logger.h"
 #include "anbox/network/local_socket_messenger.h"
@@ -29,6 +36,8 @@
 #include "anbox/qemu/hwcontrol_message_processor.h"
 #include "anbox/qemu/null_message_processor.h"
 #include "anbox/qemu/pipe_connection_creator.h"
+#include "anbox/qemu/pipe_handshake.h"
+#include "anbox/qemu/pipe_statistics.h"
 #include "anbox/qemu/sensors_message_processor.h"
 
 namespace ba = boost::asio;
@@ -62,18 +71,75 @@ std::string client_type_to_string(
   }
   return "unknown";
 }
+
+constexpr const char *camera_identifier{"pipe:qemud:camera"};
+
+// Returns what follows '<prefix>:' in the identifier of a client.
+std::string client_arguments(const std::string &identifier,
+                             const std::string &prefix) {
+  if (identifier.size() <= prefix.size() + 1 ||
+      identifier[prefix.size()] != ':')
+    return "";
+  return identifier.substr(prefix.size() + 1);
+}
+
+struct ClientDescription {
+  anbox::qemu::PipeConnectionCreator::client_type type;
+  // Number of bytes the client sends right after its identifier which are
+  // part of the handshake and not meant for the message processor.
+  std::size_t header_size;
+  // Setting up the message processor takes long enough that it should
+  // not happen on a thread of the main runtime.
+  bool expensive_setup;
+};
+
+const anbox::common::PrefixTrie<ClientDescription>& known_clients();
+
+ClientDescription describe_client(const std::string &identifier) {
+  const auto client = known_clients().longest_prefix(identifier);
+  if (!client)
+    return {anbox::qemu::PipeConnectionCreator::client_type::invalid, 0, false};
+  return *client;
+}
+
+const anbox::common::PrefixTrie<ClientDescription>& known_clients() {
+  using client_type = anbox::qemu::PipeConnectionCreator::client_type;
+  static const auto clients = []() {
+    anbox::common::PrefixTrie<ClientDescription> trie;
+    // OpenGL ES clients send 32 bit of client flags first.
+    trie.insert("pipe:opengles", {client_type::opengles, sizeof(std::uint32_t), true});
+    // Even if 'boot-properties' is an argument to the service 'qemud' here we
+    // take this as a own service instance as that is what it is.
+    trie.insert("pipe:qemud:boot-properties", {client_type::qemud_boot_properties, 0, false});
+    trie.insert("pipe:qemud:hw-control", {client_type::qemud_hw_control, 0, false});
+    trie.insert("pipe:qemud:sensors", {client_type::qemud_sensors, 0, false});
+    trie.insert(camera_identifier, {client_type::qemud_camera, 0, false});
+    trie.insert("pipe:qemud:fingerprintlisten", {client_type::qemud_fingerprint, 0, false});
+    trie.insert("pipe:qemud:gsm", {client_type::qemud_gsm, 0, false});
+    trie.insert("pipe:anbox:bootanimation", {client_type::bootanimation, 0, false});
+    trie.insert("pipe:qemud:adb", {client_type::qemud_adb, 0, false});
+    return trie;
+  }();
+  return clients;
+}
 }
 namespace anbox {
 namespace qemu {
 PipeConnectionCreator::PipeConnectionCreator(const std::shared_ptr<Renderer> &renderer, const std::shared_ptr<Runtime> &rt)
     : renderer_(renderer),
+#ifndef USE_SFDROID
+      render_threads_(std::make_shared<RenderThreadPool>()),
+#endif
       runtime_(rt),
+      setup_runtime_(Runtime::create(1)),
       next_connection_id_(0),
       connections_(
           std::make_shared<network::Connections<network::SocketConnection>>()) {
+  setup_runtime_->start();
 }
 
 PipeConnectionCreator::~PipeConnectionCreator() {
+  setup_runtime_->stop();
   connections_->clear();
 }
 
@@ -81,78 +147,90 @@ void PipeConnectionCreator::create_connection_for(
     std::shared_ptr<boost::asio::local::stream_protocol::socket> const
         &socket) {
   auto const messenger = std::make_shared<network::LocalSocketMessenger>(socket);
-  const auto type = identify_client(messenger);
-  auto const processor = create_processor(type, messenger);
-  if (!processor)
-    BOOST_THROW_EXCEPTION(std::runtime_error("Unhandled client type"));
+
+  // Handshakes can outlive us as they only finish once the client sent
+  // enough data.
+  std::weak_ptr<PipeConnectionCreator> weak_self = shared_from_this();
+  std::make_shared<PipeHandshake>(
+      messenger,
+      [](const std::string &identifier) { return describe_client(identifier).header_size; },
+      [weak_self](const std::shared_ptr<PipeHandshake> &handshake) {
+        if (auto self = weak_self.lock())
+          self->handshake_completed(handshake);
+      })->start();
+}
+
+void PipeConnectionCreator::handshake_completed(const std::shared_ptr<PipeHandshake> &handshake) {
+  const auto client = describe_client(handshake->identifier());
+  if (!client.expensive_setup) {
+    setup_connection(handshake, client.type);
+    return;
+  }
+
+  std::weak_ptr<PipeConnectionCreator> weak_self = shared_from_this();
+  setup_runtime_->service().post([weak_self, handshake, client]() {
+    auto self = weak_self.lock();
+    if (!self)
+      return;
+    self->setup_connection(handshake, client.type);
+    // If we hold the last reference now, we must not be destroyed here as
+    // that would join the thread we run on.
+    self->runtime_->service().post([self]() {});
+  });
+}
+
+void PipeConnectionCreator::setup_connection(const std::shared_ptr<PipeHandshake> &handshake,
+                                             const client_type &type) {
+  auto const processor = create_processor(type, handshake->identifier(),
+                                          handshake->messenger(), handshake->header());
+  if (!processor) {
+    ERROR("Unhandled client type for '%s'", handshake->identifier());
+    return;
+  }
 
   auto const &connection = std::make_shared<network::SocketConnection>(
-      messenger, messenger, next_id(), connections_, processor);
+      handshake->messenger(), handshake->messenger(), next_id(), connections_, processor);
   connection->set_name(client_type_to_string(type));
+  common::BootTimeline::get()->mark_once("qemu-pipe-" + client_type_to_string(type));
   connections_->add(connection);
-  connection->read_next_message();
-}
 
-PipeConnectionCreator::client_type PipeConnectionCreator::identify_client(
-    std::shared_ptr<network::SocketMessenger> const &messenger) {
-  // The client will identify itself as first thing by writing a string
-  // in the format 'pipe:<name>[:<arguments>]\0' to the channel.
-  std::vector<char> buffer;
-  for (;;) {
-    unsigned char byte[1] = {0};
-    const auto err = messenger->receive_msg(ba::buffer(byte, 1));
-    if (err) break;
-    buffer.push_back(byte[0]);
-    if (byte[0] == 0x0) break;
+  const auto leftover = handshake->leftover();
+  if (!leftover.empty() && !processor->process_data(leftover)) {
+    connections_->remove(connection->id());
+    return;
   }
 
-  std::string identifier_and_args = buffer.data();
-
-  if (utils::string_starts_with(identifier_and_args, "pipe:opengles"))
-    return client_type::opengles;
-  // Even if 'boot-properties' is an argument to the service 'qemud' here we
-  // take this as a own service instance as that is what it is.
-  else if (utils::string_starts_with(identifier_and_args,
-                                     "pipe:qemud:boot-properties"))
-    return client_type::qemud_boot_properties;
-  else if (utils::string_starts_with(identifier_and_args,
-                                     "pipe:qemud:hw-control"))
-    return client_type::qemud_hw_control;
-  else if (utils::string_starts_with(identifier_and_args, "pipe:qemud:sensors"))
-    return client_type::qemud_sensors;
-  else if (utils::string_starts_with(identifier_and_args, "pipe:qemud:camera"))
-    return client_type::qemud_camera;
-  else if (utils::string_starts_with(identifier_and_args,
-                                     "pipe:qemud:fingerprintlisten"))
-    return client_type::qemud_fingerprint;
-  else if (utils::string_starts_with(identifier_and_args, "pipe:qemud:gsm"))
-    return client_type::qemud_gsm;
-  else if (utils::string_starts_with(identifier_and_args,
-                                     "pipe:anbox:bootanimation"))
-    return client_type::bootanimation;
-  else if (utils::string_starts_with(identifier_and_args, "pipe:qemud:adb"))
-    return client_type::qemud_adb;
-
-  return client_type::invalid;
+  connection->read_next_message();
+
+  const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - handshake->started());
+  PipeStatistics::get()->client_connected(client_type_to_string(type), latency);
+  DEBUG("Client '%s' connected after %d us", handshake->identifier(), latency.count());
 }
 
 std::shared_ptr<network::MessageProcessor>
 PipeConnectionCreator::create_processor(
-    const client_type &type,
-    const std::shared_ptr<network::SocketMessenger> &messenger) {
+    const client_type &type, const std::string &identifier,
+    const std::shared_ptr<network::SocketMessenger> &messenger,
+    const std::vector<std::uint8_t> &header) {
 #ifndef USE_SFDROID
-  if (type == client_type::opengles)
-    return std::make_shared<graphics::OpenGlesMessageProcessor>(renderer_, messenger);
-  else
+  if (type == client_type::opengles) {
+    std::uint32_t client_flags = 0;
+    std::memcpy(&client_flags, header.data(), std::min(header.size(), sizeof(client_flags)));
+    return std::make_shared<graphics::OpenGlesMessageProcessor>(renderer_, render_threads_, messenger, client_flags);
+  } else
+#else
+  (void)header;
 #endif
   if (type == client_type::qemud_boot_properties)
     return std::make_shared<qemu::BootPropertiesMessageProcessor>(messenger);
   else if (type == client_type::qemud_hw_control)
     return std::make_shared<qemu::HwControlMessageProcessor>(messenger);
   else if (type == client_type::qemud_sensors)
-    return std::make_shared<qemu::SensorsMessageProcessor>(messenger);
+    return std::make_shared<qemu::SensorsMessageProcessor>(messenger, runtime_);
   else if (type == client_type::qemud_camera)
-    return std::make_shared<qemu::CameraMessageProcessor>(messenger);
+    return std::make_shared<qemu::CameraMessageProcessor>(
+        messenger, client_arguments(identifier, camera_identifier));
   else if (type == client_type::qemud_fingerprint)
     return std::make_shared<qemu::FingerprintMessageProcessor>(messenger);
   else if (type == client_type::qemud_gsm)
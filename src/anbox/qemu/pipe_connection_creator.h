@@ -20,6 +20,7 @@
 
 #include <boost/asio.hpp>
 
+#include <chrono>
 #include <memory>
 
 #include "anbox/do_not_copy_or_move.h"
@@ -30,11 +31,14 @@
 #include "anbox/runtime.h"
 
 class Renderer;
+class RenderThreadPool;
 
 namespace anbox {
 namespace qemu {
+class PipeHandshake;
 class PipeConnectionCreator
-    : public network::ConnectionCreator<boost::asio::local::stream_protocol> {
+    : public network::ConnectionCreator<boost::asio::local::stream_protocol>,
+      public std::enable_shared_from_this<PipeConnectionCreator> {
  public:
   PipeConnectionCreator(const std::shared_ptr<Renderer> &renderer, const std::shared_ptr<Runtime> &rt);
   ~PipeConnectionCreator() noexcept;
@@ -59,14 +63,21 @@ class PipeConnectionCreator
  private:
   int next_id();
 
-  client_type identify_client(
-      std::shared_ptr<network::SocketMessenger> const &messenger);
+  void handshake_completed(const std::shared_ptr<PipeHandshake> &handshake);
+  void setup_connection(const std::shared_ptr<PipeHandshake> &handshake,
+                        const client_type &type);
   std::shared_ptr<network::MessageProcessor> create_processor(
-      const client_type &type,
-      const std::shared_ptr<network::SocketMessenger> &messenger);
+      const client_type &type, const std::string &identifier,
+      const std::shared_ptr<network::SocketMessenger> &messenger,
+      const std::vector<std::uint8_t> &header);
 
   std::shared_ptr<Renderer> renderer_;
+  // Threads of OpenGL ES clients outlive them to serve the next ones.
+  std::shared_ptr<RenderThreadPool> render_threads_;
   std::shared_ptr<Runtime> runtime_;
+  // Processors which are expensive to create are set up here so that
+  // they don't hold up the threads of the main runtime.
+  std::shared_ptr<Runtime> setup_runtime_;
   std::atomic<int> next_connection_id_;
   std::shared_ptr<network::Connections<network::SocketConnection>> const connections_;
 };
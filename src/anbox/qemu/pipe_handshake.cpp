@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/qemu/pipe_handshake.h"
+#include "anbox/logger.h"
+
+#include <algorithm>
+
+namespace anbox {
+namespace qemu {
+constexpr const std::size_t PipeHandshake::max_identifier_size;
+constexpr const std::size_t PipeHandshake::read_buffer_size;
+
+PipeHandshake::PipeHandshake(const std::shared_ptr<network::SocketMessenger> &messenger,
+                             const HeaderSizeFor &header_size_for,
+                             const CompletionHandler &on_completed)
+    : messenger_(messenger),
+      header_size_for_(header_size_for),
+      on_completed_(on_completed),
+      started_(std::chrono::steady_clock::now()) {
+  pending_.reserve(read_buffer_size);
+}
+
+void PipeHandshake::start() { read_more(); }
+
+const std::shared_ptr<network::SocketMessenger>& PipeHandshake::messenger() const {
+  return messenger_;
+}
+
+const std::string& PipeHandshake::identifier() const { return identifier_; }
+
+std::chrono::steady_clock::time_point PipeHandshake::started() const { return started_; }
+
+std::vector<std::uint8_t> PipeHandshake::header() const {
+  const auto begin = pending_.begin() + identifier_.size() + 1;
+  return std::vector<std::uint8_t>(begin, begin + header_size_);
+}
+
+std::vector<std::uint8_t> PipeHandshake::leftover() const {
+  return std::vector<std::uint8_t>(pending_.begin() + handshake_size(), pending_.end());
+}
+
+std::size_t PipeHandshake::handshake_size() const {
+  return identifier_.size() + 1 + header_size_;
+}
+
+void PipeHandshake::read_more() {
+  auto self = shared_from_this();
+  messenger_->async_receive_msg(
+      [self](const boost::system::error_code &err, std::size_t size) {
+        self->on_read(err, size);
+      },
+      boost::asio::buffer(buffer_));
+}
+
+void PipeHandshake::on_read(const boost::system::error_code &err, std::size_t size) {
+  if (err) {
+    DEBUG("Client disconnected before finishing the handshake: %s", err.message());
+    return;
+  }
+
+  pending_.insert(pending_.end(), buffer_.data(), buffer_.data() + size);
+
+  if (!identified_) {
+    const auto end = std::find(pending_.begin(), pending_.end(), 0);
+    if (end == pending_.end()) {
+      if (pending_.size() >= max_identifier_size) {
+        ERROR("Client sent an identifier longer than %d bytes", max_identifier_size);
+        return;
+      }
+      read_more();
+      return;
+    }
+
+    if (static_cast<std::size_t>(end - pending_.begin()) >= max_identifier_size) {
+      ERROR("Client sent an identifier longer than %d bytes", max_identifier_size);
+      return;
+    }
+
+    identifier_.assign(pending_.begin(), end);
+    header_size_ = header_size_for_(identifier_);
+    identified_ = true;
+  }
+
+  if (pending_.size() < handshake_size()) {
+    read_more();
+    return;
+  }
+
+  on_completed_(shared_from_this());
+}
+}  // namespace qemu
+}  // namespace anbox
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_QEMU_PIPE_HANDSHAKE_H_
+#define ANBOX_QEMU_PIPE_HANDSHAKE_H_
+
+#include "anbox/network/socket_messenger.h"
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace anbox {
+namespace qemu {
+// PipeHandshake reads the identifier a client sends as first thing in the
+// format 'pipe:<name>[:<arguments>]\0' and any header following it
+// without ever blocking the thread it runs on.
+class PipeHandshake : public std::enable_shared_from_this<PipeHandshake> {
+ public:
+  // The identifier can't be longer than this including the terminating
+  // null byte.
+  static constexpr const std::size_t max_identifier_size{256};
+
+  // Returns the number of bytes a client with the given identifier sends
+  // right after it which are part of the handshake.
+  typedef std::function<std::size_t(const std::string&)> HeaderSizeFor;
+  // Called once the identifier and the header were received. Clients which
+  // disconnect or send garbage before that are dropped.
+  typedef std::function<void(const std::shared_ptr<PipeHandshake>&)> CompletionHandler;
+
+  PipeHandshake(const std::shared_ptr<network::SocketMessenger> &messenger,
+                const HeaderSizeFor &header_size_for,
+                const CompletionHandler &on_completed);
+
+  void start();
+
+  const std::shared_ptr<network::SocketMessenger>& messenger() const;
+  const std::string& identifier() const;
+  std::chrono::steady_clock::time_point started() const;
+
+  // Returns the header the client sent after its identifier.
+  std::vector<std::uint8_t> header() const;
+
+  // Returns everything the client sent after the handshake which has to
+  // be passed on to the message processor.
+  std::vector<std::uint8_t> leftover() const;
+
+ private:
+  static constexpr const std::size_t read_buffer_size{512};
+
+  std::size_t handshake_size() const;
+  void read_more();
+  void on_read(const boost::system::error_code &err, std::size_t size);
+
+  std::shared_ptr<network::SocketMessenger> messenger_;
+  HeaderSizeFor header_size_for_;
+  CompletionHandler on_completed_;
+  std::chrono::steady_clock::time_point started_;
+  std::array<std::uint8_t, read_buffer_size> buffer_;
+  std::vector<std::uint8_t> pending_;
+  bool identified_ = false;
+  std::string identifier_;
+  std::size_t header_size_ = 0;
+};
+}  // namespace qemu
+}  // namespace anbox
+
+#endif
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/qemu/pipe_statistics.h"
+
+namespace anbox {
+namespace qemu {
+std::shared_ptr<PipeStatistics> PipeStatistics::get() {
+  static auto statistics = std::make_shared<PipeStatistics>();
+  return statistics;
+}
+
+PipeStatistics::PipeStatistics() {}
+
+PipeStatistics::~PipeStatistics() {}
+
+void PipeStatistics::client_connected(const std::string &type, const std::chrono::microseconds &latency) {
+  handshake_latency_.record(latency);
+  std::lock_guard<std::mutex> l(lock_);
+  clients_[type]++;
+}
+
+const common::LatencyHistogram& PipeStatistics::handshake_latency() const {
+  return handshake_latency_;
+}
+
+std::map<std::string, std::uint64_t> PipeStatistics::summary() const {
+  auto result = handshake_latency_.summary("handshake_latency_");
+  std::lock_guard<std::mutex> l(lock_);
+  for (const auto &client : clients_)
+    result["clients_" + client.first] = client.second;
+  return result;
+}
+}  // namespace qemu
+}  // namespace anbox
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_QEMU_PIPE_STATISTICS_H_
+#define ANBOX_QEMU_PIPE_STATISTICS_H_
+
+#include "anbox/common/latency_histogram.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace anbox {
+namespace qemu {
+// PipeStatistics collects how many clients of each type connected through
+// the qemu pipe and how long it took to set up their connections.
+class PipeStatistics {
+ public:
+  static std::shared_ptr<PipeStatistics> get();
+
+  PipeStatistics();
+  ~PipeStatistics();
+
+  // Records a client whose connection was set up the given time after it
+  // was accepted.
+  void client_connected(const std::string &type, const std::chrono::microseconds &latency);
+
+  const common::LatencyHistogram& handshake_latency() const;
+
+  std::map<std::string, std::uint64_t> summary() const;
+
+ private:
+  common::LatencyHistogram handshake_latency_;
+  mutable std::mutex lock_;
+  std::map<std::string, std::uint64_t> clients_;
+};
+}  // namespace qemu
+}  // namespace anbox
+
+#endif
@@ -19,65 +19,61 @@
 #include "anbox/logger.h"
 #include "anbox/utils.h"
 
-#include <string.h>
+#include <boost/throw_exception.hpp>
 
-namespace {
-static constexpr const long header_size{4};
-}
+#include <stdio.h>
+
+#include <stdexcept>
 
 namespace anbox {
 namespace qemu {
 QemudMessageProcessor::QemudMessageProcessor(
     const std::shared_ptr<network::SocketMessenger> &messenger)
-    : messenger_(messenger) {}
+    : messenger_(messenger), parser_(FrameParser::length_prefixed()) {}
 
 QemudMessageProcessor::~QemudMessageProcessor() {}
 
 bool QemudMessageProcessor::process_data(
     const std::vector<std::uint8_t> &data) {
-  for (const auto &byte : data) buffer_.push_back(byte);
-
-  process_commands();
+  if (!parser_.feed(data, [&](const boost::string_view &command) {
+        handle_command(command);
+      }))
+    WARNING("Dropping malformed qemud message data");
 
   return true;
 }
 
-void QemudMessageProcessor::process_commands() {
-  while (true) {
-    if (buffer_.size() < header_size) break;
-
-    char header[header_size] = {0};
-    ::memcpy(header, buffer_.data(), header_size);
-
-    unsigned int body_size = 0;
-    ::sscanf(header, "%04x", &body_size);
-    if (body_size != buffer_.size() - header_size) break;
-
-    std::string command;
-    // Make sure we only copy as much bytes as we have to and not more
-    command.insert(0,
-                   reinterpret_cast<const char *>(buffer_.data()) + header_size,
-                   body_size);
+void QemudMessageProcessor::send_messages(
+    const std::vector<boost::string_view> &messages) {
+  send_frames(*messenger_, messages, true);
+}
 
-    handle_command(command);
+void QemudMessageProcessor::send_frames(
+    network::SocketMessenger &messenger,
+    const std::vector<boost::string_view> &frames, bool terminate) {
+  static char terminator = '\0';
+  const auto header_size = FrameParser::length_header_size;
+
+  // The length header can't express anything bigger and the guest treats
+  // every frame as a message of its own, so we can't split them either.
+  for (const auto &frame : frames) {
+    if (frame.size() > FrameParser::max_frame_size)
+      BOOST_THROW_EXCEPTION(std::runtime_error("qemud frame exceeds the maximum frame size"));
+  }
 
-    const auto consumed = header_size + body_size;
-    buffer_.erase(buffer_.begin(), buffer_.begin() + consumed);
+  std::vector<char> headers((header_size + 1) * frames.size());
+  std::vector<struct iovec> buffers;
+  buffers.reserve(frames.size() * 2 + 1);
 
-    const auto remaining = buffer_.size() - consumed;
-    if (remaining <= 0) break;
+  for (size_t n = 0; n < frames.size(); n++) {
+    const auto header = headers.data() + n * (header_size + 1);
+    ::snprintf(header, header_size + 1, "%04zx", frames[n].size());
+    buffers.push_back({header, header_size});
+    buffers.push_back({const_cast<char *>(frames[n].data()), frames[n].size()});
   }
-}
-
-void QemudMessageProcessor::send_header(const size_t &size) {
-  char header[header_size + 1];
-  std::snprintf(header, header_size + 1, "%04lx", size);
-  messenger_->send(header, header_size);
-}
+  if (terminate) buffers.push_back({&terminator, 1});
 
-void QemudMessageProcessor::finish_message() {
-  // Send terminating NULL byte
-  messenger_->send(static_cast<const char *>(""), 1);
+  messenger.send_vectored(buffers.data(), buffers.size());
 }
 }  // namespace qemu
 }  // namespace anbox
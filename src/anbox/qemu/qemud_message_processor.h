@@ -14,12 +14,12 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  *
  */
-
 #ifndef ANBOX_QEMU_QEMUD_MESSAGE_PROCESSOR_H_
 #define ANBOX_QEMU_QEMUD_MESSAGE_PROCESSOR_H_
 
 #include "anbox/network/message_processor.h"
 #include "anbox/network/socket_messenger.h"
+#include "anbox/qemu/frame_parser.h"
 
 namespace anbox {
 namespace qemu {
@@ -32,17 +32,24 @@ class QemudMessageProcessor : public network::MessageProcessor {
   bool process_data(const std::vector<std::uint8_t> &data) override;
 
  protected:
-  virtual void handle_command(const std::string &command) = 0;
+  // The command is only valid for the duration of the call.
+  virtual void handle_command(const boost::string_view &command) = 0;
+
+  // Sends each of the messages with its length header followed by the
+  // terminating NUL byte as one single write.
+  void send_messages(const std::vector<boost::string_view> &messages);
 
-  void send_header(const size_t &size);
-  void finish_message();
+  // Sends each of the frames with its length header as one single write and
+  // adds the terminating NUL byte only when asked to. Throws without sending
+  // anything if a frame is bigger than FrameParser::max_frame_size.
+  static void send_frames(network::SocketMessenger &messenger,
+                          const std::vector<boost::string_view> &frames,
+                          bool terminate);
 
   std::shared_ptr<network::SocketMessenger> messenger_;
 
  private:
-  void process_commands();
-
-  std::vector<std::uint8_t> buffer_;
+  FrameParser parser_;
 };
 }  // namespace graphics
 }  // namespace anbox
@@ -17,27 +17,224 @@
 
 #include "anbox/qemu/sensors_message_processor.h"
 #include "anbox/logger.h"
+#include "anbox/sensors/manager.h"
+
+#include <boost/asio/steady_timer.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <mutex>
+
+namespace {
+// After a stall we don't try to catch up with more than this
+constexpr const std::chrono::seconds max_backlog{1};
+}  // namespace
 
 namespace anbox {
 namespace qemu {
+constexpr const std::chrono::milliseconds
+    SensorsMessageProcessor::default_delay;
+constexpr const std::chrono::milliseconds
+    SensorsMessageProcessor::default_delivery_period;
+
+// Stream samples the enabled sensors and writes the batched events out to
+// the HAL. It lives on as long as a delivery is pending so that it can
+// outlast the message processor.
+class SensorsMessageProcessor::Stream
+    : public std::enable_shared_from_this<Stream> {
+ public:
+  Stream(const std::shared_ptr<network::SocketMessenger> &messenger,
+         boost::asio::io_service &service,
+         const std::chrono::milliseconds &delivery_period)
+      : messenger_(messenger),
+        timer_(service),
+        delivery_period_(delivery_period),
+        delay_(default_delay) {}
+
+  void set_delay(const std::chrono::milliseconds &delay) {
+    std::lock_guard<std::mutex> l(lock_);
+    delay_ = std::max(delay, std::chrono::milliseconds{1});
+    // Don't let the guest wait for the rest of a long previous delay
+    const auto now = std::chrono::steady_clock::now();
+    if (next_sample_ > now + delay_) {
+      next_sample_ = now;
+      if (enabled_ != 0) schedule_locked(now);
+    }
+  }
+
+  void set_enabled(sensors::Type type, bool enabled) {
+    std::lock_guard<std::mutex> l(lock_);
+    const auto was_enabled = enabled_;
+    if (enabled)
+      enabled_ |= sensors::mask_for(type);
+    else
+      enabled_ &= ~sensors::mask_for(type);
+
+    if (was_enabled == 0 && enabled_ != 0) {
+      const auto now = std::chrono::steady_clock::now();
+      next_sample_ = now;
+      schedule_locked(now);
+    }
+  }
+
+  void stop() {
+    std::lock_guard<std::mutex> l(lock_);
+    stopped_ = true;
+    generation_++;
+    timer_.cancel();
+  }
+
+  Statistics statistics() const {
+    std::lock_guard<std::mutex> l(lock_);
+    return statistics_;
+  }
+
+ private:
+  void schedule_locked(const std::chrono::steady_clock::time_point &now) {
+    if (stopped_) return;
+
+    // Re-arming the timer aborts any pending wait; the generation makes
+    // sure a completion which was already queued doesn't deliver twice.
+    const auto generation = ++generation_;
+    timer_.expires_at(std::max(next_sample_, now + delivery_period_));
+
+    auto self = shared_from_this();
+    timer_.async_wait([self, generation](const boost::system::error_code &err) {
+      if (err == boost::asio::error::operation_aborted) return;
+      self->deliver(generation);
+    });
+  }
+
+  void deliver(std::uint64_t generation) {
+    // All frames of a batch go into one buffer and are written out together
+    std::string data;
+    std::vector<std::pair<std::size_t, std::size_t>> frames;
+    auto append = [&](const char *buffer, int size) {
+      frames.push_back({data.size(), static_cast<std::size_t>(size)});
+      data.append(buffer, size);
+    };
+
+    {
+      std::lock_guard<std::mutex> l(lock_);
+      if (stopped_ || generation != generation_ || enabled_ == 0) return;
+
+      const auto source = sensors::Manager::get()->source();
+      const auto mask = enabled_ & source->available();
+      const auto now = std::chrono::steady_clock::now();
+      if (now - next_sample_ > max_backlog) next_sample_ = now;
+
+      char buffer[128];
+      sensors::Values values;
+      while (next_sample_ <= now) {
+        for (std::size_t n = 0; n < sensors::type_count; n++) {
+          const auto type = static_cast<sensors::Type>(n);
+          if (!(mask & sensors::mask_for(type)) ||
+              !source->sample(type, next_sample_, values))
+            continue;
+
+          const auto name = sensors::event_name_for(type);
+          if (sensors::value_count_for(type) == 3)
+            append(buffer, ::snprintf(buffer, sizeof(buffer), "%s:%g:%g:%g",
+                                      name, values[0], values[1], values[2]));
+          else
+            append(buffer, ::snprintf(buffer, sizeof(buffer), "%s:%g", name,
+                                      values[0]));
+        }
+
+        // The HAL hands out all events received before a sync together
+        // with its timestamp given in microseconds.
+        const auto timestamp =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                next_sample_.time_since_epoch());
+        append(buffer, ::snprintf(buffer, sizeof(buffer), "sync:%lld",
+                                  static_cast<long long>(timestamp.count())));
+
+        statistics_.samples++;
+        next_sample_ += delay_;
+      }
+
+      if (!frames.empty()) statistics_.writes++;
+      schedule_locked(now);
+    }
+
+    if (frames.empty()) return;
+
+    std::vector<boost::string_view> views;
+    views.reserve(frames.size());
+    for (const auto &frame : frames)
+      views.push_back(boost::string_view(data.data() + frame.first,
+                                         frame.second));
+
+    try {
+      send_frames(*messenger_, views, false);
+    } catch (const std::exception &err) {
+      DEBUG("Failed to deliver sensor events: %s", err.what());
+      stop();
+    }
+  }
+
+  std::shared_ptr<network::SocketMessenger> messenger_;
+  boost::asio::steady_timer timer_;
+  const std::chrono::milliseconds delivery_period_;
+
+  mutable std::mutex lock_;
+  bool stopped_ = false;
+  std::uint64_t generation_ = 0;
+  sensors::Mask enabled_ = 0;
+  std::chrono::milliseconds delay_;
+  std::chrono::steady_clock::time_point next_sample_;
+  Statistics statistics_;
+};
+
 SensorsMessageProcessor::SensorsMessageProcessor(
-    const std::shared_ptr<network::SocketMessenger> &messenger)
-    : QemudMessageProcessor(messenger) {}
+    const std::shared_ptr<network::SocketMessenger> &messenger,
+    const std::shared_ptr<Runtime> &runtime,
+    const std::chrono::milliseconds &delivery_period)
+    : QemudMessageProcessor(messenger),
+      stream_(std::make_shared<Stream>(messenger, runtime->service(),
+                                       delivery_period)) {}
+
+SensorsMessageProcessor::~SensorsMessageProcessor() { stream_->stop(); }
 
-SensorsMessageProcessor::~SensorsMessageProcessor() {}
+SensorsMessageProcessor::Statistics SensorsMessageProcessor::statistics()
+    const {
+  return stream_->statistics();
+}
 
-void SensorsMessageProcessor::handle_command(const std::string &command) {
-  if (command == "list-sensors") list_sensors();
+void SensorsMessageProcessor::handle_command(
+    const boost::string_view &command) {
+  if (command == "list-sensors") {
+    list_sensors();
+  } else if (command.starts_with("set-delay:")) {
+    const auto delay = ::atoi(command.substr(10).to_string().c_str());
+    stream_->set_delay(std::chrono::milliseconds{delay});
+  } else if (command.starts_with("set:")) {
+    // set:<sensor name>:<0|1>
+    const auto args = command.substr(4);
+    const auto separator = args.rfind(':');
+    sensors::Type type;
+    if (separator == boost::string_view::npos ||
+        !sensors::type_from_name(args.substr(0, separator), type)) {
+      WARNING("Invalid sensor command '%s'", command);
+      return;
+    }
+    stream_->set_enabled(type, args.substr(separator + 1) == "1");
+  } else if (command == "wake") {
+    // Unblocks a HAL thread waiting for events
+    send_frames(*messenger_, {"wake"}, false);
+  } else if (command.starts_with("time:")) {
+    // We report host time in sync events so the guest time isn't needed
+  } else {
+    DEBUG("Unknown sensors command '%s'", command);
+  }
 }
 
 void SensorsMessageProcessor::list_sensors() {
-  // We don't support sensors yet so we mark all as disabled
-  int mask = 0;
   char buf[12];
-  snprintf(buf, sizeof(buf), "%d", mask);
-  send_header(strlen(buf));
-  messenger_->send(buf, strlen(buf));
-  finish_message();
+  snprintf(buf, sizeof(buf), "%u",
+           sensors::Manager::get()->source()->available());
+  send_messages({buf});
 }
 }  // namespace qemu
 }  // namespace anbox
@@ -14,25 +14,50 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  *
  */
-
 #ifndef ANBOX_QEMU_SENSORS_MESSAGE_PROCESSOR_H_
 #define ANBOX_QEMU_SENSORS_MESSAGE_PROCESSOR_H_
 
 #include "anbox/qemu/qemud_message_processor.h"
+#include "anbox/runtime.h"
+#include "anbox/sensors/sensor.h"
+
+#include <chrono>
 
 namespace anbox {
 namespace qemu {
+// SensorsMessageProcessor implements the host side of the goldfish sensors
+// protocol. The HAL enables sensors with set:<name>:<0|1> and sets the
+// sampling rate with set-delay:<ms>. Samples are taken from the active
+// sensors::Source at that rate but written out in batches, at most once per
+// delivery period, so that high rates don't result in one write per sample.
 class SensorsMessageProcessor : public QemudMessageProcessor {
  public:
+  static constexpr const std::chrono::milliseconds default_delay{200};
+  static constexpr const std::chrono::milliseconds default_delivery_period{20};
+
+  struct Statistics {
+    std::uint64_t samples = 0;
+    std::uint64_t writes = 0;
+  };
+
   SensorsMessageProcessor(
-      const std::shared_ptr<network::SocketMessenger> &messenger);
+      const std::shared_ptr<network::SocketMessenger> &messenger,
+      const std::shared_ptr<Runtime> &runtime,
+      const std::chrono::milliseconds &delivery_period =
+          default_delivery_period);
   ~SensorsMessageProcessor();
 
+  Statistics statistics() const;
+
  protected:
-  void handle_command(const std::string &command) override;
+  void handle_command(const boost::string_view &command) override;
 
  private:
+  class Stream;
+
   void list_sensors();
+
+  std::shared_ptr<Stream> stream_;
 };
 }  // namespace graphics
 }  // namespace anbox
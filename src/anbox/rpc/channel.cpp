@@ -18,6 +18,7 @@
  */
 
 #include "anbox/rpc/channel.h"
+#include "anbox/common/tracer.h"
 #include "anbox/common/variable_length_array.h"
 #include "anbox/network/message_sender.h"
 #include "anbox/rpc/constants.h"
@@ -37,6 +38,7 @@ void Channel::call_method(std::string const &method_name,
                           google::protobuf::MessageLite const *parameters,
                           google::protobuf::MessageLite *response,
                           google::protobuf::Closure *complete) {
+  ANBOX_TRACE_SCOPE("rpc", "Channel::call_method");
   auto const &invocation = invocation_for(method_name, parameters);
   pending_calls_->save_completion_details(invocation, response, complete);
   send_message(MessageType::invocation, invocation);
@@ -17,10 +17,20 @@
 
 #include <iostream>
 
+#include <boost/throw_exception.hpp>
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
 #include "anbox/logger.h"
 #include "anbox/runtime.h"
 
 namespace {
+// Realtime priority used for executors asking for it. Kept low so that
+// kernel threads and audio servers still preempt us.
+constexpr const int realtime_priority{10};
+
 // exception_safe_run runs service, catching all exceptions and
 // restarting operation until an explicit shutdown has been requested.
 //
@@ -46,16 +56,117 @@ void exception_safe_run(boost::asio::io_service& service) {
 }
 }
 namespace anbox {
+constexpr const char *Runtime::default_executor;
+constexpr const std::chrono::milliseconds Runtime::Executor::probe_interval;
+
+Runtime::Executor::Executor(const ExecutorConfiguration &config)
+    : config_(config),
+      service_{static_cast<int>(config.threads)},
+      probe_timer_{service_} {}
+
+Runtime::Executor::~Executor() {
+  stop();
+}
+
+std::map<std::string, std::uint64_t> Runtime::Executor::statistics() const {
+  auto stats = queue_latency_.summary("queue_latency_");
+  for (const auto &stat : handler_latency_.summary("handler_latency_"))
+    stats.insert(stat);
+  stats["queue_depth"] = queue_depth_;
+  stats["threads"] = config_.threads;
+  return stats;
+}
+
+void Runtime::Executor::post(const std::function<void()> &task) {
+  service_.post(account(task));
+}
+
+void Runtime::Executor::post(boost::asio::io_service::strand &strand,
+                             const std::function<void()> &task) {
+  strand.post(account(task));
+}
+
+std::function<void()> Runtime::Executor::account(const std::function<void()> &task) {
+  queue_depth_++;
+  return [this, task]() {
+    const auto started_at = std::chrono::steady_clock::now();
+    task();
+    handler_latency_.record(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started_at));
+    queue_depth_--;
+  };
+}
+
+void Runtime::Executor::start() {
+  if (!workers_.empty())
+    return;
+
+  service_.reset();
+  keep_alive_.reset(new boost::asio::io_service::work(service_));
+  schedule_probe();
+
+  for (unsigned int i = 0; i < config_.threads; i++)
+    workers_.push_back(std::thread{&Executor::run, this});
+}
+
+void Runtime::Executor::stop() {
+  keep_alive_.reset();
+  service_.stop();
+
+  for (auto& worker : workers_)
+    if (worker.joinable())
+      worker.join();
+
+  workers_.clear();
+}
+
+void Runtime::Executor::run() {
+  configure_thread();
+  exception_safe_run(service_);
+}
+
+void Runtime::Executor::configure_thread() {
+  if (!config_.cpus.empty()) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (const auto &cpu : config_.cpus)
+      CPU_SET(cpu, &cpus);
+    const auto err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (err != 0)
+      WARNING("Failed to set CPU affinity of executor %s: %s", config_.name, strerror(err));
+  }
+
+  if (config_.priority == Priority::realtime) {
+    struct sched_param param;
+    param.sched_priority = realtime_priority;
+    const auto err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (err != 0)
+      WARNING("Failed to enable realtime scheduling for executor %s: %s", config_.name, strerror(err));
+  }
+}
+
+void Runtime::Executor::schedule_probe() {
+  // The probe handler is queued behind everything else once the timer
+  // expires, so its delay tells how long any handler has to wait.
+  probe_timer_.expires_from_now(probe_interval);
+  probe_timer_.async_wait([this](const boost::system::error_code &err) {
+    if (err)
+      return;
+    queue_latency_.record(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - probe_timer_.expires_at()));
+    schedule_probe();
+  });
+}
 
 std::shared_ptr<Runtime> Runtime::create(std::uint32_t pool_size) {
   return std::shared_ptr<Runtime>(new Runtime(pool_size));
 }
 
 Runtime::Runtime(std::uint32_t pool_size)
-    : pool_size_{pool_size},
-      service_{pool_size_},
-      strand_{service_},
-      keep_alive_{service_} {}
+    : default_{std::make_shared<Executor>(ExecutorConfiguration{default_executor, pool_size, Priority::normal, {}})},
+      strand_{default_->service()} {
+  executors_.insert({default_->name(), default_});
+}
 
 Runtime::~Runtime() {
   try {
@@ -66,16 +177,55 @@ Runtime::~Runtime() {
 }
 
 void Runtime::start() {
-  for (unsigned int i = 0; i < pool_size_; i++)
-    workers_.push_back(std::thread{exception_safe_run, std::ref(service_)});
+  std::lock_guard<std::mutex> l(executors_lock_);
+  running_ = true;
+  for (auto& executor : executors_)
+    executor.second->start();
 }
 
 void Runtime::stop() {
-  service_.stop();
+  // Handlers still running might look up executors, so we must not hold
+  // the lock while waiting for the worker threads.
+  std::vector<std::shared_ptr<Executor>> executors;
+  {
+    std::lock_guard<std::mutex> l(executors_lock_);
+    running_ = false;
+    for (auto& executor : executors_)
+      executors.push_back(executor.second);
+  }
 
-  for (auto& worker : workers_)
-    if (worker.joinable())
-      worker.join();
+  for (auto& executor : executors)
+    executor->stop();
+}
+
+std::shared_ptr<Runtime::Executor> Runtime::add_executor(const ExecutorConfiguration &config) {
+  std::lock_guard<std::mutex> l(executors_lock_);
+  if (executors_.find(config.name) != executors_.end())
+    BOOST_THROW_EXCEPTION(std::runtime_error("Executor already exists"));
+
+  auto executor = std::make_shared<Executor>(config);
+  executors_.insert({config.name, executor});
+  if (running_)
+    executor->start();
+  return executor;
+}
+
+std::shared_ptr<Runtime::Executor> Runtime::executor(const std::string &name) {
+  std::lock_guard<std::mutex> l(executors_lock_);
+  auto it = executors_.find(name);
+  if (it == executors_.end())
+    return default_;
+  return it->second;
+}
+
+std::map<std::string, std::uint64_t> Runtime::statistics() const {
+  std::lock_guard<std::mutex> l(executors_lock_);
+  std::map<std::string, std::uint64_t> stats;
+  for (const auto& executor : executors_) {
+    for (const auto& entry : executor.second->statistics())
+      stats.insert({executor.first + "_" + entry.first, entry.second});
+  }
+  return stats;
 }
 
 std::function<void(std::function<void()>)> Runtime::to_dispatcher_functional() {
@@ -85,6 +235,8 @@ std::function<void(std::function<void()>)> Runtime::to_dispatcher_functional() {
   return [sp](std::function<void()> task) { sp->strand_.post(task); };
 }
 
-boost::asio::io_service& Runtime::service() { return service_; }
+boost::asio::io_service& Runtime::service(const std::string &executor) {
+  return this->executor(executor)->service();
+}
 
 }  // namespace anbox
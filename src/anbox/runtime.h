@@ -21,9 +21,15 @@
 #include <boost/asio.hpp>
 
 #include <memory.h>
+#include <atomic>
 #include <functional>
+#include <map>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <vector>
 
+#include "anbox/common/latency_histogram.h"
 #include "anbox/do_not_copy_or_move.h"
 
 namespace anbox {
@@ -31,45 +37,136 @@ namespace anbox {
 // We bundle our "global" runtime dependencies here, specifically
 // a dispatcher to decouple multiple in-process providers from one
 // another , forcing execution to a well known set of threads.
+//
+// Work is spread over named executors which each run their own
+// io_service on a dedicated set of threads. Latency critical paths like
+// input and audio get their own executor so that slow handlers elsewhere
+// (icon writes, blocking handshakes, ...) can't delay them.
 class Runtime : public DoNotCopyOrMove,
                 public std::enable_shared_from_this<Runtime> {
  public:
   // Our default concurrency setup.
   static constexpr const std::uint32_t worker_threads = 8;
 
+  // Name of the executor service() and the dispatcher run on and which
+  // is used for all lookups of unknown executors.
+  static constexpr const char *default_executor{"default"};
+
+  enum class Priority {
+    normal,
+    // Threads are scheduled with SCHED_FIFO if the process is permitted
+    // to. Only meant for executors with short handlers.
+    realtime,
+  };
+
+  struct ExecutorConfiguration {
+    ExecutorConfiguration(const std::string &name, std::uint32_t threads = 1,
+                          Priority priority = Priority::normal,
+                          const std::vector<int> &cpus = {})
+        : name{name}, threads{threads}, priority{priority}, cpus{cpus} {}
+
+    std::string name;
+    std::uint32_t threads;
+    Priority priority;
+    // CPUs the threads are pinned to; empty means all CPUs.
+    std::vector<int> cpus;
+  };
+
+  class Executor : public DoNotCopyOrMove {
+   public:
+    // Interval in which we measure how long handlers have to wait before
+    // they are executed.
+    static constexpr const std::chrono::milliseconds probe_interval{100};
+
+    explicit Executor(const ExecutorConfiguration &config);
+    ~Executor();
+
+    const std::string &name() const { return config_.name; }
+    boost::asio::io_service &service() { return service_; }
+
+    // post queues the task for execution and accounts it in the queue
+    // depth and handler latency statistics.
+    void post(const std::function<void()> &task);
+    // Same as post() but runs the task on the given strand, which must
+    // belong to service().
+    void post(boost::asio::io_service::strand &strand, const std::function<void()> &task);
+
+    // Time handlers spent queued before being executed, sampled once per
+    // probe_interval.
+    const common::LatencyHistogram &queue_latency() const { return queue_latency_; }
+    // Number of tasks submitted with post() which haven't finished yet.
+    std::uint64_t queue_depth() const { return queue_depth_; }
+    // Time tasks submitted with post() took to execute.
+    const common::LatencyHistogram &handler_latency() const { return handler_latency_; }
+
+    std::map<std::string, std::uint64_t> statistics() const;
+
+   private:
+    friend class Runtime;
+
+    void start();
+    void stop();
+    void run();
+    void configure_thread();
+    void schedule_probe();
+    std::function<void()> account(const std::function<void()> &task);
+
+    const ExecutorConfiguration config_;
+    boost::asio::io_service service_;
+    std::unique_ptr<boost::asio::io_service::work> keep_alive_;
+    boost::asio::steady_timer probe_timer_;
+    std::vector<std::thread> workers_;
+    common::LatencyHistogram queue_latency_;
+    std::atomic<std::uint64_t> queue_depth_{0};
+    common::LatencyHistogram handler_latency_;
+  };
+
   // create returns a Runtime instance with pool_size worker threads
-  // executing the underlying service.
+  // executing the default executor.
   static std::shared_ptr<Runtime> create(
       std::uint32_t pool_size = worker_threads);
 
   // Tears down the runtime, stopping all worker threads.
   ~Runtime() noexcept(true);
 
-  // start executes the underlying io_service on a thread pool with
-  // the size configured at creation time.
+  // start executes all executors on their thread pools with the size
+  // configured at creation time.
   void start();
 
   // stop cleanly shuts down a Runtime instance.
   void stop();
 
+  // add_executor creates a new executor which is started right away if
+  // the runtime is already running. Names have to be unique.
+  std::shared_ptr<Executor> add_executor(const ExecutorConfiguration &config);
+
+  // executor returns the executor with the given name or the default one
+  // if no such executor exists, so components can ask for their executor
+  // without caring whether it was set up.
+  std::shared_ptr<Executor> executor(const std::string &name = default_executor);
+
+  // Returns the statistics of all executors with their name prepended to
+  // the keys.
+  std::map<std::string, std::uint64_t> statistics() const;
+
   // to_dispatcher_functional returns a function for integration
   // with components that expect a dispatcher for operation.
   std::function<void(std::function<void()>)> to_dispatcher_functional();
 
   // service returns the underlying boost::asio::io_service that is executed
-  // by the Runtime.
-  boost::asio::io_service& service();
+  // by the given executor of the Runtime.
+  boost::asio::io_service& service(const std::string &executor = default_executor);
 
  private:
   // Runtime constructs a new instance, firing up pool_size
   // worker threads.
   Runtime(std::uint32_t pool_size);
 
-  std::uint32_t pool_size_;
-  boost::asio::io_service service_;
+  std::shared_ptr<Executor> default_;
   boost::asio::io_service::strand strand_;
-  boost::asio::io_service::work keep_alive_;
-  std::vector<std::thread> workers_;
+  mutable std::mutex executors_lock_;
+  std::map<std::string, std::shared_ptr<Executor>> executors_;
+  bool running_ = false;
 };
 
 }  // namespace anbox
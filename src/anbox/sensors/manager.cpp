@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/sensors/manager.h"
+#include "anbox/sensors/replay_source.h"
+#include "anbox/sensors/synthetic_source.h"
+#include "anbox/utils.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <stdexcept>
+
+namespace anbox {
+namespace sensors {
+std::shared_ptr<Manager> Manager::get() {
+  static auto instance = std::shared_ptr<Manager>(new Manager);
+  return instance;
+}
+
+std::shared_ptr<Source> Manager::create_source(const std::string &spec) {
+  if (spec == "static")
+    return std::make_shared<StaticSource>();
+  else if (spec == "synthetic")
+    return std::make_shared<SyntheticSource>();
+  else if (utils::string_starts_with(spec, "replay:"))
+    return ReplaySource::create_from_file(spec.substr(7));
+
+  BOOST_THROW_EXCEPTION(std::runtime_error(
+      utils::string_format("Invalid sensor source '%s'", spec)));
+}
+
+Manager::Manager()
+    : static_source_(std::make_shared<StaticSource>()),
+      source_(static_source_) {}
+
+std::shared_ptr<Source> Manager::source() const {
+  std::lock_guard<std::mutex> l(lock_);
+  return source_;
+}
+
+void Manager::set_source(const std::shared_ptr<Source> &source) {
+  std::lock_guard<std::mutex> l(lock_);
+  source_ = source;
+  if (auto s = std::dynamic_pointer_cast<StaticSource>(source))
+    static_source_ = s;
+}
+
+void Manager::set_value(Type type, const Values &values) {
+  std::lock_guard<std::mutex> l(lock_);
+  static_source_->set(type, values);
+  source_ = static_source_;
+}
+}  // namespace sensors
+}  // namespace anbox
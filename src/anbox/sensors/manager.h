@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_SENSORS_MANAGER_H_
+#define ANBOX_SENSORS_MANAGER_H_
+
+#include "anbox/sensors/source.h"
+#include "anbox/sensors/static_source.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace anbox {
+namespace sensors {
+// Manager holds the source all sensor clients of the container are served
+// from. Switching the source takes effect with the next sample delivered.
+class Manager {
+ public:
+  static std::shared_ptr<Manager> get();
+
+  // Creates a source from a description as given on the command line:
+  // 'static', 'synthetic' or 'replay:<path>'. Throws if the description
+  // is invalid or the recording can't be loaded.
+  static std::shared_ptr<Source> create_source(const std::string &spec);
+
+  std::shared_ptr<Source> source() const;
+  void set_source(const std::shared_ptr<Source> &source);
+
+  // Sets the value of a sensor and switches to the static source if
+  // another one was active.
+  void set_value(Type type, const Values &values);
+
+ private:
+  Manager();
+
+  mutable std::mutex lock_;
+  std::shared_ptr<StaticSource> static_source_;
+  std::shared_ptr<Source> source_;
+};
+}  // namespace sensors
+}  // namespace anbox
+
+#endif
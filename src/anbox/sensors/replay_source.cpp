@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/sensors/replay_source.h"
+#include "anbox/utils.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace anbox {
+namespace sensors {
+std::shared_ptr<ReplaySource> ReplaySource::create_from_file(
+    const std::string &path) {
+  std::ifstream in(path);
+  if (!in)
+    BOOST_THROW_EXCEPTION(std::runtime_error(
+        utils::string_format("Failed to open sensor recording %s", path)));
+  return std::make_shared<ReplaySource>(in);
+}
+
+ReplaySource::ReplaySource(std::istream &in,
+                           std::chrono::steady_clock::time_point start)
+    : start_(start) {
+  std::string line;
+  std::size_t line_number = 0;
+  while (std::getline(in, line)) {
+    line_number++;
+    if (line.empty() || line[0] == '#') continue;
+
+    std::istringstream fields(line);
+    std::int64_t time = 0;
+    std::string name;
+    Values values{{0.0f, 0.0f, 0.0f}};
+    Type type;
+
+    if (!(fields >> time >> name) || time < 0 || !type_from_name(name, type))
+      BOOST_THROW_EXCEPTION(std::runtime_error(utils::string_format(
+          "Invalid sensor recording entry in line %d", line_number)));
+
+    for (std::size_t n = 0; n < value_count_for(type); n++) {
+      if (!(fields >> values[n]))
+        BOOST_THROW_EXCEPTION(std::runtime_error(utils::string_format(
+            "Missing sensor value in line %d", line_number)));
+    }
+
+    auto &entries = entries_[static_cast<std::size_t>(type)];
+    const std::chrono::milliseconds timestamp{time};
+    if (!entries.empty() && entries.back().time > timestamp)
+      BOOST_THROW_EXCEPTION(std::runtime_error(utils::string_format(
+          "Sensor recording isn't sorted by time in line %d", line_number)));
+
+    entries.emplace_back(timestamp, values);
+    available_ |= mask_for(type);
+    duration_ = std::max(duration_, timestamp);
+  }
+}
+
+Mask ReplaySource::available() const { return available_; }
+
+bool ReplaySource::sample(Type type,
+                          std::chrono::steady_clock::time_point time,
+                          Values &values) {
+  const auto &entries = entries_[static_cast<std::size_t>(type)];
+  if (entries.empty()) return false;
+
+  auto elapsed = std::max(
+      std::chrono::duration_cast<std::chrono::milliseconds>(time - start_),
+      std::chrono::milliseconds{0});
+  // Recordings loop, the last entry marks the end of one iteration.
+  if (duration_.count() > 0) elapsed = elapsed % duration_;
+
+  // Find the last entry which is not newer than the requested time. Before
+  // the first entry of a sensor its last value from the previous iteration
+  // is still in effect.
+  auto iter = std::upper_bound(
+      entries.begin(), entries.end(), elapsed,
+      [](const std::chrono::milliseconds &t, const Entry &e) {
+        return t < e.time;
+      });
+  if (iter == entries.begin())
+    values = entries.back().values;
+  else
+    values = std::prev(iter)->values;
+
+  return true;
+}
+}  // namespace sensors
+}  // namespace anbox
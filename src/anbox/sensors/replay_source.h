@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_SENSORS_REPLAY_SOURCE_H_
+#define ANBOX_SENSORS_REPLAY_SOURCE_H_
+
+#include "anbox/sensors/source.h"
+
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace anbox {
+namespace sensors {
+// ReplaySource plays back sensor values recorded in a text file. Every line
+// has the form
+//
+//   <time in milliseconds> <sensor name> <value> [<value> <value>]
+//
+// where the sensor name is the one used by the HAL, e.g. 'acceleration' or
+// 'magnetic-field'. Empty lines and lines starting with '#' are ignored. A
+// value stays in effect until the next one of the same sensor and the
+// recording loops once its last entry was reached.
+class ReplaySource : public Source {
+ public:
+  static std::shared_ptr<ReplaySource> create_from_file(
+      const std::string &path);
+
+  explicit ReplaySource(std::istream &in,
+                        std::chrono::steady_clock::time_point start =
+                            std::chrono::steady_clock::now());
+
+  Mask available() const override;
+  bool sample(Type type, std::chrono::steady_clock::time_point time,
+              Values &values) override;
+
+ private:
+  struct Entry {
+    Entry(std::chrono::milliseconds time, const Values &values)
+        : time(time), values(values) {}
+
+    std::chrono::milliseconds time;
+    Values values;
+  };
+
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::milliseconds duration_{0};
+  Mask available_ = 0;
+  std::array<std::vector<Entry>, type_count> entries_;
+};
+}  // namespace sensors
+}  // namespace anbox
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/sensors/sensor.h"
+
+namespace {
+struct Description {
+  const char *name;
+  const char *event_name;
+  std::size_t value_count;
+};
+
+// Indexed by anbox::sensors::Type. The HAL names the magnetic field sensor
+// differently in its commands and events.
+const Description descriptions[anbox::sensors::type_count] = {
+    {"acceleration", "acceleration", 3},
+    {"magnetic-field", "magnetic", 3},
+    {"orientation", "orientation", 3},
+    {"temperature", "temperature", 1},
+    {"proximity", "proximity", 1},
+    {"light", "light", 1},
+    {"pressure", "pressure", 1},
+    {"humidity", "humidity", 1},
+};
+}  // namespace
+
+namespace anbox {
+namespace sensors {
+const char *name_for(Type type) {
+  return descriptions[static_cast<std::size_t>(type)].name;
+}
+
+const char *event_name_for(Type type) {
+  return descriptions[static_cast<std::size_t>(type)].event_name;
+}
+
+std::size_t value_count_for(Type type) {
+  return descriptions[static_cast<std::size_t>(type)].value_count;
+}
+
+bool type_from_name(const boost::string_view &name, Type &type) {
+  for (std::size_t n = 0; n < type_count; n++) {
+    if (name == descriptions[n].name) {
+      type = static_cast<Type>(n);
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace sensors
+}  // namespace anbox
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_SENSORS_SENSOR_H_
+#define ANBOX_SENSORS_SENSOR_H_
+
+#include <boost/utility/string_view.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace anbox {
+namespace sensors {
+// The sensors the goldfish sensors HAL inside the container knows about. The
+// numeric values match the sensor handles used by the HAL and define the bit
+// of each sensor in the mask reported for list-sensors.
+enum class Type : std::uint8_t {
+  acceleration = 0,
+  magnetic_field,
+  orientation,
+  temperature,
+  proximity,
+  light,
+  pressure,
+  humidity,
+};
+
+static constexpr const std::size_t type_count{8};
+
+typedef std::uint32_t Mask;
+static constexpr const Mask all_sensors{(1 << type_count) - 1};
+
+// Up to three values per sample; sensors with a single value only use the
+// first one.
+typedef std::array<float, 3> Values;
+
+inline Mask mask_for(Type type) { return 1 << static_cast<Mask>(type); }
+
+// Name used for the sensor in set:<name>:<enabled> commands.
+const char *name_for(Type type);
+// Prefix used for the sensor when reporting events to the HAL.
+const char *event_name_for(Type type);
+std::size_t value_count_for(Type type);
+
+bool type_from_name(const boost::string_view &name, Type &type);
+}  // namespace sensors
+}  // namespace anbox
+
+#endif
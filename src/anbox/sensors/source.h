@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_SENSORS_SOURCE_H_
+#define ANBOX_SENSORS_SOURCE_H_
+
+#include "anbox/sensors/sensor.h"
+
+#include <chrono>
+
+namespace anbox {
+namespace sensors {
+// A Source provides the values reported for the emulated sensors. Sources
+// are sampled by every connected client at the rate the client asked for,
+// so sample() is called from multiple threads and has to be cheap.
+class Source {
+ public:
+  virtual ~Source() {}
+
+  // Mask of the sensors this source provides values for.
+  virtual Mask available() const = 0;
+
+  // Returns the value of the sensor at the given time. Returns false if the
+  // source has no value for the sensor.
+  virtual bool sample(Type type, std::chrono::steady_clock::time_point time,
+                      Values &values) = 0;
+};
+}  // namespace sensors
+}  // namespace anbox
+
+#endif
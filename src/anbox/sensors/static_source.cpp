@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/sensors/static_source.h"
+
+namespace anbox {
+namespace sensors {
+StaticSource::StaticSource() {
+  values_[static_cast<std::size_t>(Type::acceleration)] = {{0.0f, 0.0f, 9.81f}};
+  values_[static_cast<std::size_t>(Type::magnetic_field)] = {{0.0f, 22.0f, -42.0f}};
+  values_[static_cast<std::size_t>(Type::orientation)] = {{0.0f, 0.0f, 0.0f}};
+  values_[static_cast<std::size_t>(Type::temperature)] = {{22.0f, 0.0f, 0.0f}};
+  values_[static_cast<std::size_t>(Type::proximity)] = {{1.0f, 0.0f, 0.0f}};
+  values_[static_cast<std::size_t>(Type::light)] = {{300.0f, 0.0f, 0.0f}};
+  values_[static_cast<std::size_t>(Type::pressure)] = {{1013.25f, 0.0f, 0.0f}};
+  values_[static_cast<std::size_t>(Type::humidity)] = {{45.0f, 0.0f, 0.0f}};
+}
+
+void StaticSource::set(Type type, const Values &values) {
+  std::lock_guard<std::mutex> l(lock_);
+  values_[static_cast<std::size_t>(type)] = values;
+}
+
+Mask StaticSource::available() const { return all_sensors; }
+
+bool StaticSource::sample(Type type, std::chrono::steady_clock::time_point,
+                          Values &values) {
+  std::lock_guard<std::mutex> l(lock_);
+  values = values_[static_cast<std::size_t>(type)];
+  return true;
+}
+}  // namespace sensors
+}  // namespace anbox
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_SENSORS_STATIC_SOURCE_H_
+#define ANBOX_SENSORS_STATIC_SOURCE_H_
+
+#include "anbox/sensors/source.h"
+
+#include <mutex>
+
+namespace anbox {
+namespace sensors {
+// StaticSource reports fixed values which can be changed at any time, e.g.
+// over D-Bus. It starts out with values of a device lying flat on a desk in
+// a lit room.
+class StaticSource : public Source {
+ public:
+  StaticSource();
+
+  void set(Type type, const Values &values);
+
+  Mask available() const override;
+  bool sample(Type type, std::chrono::steady_clock::time_point time,
+              Values &values) override;
+
+ private:
+  std::mutex lock_;
+  std::array<Values, type_count> values_;
+};
+}  // namespace sensors
+}  // namespace anbox
+
+#endif
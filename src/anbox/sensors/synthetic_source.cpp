@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/sensors/synthetic_source.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr const float gravity{9.81f};
+constexpr const float pi{3.14159265f};
+}  // namespace
+
+namespace anbox {
+namespace sensors {
+SyntheticSource::SyntheticSource(std::chrono::milliseconds period,
+                                 std::chrono::steady_clock::time_point start)
+    : period_(period), start_(start) {}
+
+Mask SyntheticSource::available() const { return all_sensors; }
+
+bool SyntheticSource::sample(Type type,
+                             std::chrono::steady_clock::time_point time,
+                             Values &values) {
+  const auto elapsed = std::max(
+      std::chrono::duration_cast<std::chrono::microseconds>(time - start_),
+      std::chrono::microseconds{0});
+  const auto period =
+      std::chrono::duration_cast<std::chrono::microseconds>(period_);
+  // Phase of the rotation in [0, 1)
+  const auto phase = static_cast<float>(elapsed.count() % period.count()) /
+                     static_cast<float>(period.count());
+  const auto angle = 2.0f * pi * phase;
+
+  switch (type) {
+    case Type::acceleration:
+      values = {{gravity * std::sin(angle), gravity * std::cos(angle), 0.0f}};
+      break;
+    case Type::magnetic_field:
+      values = {{22.0f * std::sin(angle), 22.0f * std::cos(angle), -42.0f}};
+      break;
+    case Type::orientation:
+      values = {{360.0f * phase, 0.0f, 0.0f}};
+      break;
+    case Type::temperature:
+      values = {{22.0f + 2.0f * std::sin(angle), 0.0f, 0.0f}};
+      break;
+    case Type::proximity:
+      // Something moves in front of the device for half of the period
+      values = {{phase < 0.5f ? 1.0f : 0.0f, 0.0f, 0.0f}};
+      break;
+    case Type::light:
+      values = {{300.0f + 200.0f * std::sin(angle), 0.0f, 0.0f}};
+      break;
+    case Type::pressure:
+      values = {{1013.25f + std::sin(angle), 0.0f, 0.0f}};
+      break;
+    case Type::humidity:
+      values = {{45.0f + 5.0f * std::sin(angle), 0.0f, 0.0f}};
+      break;
+    default:
+      return false;
+  }
+  return true;
+}
+}  // namespace sensors
+}  // namespace anbox
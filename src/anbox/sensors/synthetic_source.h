@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ANBOX_SENSORS_SYNTHETIC_SOURCE_H_
+#define ANBOX_SENSORS_SYNTHETIC_SOURCE_H_
+
+#include "anbox/sensors/source.h"
+
+namespace anbox {
+namespace sensors {
+// SyntheticSource generates smoothly changing values for all sensors as if
+// the device was slowly rotated around its z axis. The values only depend
+// on the time passed since the source was created which makes it useful
+// for tests.
+class SyntheticSource : public Source {
+ public:
+  explicit SyntheticSource(
+      std::chrono::milliseconds period = std::chrono::seconds{10},
+      std::chrono::steady_clock::time_point start =
+          std::chrono::steady_clock::now());
+
+  Mask available() const override;
+  bool sample(Type type, std::chrono::steady_clock::time_point time,
+              Values &values) override;
+
+ private:
+  std::chrono::milliseconds period_;
+  std::chrono::steady_clock::time_point start_;
+};
+}  // namespace sensors
+}  // namespace anbox
+
+#endif
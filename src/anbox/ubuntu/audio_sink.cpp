@@ -16,46 +16,64 @@
  */
 
 #include "anbox/ubuntu/audio_sink.h"
+#include "anbox/common/tracer.h"
 #include "anbox/logger.h"
 
 #include <stdexcept>
 
 #include <boost/throw_exception.hpp>
 
+#include <SDL2/SDL_error.h>
+
 namespace {
-const constexpr size_t max_queue_size{16};
+const constexpr std::uint16_t output_period_frames{256};
 }
 
 namespace anbox {
 namespace ubuntu {
 AudioSink::AudioSink() :
-  device_id_(0),
-  queue_(max_queue_size) {
+  device_id_(0) {
 }
 
-AudioSink::~AudioSink() {}
+AudioSink::~AudioSink() {
+  disconnect_audio();
+}
 
 void AudioSink::on_data_requested(void *user_data, std::uint8_t *buffer, int size) {
+  // Called from the SDL audio thread so we must not block here.
+  ANBOX_TRACE_SCOPE("audio", "AudioSink::on_data_requested");
   auto thiz = static_cast<AudioSink*>(user_data);
-  thiz->read_data(buffer, size);
+  thiz->mixer_->mix(buffer, size);
 }
 
-bool AudioSink::connect_audio() {
+bool AudioSink::connect_audio(const audio::StreamConfig &config) {
   if (device_id_ > 0)
     return true;
 
-  SDL_memset(&spec_, 0, sizeof(spec_));
-  spec_.freq = 44100;
-  spec_.format = AUDIO_S16;
-  spec_.channels = 2;
-  spec_.samples = 4096;
-  spec_.callback = &AudioSink::on_data_requested;
-  spec_.userdata = this;
-
-  device_id_ = SDL_OpenAudioDevice(nullptr, 0, &spec_, nullptr, 0);
+  // The device is opened with the rate of the first stream, which is what
+  // the Android audio HAL uses for all of them, so that nothing needs to
+  // be resampled. All streams are converted to 16 bit stereo.
+  SDL_AudioSpec desired;
+  SDL_memset(&desired, 0, sizeof(desired));
+  desired.freq = config.sample_rate;
+  desired.format = AUDIO_S16SYS;
+  desired.channels = 2;
+  desired.samples = output_period_frames;
+  desired.callback = &AudioSink::on_data_requested;
+  desired.userdata = this;
+
+  // If the device can't handle the rate we mix at the one it prefers
+  // instead of letting SDL convert the mixed output once more.
+  device_id_ = SDL_OpenAudioDevice(nullptr, 0, &desired, &spec_,
+                                   SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
   if (!device_id_)
     return false;
 
+  const audio::StreamConfig output{static_cast<std::uint32_t>(spec_.freq), 2,
+                                   audio::StreamConfig::Format::S16, 0, spec_.samples};
+  mixer_ = std::make_shared<audio::Mixer>(output);
+  DEBUG("Mixing audio at %d Hz", spec_.freq);
+
   SDL_PauseAudioDevice(device_id_, 0);
 
   return true;
@@ -69,49 +87,15 @@ void AudioSink::disconnect_audio() {
   device_id_ = 0;
 }
 
-void AudioSink::read_data(std::uint8_t *buffer, int size) {
-  std::unique_lock<std::mutex> l(lock_);
-  const auto wanted = size;
-  int count = 0;
-  auto dst = buffer;
-
-  while (count < wanted) {
-    if (read_buffer_left_ > 0) {
-      size_t avail = std::min<size_t>(wanted - count, read_buffer_left_);
-      memcpy(dst + count,
-             read_buffer_.data() + (read_buffer_.size() - read_buffer_left_),
-             avail);
-      count += avail;
-      read_buffer_left_ -= avail;
-      continue;
-    }
-
-    bool blocking = (count == 0);
-    auto result = -EIO;
-    if (blocking)
-      result = queue_.pop_locked(&read_buffer_, l);
-    else
-      result = queue_.try_pop_locked(&read_buffer_);
-
-    if (result == 0) {
-      read_buffer_left_ = read_buffer_.size();
-      continue;
+std::shared_ptr<audio::Sink> AudioSink::create_stream(const audio::StreamConfig &config) {
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    if (!connect_audio(config)) {
+      ERROR("Failed to open audio device: %s", SDL_GetError());
+      return nullptr;
     }
-
-    if (count > 0) break;
-
-    return;
-  }
-}
-
-void AudioSink::write_data(const std::vector<std::uint8_t> &data) {
-  std::unique_lock<std::mutex> l(lock_);
-  if (!connect_audio()) {
-    WARNING("Audio server not connected, skipping %d bytes", data.size());
-    return;
   }
-  graphics::Buffer buffer{data.data(), data.data() + data.size()};
-  queue_.push_locked(std::move(buffer), l);
+  return mixer_->create_stream(config);
 }
 } // namespace ubuntu
 } // namespace anbox
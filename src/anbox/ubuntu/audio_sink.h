@@ -18,35 +18,34 @@
 #ifndef ANBOX_UBUNTU_AUDIO_SINK_H_
 #define ANBOX_UBUNTU_AUDIO_SINK_H_
 
-#include "anbox/audio/sink.h"
-#include "anbox/graphics/buffer_queue.h"
+#include "anbox/audio/client_info.h"
+#include "anbox/audio/mixer.h"
 
 #include <SDL2/SDL_audio.h>
 
-#include <thread>
+#include <mutex>
 
 namespace anbox {
 namespace ubuntu {
-class AudioSink : public audio::Sink {
+// AudioSink owns the single SDL output device all playback streams of the
+// container are mixed into.
+class AudioSink {
  public:
   AudioSink();
   ~AudioSink();
 
-  void write_data(const std::vector<std::uint8_t> &data) override;
+  std::shared_ptr<audio::Sink> create_stream(const audio::StreamConfig &config);
 
  private:
-  bool connect_audio();
+  bool connect_audio(const audio::StreamConfig &config);
   void disconnect_audio();
-  void read_data(std::uint8_t *buffer, int size);
 
   static void on_data_requested(void *user_data, std::uint8_t *buffer, int size);
 
   std::mutex lock_;
   SDL_AudioSpec spec_;
   SDL_AudioDeviceID device_id_;
-  graphics::BufferQueue queue_;
-  graphics::Buffer read_buffer_;
-  size_t read_buffer_left_ = 0;
+  std::shared_ptr<audio::Mixer> mixer_;
 };
 } // namespace ubuntu
 } // namespace anbox
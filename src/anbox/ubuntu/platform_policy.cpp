@@ -18,6 +18,7 @@
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wswitch-default"
 #include "anbox/ubuntu/platform_policy.h"
+#include "anbox/common/small_vector.h"
 #include "anbox/input/device.h"
 #include "anbox/input/manager.h"
 #include "anbox/logger.h"
@@ -40,7 +41,8 @@ PlatformPolicy::PlatformPolicy(
     bool single_window)
     : input_manager_(input_manager),
       event_thread_running_(false),
-      single_window_(single_window) {
+      single_window_(single_window),
+      audio_sink_(std::make_shared<AudioSink>()) {
   if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_EVENTS) < 0) {
     const auto message = utils::string_format("Failed to initialize SDL: %s", SDL_GetError());
     BOOST_THROW_EXCEPTION(std::runtime_error(message));
@@ -149,8 +151,10 @@ void PlatformPolicy::process_events() {
 }
 
 void PlatformPolicy::process_input_event(const SDL_Event &event) {
-  std::vector<input::Event> mouse_events;
-  std::vector<input::Event> keyboard_events;
+  // Each SDL event translates into a handful of input events only so we
+  // keep them on the stack.
+  common::SmallFixedVector<input::Event, 8> mouse_events;
+  common::SmallFixedVector<input::Event, 4> keyboard_events;
 
   std::int32_t x = 0;
   std::int32_t y = 0;
@@ -241,9 +245,20 @@ void PlatformPolicy::process_input_event(const SDL_Event &event) {
       break;
   }
 
-  if (mouse_events.size() > 0) pointer_->send_events(mouse_events);
+  if (mouse_events.empty() && keyboard_events.empty())
+    return;
+
+  // SDL gives us the time in milliseconds since it was initialized when the
+  // event was created. We map that onto the monotonic clock so that the
+  // events reach Android with the time they really happened.
+  const auto event_age = std::chrono::milliseconds{SDL_GetTicks() - event.common.timestamp};
+  const auto event_time = input::Timestamp::clock::now() - event_age;
+
+  if (mouse_events.size() > 0)
+    pointer_->send_events(mouse_events.data(), mouse_events.size(), event_time);
 
-  if (keyboard_events.size() > 0) keyboard_->send_events(keyboard_events);
+  if (keyboard_events.size() > 0)
+    keyboard_->send_events(keyboard_events.data(), keyboard_events.size(), event_time);
 }
 
 Window::Id PlatformPolicy::next_window_id() {
@@ -337,8 +352,8 @@ PlatformPolicy::ClipboardData PlatformPolicy::get_clipboard_data() {
   return data;
 }
 
-std::shared_ptr<audio::Sink> PlatformPolicy::create_audio_sink() {
-  return std::make_shared<AudioSink>();
+std::shared_ptr<audio::Sink> PlatformPolicy::create_audio_sink(const audio::StreamConfig &config) {
+  return audio_sink_->create_stream(config);
 }
 
 std::shared_ptr<audio::Source> PlatformPolicy::create_audio_source() {
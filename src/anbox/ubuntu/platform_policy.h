@@ -43,6 +43,7 @@ namespace wm {
 class Manager;
 } // namespace wm
 namespace ubuntu {
+class AudioSink;
 class PlatformPolicy : public std::enable_shared_from_this<PlatformPolicy>,
                        public platform::Policy,
                        public Window::Observer,
@@ -67,13 +68,13 @@ class PlatformPolicy : public std::enable_shared_from_this<PlatformPolicy>,
 
   DisplayInfo display_info() const override;
 
-  void set_renderer(const std::shared_ptr<Renderer> &renderer);
-  void set_window_manager(const std::shared_ptr<wm::Manager> &window_manager);
+  void set_renderer(const std::shared_ptr<Renderer> &renderer) override;
+  void set_window_manager(const std::shared_ptr<wm::Manager> &window_manager) override;
 
   void set_clipboard_data(const ClipboardData &data) override;
   ClipboardData get_clipboard_data() override;
 
-  std::shared_ptr<audio::Sink> create_audio_sink() override;
+  std::shared_ptr<audio::Sink> create_audio_sink(const audio::StreamConfig &config) override;
   std::shared_ptr<audio::Source> create_audio_source() override;
 
  private:
@@ -96,6 +97,7 @@ class PlatformPolicy : public std::enable_shared_from_this<PlatformPolicy>,
   DisplayManager::DisplayInfo display_info_;
   bool window_size_immutable_ = false;
   bool single_window_ = false;
+  std::shared_ptr<AudioSink> audio_sink_;
 };
 }  // namespace wm
 }  // namespace anbox
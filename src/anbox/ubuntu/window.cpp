@@ -180,9 +180,17 @@ void Window::process_event(const SDL_Event &event) {
       if (observer_)
         observer_->window_moved(id_, event.window.data1, event.window.data2);
       break;
+    // SDL doesn't tell us when a window is fully covered by others, so we
+    // only know it's invisible when it's hidden or minimized.
     case SDL_WINDOWEVENT_SHOWN:
+    case SDL_WINDOWEVENT_EXPOSED:
+    case SDL_WINDOWEVENT_RESTORED:
+    case SDL_WINDOWEVENT_MAXIMIZED:
+      set_visible(true);
       break;
     case SDL_WINDOWEVENT_HIDDEN:
+    case SDL_WINDOWEVENT_MINIMIZED:
+      set_visible(false);
       break;
     case SDL_WINDOWEVENT_CLOSE:
       if (observer_) observer_->window_deleted(id_);
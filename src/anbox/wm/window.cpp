@@ -42,6 +42,13 @@ void Window::update_frame(const graphics::Rect &frame) {
   frame_ = frame;
 }
 
+bool Window::visible() const { return visible_.load(); }
+
+void Window::set_visible(bool visible) {
+  if (visible_.exchange(visible) == visible) return;
+  DEBUG("Window of task %d is %s now", task_, visible ? "visible" : "invisible");
+}
+
 Task::Id Window::task() const { return task_; }
 
 graphics::Rect Window::frame() const { return frame_; }
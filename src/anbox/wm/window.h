@@ -20,6 +20,7 @@
 
 #include "anbox/wm/window_state.h"
 
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -48,12 +49,17 @@ class Window {
   Window(const std::shared_ptr<Renderer> &renderer, const Task::Id &task, const graphics::Rect &frame, const std::string &title);
   virtual ~Window();
 
-  bool attach();
-  void release();
+  virtual bool attach();
+  virtual void release();
 
   void update_state(const WindowState::List &states);
   void update_frame(const graphics::Rect &frame);
 
+  // Windows which are hidden or minimized can't be seen by the user and
+  // are not composed. Can be changed from any thread.
+  bool visible() const;
+  void set_visible(bool visible);
+
   virtual EGLNativeWindowType native_handle() const;
   virtual void *native_surface() const;
   virtual EGLNativeDisplayType native_display() const;
@@ -67,6 +73,7 @@ class Window {
   graphics::Rect frame_;
   std::string title_;
   bool attached_ = false;
+  std::atomic<bool> visible_{true};
 };
 }  // namespace wm
 }  // namespace anbox
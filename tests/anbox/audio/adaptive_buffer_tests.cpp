@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/audio/adaptive_buffer.h"
+
+#include <vector>
+
+namespace anbox {
+namespace audio {
+namespace {
+// 48 kHz stereo S16 with 64 frames per period gives 256 bytes per period.
+const StreamConfig config{48000, 2, StreamConfig::Format::S16, 0, 64};
+const std::size_t period_size = 256;
+
+std::vector<std::uint8_t> period_of(std::uint8_t value) {
+  return std::vector<std::uint8_t>(period_size, value);
+}
+}  // namespace
+
+TEST(AdaptiveBuffer, PlaysSilenceUntilTargetIsReached) {
+  AdaptiveBuffer buffer(config, 8);
+  ASSERT_EQ(2 * period_size, buffer.target());
+
+  auto data = period_of(1);
+  ASSERT_EQ(period_size, buffer.write(data.data(), data.size()));
+
+  std::vector<std::uint8_t> out(period_size, 0xff);
+  buffer.read(out.data(), out.size());
+  ASSERT_EQ(period_of(0), out);
+  ASSERT_EQ(period_size, buffer.buffered());
+
+  ASSERT_EQ(period_size, buffer.write(data.data(), data.size()));
+  buffer.read(out.data(), out.size());
+  ASSERT_EQ(period_of(1), out);
+  ASSERT_EQ(0u, buffer.underruns());
+}
+
+TEST(AdaptiveBuffer, LimitsQueuedData) {
+  AdaptiveBuffer buffer(config, 8);
+  std::vector<std::uint8_t> data(10 * period_size, 1);
+  ASSERT_EQ(3 * period_size, buffer.write(data.data(), data.size()));
+  ASSERT_EQ(0u, buffer.write(data.data(), data.size()));
+}
+
+TEST(AdaptiveBuffer, GrowsTargetAfterUnderrun) {
+  AdaptiveBuffer buffer(config, 8);
+  auto data = period_of(1);
+  std::vector<std::uint8_t> out(period_size);
+
+  for (int n = 0; n < 2; n++)
+    buffer.write(data.data(), data.size());
+  for (int n = 0; n < 3; n++)
+    buffer.read(out.data(), out.size());
+
+  // The writer comes back right after the device ran dry which means it
+  // was too late.
+  buffer.write(data.data(), data.size());
+  ASSERT_EQ(1u, buffer.underruns());
+  ASSERT_EQ(4 * period_size, buffer.target());
+}
+
+TEST(AdaptiveBuffer, DoesNotGrowTargetAfterIdlePeriod) {
+  AdaptiveBuffer buffer(config, 8);
+  auto data = period_of(1);
+  std::vector<std::uint8_t> out(period_size);
+
+  for (int n = 0; n < 2; n++)
+    buffer.write(data.data(), data.size());
+  // The stream stopped for a while and the device played a lot of silence.
+  for (int n = 0; n < 20; n++)
+    buffer.read(out.data(), out.size());
+
+  buffer.write(data.data(), data.size());
+  ASSERT_EQ(0u, buffer.underruns());
+  ASSERT_EQ(2 * period_size, buffer.target());
+}
+
+TEST(AdaptiveBuffer, TargetIsBounded) {
+  AdaptiveBuffer buffer(config, 4);
+  auto data = period_of(1);
+  std::vector<std::uint8_t> out(period_size);
+
+  for (int n = 0; n < 5; n++) {
+    while (buffer.write(data.data(), data.size()) > 0);
+    while (buffer.buffered() > 0)
+      buffer.read(out.data(), out.size());
+    buffer.read(out.data(), out.size());
+  }
+
+  ASSERT_EQ(4 * period_size, buffer.target());
+}
+
+TEST(AdaptiveBuffer, ConvertsBytesToDuration) {
+  AdaptiveBuffer buffer(config, 8);
+  ASSERT_EQ(std::chrono::microseconds{1000}, buffer.duration_of(192));
+}
+}  // namespace audio
+}  // namespace anbox
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/audio/mixer.h"
+
+#include <cstring>
+
+namespace anbox {
+namespace audio {
+namespace {
+const StreamConfig output{48000, 2, StreamConfig::Format::S16, 0, 64};
+
+std::vector<std::uint8_t> samples_of(const std::vector<std::int16_t> &samples) {
+  std::vector<std::uint8_t> data(samples.size() * sizeof(std::int16_t));
+  std::memcpy(data.data(), samples.data(), data.size());
+  return data;
+}
+
+// Writes enough periods of the given constant stereo sample for the stream
+// to leave prebuffering.
+void fill(Mixer::Stream &stream, const StreamConfig &config, std::int16_t value) {
+  const auto samples = 2 * config.period_frames * config.channels;
+  stream.write_data(samples_of(std::vector<std::int16_t>(samples, value)));
+}
+
+std::vector<std::int16_t> mix(Mixer &mixer, std::size_t frames) {
+  std::vector<std::int16_t> out(frames * 2, 1);
+  mixer.mix(reinterpret_cast<std::uint8_t*>(out.data()), out.size() * sizeof(std::int16_t));
+  return out;
+}
+}  // namespace
+
+TEST(Mixer, OutputsSilenceWithoutStreams) {
+  auto mixer = std::make_shared<Mixer>(output);
+  ASSERT_EQ(std::vector<std::int16_t>(128, 0), mix(*mixer, 64));
+  ASSERT_EQ(0u, mixer->active_streams());
+}
+
+TEST(Mixer, SumsStreamsWithSaturation) {
+  auto mixer = std::make_shared<Mixer>(output);
+  auto a = mixer->create_stream(output);
+  auto b = mixer->create_stream(output);
+  auto c = mixer->create_stream(output);
+  fill(*a, output, 1000);
+  fill(*b, output, 2000);
+  fill(*c, output, 32000);
+
+  // Use a size which isn't a multiple of the SIMD width to also cover the
+  // scalar tail.
+  auto out = mix(*mixer, 61);
+  ASSERT_EQ(3u, mixer->active_streams());
+  ASSERT_EQ(std::vector<std::int16_t>(122, 32767), out);
+
+  c.reset();
+  out = mix(*mixer, 61);
+  ASSERT_EQ(std::vector<std::int16_t>(122, 3000), out);
+}
+
+TEST(Mixer, AppliesGain) {
+  auto mixer = std::make_shared<Mixer>(output);
+  auto stream = mixer->create_stream(output);
+  stream->set_gain(0.5f);
+  fill(*stream, output, 1000);
+  ASSERT_EQ(std::vector<std::int16_t>(128, 500), mix(*mixer, 64));
+
+  stream->set_gain(100.0f);
+  ASSERT_EQ(4.0f, stream->gain());
+}
+
+TEST(Mixer, ConvertsFormatAndChannels) {
+  auto mixer = std::make_shared<Mixer>(output);
+  const StreamConfig config{48000, 1, StreamConfig::Format::U8, 0, 64};
+  auto stream = mixer->create_stream(config);
+  stream->write_data(std::vector<std::uint8_t>(2 * 64, 0x90));
+  ASSERT_EQ(std::vector<std::int16_t>(128, 0x1000), mix(*mixer, 64));
+}
+
+TEST(Mixer, ResamplesStreams) {
+  auto mixer = std::make_shared<Mixer>(output);
+  const StreamConfig config{24000, 2, StreamConfig::Format::S16, 0, 32};
+  auto stream = mixer->create_stream(config);
+
+  // A ramp with a step of 100 should come out with steps of 50 once
+  // upsampled to twice the rate.
+  std::vector<std::int16_t> ramp;
+  for (std::int16_t n = 0; n < 64; n++) {
+    ramp.push_back(n * 100);
+    ramp.push_back(n * 100);
+  }
+  stream->write_data(samples_of(ramp));
+
+  const auto out = mix(*mixer, 64);
+  // The interpolation starts from silence and the first input frame is a
+  // zero too, so the ramp only shows up from the fifth output frame on.
+  for (std::size_t n = 5; n < 64; n++) {
+    ASSERT_EQ(out[2 * n], out[2 * n + 1]);
+    ASSERT_EQ(50, out[2 * n] - out[2 * (n - 1)]);
+  }
+}
+
+TEST(Mixer, ResamplesFullScaleSteps) {
+  auto mixer = std::make_shared<Mixer>(output);
+  const StreamConfig config{44100, 2, StreamConfig::Format::S16, 0, 32};
+  auto stream = mixer->create_stream(config);
+
+  std::vector<std::int16_t> input;
+  for (std::size_t n = 0; n < 64; n++) {
+    const std::int16_t value = n % 2 ? 32767 : -32768;
+    input.push_back(value);
+    input.push_back(value);
+  }
+  stream->write_data(samples_of(input));
+
+  const auto out = mix(*mixer, 64);
+
+  // Every output frame lies on the line between the two input frames
+  // around it. The interpolation starts from two frames of silence.
+  std::vector<std::int64_t> frames{0, 0};
+  for (std::size_t n = 0; n < input.size(); n += 2)
+    frames.push_back(input[n]);
+  const std::uint64_t step = (44100ull << 16) / output.sample_rate;
+  for (std::size_t n = 0; n < 64; n++) {
+    const auto position = n * step;
+    const auto current = frames[position >> 16];
+    const auto next = frames[(position >> 16) + 1];
+    const auto expected = current + (((next - current) * static_cast<std::int64_t>(position & 0xffff)) >> 16);
+    ASSERT_EQ(expected, out[2 * n]);
+    ASSERT_EQ(expected, out[2 * n + 1]);
+  }
+}
+
+TEST(Mixer, SkipsIdleStreams) {
+  auto mixer = std::make_shared<Mixer>(output);
+  auto stream = mixer->create_stream(output);
+  fill(*stream, output, 1000);
+
+  for (int n = 0; n < 8; n++)
+    mix(*mixer, 64);
+
+  ASSERT_FALSE(stream->active());
+  mix(*mixer, 64);
+  ASSERT_EQ(0u, mixer->active_streams());
+
+  fill(*stream, output, 1000);
+  ASSERT_TRUE(stream->active());
+  ASSERT_EQ(std::vector<std::int16_t>(128, 1000), mix(*mixer, 64));
+  ASSERT_EQ(0u, stream->buffer().underruns());
+}
+
+TEST(Mixer, LimitsNumberOfStreams) {
+  auto mixer = std::make_shared<Mixer>(output);
+  std::vector<std::shared_ptr<Mixer::Stream>> streams;
+  for (std::size_t n = 0; n < Mixer::max_streams; n++)
+    streams.push_back(mixer->create_stream(output));
+  ASSERT_EQ(nullptr, mixer->create_stream(output));
+
+  streams.pop_back();
+  ASSERT_NE(nullptr, mixer->create_stream(output));
+}
+}  // namespace audio
+}  // namespace anbox
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/audio/ring_buffer.h"
+
+#include <cstring>
+#include <thread>
+
+namespace anbox {
+namespace audio {
+TEST(RingBuffer, ReadsBackWhatWasWritten) {
+  RingBuffer ring(8);
+  const std::uint8_t data[] = {1, 2, 3, 4, 5};
+  ASSERT_EQ(5u, ring.write(data, sizeof(data)));
+  ASSERT_EQ(5u, ring.available());
+  ASSERT_EQ(3u, ring.free_space());
+
+  std::uint8_t out[5] = {0};
+  ASSERT_EQ(5u, ring.read(out, sizeof(out)));
+  ASSERT_EQ(0, std::memcmp(data, out, sizeof(data)));
+  ASSERT_EQ(0u, ring.available());
+}
+
+TEST(RingBuffer, DoesNotOverwriteUnreadData) {
+  RingBuffer ring(4);
+  const std::uint8_t data[] = {1, 2, 3, 4, 5, 6};
+  ASSERT_EQ(4u, ring.write(data, sizeof(data)));
+  ASSERT_EQ(0u, ring.write(data, sizeof(data)));
+
+  std::uint8_t out[6] = {0};
+  ASSERT_EQ(4u, ring.read(out, sizeof(out)));
+  ASSERT_EQ(0, std::memcmp(data, out, 4));
+  ASSERT_EQ(0u, ring.read(out, sizeof(out)));
+}
+
+TEST(RingBuffer, WrapsAround) {
+  RingBuffer ring(4);
+  std::uint8_t out[4] = {0};
+  for (std::uint8_t n = 0; n < 10; n++) {
+    const std::uint8_t data[] = {n, static_cast<std::uint8_t>(n + 1), static_cast<std::uint8_t>(n + 2)};
+    ASSERT_EQ(3u, ring.write(data, sizeof(data)));
+    ASSERT_EQ(3u, ring.read(out, sizeof(out)));
+    ASSERT_EQ(0, std::memcmp(data, out, sizeof(data)));
+  }
+}
+
+TEST(RingBuffer, TransfersDataBetweenThreads) {
+  const std::size_t total = 1 << 16;
+  RingBuffer ring(256);
+
+  std::thread producer([&]() {
+    std::uint8_t chunk[100];
+    std::size_t written = 0;
+    while (written < total) {
+      const auto size = std::min(sizeof(chunk), total - written);
+      for (std::size_t n = 0; n < size; n++)
+        chunk[n] = static_cast<std::uint8_t>(written + n);
+      auto offset = 0u;
+      while (offset < size) {
+        const auto count = ring.write(chunk + offset, size - offset);
+        if (count == 0)
+          std::this_thread::yield();
+        offset += count;
+      }
+      written += size;
+    }
+  });
+
+  std::uint8_t chunk[64];
+  std::size_t read = 0;
+  bool in_order = true;
+  while (read < total) {
+    const auto count = ring.read(chunk, sizeof(chunk));
+    if (count == 0)
+      std::this_thread::yield();
+    for (std::size_t n = 0; n < count; n++)
+      in_order &= chunk[n] == static_cast<std::uint8_t>(read + n);
+    read += count;
+  }
+  producer.join();
+
+  ASSERT_TRUE(in_order);
+  ASSERT_EQ(0u, ring.available());
+}
+}  // namespace audio
+}  // namespace anbox
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/camera/converter.h"
+#include "anbox/camera/synthetic_source.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace anbox;
+
+namespace {
+constexpr const int frames{100};
+}
+
+// Measures how many frames per second we can deliver in the format the
+// camera HAL asks for most (NV21 plus RGB32 preview).
+int main() {
+  const camera::Size size{640, 480};
+
+  camera::SyntheticSource source;
+  if (!source.start(size)) {
+    std::cerr << "Failed to start the synthetic source" << std::endl;
+    return 1;
+  }
+
+  camera::Frame frame;
+  std::vector<std::uint8_t> video(
+      camera::frame_size(camera::PixelFormat::nv21, size.width, size.height));
+  std::vector<std::uint8_t> preview(
+      camera::frame_size(camera::PixelFormat::rgb32, size.width, size.height));
+
+  const auto measure = [&](void (*to_rgb32)(const camera::Frame &, std::uint8_t *)) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < frames; n++) {
+      source.read(frame);
+      camera::convert(frame, camera::PixelFormat::nv21, video.data());
+      to_rgb32(frame, preview.data());
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    return frames * 1e6 / std::max<std::int64_t>(elapsed.count(), 1);
+  };
+
+  const auto fps = measure(&camera::i420_to_rgb32);
+  const auto reference_fps = measure(&camera::reference::i420_to_rgb32);
+  source.stop();
+
+  std::cout << "640x480 NV21 + RGB32 preview: " << fps << " fps ("
+            << (camera::simd_available() ? "SIMD" : "scalar") << "), "
+            << reference_fps << " fps (reference)" << std::endl;
+  return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/camera/converter.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace anbox {
+namespace camera {
+namespace {
+std::vector<std::uint8_t> random_rgb32(int width, int height) {
+  std::vector<std::uint8_t> rgb(width * height * 4);
+  std::srand(42);
+  for (auto &c : rgb) c = static_cast<std::uint8_t>(std::rand());
+  return rgb;
+}
+}  // namespace
+
+TEST(Converter, SimdMatchesReference) {
+  // Odd sized in the SIMD sense to cover the scalar tail handling as well
+  const int width = 70, height = 34;
+  const auto rgb = random_rgb32(width, height);
+
+  Frame frame(width, height), expected_frame(width, height);
+  rgb32_to_i420(rgb.data(), frame);
+  reference::rgb32_to_i420(rgb.data(), expected_frame);
+  ASSERT_EQ(0, std::memcmp(expected_frame.y(), frame.y(), frame.byte_size()));
+
+  std::vector<std::uint8_t> out(rgb.size()), expected_out(rgb.size());
+  i420_to_rgb32(frame, out.data());
+  reference::i420_to_rgb32(frame, expected_out.data());
+  ASSERT_EQ(expected_out, out);
+}
+
+TEST(Converter, KnownColors) {
+  Frame frame(2, 2);
+  const std::uint8_t white[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                                0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+  rgb32_to_i420(white, frame);
+  EXPECT_EQ(235, frame.y()[0]);
+  EXPECT_EQ(128, frame.u()[0]);
+  EXPECT_EQ(128, frame.v()[0]);
+
+  const std::uint8_t red[] = {0xff, 0, 0, 0xff, 0xff, 0, 0, 0xff,
+                              0xff, 0, 0, 0xff, 0xff, 0, 0, 0xff};
+  rgb32_to_i420(red, frame);
+  EXPECT_EQ(82, frame.y()[0]);
+  EXPECT_EQ(90, frame.u()[0]);
+  EXPECT_EQ(240, frame.v()[0]);
+
+  std::uint8_t rgb[16];
+  i420_to_rgb32(frame, rgb);
+  EXPECT_NEAR(0xff, rgb[0], 2);
+  EXPECT_NEAR(0, rgb[1], 2);
+  EXPECT_NEAR(0, rgb[2], 2);
+  EXPECT_EQ(0xff, rgb[3]);
+}
+
+TEST(Converter, SemiPlanarFormats) {
+  Frame frame(4, 2);
+  for (std::size_t n = 0; n < frame.byte_size(); n++) frame.y()[n] = n;
+
+  std::vector<std::uint8_t> nv21(frame_size(PixelFormat::nv21, 4, 2));
+  convert(frame, PixelFormat::nv21, nv21.data());
+  // Y plane first, followed by interleaved V and U
+  EXPECT_EQ(0, std::memcmp(frame.y(), nv21.data(), 8));
+  EXPECT_EQ(frame.v()[0], nv21[8]);
+  EXPECT_EQ(frame.u()[0], nv21[9]);
+  EXPECT_EQ(frame.v()[1], nv21[10]);
+  EXPECT_EQ(frame.u()[1], nv21[11]);
+}
+
+TEST(Converter, YuyvToI420) {
+  Frame frame(2, 2);
+  // Two rows of Y0 U Y1 V with padding at the end of each row
+  const std::uint8_t yuyv[] = {10, 100, 20, 200, 0, 0,
+                               30, 110, 40, 210, 0, 0};
+  yuyv_to_i420(yuyv, 6, frame);
+  EXPECT_EQ(10, frame.y()[0]);
+  EXPECT_EQ(20, frame.y()[1]);
+  EXPECT_EQ(30, frame.y()[2]);
+  EXPECT_EQ(40, frame.y()[3]);
+  EXPECT_EQ(105, frame.u()[0]);
+  EXPECT_EQ(205, frame.v()[0]);
+}
+}  // namespace camera
+}  // namespace anbox
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/camera/frame_ring.h"
+
+#include <cstring>
+
+namespace anbox {
+namespace camera {
+TEST(FrameRing, WrittenFramesCanBeReadThroughAttachedRing) {
+  const auto writer = FrameRing::create(1024, 2);
+  const auto reader = FrameRing::attach(writer->fd());
+  ASSERT_EQ(2u, reader->slot_count());
+  ASSERT_EQ(writer->slot_size(), reader->slot_size());
+
+  std::vector<std::uint8_t> out(reader->slot_size());
+  FrameRing::SlotInfo info;
+  EXPECT_FALSE(reader->read(0, out.data(), info));
+
+  for (std::uint8_t n = 0; n < 3; n++) {
+    std::uint8_t *data = nullptr;
+    const auto slot = writer->begin_write(&data);
+    EXPECT_EQ(n % 2u, slot);
+    std::memset(data, n + 1, 100);
+    writer->end_write(slot, 60, 40);
+
+    ASSERT_TRUE(reader->read(slot, out.data(), info));
+    EXPECT_EQ(60u, info.video_size);
+    EXPECT_EQ(40u, info.preview_size);
+    EXPECT_EQ(n + 1, out[0]);
+    EXPECT_EQ(n + 1, out[99]);
+  }
+}
+
+TEST(FrameRing, RejectsInvalidMemory) {
+  EXPECT_ANY_THROW(FrameRing::attach(Fd{-1}));
+}
+}  // namespace camera
+}  // namespace anbox
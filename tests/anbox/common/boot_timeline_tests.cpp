@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/common/boot_timeline.h"
+
+#include <boost/filesystem.hpp>
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace anbox {
+namespace common {
+namespace {
+class BootTimelineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = (fs::temp_directory_path() / fs::unique_path()).string();
+  }
+  void TearDown() override { fs::remove_all(dir); }
+
+  std::string dir;
+};
+}  // namespace
+
+TEST_F(BootTimelineTest, MergesMilestonesOfAllProcesses) {
+  const auto before = BootTimeline::now();
+
+  auto timeline = BootTimeline::get();
+  timeline->start(dir, "session-manager");
+  {
+    // Another process recording into the same directory
+    std::ofstream other(dir + "/container-manager.timeline", std::ofstream::app);
+    other << before - 1000 << " container-manager rootfs-mounted\n"
+          << BootTimeline::now() << " container-manager container-started\n";
+  }
+  timeline->mark("boot-finished");
+
+  const auto milestones = BootTimeline::load(dir);
+  ASSERT_EQ(4u, milestones.size());
+  EXPECT_EQ("rootfs-mounted", milestones[0].name);
+  EXPECT_EQ("session-manager-started", milestones[1].name);
+  EXPECT_EQ("container-started", milestones[2].name);
+  EXPECT_EQ("container-manager", milestones[2].process);
+  EXPECT_EQ("boot-finished", milestones[3].name);
+}
+
+TEST_F(BootTimelineTest, MarksOnceAndNotifiesWhenReached) {
+  auto timeline = BootTimeline::get();
+  timeline->start(dir, "session-manager");
+
+  int notified = 0;
+  timeline->when_reached("first-frame", [&]() { notified++; });
+  EXPECT_TRUE(timeline->mark_once("first-frame"));
+  EXPECT_FALSE(timeline->mark_once("first-frame"));
+  EXPECT_EQ(1, notified);
+  EXPECT_TRUE(timeline->reached("first-frame"));
+
+  // Handlers registered after the milestone run right away
+  timeline->when_reached("first-frame", [&]() { notified++; });
+  EXPECT_EQ(2, notified);
+
+  EXPECT_EQ(2u, BootTimeline::load(dir).size());
+}
+
+TEST_F(BootTimelineTest, MarksOnceFromConcurrentThreads) {
+  auto timeline = BootTimeline::get();
+  timeline->start(dir, "session-manager");
+
+  std::atomic<int> recorded{0};
+  std::vector<std::thread> threads;
+  for (int n = 0; n < 8; n++) {
+    threads.emplace_back([&]() {
+      for (int m = 0; m < 100; m++) {
+        if (timeline->mark_once("first-frame")) recorded++;
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+
+  EXPECT_EQ(1, recorded.load());
+  EXPECT_EQ(2u, BootTimeline::load(dir).size());
+}
+
+TEST(BootTimeline, ReportCoversOnlyTheCurrentSession) {
+  const std::vector<BootTimeline::Milestone> milestones{
+      {1000000, "container-manager", "container-started"},
+      {5000000, "launch", "launch-started"},
+      {5500000, "session-manager", "session-manager-started"},
+      {6000000, "container-manager", "container-started"},
+      {9000000, "session-manager", "boot-finished"},
+      {9250000, "launch", "activity-launched"},
+  };
+
+  std::ostringstream out;
+  BootTimeline::write_report(milestones, out);
+  const auto report = out.str();
+
+  EXPECT_EQ(0u, report.find("Boot took 4.250s (5 milestones) from launch-started to activity-launched"));
+  EXPECT_NE(std::string::npos, report.find("   3.000s  container-started -> boot-finished"));
+  // The container start of the previous session isn't part of the report
+  EXPECT_EQ(std::string::npos, report.find("  0.000s  container-started"));
+}
+}  // namespace common
+}  // namespace anbox
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/common/image_readahead.h"
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <future>
+
+namespace fs = boost::filesystem;
+
+namespace anbox {
+namespace common {
+namespace {
+class ImageReadaheadTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directories(dir);
+    image = dir / "android.img";
+    std::ofstream(image.string()) << std::string(1024 * 1024, 'x');
+  }
+  void TearDown() override { fs::remove_all(dir); }
+
+  fs::path dir;
+  fs::path image;
+};
+}  // namespace
+
+TEST(ImageReadahead, CoalescesNearbyExtents) {
+  const std::vector<Extent> extents{{8192, 4096}, {0, 4096}, {4096, 1024}, {20000, 100}, {13000, 0}};
+  EXPECT_EQ((std::vector<Extent>{{0, 5120}, {8192, 4096}, {20000, 100}}),
+            ImageReadahead::coalesce(extents, 2048));
+  EXPECT_EQ((std::vector<Extent>{{0, 12288}, {20000, 100}}),
+            ImageReadahead::coalesce(extents, 4096));
+  EXPECT_EQ(3u, ImageReadahead::coalesce({{0, 10}, {20, 10}, {40, 10}}, 0).size());
+}
+
+TEST(ImageReadahead, PartitionsIntoEqualParts) {
+  const auto parts = ImageReadahead::partition({{0, 100}, {200, 300}, {1000, 200}}, 3);
+  ASSERT_EQ(3u, parts.size());
+  for (const auto &part : parts) EXPECT_EQ(200u, ImageReadahead::total_size(part));
+  EXPECT_EQ((std::vector<Extent>{{0, 100}, {200, 100}}), parts[0]);
+  EXPECT_EQ((std::vector<Extent>{{300, 200}}), parts[1]);
+  EXPECT_EQ((std::vector<Extent>{{1000, 200}}), parts[2]);
+
+  EXPECT_TRUE(ImageReadahead::partition({}, 4).empty());
+  EXPECT_EQ(1u, ImageReadahead::partition({{0, 10}}, 1).size());
+}
+
+TEST(ImageReadahead, CountsCachedOverlap) {
+  EXPECT_EQ(100u, ImageReadahead::cached_size({{0, 100}, {200, 100}},
+                                              {{50, 200}}));
+  EXPECT_EQ(0u, ImageReadahead::cached_size({{0, 100}}, {{100, 100}}));
+}
+
+TEST_F(ImageReadaheadTest, ProfileIsOnlyValidForItsImage) {
+  const auto profile = dir / "readahead.profile";
+  const std::vector<Extent> extents{{0, 4096}, {65536, 8192}};
+  ASSERT_TRUE(ImageReadahead::save_profile(profile, image, extents));
+
+  std::vector<Extent> loaded;
+  ASSERT_TRUE(ImageReadahead::load_profile(profile, image, loaded));
+  EXPECT_EQ(extents, loaded);
+
+  std::ofstream(image.string(), std::ofstream::app) << "y";
+  EXPECT_FALSE(ImageReadahead::load_profile(profile, image, loaded));
+  EXPECT_FALSE(ImageReadahead::load_profile(dir / "missing", image, loaded));
+}
+
+TEST_F(ImageReadaheadTest, ReadsExtentsAndReportsCompletion) {
+  // Freshly written data is still in the page cache
+  EXPECT_FALSE(ImageReadahead::cached_extents(image).empty());
+
+  std::promise<void> done;
+  const auto readahead = ImageReadahead::start(image, {{0, 512 * 1024}, {768 * 1024, 4096}}, 2,
+                                               [&]() { done.set_value(); });
+  ASSERT_NE(nullptr, readahead);
+  ASSERT_EQ(std::future_status::ready,
+            done.get_future().wait_for(std::chrono::seconds{5}));
+  readahead->wait();
+  EXPECT_EQ(512u * 1024 + 4096, readahead->bytes_read());
+
+  EXPECT_EQ(nullptr, ImageReadahead::start(dir / "missing", {{0, 10}}));
+}
+}  // namespace common
+}  // namespace anbox
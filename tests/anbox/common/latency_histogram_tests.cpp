@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/common/latency_histogram.h"
+
+using namespace std::chrono;
+
+namespace anbox {
+namespace common {
+TEST(LatencyHistogram, EmptyHistogram) {
+  LatencyHistogram histogram;
+  ASSERT_EQ(0, histogram.count());
+  ASSERT_EQ(microseconds{0}, histogram.max());
+  ASSERT_EQ(microseconds{0}, histogram.percentile(50));
+}
+
+TEST(LatencyHistogram, RecordsSamples) {
+  LatencyHistogram histogram;
+  for (int n = 0; n < 90; n++)
+    histogram.record(microseconds{100});
+  for (int n = 0; n < 10; n++)
+    histogram.record(milliseconds{10});
+
+  ASSERT_EQ(100, histogram.count());
+  ASSERT_EQ(microseconds{10000}, histogram.max());
+  ASSERT_EQ(microseconds{1090}, histogram.mean());
+  // Percentiles are reported as the upper bound of their bucket
+  ASSERT_EQ(microseconds{127}, histogram.percentile(50));
+  ASSERT_EQ(microseconds{127}, histogram.percentile(90));
+  ASSERT_EQ(microseconds{10000}, histogram.percentile(99));
+}
+
+TEST(LatencyHistogram, Reset) {
+  LatencyHistogram histogram;
+  histogram.record(microseconds{42});
+  histogram.reset();
+  ASSERT_EQ(0, histogram.count());
+  ASSERT_EQ(microseconds{0}, histogram.max());
+}
+
+TEST(LatencyHistogram, ProvidesSummary) {
+  LatencyHistogram histogram;
+  histogram.record(microseconds{3});
+  const auto summary = histogram.summary("foo.");
+  ASSERT_EQ(1, summary.at("foo.count"));
+  ASSERT_EQ(3, summary.at("foo.max_us"));
+}
+}  // namespace common
+}  // namespace anbox
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/common/prefix_trie.h"
+
+namespace anbox {
+namespace common {
+TEST(PrefixTrie, FindsLongestPrefix) {
+  PrefixTrie<int> trie;
+  trie.insert("pipe:qemud", 1);
+  trie.insert("pipe:qemud:sensors", 2);
+  trie.insert("pipe:opengles", 3);
+
+  ASSERT_EQ(1, *trie.longest_prefix("pipe:qemud:gsm"));
+  ASSERT_EQ(2, *trie.longest_prefix("pipe:qemud:sensors:arg"));
+  ASSERT_EQ(2, *trie.longest_prefix("pipe:qemud:sensors"));
+  ASSERT_EQ(3, *trie.longest_prefix("pipe:opengles"));
+}
+
+TEST(PrefixTrie, ReturnsNullWithoutMatch) {
+  PrefixTrie<int> trie;
+  trie.insert("pipe:opengles", 1);
+
+  ASSERT_EQ(nullptr, trie.longest_prefix("pipe:open"));
+  ASSERT_EQ(nullptr, trie.longest_prefix("foo"));
+  ASSERT_EQ(nullptr, trie.longest_prefix(""));
+}
+
+TEST(PrefixTrie, EmptyPrefixMatchesEverything) {
+  PrefixTrie<int> trie;
+  trie.insert("", 1);
+  trie.insert("a", 2);
+
+  ASSERT_EQ(1, *trie.longest_prefix("b"));
+  ASSERT_EQ(2, *trie.longest_prefix("abc"));
+}
+
+TEST(PrefixTrie, ReplacesValueOfExistingPrefix) {
+  PrefixTrie<int> trie;
+  trie.insert("abc", 1);
+  trie.insert("abc", 2);
+
+  ASSERT_EQ(2, *trie.longest_prefix("abcd"));
+}
+
+TEST(PrefixTrie, StopsAtGivenSize) {
+  PrefixTrie<int> trie;
+  trie.insert("ab", 1);
+  trie.insert("abcd", 2);
+
+  const char key[] = "abcdef";
+  ASSERT_EQ(1, *trie.longest_prefix(key, 3));
+}
+}  // namespace common
+}  // namespace anbox
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/common/shared_memory_ring.h"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace anbox;
+
+namespace {
+typedef std::function<void(const std::uint8_t*, std::size_t)> Writer;
+typedef std::function<std::size_t(std::uint8_t*, std::size_t)> Reader;
+
+constexpr const std::size_t total = 256 * 1024 * 1024;
+constexpr const std::size_t chunk_size = 64 * 1024;
+
+// Returns the throughput in MB/s when moving total bytes from a producer
+// thread through write to read.
+double measure(const Writer &write, const Reader &read) {
+  const auto start = std::chrono::steady_clock::now();
+  std::thread producer([&]() {
+    std::vector<std::uint8_t> chunk(chunk_size, 0x42);
+    for (std::size_t written = 0; written < total; written += chunk_size)
+      write(chunk.data(), chunk.size());
+  });
+  std::vector<std::uint8_t> buffer(chunk_size);
+  std::size_t received = 0;
+  while (received < total) {
+    const auto count = read(buffer.data(), buffer.size());
+    if (count == 0)
+      break;
+    received += count;
+  }
+  producer.join();
+  const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  return static_cast<double>(received) / duration.count();
+}
+}
+
+// Compares the throughput of the shared memory ring the GL stream can use
+// with the one of the socket it replaces.
+int main() {
+  auto ring = common::SharedMemoryRing::create(4 * 1024 * 1024);
+  const auto fds = ring->fds();
+  auto peer = common::SharedMemoryRing::attach(Fd{::dup(fds[0])}, Fd{::dup(fds[1])},
+                                               Fd{::dup(fds[2])});
+  const auto ring_throughput = measure(
+      [&](const std::uint8_t *data, std::size_t size) { peer->write(data, size); },
+      [&](std::uint8_t *data, std::size_t size) { return ring->read(data, size); });
+
+  int sockets[2];
+  if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) < 0) {
+    std::cerr << "Failed to create socket pair" << std::endl;
+    return 1;
+  }
+  Fd writer{sockets[0]};
+  Fd reader{sockets[1]};
+  const auto socket_throughput = measure(
+      [&](const std::uint8_t *data, std::size_t size) {
+        while (size > 0) {
+          const auto written = ::write(writer, data, size);
+          if (written <= 0)
+            break;
+          data += written;
+          size -= written;
+        }
+      },
+      [&](std::uint8_t *data, std::size_t size) {
+        const auto count = ::read(reader, data, size);
+        return count > 0 ? static_cast<std::size_t>(count) : 0;
+      });
+
+  std::cout << "Transferred " << total / (1024 * 1024) << " MiB: "
+            << ring_throughput << " MB/s through shared memory, "
+            << socket_throughput << " MB/s through a socket" << std::endl;
+  return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/common/shared_memory_ring.h"
+#include "anbox/network/fd_socket_transmission.h"
+
+#include <chrono>
+#include <functional>
+#include <thread>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace anbox {
+namespace common {
+namespace {
+std::shared_ptr<SharedMemoryRing> attach_to(const std::shared_ptr<SharedMemoryRing> &ring) {
+  const auto fds = ring->fds();
+  return SharedMemoryRing::attach(Fd{::dup(fds[0])}, Fd{::dup(fds[1])}, Fd{::dup(fds[2])});
+}
+
+// Writes total bytes in chunks of the given size with a pattern which
+// depends on the position in the stream.
+void produce(const std::function<void(const std::uint8_t*, std::size_t)> &write,
+             std::size_t total, std::size_t chunk_size) {
+  std::vector<std::uint8_t> chunk(chunk_size);
+  for (std::size_t written = 0; written < total; written += chunk_size) {
+    for (std::size_t n = 0; n < chunk_size; n++)
+      chunk[n] = static_cast<std::uint8_t>((written + n) * 7);
+    write(chunk.data(), chunk.size());
+  }
+}
+}  // namespace
+
+TEST(SharedMemoryRing, TransfersDataToAttachedRing) {
+  auto producer_ring = SharedMemoryRing::create(4096);
+  auto consumer_ring = attach_to(producer_ring);
+  ASSERT_EQ(producer_ring->capacity(), consumer_ring->capacity());
+
+  const std::size_t total = 1024 * 1024;
+  std::thread producer([&]() {
+    produce([&](const std::uint8_t *data, std::size_t size) {
+      producer_ring->write(data, size);
+    }, total, 1000);
+  });
+
+  std::vector<std::uint8_t> buffer(3000);
+  std::size_t received = 0;
+  bool in_order = true;
+  while (received < total) {
+    const auto count = consumer_ring->read(buffer.data(), buffer.size());
+    ASSERT_GT(count, 0u);
+    for (std::size_t n = 0; n < count; n++)
+      in_order &= buffer[n] == static_cast<std::uint8_t>((received + n) * 7);
+    received += count;
+  }
+  producer.join();
+
+  ASSERT_TRUE(in_order);
+  ASSERT_EQ(0u, consumer_ring->available());
+}
+
+TEST(SharedMemoryRing, CloseWakesUpBlockedReader) {
+  auto ring = SharedMemoryRing::create(4096);
+  auto peer = attach_to(ring);
+
+  std::thread closer([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    peer->close();
+  });
+
+  std::uint8_t data[16];
+  ASSERT_EQ(0u, ring->read(data, sizeof(data)));
+  ASSERT_TRUE(ring->closed());
+  ASSERT_EQ(0u, ring->write(data, sizeof(data)));
+  closer.join();
+}
+
+TEST(SharedMemoryRing, RejectsCorruptedPositions) {
+  auto ring = SharedMemoryRing::create(4096);
+  std::vector<std::uint8_t> data(ring->capacity());
+  ASSERT_EQ(data.size(), ring->write(data.data(), data.size()));
+
+  // Point the write position far past what the ring can hold the way a
+  // misbehaving peer could.
+  const auto fds = ring->fds();
+  std::uint64_t bogus = ring->capacity() * 3;
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(bogus)), ::pwrite(fds[0], &bogus, sizeof(bogus), 64));
+
+  ASSERT_EQ(0u, ring->read(data.data(), data.size()));
+  ASSERT_TRUE(ring->closed());
+}
+
+TEST(SharedMemoryRing, RefusesInvalidMemory) {
+  auto ring = SharedMemoryRing::create(4096);
+  const auto fds = ring->fds();
+  const std::uint32_t bogus_magic = 0;
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(bogus_magic)), ::pwrite(fds[0], &bogus_magic, sizeof(bogus_magic), 0));
+  ASSERT_THROW(attach_to(ring), std::runtime_error);
+}
+
+TEST(SharedMemoryRing, CanBePassedOverSocket) {
+  int sockets[2];
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+  Fd host_socket{sockets[0]};
+  Fd client_socket{sockets[1]};
+
+  auto host_ring = SharedMemoryRing::create(64 * 1024);
+  send_fds(host_socket, host_ring->fds());
+
+  // This is what a client does after it asked for the shared memory
+  // transport.
+  std::vector<Fd> fds(3);
+  char reply = 0;
+  receive_data(client_socket, &reply, sizeof(reply), fds);
+  auto client_ring = SharedMemoryRing::attach(Fd{fds[0]}, Fd{fds[1]}, Fd{fds[2]});
+
+  const std::string message{"glClear"};
+  ASSERT_EQ(message.size(), client_ring->write(message.data(), message.size()));
+
+  std::vector<char> buffer(64);
+  ASSERT_EQ(message.size(), host_ring->read(buffer.data(), buffer.size()));
+  ASSERT_EQ(message, std::string(buffer.data(), message.size()));
+}
+}  // namespace common
+}  // namespace anbox
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/common/tracer.h"
+
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace anbox {
+namespace common {
+namespace {
+std::size_t count_of(const std::string &text, const std::string &what) {
+  std::size_t count = 0;
+  for (auto pos = text.find(what); pos != std::string::npos; pos = text.find(what, pos + 1))
+    count++;
+  return count;
+}
+}  // namespace
+
+TEST(Tracer, RecordsNothingWhenInactive) {
+  std::ostringstream discard;
+  Tracer::get()->stop(discard);
+  { ANBOX_TRACE_SCOPE("test", "inactive"); }
+
+  Tracer::get()->start();
+  std::ostringstream out;
+  Tracer::get()->stop(out);
+  EXPECT_EQ(0u, count_of(out.str(), "inactive"));
+}
+
+TEST(Tracer, ExportsScopesOfAllThreads) {
+  Tracer::get()->start();
+  {
+    ANBOX_TRACE_SCOPE("test", "main_scope");
+    std::thread([]() {
+      ANBOX_TRACE_SCOPE("test", "thread_scope");
+      std::this_thread::sleep_for(std::chrono::milliseconds{2});
+    }).join();
+  }
+  std::ostringstream out;
+  Tracer::get()->stop(out);
+
+  const auto json = out.str();
+  EXPECT_EQ(0u, json.find("{\"traceEvents\":["));
+  EXPECT_EQ(1u, count_of(json, "\"name\":\"main_scope\",\"cat\":\"test\",\"ph\":\"X\""));
+  EXPECT_EQ(1u, count_of(json, "\"name\":\"thread_scope\""));
+  EXPECT_EQ(2u, count_of(json, "\"name\":\"thread_name\""));
+  EXPECT_NE(std::string::npos, json.find("\"displayTimeUnit\":\"ms\"}"));
+}
+
+TEST(Tracer, KeepsMostRecentEvents) {
+  Tracer::get()->start();
+  { ANBOX_TRACE_SCOPE("test", "oldest"); }
+  for (std::size_t n = 0; n < Tracer::events_per_thread; n++) {
+    ANBOX_TRACE_SCOPE("test", "newer");
+  }
+  std::ostringstream out;
+  Tracer::get()->stop(out);
+
+  EXPECT_EQ(0u, count_of(out.str(), "\"oldest\""));
+  EXPECT_EQ(Tracer::events_per_thread, count_of(out.str(), "\"newer\""));
+}
+
+TEST(Tracer, RestartsWhileThreadsRecord) {
+  std::atomic<bool> running{true};
+  std::vector<std::thread> threads;
+  for (int n = 0; n < 4; n++) {
+    threads.push_back(std::thread([&]() {
+      while (running) {
+        ANBOX_TRACE_SCOPE("test", "busy");
+      }
+    }));
+  }
+
+  // Long enough for the rings to wrap around.
+  for (int n = 0; n < 20; n++) {
+    Tracer::get()->start();
+    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    std::ostringstream out;
+    Tracer::get()->stop(out);
+
+    const auto json = out.str();
+    EXPECT_EQ(0u, json.find("{\"traceEvents\":["));
+    EXPECT_EQ(json.size() - 26, json.find("],\"displayTimeUnit\":\"ms\"}\n"));
+    EXPECT_LE(count_of(json, "\"busy\""), 4 * Tracer::events_per_thread);
+  }
+
+  running = false;
+  for (auto &thread : threads)
+    thread.join();
+}
+}  // namespace common
+}  // namespace anbox
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/container/instance_registry.h"
+
+#include <gtest/gtest.h>
+
+using namespace anbox::container;
+
+namespace {
+class FakeContainer : public Container {
+ public:
+  explicit FakeContainer(std::uint64_t memory) { usage_.memory_bytes = memory; }
+
+  void start(const Configuration &) override {}
+  void stop() override {}
+  State state() override { return State::running; }
+  ResourceUsage resource_usage() override { return usage_; }
+
+ private:
+  ResourceUsage usage_;
+};
+}  // namespace
+
+TEST(InstanceRegistry, LimitsNumberOfInstances) {
+  auto first = std::make_shared<FakeContainer>(1);
+  auto second = std::make_shared<FakeContainer>(2);
+
+  InstanceRegistry registry(1);
+  ASSERT_TRUE(registry.add("first", first));
+  ASSERT_FALSE(registry.add("second", second));
+  ASSERT_EQ(1, registry.size());
+
+  registry.remove("first");
+  ASSERT_TRUE(registry.add("second", second));
+}
+
+TEST(InstanceRegistry, RejectsDuplicateInstances) {
+  auto first = std::make_shared<FakeContainer>(1);
+  auto second = std::make_shared<FakeContainer>(2);
+
+  InstanceRegistry registry(4);
+  ASSERT_TRUE(registry.add("default", first));
+  ASSERT_FALSE(registry.add("default", second));
+  ASSERT_EQ(1, registry.size());
+}
+
+TEST(InstanceRegistry, ReportsUsageOfLiveInstances) {
+  auto first = std::make_shared<FakeContainer>(1024);
+  auto second = std::make_shared<FakeContainer>(2048);
+
+  InstanceRegistry registry(4);
+  ASSERT_TRUE(registry.add("first", first));
+  ASSERT_TRUE(registry.add("second", second));
+
+  second.reset();
+
+  const auto usage = registry.resource_usage();
+  ASSERT_EQ(1, usage.size());
+  ASSERT_EQ(1024, usage.at("first").memory_bytes);
+}
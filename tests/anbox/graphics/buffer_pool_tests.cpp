@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/graphics/buffer_pool.h"
+#include "anbox/graphics/buffer_statistics.h"
+
+#include <memory>
+
+namespace anbox {
+namespace graphics {
+using Pool = BufferPool<std::shared_ptr<int>>;
+
+TEST(BufferPool, ReusesBuffersWithMatchingKey) {
+  Pool pool(100);
+  const Pool::Key key{64, 64, 1};
+  auto buffer = std::make_shared<int>(1);
+
+  EXPECT_EQ(0u, pool.release(key, buffer, 10));
+  EXPECT_EQ(1u, pool.count());
+  EXPECT_EQ(10u, pool.size());
+
+  std::shared_ptr<int> other;
+  EXPECT_FALSE(pool.acquire(Pool::Key{64, 64, 2}, other));
+  EXPECT_FALSE(pool.acquire(Pool::Key{32, 64, 1}, other));
+
+  std::shared_ptr<int> reused;
+  ASSERT_TRUE(pool.acquire(key, reused));
+  EXPECT_EQ(buffer, reused);
+  EXPECT_EQ(0u, pool.count());
+  EXPECT_EQ(0u, pool.size());
+  EXPECT_FALSE(pool.acquire(key, reused));
+}
+
+TEST(BufferPool, EvictsOldestBuffersOverBudget) {
+  Pool pool(100);
+  const Pool::Key key{64, 64, 1};
+  auto first = std::make_shared<int>(1);
+  auto second = std::make_shared<int>(2);
+  auto third = std::make_shared<int>(3);
+
+  EXPECT_EQ(0u, pool.release(key, first, 40));
+  EXPECT_EQ(0u, pool.release(key, second, 40));
+  EXPECT_EQ(1u, pool.release(key, third, 40));
+  EXPECT_EQ(2u, pool.count());
+  EXPECT_EQ(80u, pool.size());
+  // Only the pool held on to the evicted buffer
+  EXPECT_EQ(1, first.use_count());
+
+  // Buffers which would never fit aren't taken at all
+  EXPECT_EQ(1u, pool.release(key, std::make_shared<int>(4), 101));
+  EXPECT_EQ(2u, pool.count());
+
+  // Most recently released first
+  std::shared_ptr<int> reused;
+  ASSERT_TRUE(pool.acquire(key, reused));
+  EXPECT_EQ(third, reused);
+
+  pool.clear();
+  EXPECT_EQ(0u, pool.count());
+  EXPECT_EQ(0u, pool.size());
+}
+
+TEST(BufferStatistics, SeparatesLiveAndPooledBuffers) {
+  BufferStatistics statistics;
+  statistics.buffer_created(100);
+  statistics.buffer_created(200);
+  statistics.buffer_grown(50);
+  statistics.set_pooled(1, 100);
+  statistics.pool_hit();
+  statistics.pool_miss();
+  statistics.pool_evicted(2);
+
+  auto summary = statistics.summary();
+  EXPECT_EQ(1u, summary["live_buffers"]);
+  EXPECT_EQ(250u, summary["live_bytes"]);
+  EXPECT_EQ(1u, summary["pooled_buffers"]);
+  EXPECT_EQ(100u, summary["pooled_bytes"]);
+  EXPECT_EQ(1u, summary["pool_hits"]);
+  EXPECT_EQ(1u, summary["pool_misses"]);
+  EXPECT_EQ(2u, summary["pool_evictions"]);
+
+  statistics.buffer_destroyed(100);
+  statistics.set_pooled(0, 0);
+  EXPECT_EQ(1u, statistics.summary()["live_buffers"]);
+  EXPECT_EQ(250u, statistics.summary()["live_bytes"]);
+}
+}  // namespace graphics
+}  // namespace anbox
@@ -18,6 +18,7 @@
 #include "anbox/graphics/buffered_io_stream.h"
 
 #include <chrono>
+#include <cstring>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -33,10 +34,13 @@ class MockSocketMessenger :
   MOCK_CONST_METHOD0(local_port, unsigned short());
   MOCK_METHOD0(set_no_delay, void());
   MOCK_METHOD0(close, void());
+  MOCK_METHOD1(send_fds, void(std::vector<anbox::Fd> const&));
+  MOCK_CONST_METHOD0(native_handle, int());
 
   // anbox::network::MessageSender
   MOCK_METHOD2(send, void(char const*, size_t));
   MOCK_METHOD2(send_raw, ssize_t(char const*, size_t));
+  MOCK_METHOD2(send_vectored, void(struct iovec const*, size_t));
 
   // anbox::network::MessageReceiver
   MOCK_METHOD2(async_receive_msg, void(AnboxReadHandler const&, boost::asio::mutable_buffers_1 const&));
@@ -141,5 +145,25 @@ TEST(BufferedIOStream, ReadWithNoDataAvailable) {
   stopped = true;
   producer.join();
 }
+
+TEST(BufferedIOStream, ReadsFromSharedMemoryRing) {
+  auto messenger = std::make_shared<MockSocketMessenger>();
+  auto ring = common::SharedMemoryRing::create(4096);
+  BufferedIOStream stream(messenger, BufferedIOStream::default_buffer_size, ring);
+
+  const std::uint8_t data[] = {0x12, 0x34, 0x56};
+  ASSERT_EQ(sizeof(data), ring->write(data, sizeof(data)));
+
+  std::uint8_t read_data[10] = {0x0};
+  size_t size = sizeof(read_data);
+  EXPECT_NE(nullptr, stream.read(read_data, &size));
+  EXPECT_EQ(sizeof(data), size);
+  EXPECT_EQ(0, std::memcmp(data, read_data, sizeof(data)));
+
+  // Stopping the stream closes the ring and wakes up any reader.
+  stream.forceStop();
+  size = sizeof(read_data);
+  EXPECT_EQ(nullptr, stream.read(read_data, &size));
+}
 } // namespace graphics
 } // namespace anbox
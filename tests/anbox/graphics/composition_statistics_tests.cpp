@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/graphics/composition_statistics.h"
+
+namespace anbox {
+namespace graphics {
+TEST(CompositionStatistics, CountsComposedAndSkippedFrames) {
+  CompositionStatistics statistics;
+  const auto now = CompositionStatistics::Clock::now();
+
+  statistics.frame_composed(1, now);
+  statistics.frame_composed(1, now);
+  statistics.frame_skipped(1, now);
+  statistics.frame_skipped(2, now);
+  statistics.frame_throttled(std::chrono::milliseconds{20});
+
+  auto summary = statistics.summary(now);
+  EXPECT_EQ(2u, summary["task.1.composed"]);
+  EXPECT_EQ(1u, summary["task.1.skipped"]);
+  EXPECT_EQ(0u, summary["task.2.composed"]);
+  EXPECT_EQ(1u, summary["task.2.skipped"]);
+  EXPECT_EQ(1u, summary["throttled_frames"]);
+  EXPECT_EQ(20u, summary["throttled_ms"]);
+}
+
+TEST(CompositionStatistics, CountsContextSwitches) {
+  CompositionStatistics statistics;
+
+  statistics.context_switches(2, 0);
+  statistics.context_switches(4, 3);
+
+  auto summary = statistics.summary();
+  EXPECT_EQ(2u, summary["composition_passes"]);
+  EXPECT_EQ(6u, summary["make_current_calls"]);
+  EXPECT_EQ(3u, summary["make_current_skipped"]);
+  EXPECT_EQ(4u, summary["make_current_max_per_pass"]);
+}
+
+TEST(CompositionStatistics, MeasuresComposeRate) {
+  CompositionStatistics statistics;
+  const auto start = CompositionStatistics::Clock::now();
+
+  // 30 frames per second for two seconds
+  for (auto n = 0; n <= 60; n++)
+    statistics.frame_composed(1, start + std::chrono::milliseconds{n * 1000 / 30});
+  const auto end = start + std::chrono::seconds{2};
+  EXPECT_NEAR(30.0, statistics.compose_rate(1, end), 1.0);
+  EXPECT_EQ(30u, statistics.summary(end)["task.1.fps"]);
+
+  // Once the window isn't composed anymore the rate drops
+  EXPECT_NEAR(0.0, statistics.compose_rate(1, end + std::chrono::seconds{10}), 1.0);
+  EXPECT_EQ(0.0, statistics.compose_rate(2, end));
+}
+}  // namespace graphics
+}  // namespace anbox
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/application/database.h"
+#include "anbox/platform/default_policy.h"
+#include "anbox/wm/multi_window_manager.h"
+#include "anbox/wm/window_state.h"
+
+#include "anbox/graphics/layer_composer.h"
+#include "anbox/graphics/multi_window_composer_strategy.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace anbox;
+
+namespace {
+class NullRenderer : public graphics::Renderer {
+ public:
+  bool draw(EGLNativeWindowType, const graphics::Rect&, const RenderableList&) override {
+    return true;
+  }
+};
+}
+
+// Measures how long the layer composer takes to assign the layers of a
+// frame to their windows, without any rendering.
+int main() {
+  auto renderer = std::make_shared<NullRenderer>();
+
+  auto platform_policy = std::make_shared<platform::DefaultPolicy>();
+  auto app_db = std::make_shared<application::Database>();
+  auto wm = std::make_shared<wm::MultiWindowManager>(platform_policy, nullptr, app_db);
+
+  const auto num_windows = 8;
+  const auto layers_per_window = 3;
+  const auto num_frames = 20000;
+
+  wm::WindowState::List windows;
+  for (auto n = 1; n <= num_windows; n++) {
+    windows.push_back(wm::WindowState{
+        wm::Display::Id{1},
+        true,
+        graphics::Rect{n * 10, n * 10, n * 10 + 1024, n * 10 + 768},
+        "org.anbox.test",
+        wm::Task::Id{n},
+        wm::Stack::Id::Freeform,
+    });
+  }
+  wm->apply_window_state_update(windows, {});
+
+  graphics::LayerComposer composer(renderer, std::make_shared<graphics::MultiWindowComposerStrategy>(wm));
+
+  RenderableList renderables;
+  for (auto n = 1; n <= num_windows; n++) {
+    const auto name = "org.anbox.surface." + std::to_string(n);
+    for (auto l = 0; l < layers_per_window; l++)
+      renderables.push_back({name.c_str(), static_cast<std::uint32_t>(n * 10 + l),
+                             {n * 10, n * 10, n * 10 + 1024, n * 10 + 768},
+                             {0, 0, 1024, 768}});
+  }
+  renderables.push_back({"Sprite", 1000, {0, 0, 32, 32}, {0, 0, 32, 32}});
+  renderables.push_back({"com.android.systemui.ImageWallpaper", 1001,
+                         {0, 0, 1920, 1080}, {0, 0, 1920, 1080}});
+
+  const auto start = std::chrono::steady_clock::now();
+  for (auto n = 0; n < num_frames; n++)
+    composer.submit_layers(renderables);
+  const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start);
+
+  std::cout << "Composed " << num_frames << " frames with " << renderables.size()
+            << " layers each, " << duration.count() / num_frames << " ns per frame"
+            << std::endl;
+  return 0;
+}
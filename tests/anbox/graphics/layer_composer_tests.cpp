@@ -25,9 +25,13 @@
 #include "anbox/wm/multi_window_manager.h"
 #include "anbox/wm/window_state.h"
 
+#include "anbox/graphics/composition_statistics.h"
 #include "anbox/graphics/layer_composer.h"
 #include "anbox/graphics/multi_window_composer_strategy.h"
 
+#include <chrono>
+#include <vector>
+
 using namespace ::testing;
 
 namespace {
@@ -35,6 +39,8 @@ class MockRenderer : public anbox::graphics::Renderer {
  public:
   MOCK_METHOD3(draw, bool(EGLNativeWindowType, const anbox::graphics::Rect&,
                           const RenderableList&));
+  MOCK_METHOD0(begin_composition, void());
+  MOCK_METHOD0(end_composition, void());
 };
 }
 
@@ -227,5 +233,134 @@ TEST(LayerComposer, PopupShouldNotCauseWindowLayerOffset) {
   composer.submit_layers(renderables);
 }
 
+TEST(LayerComposer, SkipsAndThrottlesInvisibleWindows) {
+  auto renderer = std::make_shared<MockRenderer>();
+
+  auto platform_policy = std::make_shared<platform::DefaultPolicy>();
+  auto app_db = std::make_shared<application::Database>();
+  auto wm = std::make_shared<wm::MultiWindowManager>(platform_policy, nullptr, app_db);
+
+  auto window = wm::WindowState{
+      wm::Display::Id{1},
+      true,
+      graphics::Rect{0, 0, 1024, 768},
+      "org.anbox.foo",
+      wm::Task::Id{3},
+      wm::Stack::Id::Freeform,
+  };
+  wm->apply_window_state_update({window}, {});
+  wm->find_window_for_task(3)->set_visible(false);
+
+  const auto interval = std::chrono::milliseconds{50};
+  LayerComposer composer(renderer, std::make_shared<MultiWindowComposerStrategy>(wm), interval);
+
+  RenderableList renderables = {
+      {"org.anbox.surface.3", 0, {0, 0, 1024, 768}, {0, 0, 1024, 768}},
+  };
+
+  EXPECT_CALL(*renderer, draw(_, _, _)).Times(0);
+
+  const auto skipped_before = CompositionStatistics::get()->summary()["task.3.skipped"];
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::chrono::steady_clock::time_point> hold_back_until;
+  for (auto n = 0; n < 3; n++)
+    hold_back_until.push_back(composer.submit_layers(renderables));
+
+  // The composer never waits itself. The first frame goes through right
+  // away, the following ones are held back one interval each.
+  EXPECT_LT(std::chrono::steady_clock::now() - start, interval);
+  EXPECT_LE(hold_back_until[0], std::chrono::steady_clock::now());
+  EXPECT_EQ(interval, hold_back_until[1] - hold_back_until[0]);
+  EXPECT_EQ(interval, hold_back_until[2] - hold_back_until[1]);
+  EXPECT_EQ(skipped_before + 3, CompositionStatistics::get()->summary()["task.3.skipped"]);
+
+  Mock::VerifyAndClearExpectations(renderer.get());
+  wm->find_window_for_task(3)->set_visible(true);
+  EXPECT_CALL(*renderer, draw(_, _, _)).Times(1).WillOnce(Return(true));
+  const auto visible_hold_back_until = composer.submit_layers(renderables);
+  EXPECT_LE(visible_hold_back_until, std::chrono::steady_clock::now());
+}
+
+TEST(LayerComposer, ComposesAllWindowsInOnePass) {
+  auto renderer = std::make_shared<MockRenderer>();
+
+  auto platform_policy = std::make_shared<platform::DefaultPolicy>();
+  auto app_db = std::make_shared<application::Database>();
+  auto wm = std::make_shared<wm::MultiWindowManager>(platform_policy, nullptr, app_db);
+
+  wm::WindowState::List windows;
+  for (auto n = 1; n <= 3; n++) {
+    windows.push_back(wm::WindowState{
+        wm::Display::Id{1},
+        true,
+        graphics::Rect{n * 10, n * 10, n * 10 + 100, n * 10 + 100},
+        "org.anbox.foo",
+        wm::Task::Id{n},
+        wm::Stack::Id::Freeform,
+    });
+  }
+  wm->apply_window_state_update(windows, {});
+
+  LayerComposer composer(renderer, std::make_shared<MultiWindowComposerStrategy>(wm),
+                         std::chrono::milliseconds{1});
+
+  RenderableList renderables;
+  for (auto n = 1; n <= 3; n++) {
+    const auto name = "org.anbox.surface." + std::to_string(n);
+    renderables.push_back({name.c_str(), static_cast<std::uint32_t>(n),
+                           {n * 10, n * 10, n * 10 + 100, n * 10 + 100},
+                           {0, 0, 100, 100}});
+  }
+
+  {
+    InSequence s;
+    EXPECT_CALL(*renderer, begin_composition()).Times(1);
+    EXPECT_CALL(*renderer, draw(_, _, _)).Times(3).WillRepeatedly(Return(true));
+    EXPECT_CALL(*renderer, end_composition()).Times(1);
+  }
+  composer.submit_layers(renderables);
+  Mock::VerifyAndClearExpectations(renderer.get());
+
+  // Without anything to draw there is no pass at all
+  for (auto n = 1; n <= 3; n++)
+    wm->find_window_for_task(n)->set_visible(false);
+  EXPECT_CALL(*renderer, begin_composition()).Times(0);
+  EXPECT_CALL(*renderer, end_composition()).Times(0);
+  composer.submit_layers(renderables);
+}
+
+TEST(LayerComposer, ClearsWindowsWhoseLayersAreGone) {
+  auto renderer = std::make_shared<MockRenderer>();
+
+  auto platform_policy = std::make_shared<platform::DefaultPolicy>();
+  auto app_db = std::make_shared<application::Database>();
+  auto wm = std::make_shared<wm::MultiWindowManager>(platform_policy, nullptr, app_db);
+
+  auto window = wm::WindowState{
+      wm::Display::Id{1},
+      true,
+      graphics::Rect{0, 0, 1024, 768},
+      "org.anbox.foo",
+      wm::Task::Id{1},
+      wm::Stack::Id::Freeform,
+  };
+  wm->apply_window_state_update({window}, {});
+
+  LayerComposer composer(renderer, std::make_shared<MultiWindowComposerStrategy>(wm));
+
+  RenderableList renderables = {
+      {"org.anbox.surface.1", 0, {0, 0, 1024, 768}, {0, 0, 1024, 768}},
+  };
+
+  {
+    InSequence s;
+    EXPECT_CALL(*renderer, draw(_, _, renderables)).Times(1).WillOnce(Return(true));
+    EXPECT_CALL(*renderer, draw(_, _, RenderableList{})).Times(1).WillOnce(Return(true));
+  }
+  composer.submit_layers(renderables);
+  // The last layer of the window is gone, it's cleared once
+  composer.submit_layers({});
+  composer.submit_layers({});
+}
 }  // namespace graphics
 }  // namespace anbox
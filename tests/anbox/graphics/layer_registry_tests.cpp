@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/graphics/layer_registry.h"
+
+#include <string>
+
+namespace anbox {
+namespace graphics {
+TEST(LayerRegistry, InternsNamesOnlyOnce) {
+  LayerRegistry registry;
+
+  const auto first = registry.intern("org.anbox.surface.1");
+  const auto second = registry.intern("org.anbox.surface.1");
+
+  ASSERT_EQ(first.id, second.id);
+  ASSERT_EQ(1, registry.size());
+  ASSERT_EQ("org.anbox.surface.1", registry.name_of(first.id));
+}
+
+TEST(LayerRegistry, ResolvesTaskIds) {
+  LayerRegistry registry;
+
+  ASSERT_EQ(42, registry.intern("org.anbox.surface.42").task);
+  ASSERT_EQ(0, registry.intern("org.anbox.surface.").task);
+  ASSERT_EQ(0, registry.intern("org.anbox.surface.0").task);
+  ASSERT_EQ(0, registry.intern("com.android.systemui").task);
+}
+
+TEST(LayerRegistry, MarksBlacklistedLayers) {
+  LayerRegistry registry;
+
+  ASSERT_TRUE(registry.intern("Sprite").blacklisted);
+  ASSERT_FALSE(registry.intern("Sprite2").blacklisted);
+  ASSERT_FALSE(registry.intern("org.anbox.surface.1").blacklisted);
+}
+
+TEST(LayerRegistry, KeepsIdsStableWhileGrowing) {
+  LayerRegistry registry;
+
+  for (int n = 0; n < 1000; n++) {
+    const auto name = "layer." + std::to_string(n);
+    ASSERT_EQ(n, registry.intern(name.c_str()).id);
+  }
+
+  for (int n = 0; n < 1000; n++) {
+    const auto name = "layer." + std::to_string(n);
+    ASSERT_EQ(n, registry.intern(name.c_str()).id);
+    ASSERT_EQ(name, registry.name_of(n));
+  }
+
+  ASSERT_EQ(1000, registry.size());
+}
+
+TEST(LayerRegistry, EvictsNamesWhichAreGone) {
+  LayerRegistry registry(4);
+
+  for (int n = 0; n < 4; n++)
+    registry.intern(("layer." + std::to_string(n)).c_str());
+  ASSERT_EQ(4, registry.size());
+
+  // Only the first two layers are still posted when the next ones show up
+  registry.intern("layer.0");
+  registry.intern("layer.1");
+  const auto layer_4 = registry.intern("layer.4");
+  const auto layer_5 = registry.intern("layer.5");
+
+  ASSERT_EQ(4, registry.size());
+  ASSERT_EQ(0, registry.intern("layer.0").id);
+  ASSERT_EQ(1, registry.intern("layer.1").id);
+  ASSERT_EQ("", registry.name_of(2));
+  ASSERT_EQ("", registry.name_of(3));
+  // Renderables may still hold the ids of the layers which are gone, so
+  // they are never used again
+  ASSERT_EQ(4, layer_4.id);
+  ASSERT_EQ(5, layer_5.id);
+  ASSERT_EQ("layer.4", registry.name_of(layer_4.id));
+  ASSERT_EQ("layer.5", registry.name_of(layer_5.id));
+
+  // A layer which comes back gets a new id as well
+  const auto layer_2 = registry.intern("layer.2");
+  ASSERT_EQ(6, layer_2.id);
+  ASSERT_EQ("layer.2", registry.name_of(layer_2.id));
+}
+
+TEST(LayerRegistry, StaysBoundedWithChangingNames) {
+  LayerRegistry registry(16);
+
+  // Every frame posts one layer with a new name, e.g. a new task
+  for (int n = 0; n < 10000; n++) {
+    registry.intern("com.android.systemui");
+    registry.intern(("org.anbox.surface." + std::to_string(n)).c_str());
+  }
+
+  ASSERT_LE(registry.size(), 16);
+  ASSERT_EQ("com.android.systemui", registry.name_of(registry.intern("com.android.systemui").id));
+}
+}  // namespace graphics
+}  // namespace anbox
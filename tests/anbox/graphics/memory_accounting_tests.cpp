@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/graphics/memory_accounting.h"
+
+namespace anbox {
+namespace graphics {
+TEST(MemoryAccounting, RejectsAllocationsBeyondHardBudget) {
+  MemoryAccounting accounting;
+  accounting.set_budget({0, 100});
+
+  const auto client = accounting.register_client();
+  EXPECT_TRUE(accounting.charge(client, 60));
+  EXPECT_FALSE(accounting.charge(client, 60));
+  EXPECT_EQ(60u, accounting.usage(client));
+
+  // The host itself is never limited
+  EXPECT_TRUE(accounting.charge(MemoryAccounting::host, 1000));
+
+  // Restoring evicted memory can't be refused
+  accounting.force_charge(client, 60);
+  EXPECT_EQ(120u, accounting.usage(client));
+
+  accounting.credit(client, 120);
+  EXPECT_TRUE(accounting.charge(client, 60));
+
+  const auto summary = accounting.summary();
+  EXPECT_EQ(1u, summary.at("rejected_allocations"));
+  EXPECT_EQ(1u, summary.at("client.1.rejected"));
+  EXPECT_EQ(120u, summary.at("client.1.peak_bytes"));
+  EXPECT_EQ(1060u, summary.at("total_bytes"));
+}
+
+TEST(MemoryAccounting, TracksSoftBudgetPerClient) {
+  MemoryAccounting accounting;
+  accounting.set_budget({100, 0});
+
+  const auto first = accounting.register_client();
+  const auto second = accounting.register_client();
+  EXPECT_TRUE(accounting.charge(first, 150));
+  EXPECT_TRUE(accounting.charge(second, 50));
+  EXPECT_TRUE(accounting.over_soft_budget(first));
+  EXPECT_FALSE(accounting.over_soft_budget(second));
+
+  accounting.credit(first, 50);
+  EXPECT_FALSE(accounting.over_soft_budget(first));
+}
+
+TEST(MemoryAccounting, KeepsClientsUntilTheirMemoryIsReleased) {
+  MemoryAccounting accounting;
+
+  const auto client = accounting.register_client();
+  accounting.charge(client, 10);
+  accounting.unregister_client(client);
+  EXPECT_EQ(10u, accounting.usage(client));
+  EXPECT_EQ(1u, accounting.summary().count("client.1.bytes"));
+
+  accounting.credit(client, 10);
+  EXPECT_EQ(0u, accounting.summary().count("client.1.bytes"));
+}
+}  // namespace graphics
+}  // namespace anbox
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/graphics/render_scale.h"
+
+#include <vector>
+
+namespace anbox {
+namespace graphics {
+TEST(RenderScale, RejectsScalesOutOfRange) {
+  RenderScale scale;
+  EXPECT_FALSE(scale.set(0.0f));
+  EXPECT_FALSE(scale.set(1.5f));
+  EXPECT_FALSE(scale.set(RenderScale::min_scale / 2.0f));
+  EXPECT_EQ(RenderScale::max_scale, scale.value());
+
+  EXPECT_TRUE(scale.set(0.5f));
+  EXPECT_EQ(0.5f, scale.value());
+}
+
+TEST(RenderScale, ScalesDisplaySizeAndDensity) {
+  RenderScale scale;
+  const Rect display{0, 0, 1920, 1080};
+  EXPECT_EQ(display, scale.guest_display_size(display));
+  EXPECT_EQ(160, scale.guest_density(160));
+
+  scale.set(0.5f);
+  EXPECT_EQ((Rect{0, 0, 960, 540}), scale.guest_display_size(display));
+  EXPECT_EQ(80, scale.guest_density(160));
+
+  // Sizes are kept even
+  scale.set(0.7f);
+  EXPECT_EQ((Rect{0, 0, 1344, 756}), scale.guest_display_size(display));
+  EXPECT_EQ(0, scale.guest_display_size({0, 0, 1023, 767}).width() % 2);
+}
+
+TEST(RenderScale, ConvertsBetweenHostAndGuestCoordinates) {
+  RenderScale scale;
+  const Rect display{0, 0, 1920, 1080};
+  const Rect window{100, 50, 1100, 850};
+  EXPECT_EQ(window, scale.to_guest(window, display));
+  EXPECT_EQ(window, scale.to_host(window, display));
+
+  scale.set(0.5f);
+  EXPECT_EQ((Rect{50, 25, 550, 425}), scale.to_guest(window, display));
+  EXPECT_EQ(window, scale.to_host(scale.to_guest(window, display), display));
+  EXPECT_EQ(Rect::Invalid, scale.to_guest(Rect::Invalid, display));
+
+  // The guest display is rounded to an even size so the whole display
+  // still maps to the whole display
+  scale.set(0.7f);
+  EXPECT_EQ(scale.guest_display_size(display), scale.to_guest(display, display));
+  EXPECT_EQ(display, scale.to_host(scale.guest_display_size(display), display));
+}
+
+TEST(RenderScale, NotifiesAboutChanges) {
+  RenderScale scale;
+  std::vector<float> changes;
+  scale.register_change_handler([&](float value) { changes.push_back(value); });
+
+  scale.set(0.5f);
+  scale.set(0.5f);
+  scale.set(2.0f);
+  scale.set(1.0f);
+
+  ASSERT_EQ(2u, changes.size());
+  EXPECT_EQ(0.5f, changes[0]);
+  EXPECT_EQ(1.0f, changes[1]);
+}
+}  // namespace graphics
+}  // namespace anbox
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/graphics/emugl/RenderApi.h"
+#include "anbox/graphics/emugl/RenderThread.h"
+#include "anbox/graphics/emugl/Renderer.h"
+
+#include <dirent.h>
+
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+namespace anbox {
+namespace graphics {
+namespace {
+bool initialize_gl() {
+  // Runs without any display server through Mesa
+  setenv("EGL_PLATFORM", "surfaceless", 0);
+  return emugl::initialize(emugl::default_gl_libraries(), nullptr, nullptr);
+}
+
+// A client which goes away right after it connected.
+class ShortLivedStream : public IOStream {
+ public:
+  ShortLivedStream() : IOStream(0) {}
+
+  void *allocBuffer(size_t) override { return nullptr; }
+  size_t commitBuffer(size_t) override { return 0; }
+  void forceStop() override {}
+
+  const unsigned char *read(void*, size_t*) override {
+    std::lock_guard<std::mutex> l(lock_);
+    read_ = true;
+    cond_.notify_all();
+    return nullptr;
+  }
+
+  void wait_for_first_read() {
+    std::unique_lock<std::mutex> l(lock_);
+    cond_.wait(l, [&] { return read_; });
+  }
+
+ private:
+  std::mutex lock_;
+  std::condition_variable cond_;
+  bool read_ = false;
+};
+
+std::size_t thread_count() {
+  std::size_t count = 0;
+  if (auto dir = opendir("/proc/self/task")) {
+    while (auto entry = readdir(dir))
+      if (entry->d_name[0] != '.') count++;
+    closedir(dir);
+  }
+  return count;
+}
+
+struct Connections {
+  std::uint64_t threads_created = 0;
+  std::uint64_t threads_reused = 0;
+};
+
+// Serves |count| clients one after another, |parallel| at a time, the way
+// Android opens a connection whenever a process sets up EGL.
+Connections connect_clients(const std::shared_ptr<::Renderer> &renderer,
+                            std::size_t max_idle_threads, int count, int parallel) {
+  ::emugl::Mutex lock;
+  auto pool = std::make_shared<RenderThreadPool>(max_idle_threads);
+
+  Connections connections;
+  for (int n = 0; n < count; n += parallel) {
+    std::vector<std::unique_ptr<ShortLivedStream>> streams;
+    std::vector<std::shared_ptr<RenderThread>> threads;
+    for (int m = 0; m < parallel; m++) {
+      streams.emplace_back(new ShortLivedStream);
+      threads.push_back(pool->acquire(renderer, streams.back().get(), &lock));
+      if (!threads.back())
+        return connections;
+      streams.back()->wait_for_first_read();
+    }
+  }
+
+  connections.threads_created = pool->threadsCreated();
+  connections.threads_reused = pool->threadsReused();
+  return connections;
+}
+}  // namespace
+
+TEST(RenderThreadPool, ReusesThreadsOfShortLivedClients) {
+  if (!initialize_gl())
+    GTEST_SKIP() << "No EGL implementation available";
+
+  auto renderer = std::make_shared<::Renderer>();
+  ASSERT_TRUE(renderer->initialize(EGL_DEFAULT_DISPLAY, true));
+
+  const int count = 200, parallel = 4;
+  const auto threads_before = thread_count();
+  const auto unpooled = connect_clients(renderer, 0, count, parallel);
+  const auto pooled = connect_clients(renderer, RenderThreadPool::default_max_idle_threads,
+                                      count, parallel);
+  renderer->finalize();
+
+  EXPECT_EQ(static_cast<std::uint64_t>(count), unpooled.threads_created);
+  EXPECT_EQ(static_cast<std::uint64_t>(parallel), pooled.threads_created);
+  EXPECT_EQ(static_cast<std::uint64_t>(count - parallel), pooled.threads_reused);
+  // Idle threads of the pool are gone with it
+  EXPECT_EQ(threads_before, thread_count());
+}
+}  // namespace graphics
+}  // namespace anbox
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/graphics/buffer_statistics.h"
+#include "anbox/graphics/emugl/DispatchTables.h"
+#include "anbox/graphics/emugl/RenderApi.h"
+#include "anbox/graphics/emugl/RenderThreadInfo.h"
+#include "anbox/graphics/emugl/Renderer.h"
+#include "anbox/graphics/frame_sink.h"
+#include "anbox/graphics/memory_accounting.h"
+
+#include <cstdlib>
+#include <vector>
+
+namespace anbox {
+namespace graphics {
+namespace {
+bool initialize_gl() {
+  // Runs without any display server through Mesa
+  setenv("EGL_PLATFORM", "surfaceless", 0);
+  return emugl::initialize(emugl::default_gl_libraries(), nullptr, nullptr);
+}
+
+class FrameCounter : public FrameSink {
+ public:
+  std::uint8_t* begin_frame(std::uint32_t width, std::uint32_t height) override {
+    pixels.resize(width * height * 4);
+    return pixels.data();
+  }
+  void end_frame(std::uint32_t, std::uint32_t) override { frames++; }
+
+  std::vector<std::uint8_t> pixels;
+  int frames = 0;
+};
+
+std::vector<std::uint8_t> filled(int width, int height, std::uint8_t r,
+                                 std::uint8_t g, std::uint8_t b) {
+  std::vector<std::uint8_t> pixels(width * height * 4);
+  for (size_t n = 0; n < pixels.size(); n += 4) {
+    pixels[n + 0] = r;
+    pixels[n + 1] = g;
+    pixels[n + 2] = b;
+    pixels[n + 3] = 255;
+  }
+  return pixels;
+}
+}  // namespace
+
+TEST(RendererMemory, EvictsAndRestoresColorBuffersWithinBudgets) {
+  if (!initialize_gl())
+    GTEST_SKIP() << "No EGL implementation available";
+
+  ::Renderer renderer;
+  if (!renderer.initialize(EGL_DEFAULT_DISPLAY, true))
+    GTEST_SKIP() << "No EGL display available";
+
+  const int width = 64, height = 64;
+  const std::uint64_t size = width * height * 4;
+
+  auto accounting = MemoryAccounting::get();
+  const auto previous_budget = accounting->budget();
+  accounting->set_budget({2 * size, 3 * size});
+
+  RenderThreadInfo thread_info;
+  thread_info.m_client = accounting->register_client();
+  const auto evicted_before = accounting->summary()["evicted_buffers"];
+  const auto restored_before = accounting->summary()["restored_buffers"];
+
+  FrameCounter sink;
+  const EGLNativeWindowType window = 1;
+  ASSERT_NE(nullptr, renderer.createOffscreenWindow(window, width, height, &sink));
+  const Rect frame{0, 0, width, height};
+
+  auto red = filled(width, height, 255, 0, 0);
+  auto green = filled(width, height, 0, 255, 0);
+  const auto first = renderer.createColorBuffer(width, height, GL_RGBA);
+  ASSERT_NE(0u, first);
+  ASSERT_TRUE(renderer.updateColorBuffer(first, 0, 0, width, height, GL_RGBA,
+                                         GL_UNSIGNED_BYTE, red.data()));
+
+  // Sets up the resizer of the first buffer in the compositor context
+  const RenderableList layers{
+      Renderable{"first", first, frame, frame, glm::mat4(1.0f)}};
+  renderer.draw(window, frame, layers);
+  ASSERT_EQ(1, sink.frames);
+
+  const auto second = renderer.createColorBuffer(width, height, GL_RGBA);
+  ASSERT_NE(0u, second);
+  ASSERT_TRUE(renderer.updateColorBuffer(second, 0, 0, width, height, GL_RGBA,
+                                         GL_UNSIGNED_BYTE, green.data()));
+  EXPECT_EQ(2 * size, accounting->usage(thread_info.m_client));
+
+  // Going beyond the soft budget moves the least recently used buffer
+  // out of GPU memory
+  const auto third = renderer.createColorBuffer(width, height, GL_RGBA);
+  ASSERT_NE(0u, third);
+  EXPECT_EQ(evicted_before + 1, accounting->summary()["evicted_buffers"]);
+  EXPECT_EQ(2 * size, accounting->usage(thread_info.m_client));
+
+  // Drawing brings the first buffer back and drops the resizer it had
+  renderer.draw(window, frame, layers);
+  ASSERT_EQ(2, sink.frames);
+  EXPECT_EQ(restored_before + 1, accounting->summary()["restored_buffers"]);
+  EXPECT_EQ(3 * size, accounting->usage(thread_info.m_client));
+
+  // Restored buffers may go beyond the soft budget but new ones can't go
+  // beyond the hard one
+  EXPECT_EQ(0u, renderer.createColorBuffer(width, height, GL_RGBA));
+  EXPECT_EQ(3 * size, accounting->usage(thread_info.m_client));
+
+  std::vector<std::uint8_t> pixels(size);
+  renderer.readColorBuffer(first, 0, 0, width, height, GL_RGBA,
+                           GL_UNSIGNED_BYTE, pixels.data());
+  EXPECT_EQ(red, pixels);
+  renderer.readColorBuffer(second, 0, 0, width, height, GL_RGBA,
+                           GL_UNSIGNED_BYTE, pixels.data());
+  EXPECT_EQ(green, pixels);
+
+  renderer.closeColorBuffer(first);
+  renderer.closeColorBuffer(second);
+  renderer.closeColorBuffer(third);
+  renderer.destroyNativeWindow(window);
+  renderer.finalize();
+
+  accounting->unregister_client(thread_info.m_client);
+  accounting->set_budget(previous_budget);
+}
+
+TEST(RendererMemory, DoesNotPoolExportedColorBuffers) {
+  if (!initialize_gl())
+    GTEST_SKIP() << "No EGL implementation available";
+
+  ::Renderer renderer;
+  if (!renderer.initialize(EGL_DEFAULT_DISPLAY, true))
+    GTEST_SKIP() << "No EGL display available";
+
+  RenderThreadInfo thread_info;
+  thread_info.m_client = MemoryAccounting::get()->register_client();
+
+  int config = -1;
+  const auto configs = renderer.getConfigs();
+  for (size_t n = 0; n < configs->size() && config < 0; n++) {
+    const auto c = configs->get(n);
+    if ((c->getRenderableType() & EGL_OPENGL_ES2_BIT) &&
+        (c->getSurfaceType() & EGL_PBUFFER_BIT))
+      config = n;
+  }
+
+  const int width = 64, height = 64;
+  const auto context = renderer.createRenderContext(config, 0, true);
+  const auto surface = renderer.createWindowSurface(config, width, height);
+  if (config < 0 || !context || !surface ||
+      !renderer.bindContext(context, surface, surface)) {
+    renderer.finalize();
+    MemoryAccounting::get()->unregister_client(thread_info.m_client);
+    GTEST_SKIP() << "No GLES 2 context available";
+  }
+
+  auto statistics = BufferStatistics::get();
+
+  // The storage of a buffer bound to a guest texture stays shared with
+  // it, so it must not be handed out again
+  const auto exported = renderer.createColorBuffer(width, height, GL_RGBA);
+  ASSERT_NE(0u, exported);
+  GLuint texture = 0;
+  s_gles2.glGenTextures(1, &texture);
+  s_gles2.glBindTexture(GL_TEXTURE_2D, texture);
+  ASSERT_TRUE(renderer.bindColorBufferToTexture(exported));
+  renderer.closeColorBuffer(exported);
+
+  auto hits_before = statistics->summary()["pool_hits"];
+  const auto plain = renderer.createColorBuffer(width, height, GL_RGBA);
+  ASSERT_NE(0u, plain);
+  EXPECT_EQ(hits_before, statistics->summary()["pool_hits"]);
+
+  // while buffers nobody refers to anymore are
+  renderer.closeColorBuffer(plain);
+  hits_before = statistics->summary()["pool_hits"];
+  const auto reused = renderer.createColorBuffer(width, height, GL_RGBA);
+  ASSERT_NE(0u, reused);
+  EXPECT_EQ(hits_before + 1, statistics->summary()["pool_hits"]);
+  renderer.closeColorBuffer(reused);
+
+  s_gles2.glDeleteTextures(1, &texture);
+  renderer.bindContext(0, 0, 0);
+  renderer.DestroyWindowSurface(surface);
+  renderer.DestroyRenderContext(context);
+  renderer.finalize();
+
+  MemoryAccounting::get()->unregister_client(thread_info.m_client);
+}
+}  // namespace graphics
+}  // namespace anbox
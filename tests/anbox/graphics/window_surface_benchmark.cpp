@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/graphics/buffer_statistics.h"
+#include "anbox/graphics/emugl/DispatchTables.h"
+#include "anbox/graphics/emugl/RenderApi.h"
+#include "anbox/graphics/emugl/RenderThreadInfo.h"
+#include "anbox/graphics/emugl/Renderer.h"
+
+#include "OpenGLESDispatch/EGLDispatch.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace anbox;
+
+namespace {
+struct Swaps {
+  bool completed = false;
+  double per_second = 0.0;
+  std::uint64_t framebuffer_blits = 0;
+};
+
+// Runs |count| guest swaps of a |width|x|height| window surface the way
+// rcFlushWindowColorBuffer does.
+Swaps swap_window_surface(bool framebuffer_blit, int width, int height, int count) {
+  if (framebuffer_blit)
+    unsetenv("ANBOX_NO_FRAMEBUFFER_BLIT");
+  else
+    setenv("ANBOX_NO_FRAMEBUFFER_BLIT", "1", 1);
+
+  Swaps swaps;
+  ::Renderer renderer;
+  if (!renderer.initialize(EGL_DEFAULT_DISPLAY, true))
+    return swaps;
+
+  RenderThreadInfo thread_info;
+
+  int config = -1;
+  const auto configs = renderer.getConfigs();
+  for (size_t n = 0; n < configs->size() && config < 0; n++) {
+    const auto c = configs->get(n);
+    EGLint samples = 0;
+    s_egl.eglGetConfigAttrib(renderer.getDisplay(), c->getEglConfig(), EGL_SAMPLES, &samples);
+    if ((c->getRenderableType() & EGL_OPENGL_ES2_BIT) &&
+        (c->getSurfaceType() & EGL_PBUFFER_BIT) && samples == 0)
+      config = n;
+  }
+
+  const auto context = renderer.createRenderContext(config, 0, true);
+  const auto surface = renderer.createWindowSurface(config, width, height);
+  const auto buffer = renderer.createColorBuffer(width, height, GL_RGBA);
+  if (config < 0 || !context || !surface || !buffer ||
+      !renderer.setWindowSurfaceColorBuffer(surface, buffer) ||
+      !renderer.bindContext(context, surface, surface)) {
+    renderer.finalize();
+    return swaps;
+  }
+
+  s_gles2.glClearColor(1.0f, 0.0f, 0.0f, 1.0f);
+  s_gles2.glClear(GL_COLOR_BUFFER_BIT);
+
+  const auto blits_before = graphics::BufferStatistics::get()->summary()["surface_flushes_blit"];
+  const auto start = std::chrono::steady_clock::now();
+  bool flushed = true;
+  for (int n = 0; n < count; n++)
+    flushed = renderer.flushWindowSurfaceColorBuffer(surface) && flushed;
+  s_gles2.glFinish();
+  const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+  swaps.framebuffer_blits = graphics::BufferStatistics::get()->summary()["surface_flushes_blit"] - blits_before;
+
+  renderer.bindContext(0, 0, 0);
+  renderer.closeColorBuffer(buffer);
+  renderer.DestroyWindowSurface(surface);
+  renderer.DestroyRenderContext(context);
+  renderer.finalize();
+
+  swaps.completed = flushed;
+  swaps.per_second = count / elapsed.count();
+  return swaps;
+}
+}
+
+// Compares how fast guest swaps copy a window surface into its color
+// buffer through a texture draw and through a framebuffer blit.
+int main() {
+  // Runs without any display server through Mesa
+  setenv("EGL_PLATFORM", "surfaceless", 0);
+  if (!graphics::emugl::initialize(graphics::emugl::default_gl_libraries(), nullptr, nullptr)) {
+    std::cerr << "No EGL implementation available" << std::endl;
+    return 1;
+  }
+
+  const int width = 1280, height = 720, count = 200;
+  const auto draw = swap_window_surface(false, width, height, count);
+  const auto blit = swap_window_surface(true, width, height, count);
+  if (!draw.completed || !blit.completed) {
+    std::cerr << "Failed to swap window surfaces" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Swaps of a " << width << "x" << height << " surface: "
+            << static_cast<int>(draw.per_second) << "/s through a texture, "
+            << static_cast<int>(blit.per_second) << "/s with framebuffer blits"
+            << (blit.framebuffer_blits == 0 ? " (unsupported, fell back)" : "")
+            << std::endl;
+  return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/graphics/buffer_statistics.h"
+#include "anbox/graphics/emugl/DispatchTables.h"
+#include "anbox/graphics/emugl/RenderApi.h"
+#include "anbox/graphics/emugl/RenderThreadInfo.h"
+#include "anbox/graphics/emugl/Renderer.h"
+
+#include "OpenGLESDispatch/EGLDispatch.h"
+
+#include <cstdlib>
+#include <vector>
+
+namespace anbox {
+namespace graphics {
+namespace {
+bool initialize_gl() {
+  // Runs without any display server through Mesa
+  setenv("EGL_PLATFORM", "surfaceless", 0);
+  return emugl::initialize(emugl::default_gl_libraries(), nullptr, nullptr);
+}
+
+struct Swaps {
+  bool completed = false;
+  bool framebuffer_blit_supported = false;
+  std::uint64_t framebuffer_blits = 0;
+  std::vector<std::uint8_t> pixels;
+};
+
+// Runs a guest swap of a |width|x|height| window surface the way
+// rcFlushWindowColorBuffer does and reads back the buffer afterwards. The
+// lower half of the surface is red, the upper half green.
+Swaps swap_window_surface(bool framebuffer_blit, int width, int height) {
+  if (framebuffer_blit)
+    unsetenv("ANBOX_NO_FRAMEBUFFER_BLIT");
+  else
+    setenv("ANBOX_NO_FRAMEBUFFER_BLIT", "1", 1);
+
+  Swaps swaps;
+  ::Renderer renderer;
+  if (!renderer.initialize(EGL_DEFAULT_DISPLAY, true))
+    return swaps;
+
+  RenderThreadInfo thread_info;
+  swaps.framebuffer_blit_supported = renderer.getCaps().has_framebuffer_blit;
+
+  int config = -1;
+  const auto configs = renderer.getConfigs();
+  for (size_t n = 0; n < configs->size() && config < 0; n++) {
+    const auto c = configs->get(n);
+    EGLint samples = 0;
+    s_egl.eglGetConfigAttrib(renderer.getDisplay(), c->getEglConfig(), EGL_SAMPLES, &samples);
+    if ((c->getRenderableType() & EGL_OPENGL_ES2_BIT) &&
+        (c->getSurfaceType() & EGL_PBUFFER_BIT) && samples == 0)
+      config = n;
+  }
+
+  const auto context = renderer.createRenderContext(config, 0, true);
+  const auto surface = renderer.createWindowSurface(config, width, height);
+  const auto buffer = renderer.createColorBuffer(width, height, GL_RGBA);
+  if (config < 0 || !context || !surface || !buffer ||
+      !renderer.setWindowSurfaceColorBuffer(surface, buffer) ||
+      !renderer.bindContext(context, surface, surface)) {
+    renderer.finalize();
+    return swaps;
+  }
+
+  s_gles2.glEnable(GL_SCISSOR_TEST);
+  s_gles2.glScissor(0, 0, width, height / 2);
+  s_gles2.glClearColor(1.0f, 0.0f, 0.0f, 1.0f);
+  s_gles2.glClear(GL_COLOR_BUFFER_BIT);
+  s_gles2.glScissor(0, height / 2, width, height - height / 2);
+  s_gles2.glClearColor(0.0f, 1.0f, 0.0f, 1.0f);
+  s_gles2.glClear(GL_COLOR_BUFFER_BIT);
+  // Must not clip the copy
+  s_gles2.glScissor(0, 0, 1, 1);
+
+  const auto blits_before = BufferStatistics::get()->summary()["surface_flushes_blit"];
+  const auto flushed = renderer.flushWindowSurfaceColorBuffer(surface);
+  swaps.framebuffer_blits = BufferStatistics::get()->summary()["surface_flushes_blit"] - blits_before;
+
+  renderer.bindContext(0, 0, 0);
+
+  swaps.pixels.resize(width * height * 4);
+  renderer.readColorBuffer(buffer, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, swaps.pixels.data());
+
+  renderer.closeColorBuffer(buffer);
+  renderer.DestroyWindowSurface(surface);
+  renderer.DestroyRenderContext(context);
+  renderer.finalize();
+
+  swaps.completed = flushed;
+  return swaps;
+}
+
+bool is_color(const std::vector<std::uint8_t> &pixels, size_t offset,
+              std::uint8_t r, std::uint8_t g) {
+  return pixels[offset] == r && pixels[offset + 1] == g && pixels[offset + 2] == 0;
+}
+}  // namespace
+
+TEST(WindowSurface, FramebufferBlitMatchesTextureDraw) {
+  if (!initialize_gl())
+    GTEST_SKIP() << "No EGL implementation available";
+
+  const int width = 64, height = 32;
+  const auto draw = swap_window_surface(false, width, height);
+  const auto blit = swap_window_surface(true, width, height);
+  ASSERT_TRUE(draw.completed);
+  ASSERT_TRUE(blit.completed);
+  EXPECT_EQ(0u, draw.framebuffer_blits);
+  if (!blit.framebuffer_blit_supported)
+    GTEST_SKIP() << "Framebuffer blits are not supported";
+  EXPECT_EQ(1u, blit.framebuffer_blits);
+
+  // Color buffers store their top row first
+  const size_t last_row = (height - 1) * width * 4;
+  EXPECT_TRUE(is_color(draw.pixels, 0, 0, 255));
+  EXPECT_TRUE(is_color(draw.pixels, last_row, 255, 0));
+  EXPECT_EQ(draw.pixels, blit.pixels);
+}
+}  // namespace graphics
+}  // namespace anbox
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/headless/frame_ring.h"
+
+#include <cstring>
+#include <thread>
+
+namespace anbox {
+namespace headless {
+TEST(FrameRing, LatestFrameCanBeReadThroughAttachedRing) {
+  const auto writer = FrameRing::create(16, 8);
+  const auto reader = FrameRing::attach(writer->fd());
+  ASSERT_EQ(3u, reader->slot_count());
+  ASSERT_EQ(16u, reader->max_width());
+  ASSERT_EQ(8u, reader->max_height());
+  ASSERT_EQ(16u * 8u * 4u, reader->slot_size());
+
+  std::vector<std::uint8_t> out(reader->slot_size());
+  FrameRing::FrameInfo info;
+  EXPECT_FALSE(reader->read_latest(out.data(), info));
+
+  for (std::uint8_t n = 0; n < 5; n++) {
+    auto data = writer->begin_write();
+    std::memset(data, n + 1, 10 * 4 * 5);
+    writer->end_write(n, 2, 10, 5, 10 * 4);
+
+    ASSERT_TRUE(reader->read_latest(out.data(), info));
+    EXPECT_EQ(n, info.x);
+    EXPECT_EQ(2, info.y);
+    EXPECT_EQ(10u, info.width);
+    EXPECT_EQ(5u, info.height);
+    EXPECT_EQ(40u, info.stride);
+    EXPECT_EQ(n + 1, out[0]);
+    EXPECT_EQ(n + 1, out[10 * 4 * 5 - 1]);
+    EXPECT_EQ(n + 1u, reader->frame_count());
+  }
+}
+
+TEST(FrameRing, WriterDoesNotOverwriteLatestFrame) {
+  const auto writer = FrameRing::create(4, 4);
+  const auto reader = FrameRing::attach(writer->fd());
+
+  auto data = writer->begin_write();
+  std::memset(data, 1, 4 * 4 * 4);
+  writer->end_write(0, 0, 4, 4, 16);
+
+  // While the next frame is being written consumers still get the
+  // previous one.
+  data = writer->begin_write();
+  std::memset(data, 2, 4 * 4 * 4);
+
+  std::vector<std::uint8_t> out(reader->slot_size());
+  FrameRing::FrameInfo info;
+  ASSERT_TRUE(reader->read_latest(out.data(), info));
+  EXPECT_EQ(1, out[0]);
+
+  writer->end_write(0, 0, 4, 4, 16);
+  ASSERT_TRUE(reader->read_latest(out.data(), info));
+  EXPECT_EQ(2, out[0]);
+}
+
+TEST(FrameRing, WaitReturnsOnceFrameIsPublished) {
+  const auto writer = FrameRing::create(4, 4);
+  const auto reader = FrameRing::attach(writer->fd());
+
+  EXPECT_EQ(0u, reader->wait_for_frame(0, std::chrono::milliseconds{1}));
+
+  std::thread publisher([&]() {
+    writer->begin_write();
+    writer->end_write(0, 0, 4, 4, 16);
+  });
+  // The timeout is just a safety net, the publisher wakes us up
+  const auto count = reader->wait_for_frame(0, std::chrono::milliseconds{5000});
+  publisher.join();
+  EXPECT_EQ(1u, count);
+}
+
+TEST(FrameRing, RejectsInvalidMemory) {
+  EXPECT_ANY_THROW(FrameRing::attach(Fd{-1}));
+  EXPECT_ANY_THROW(FrameRing::create(0, 4));
+}
+}  // namespace headless
+}  // namespace anbox
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include "anbox/config.h"
+#include "anbox/headless/frame_ring.h"
+#include "anbox/headless/frame_server.h"
+
+#include <boost/filesystem.hpp>
+
+#include <cstdlib>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace fs = boost::filesystem;
+
+namespace anbox {
+namespace headless {
+namespace {
+int connect_to(const std::string &path) {
+  const auto fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool read_message(int fd, FrameServer::Message &message) {
+  return ::recv(fd, &message, sizeof(message), MSG_WAITALL) ==
+         static_cast<ssize_t>(sizeof(message));
+}
+
+class FrameServerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = (fs::temp_directory_path() / fs::unique_path()).string();
+    ::setenv("XDG_RUNTIME_DIR", dir.c_str(), 1);
+    fs::create_directories(SystemConfiguration::instance().socket_dir());
+    rt->start();
+  }
+  void TearDown() override {
+    rt->stop();
+    fs::remove_all(dir);
+  }
+
+  std::string dir;
+  std::shared_ptr<Runtime> rt{Runtime::create(1)};
+};
+}  // namespace
+
+TEST_F(FrameServerTest, DisconnectsConsumersWhichDontKeepUp) {
+  FrameServer server(rt, 640, 480);
+
+  const auto consumer = connect_to(server.socket_file());
+  ASSERT_GE(consumer, 0);
+  FrameServer::Message message;
+  ASSERT_TRUE(read_message(consumer, message));
+  EXPECT_EQ(FrameServer::Message::Type::display, message.type);
+  EXPECT_EQ(640u, message.width);
+  EXPECT_EQ(480u, message.height);
+
+  // The consumer doesn't read anything until its socket is full. Adding
+  // windows must not wait for it.
+  const auto ring = FrameRing::create(16, 16);
+  for (int n = 0; n < 100000; n++) {
+    server.add_window(1, n, ring);
+    server.remove_window(1);
+  }
+
+  // Everything sent until the server gave up on the consumer is still
+  // there but then the connection ends.
+  std::vector<char> buffer(64 * 1024);
+  ssize_t ret;
+  while ((ret = ::read(consumer, buffer.data(), buffer.size())) > 0) {}
+  EXPECT_EQ(0, ret);
+  ::close(consumer);
+}
+}  // namespace headless
+}  // namespace anbox
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/headless/input_translator.h"
+
+#include <linux/input.h>
+
+namespace anbox {
+namespace headless {
+namespace {
+bool operator==(const input::Event &lhs, const input::Event &rhs) {
+  return lhs.type == rhs.type && lhs.code == rhs.code && lhs.value == rhs.value;
+}
+}
+
+TEST(InputTranslator, TranslatesTapIntoPointerEvents) {
+  InputTranslator translator;
+  std::vector<input::Event> pointer, keyboard;
+
+  ASSERT_TRUE(translator.translate("move 10 20", pointer, keyboard));
+  pointer.clear();
+  ASSERT_TRUE(translator.translate("tap 15 30", pointer, keyboard));
+
+  const std::vector<input::Event> expected = {
+      {EV_ABS, ABS_X, 15}, {EV_ABS, ABS_Y, 30},
+      {EV_REL, REL_X, 5}, {EV_REL, REL_Y, 10},
+      {EV_KEY, BTN_LEFT, 1}, {EV_SYN, SYN_REPORT, 0},
+      {EV_KEY, BTN_LEFT, 0}, {EV_SYN, SYN_REPORT, 0},
+  };
+  ASSERT_EQ(expected.size(), pointer.size());
+  for (std::size_t n = 0; n < expected.size(); n++)
+    EXPECT_TRUE(expected[n] == pointer[n]) << "event " << n;
+  EXPECT_TRUE(keyboard.empty());
+}
+
+TEST(InputTranslator, TranslatesKeys) {
+  InputTranslator translator;
+  std::vector<input::Event> pointer, keyboard;
+
+  ASSERT_TRUE(translator.translate("key 30", pointer, keyboard));
+  ASSERT_TRUE(translator.translate("keydown 42", pointer, keyboard));
+  ASSERT_EQ(3u, keyboard.size());
+  EXPECT_TRUE((input::Event{EV_KEY, 30, 1}) == keyboard[0]);
+  EXPECT_TRUE((input::Event{EV_KEY, 30, 0}) == keyboard[1]);
+  EXPECT_TRUE((input::Event{EV_KEY, 42, 1}) == keyboard[2]);
+  EXPECT_TRUE(pointer.empty());
+}
+
+TEST(InputTranslator, RejectsInvalidCommands) {
+  InputTranslator translator;
+  std::vector<input::Event> pointer, keyboard;
+
+  EXPECT_FALSE(translator.translate("", pointer, keyboard));
+  EXPECT_FALSE(translator.translate("jump 1 2", pointer, keyboard));
+  EXPECT_FALSE(translator.translate("move 1", pointer, keyboard));
+  EXPECT_FALSE(translator.translate("move -1 2", pointer, keyboard));
+  EXPECT_FALSE(translator.translate("key 0", pointer, keyboard));
+  EXPECT_FALSE(translator.translate("key abc", pointer, keyboard));
+  EXPECT_TRUE(pointer.empty());
+  EXPECT_TRUE(keyboard.empty());
+}
+}  // namespace headless
+}  // namespace anbox
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/input/device.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <linux/input.h>
+
+namespace anbox {
+namespace input {
+namespace {
+// Layout of the events on the wire, see Device::CompatEvent
+struct WireEvent {
+  std::uint64_t sec;
+  std::uint64_t usec;
+  std::uint16_t type;
+  std::uint16_t code;
+  std::uint32_t value;
+};
+
+int connect_to(const std::string &path) {
+  const auto fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un addr;
+  ::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  ::snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path.c_str());
+  if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+std::vector<char> read_until_idle(int fd, const std::chrono::milliseconds &idle) {
+  std::vector<char> data;
+  char buffer[4096];
+  struct pollfd fds = {fd, POLLIN, 0};
+  while (::poll(&fds, 1, idle.count()) > 0) {
+    const auto n = ::read(fd, buffer, sizeof(buffer));
+    if (n <= 0)
+      break;
+    data.insert(data.end(), buffer, buffer + n);
+  }
+  return data;
+}
+}  // namespace
+
+TEST(Device, KeepsEventStreamIntactForSlowClients) {
+  auto rt = Runtime::create(1);
+  rt->add_executor({Device::executor, 1, Runtime::Priority::normal, {}});
+  rt->start();
+
+  const auto path = "/tmp/anbox-input-test-" + std::to_string(::getpid());
+  auto device = Device::create(path, rt);
+
+  const auto fd = connect_to(path);
+  ASSERT_GE(fd, 0);
+
+  // Events are only delivered to the client once the device accepted it
+  // and sent its information.
+  struct pollfd fds = {fd, POLLIN, 0};
+  ASSERT_EQ(1, ::poll(&fds, 1, 5000));
+
+  // The client doesn't read anything until all events went out, which is
+  // more than fits into the socket buffers.
+  const int count = 4000;
+  const int batch = 64;
+  for (int n = 0; n < count; n += batch / 2) {
+    std::vector<Event> events;
+    for (int m = n; m < n + batch / 2; m++) {
+      events.push_back({EV_KEY, KEY_A, m});
+      events.push_back({EV_SYN, SYN_REPORT, 0});
+    }
+    device->send_events(events);
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+
+  const auto data = read_until_idle(fd, std::chrono::milliseconds{500});
+  ::close(fd);
+  rt->stop();
+  ::unlink(path.c_str());
+
+  const auto events_size = count * 2 * sizeof(WireEvent);
+  ASSERT_GT(data.size(), events_size);
+
+  // The device information comes first, followed by all events in order
+  auto events = reinterpret_cast<const WireEvent*>(data.data() + data.size() - events_size);
+  for (int n = 0; n < count; n++) {
+    ASSERT_EQ(EV_KEY, events[n * 2].type);
+    ASSERT_EQ(n, static_cast<int>(events[n * 2].value));
+    ASSERT_EQ(EV_SYN, events[n * 2 + 1].type);
+  }
+}
+}  // namespace input
+}  // namespace anbox
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/input/event_queue.h"
+
+#include <array>
+
+#include <linux/input.h>
+
+namespace anbox {
+namespace input {
+namespace {
+const auto now = Timestamp::clock::now();
+
+std::vector<Event> drain_all(EventQueue &queue) {
+  std::vector<Event> events(queue.capacity());
+  std::vector<Timestamp> times(queue.capacity());
+  events.resize(queue.drain(events.data(), times.data(), events.size()));
+  return events;
+}
+}  // namespace
+
+TEST(EventQueue, QueuesAndDrainsEventsInOrder) {
+  EventQueue queue;
+
+  const std::array<Event, 2> key_down{{{EV_KEY, KEY_A, 1}, {EV_SYN, SYN_REPORT, 0}}};
+  const std::array<Event, 2> key_up{{{EV_KEY, KEY_A, 0}, {EV_SYN, SYN_REPORT, 0}}};
+  ASSERT_TRUE(queue.push(key_down.data(), key_down.size(), now));
+  ASSERT_TRUE(queue.push(key_up.data(), key_up.size(), now));
+
+  const auto events = drain_all(queue);
+  ASSERT_EQ(4, events.size());
+  ASSERT_EQ(1, events[0].value);
+  ASSERT_EQ(0, events[2].value);
+  ASSERT_TRUE(queue.empty());
+}
+
+TEST(EventQueue, CoalescesMotionReports) {
+  EventQueue queue;
+
+  for (std::int32_t n = 0; n < 100; n++) {
+    const std::array<Event, 5> motion{{
+        {EV_ABS, ABS_X, n},
+        {EV_ABS, ABS_Y, n * 2},
+        {EV_REL, REL_X, 1},
+        {EV_REL, REL_Y, 2},
+        {EV_SYN, SYN_REPORT, 0},
+    }};
+    ASSERT_TRUE(queue.push(motion.data(), motion.size(), now));
+  }
+
+  ASSERT_EQ(99, queue.coalesced());
+
+  const auto events = drain_all(queue);
+  ASSERT_EQ(5, events.size());
+  ASSERT_EQ(99, events[0].value);
+  ASSERT_EQ(198, events[1].value);
+  ASSERT_EQ(100, events[2].value);
+  ASSERT_EQ(200, events[3].value);
+  ASSERT_EQ(EV_SYN, events[4].type);
+}
+
+TEST(EventQueue, DoesNotCoalesceAcrossOtherEvents) {
+  EventQueue queue;
+
+  const std::array<Event, 3> first_motion{{{EV_ABS, ABS_X, 1}, {EV_ABS, ABS_Y, 1}, {EV_SYN, SYN_REPORT, 0}}};
+  const std::array<Event, 2> button{{{EV_KEY, BTN_LEFT, 1}, {EV_SYN, SYN_REPORT, 0}}};
+  const std::array<Event, 3> second_motion{{{EV_ABS, ABS_X, 2}, {EV_ABS, ABS_Y, 2}, {EV_SYN, SYN_REPORT, 0}}};
+
+  ASSERT_TRUE(queue.push(first_motion.data(), first_motion.size(), now));
+  ASSERT_TRUE(queue.push(button.data(), button.size(), now));
+  ASSERT_TRUE(queue.push(second_motion.data(), second_motion.size(), now));
+
+  const auto events = drain_all(queue);
+  ASSERT_EQ(8, events.size());
+  ASSERT_EQ(1, events[0].value);
+  ASSERT_EQ(BTN_LEFT, events[3].code);
+  ASSERT_EQ(2, events[5].value);
+}
+
+TEST(EventQueue, DoesNotCoalesceWithDeliveredReports) {
+  EventQueue queue;
+
+  const std::array<Event, 3> motion{{{EV_ABS, ABS_X, 1}, {EV_ABS, ABS_Y, 1}, {EV_SYN, SYN_REPORT, 0}}};
+  ASSERT_TRUE(queue.push(motion.data(), motion.size(), now));
+  ASSERT_EQ(3, drain_all(queue).size());
+
+  ASSERT_TRUE(queue.push(motion.data(), motion.size(), now));
+  ASSERT_EQ(3, drain_all(queue).size());
+  ASSERT_EQ(0, queue.coalesced());
+}
+
+TEST(EventQueue, AddsMissingAxesWhenCoalescing) {
+  EventQueue queue;
+
+  const std::array<Event, 2> x_motion{{{EV_ABS, ABS_X, 1}, {EV_SYN, SYN_REPORT, 0}}};
+  const std::array<Event, 2> y_motion{{{EV_ABS, ABS_Y, 2}, {EV_SYN, SYN_REPORT, 0}}};
+  ASSERT_TRUE(queue.push(x_motion.data(), x_motion.size(), now));
+  ASSERT_TRUE(queue.push(y_motion.data(), y_motion.size(), now));
+
+  const auto events = drain_all(queue);
+  ASSERT_EQ(3, events.size());
+  ASSERT_EQ(ABS_X, events[0].code);
+  ASSERT_EQ(ABS_Y, events[1].code);
+  ASSERT_EQ(EV_SYN, events[2].type);
+}
+
+TEST(EventQueue, DropsEventsWhenFull) {
+  EventQueue queue(4);
+
+  const std::array<Event, 3> button{{{EV_KEY, BTN_LEFT, 1}, {EV_KEY, BTN_RIGHT, 1}, {EV_SYN, SYN_REPORT, 0}}};
+  ASSERT_TRUE(queue.push(button.data(), button.size(), now));
+  ASSERT_FALSE(queue.push(button.data(), button.size(), now));
+  ASSERT_EQ(3, queue.dropped());
+  ASSERT_EQ(3, drain_all(queue).size());
+}
+TEST(EventQueue, KeepsEventTimes) {
+  EventQueue queue;
+
+  const auto first = Timestamp::clock::now();
+  const auto second = first + std::chrono::milliseconds{5};
+  const auto third = first + std::chrono::milliseconds{10};
+
+  const std::array<Event, 3> motion{{{EV_ABS, ABS_X, 1}, {EV_ABS, ABS_Y, 1}, {EV_SYN, SYN_REPORT, 0}}};
+  const std::array<Event, 2> button{{{EV_KEY, BTN_LEFT, 1}, {EV_SYN, SYN_REPORT, 0}}};
+  ASSERT_TRUE(queue.push(button.data(), button.size(), first));
+  ASSERT_TRUE(queue.push(motion.data(), motion.size(), second));
+  ASSERT_TRUE(queue.push(motion.data(), motion.size(), third));
+
+  std::array<Event, 8> events;
+  std::array<Timestamp, 8> times;
+  Timestamp oldest;
+  ASSERT_EQ(5, queue.drain(events.data(), times.data(), events.size(), &oldest));
+  ASSERT_EQ(first, oldest);
+  ASSERT_EQ(first, times[0]);
+  // The merged motion report carries the time of the most recent one
+  ASSERT_EQ(third, times[2]);
+  ASSERT_EQ(third, times[4]);
+}
+}  // namespace input
+}  // namespace anbox
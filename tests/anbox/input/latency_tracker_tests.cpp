@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/input/latency_tracker.h"
+
+#include <thread>
+#include <vector>
+
+namespace anbox {
+namespace input {
+TEST(LatencyTracker, RestartsReportingWhileReportsAreRunning) {
+  auto tracker = std::make_shared<LatencyTracker>();
+
+  boost::asio::io_service service;
+  std::unique_ptr<boost::asio::io_service::work> work(new boost::asio::io_service::work(service));
+  std::vector<std::thread> threads;
+  for (int n = 0; n < 4; n++)
+    threads.emplace_back([&]() { service.run(); });
+
+  for (int n = 0; n < 2000; n++) {
+    tracker->events_written(Timestamp::clock::now());
+    tracker->report_periodically(service, boost::posix_time::microseconds(10));
+    if (n % 3 == 0)
+      tracker->stop_reporting();
+  }
+  tracker->stop_reporting();
+
+  work.reset();
+  for (auto &thread : threads)
+    thread.join();
+
+  ASSERT_EQ(2000, tracker->socket_write().count());
+}
+}  // namespace input
+}  // namespace anbox
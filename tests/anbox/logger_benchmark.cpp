@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/logger.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace anbox;
+
+namespace {
+// Measures log calls per second with the given number of threads.
+double log_rate(const std::shared_ptr<Logger> &logger, unsigned int num_threads,
+                unsigned int calls_per_thread) {
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (unsigned int n = 0; n < num_threads; n++) {
+    threads.push_back(std::thread([&, n]() {
+      for (unsigned int m = 0; m < calls_per_thread; m++)
+        logger->Logf(Logger::Severity::kWarning, __FILE__, __FUNCTION__, __LINE__,
+                     "Frame %d of thread %d took %.2f ms (%s)", m, n, 16.6, "composer");
+    }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+  const auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(
+      std::chrono::steady_clock::now() - start);
+  logger->Flush();
+  return (num_threads * calls_per_thread) / duration.count();
+}
+}
+
+// Compares the rate of log calls the asynchronous logger sustains from
+// several threads with the one of the synchronous boost::log logger.
+int main() {
+  const unsigned int num_threads = 8;
+  const unsigned int calls_per_thread = 20000;
+
+  std::ostream null_stream{nullptr};
+  auto async_logger = CreateAsyncLogger(null_stream);
+  auto sync_logger = CreateSynchronousLogger(null_stream);
+  sync_logger->Init(Logger::Severity::kWarning);
+
+  const auto async_rate = log_rate(async_logger, num_threads, calls_per_thread);
+  const auto sync_rate = log_rate(sync_logger, num_threads, calls_per_thread);
+
+  std::cout << "Log calls/s from " << num_threads << " threads: async "
+            << static_cast<std::uint64_t>(async_rate) << ", boost::log "
+            << static_cast<std::uint64_t>(sync_rate) << std::endl;
+  return 0;
+}
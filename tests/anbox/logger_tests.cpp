@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/logger.h"
+
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+namespace anbox {
+namespace {
+std::string format(const logging::Record &record) {
+  return logging::Record::format(record.data(), record.size());
+}
+
+logging::Record make_record(const std::string &pattern) {
+  return logging::Record{Logger::Severity::kInfo, __FILE__, __FUNCTION__, __LINE__,
+                         pattern.data(), pattern.size()};
+}
+}  // namespace
+
+TEST(Logger, RecordFormatsLikeStringFormat) {
+  auto record = make_record("%s %d %d %c %d %.1f %s %p");
+  const std::string name{"anbox"};
+  const std::uint8_t byte = 'x';
+  const void *ptr = reinterpret_cast<void*>(0x1234);
+  record.add(name, -42, 42u, byte, true, 1.25, "literal", ptr);
+
+  EXPECT_EQ(utils::string_format("%s %d %d %c %d %.1f %s %p", name, -42, 42u, byte, true, 1.25, "literal", ptr),
+            format(record));
+}
+
+TEST(Logger, RecordCopiesPattern) {
+  std::string pattern{"%s=%d"};
+  auto record = make_record(pattern);
+  record.add("value", 1);
+  pattern = "overwritten";
+  EXPECT_EQ("value=1", format(record));
+}
+
+TEST(Logger, RecordSurvivesInvalidFormat) {
+  auto record = make_record("%d %d");
+  record.add(1);
+  EXPECT_NE(std::string::npos, format(record).find("%d %d"));
+}
+
+TEST(Logger, RecordGrowsForLongArguments) {
+  const std::string long_value(1000, 'a');
+  auto record = make_record("%s");
+  record.add(long_value);
+  EXPECT_EQ(long_value, format(record));
+}
+
+TEST(Logger, AsyncLoggerWritesMessagesInOrder) {
+  std::ostringstream out;
+  auto logger = CreateAsyncLogger(out);
+  logger->SetSeverity(Logger::Severity::kInfo);
+
+  for (int n = 0; n < 1000; n++)
+    logger->Logf(Logger::Severity::kInfo, __FILE__, __FUNCTION__, __LINE__, "message %d", n);
+  logger->Logf(Logger::Severity::kDebug, __FILE__, __FUNCTION__, __LINE__, "filtered");
+  logger->Flush();
+
+  const auto text = out.str();
+  EXPECT_EQ(std::string::npos, text.find("filtered"));
+  EXPECT_NE(std::string::npos, text.find("logger_tests.cpp:"));
+
+  std::size_t pos = 0;
+  for (int n = 0; n < 1000; n++) {
+    pos = text.find(utils::string_format("message %d\n", n), pos);
+    ASSERT_NE(std::string::npos, pos);
+  }
+}
+
+TEST(Logger, AsyncLoggerKeepsBurstsLargerThanItsBuffer) {
+  std::ostringstream out;
+  auto logger = CreateAsyncLogger(out);
+  logger->SetSeverity(Logger::Severity::kInfo);
+
+  // Each record takes more than 100 bytes so this is several times what a
+  // thread can buffer.
+  const std::string padding(100, 'x');
+  const int count = 5000;
+  for (int n = 0; n < count; n++)
+    logger->Logf(Logger::Severity::kInfo, __FILE__, __FUNCTION__, __LINE__, "burst %d %s", n, padding);
+  logger->Flush();
+
+  const auto text = out.str();
+  EXPECT_EQ(std::string::npos, text.find("Dropped"));
+
+  std::size_t pos = 0;
+  for (int n = 0; n < count; n++) {
+    pos = text.find(utils::string_format("burst %d %s\n", n, padding), pos);
+    ASSERT_NE(std::string::npos, pos) << "record " << n << " is missing";
+  }
+}
+
+TEST(Logger, AsyncLoggerCopiesArrayPatterns) {
+  std::ostringstream out;
+  auto logger = CreateAsyncLogger(out);
+  logger->SetSeverity(Logger::Severity::kInfo);
+
+  // Arrays which aren't literals bind to the same overload literals do.
+  char pattern[32];
+  ::strcpy(pattern, "value=%d");
+  logger->Logf(Logger::Severity::kInfo, __FILE__, __FUNCTION__, __LINE__,
+               static_cast<const char (&)[32]>(pattern), 1);
+  ::strcpy(pattern, "overwritten");
+  logger->Flush();
+
+  EXPECT_NE(std::string::npos, out.str().find("value=1"));
+  EXPECT_EQ(std::string::npos, out.str().find("overwritten"));
+}
+
+TEST(Logger, AsyncLoggerDrainsOnDestruction) {
+  std::ostringstream out;
+  {
+    auto logger = CreateAsyncLogger(out);
+    std::thread([&]() {
+      logger->Logf(Logger::Severity::kError, __FILE__, __FUNCTION__, __LINE__, "from %s", "thread");
+    }).join();
+    logger->Log(Logger::Severity::kError, "plain", Logger::Location{"file.cpp", "function", 7});
+  }
+
+  EXPECT_NE(std::string::npos, out.str().find("from thread"));
+  EXPECT_NE(std::string::npos, out.str().find("[file.cpp:7@function] plain"));
+}
+
+}  // namespace anbox
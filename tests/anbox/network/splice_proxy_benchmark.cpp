@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "anbox/network/splice_proxy.h"
+#include "anbox/runtime.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace anbox;
+
+namespace {
+// Returns a connected pair of TCP sockets on the loopback device the way
+// the adb proxy is connected to the adb server on the host.
+bool connect_over_loopback(int &client, int &server) {
+  const auto listener = ::socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr;
+  ::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t addr_len = sizeof(addr);
+  if (::bind(listener, reinterpret_cast<struct sockaddr*>(&addr), addr_len) < 0 ||
+      ::listen(listener, 1) < 0 ||
+      ::getsockname(listener, reinterpret_cast<struct sockaddr*>(&addr), &addr_len) < 0) {
+    ::close(listener);
+    return false;
+  }
+
+  client = ::socket(AF_INET, SOCK_STREAM, 0);
+  const auto connected = ::connect(client, reinterpret_cast<struct sockaddr*>(&addr), addr_len) == 0;
+  server = connected ? ::accept(listener, nullptr, nullptr) : -1;
+  ::close(listener);
+  return server >= 0;
+}
+
+void write_all(int fd, std::size_t total) {
+  std::vector<std::uint8_t> chunk(64 * 1024, 0x42);
+  for (std::size_t written = 0; written < total;) {
+    const auto n = ::write(fd, chunk.data(), std::min(chunk.size(), total - written));
+    if (n <= 0)
+      return;
+    written += n;
+  }
+}
+
+void read_all(int fd, std::size_t total) {
+  std::vector<std::uint8_t> chunk(64 * 1024);
+  for (std::size_t received = 0; received < total;) {
+    const auto n = ::read(fd, chunk.data(), std::min(chunk.size(), total - received));
+    if (n <= 0)
+      return;
+    received += n;
+  }
+}
+
+void echo(int fd, std::size_t total) {
+  std::vector<std::uint8_t> chunk(64 * 1024);
+  for (std::size_t echoed = 0; echoed < total;) {
+    const auto n = ::read(fd, chunk.data(), chunk.size());
+    if (n <= 0)
+      return;
+    for (ssize_t offset = 0; offset < n;) {
+      const auto m = ::write(fd, chunk.data() + offset, n - offset);
+      if (m <= 0)
+        return;
+      offset += m;
+    }
+    echoed += n;
+  }
+}
+}
+
+// Measures how fast the splice proxy moves data between the guest and
+// an adb server on the host which echoes everything back.
+int main() {
+  int pair[2];
+  if (::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) < 0) {
+    std::cerr << "Failed to create socket pair" << std::endl;
+    return 1;
+  }
+  const auto guest = pair[0];
+
+  int host_proxy = -1, adb_server = -1;
+  if (!connect_over_loopback(host_proxy, adb_server)) {
+    std::cerr << "Failed to connect over the loopback device" << std::endl;
+    return 1;
+  }
+
+  auto rt = Runtime::create(2);
+  rt->start();
+
+  auto proxy = std::make_shared<network::SpliceProxy>(rt, pair[1], host_proxy);
+  proxy->start([]() {});
+
+  const std::size_t total = 256 * 1024 * 1024;
+  const auto start = std::chrono::steady_clock::now();
+
+  std::thread server([&]() { echo(adb_server, total); });
+  std::thread writer([&]() { write_all(guest, total); });
+  read_all(guest, total);
+
+  const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+
+  writer.join();
+  server.join();
+
+  std::cout << "Proxied " << (2 * total) / (1024 * 1024) << " MiB in "
+            << duration.count() / 1000 << " ms ("
+            << (2 * total) / static_cast<double>(duration.count()) << " MB/s)"
+            << std::endl;
+
+  proxy->stop();
+  rt->stop();
+
+  for (const auto fd : {guest, pair[1], host_proxy, adb_server})
+    ::close(fd);
+  return 0;
+}
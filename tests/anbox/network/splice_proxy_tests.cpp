@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/network/splice_proxy.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace anbox {
+namespace network {
+namespace {
+// Sets up the same topology the adb proxy works with: the guest talks
+// over a local socket pair to us and a fake adb server on the host is
+// connected over TCP on the loopback device.
+struct AdbTopology {
+  AdbTopology() {
+    int pair[2];
+    EXPECT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, pair));
+    guest = pair[0];
+    guest_proxy = pair[1];
+
+    const auto listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    ::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    EXPECT_EQ(0, ::bind(listener, reinterpret_cast<struct sockaddr*>(&addr), addr_len));
+    EXPECT_EQ(0, ::listen(listener, 1));
+    EXPECT_EQ(0, ::getsockname(listener, reinterpret_cast<struct sockaddr*>(&addr), &addr_len));
+
+    host_proxy = ::socket(AF_INET, SOCK_STREAM, 0);
+    EXPECT_EQ(0, ::connect(host_proxy, reinterpret_cast<struct sockaddr*>(&addr), addr_len));
+    adb_server = ::accept(listener, nullptr, nullptr);
+    EXPECT_LE(0, adb_server);
+    ::close(listener);
+  }
+
+  ~AdbTopology() {
+    for (const auto fd : {guest, guest_proxy, host_proxy, adb_server})
+      if (fd >= 0) ::close(fd);
+  }
+
+  int guest = -1;
+  int guest_proxy = -1;
+  int host_proxy = -1;
+  int adb_server = -1;
+};
+
+void write_pattern(int fd, std::size_t total) {
+  std::vector<std::uint8_t> chunk(64 * 1024);
+  for (std::size_t written = 0; written < total;) {
+    const auto size = std::min(chunk.size(), total - written);
+    for (std::size_t n = 0; n < size; n++)
+      chunk[n] = static_cast<std::uint8_t>((written + n) * 7);
+    for (std::size_t offset = 0; offset < size;) {
+      const auto n = ::write(fd, chunk.data() + offset, size - offset);
+      ASSERT_LT(0, n);
+      offset += n;
+    }
+    written += size;
+  }
+}
+
+void read_pattern(int fd, std::size_t total) {
+  std::vector<std::uint8_t> chunk(64 * 1024);
+  for (std::size_t received = 0; received < total;) {
+    const auto n = ::read(fd, chunk.data(), std::min(chunk.size(), total - received));
+    ASSERT_LT(0, n);
+    for (ssize_t m = 0; m < n; m++)
+      ASSERT_EQ(static_cast<std::uint8_t>((received + m) * 7), chunk[m]);
+    received += n;
+  }
+}
+
+void echo(int fd, std::size_t total) {
+  std::vector<std::uint8_t> chunk(64 * 1024);
+  for (std::size_t echoed = 0; echoed < total;) {
+    const auto n = ::read(fd, chunk.data(), chunk.size());
+    ASSERT_LT(0, n);
+    for (ssize_t offset = 0; offset < n;) {
+      const auto m = ::write(fd, chunk.data() + offset, n - offset);
+      ASSERT_LT(0, m);
+      offset += m;
+    }
+    echoed += n;
+  }
+}
+}  // namespace
+
+TEST(SpliceProxy, ForwardsDataInBothDirections) {
+  auto rt = Runtime::create(2);
+  rt->start();
+
+  AdbTopology topology;
+  auto proxy = std::make_shared<SpliceProxy>(rt, topology.guest_proxy, topology.host_proxy);
+  proxy->start([]() {});
+
+  const std::size_t total = 16 * 1024 * 1024;
+  std::thread adb_server([&]() { echo(topology.adb_server, total); });
+  std::thread writer([&]() { write_pattern(topology.guest, total); });
+  read_pattern(topology.guest, total);
+
+  writer.join();
+  adb_server.join();
+
+  EXPECT_EQ(total, proxy->forwarded_to_first());
+  EXPECT_EQ(total, proxy->forwarded_to_second());
+
+  proxy->stop();
+  rt->stop();
+}
+
+TEST(SpliceProxy, StopsReadingWhenPeerDoesNotConsume) {
+  auto rt = Runtime::create(1);
+  rt->start();
+
+  AdbTopology topology;
+  auto proxy = std::make_shared<SpliceProxy>(rt, topology.guest_proxy, topology.host_proxy);
+  proxy->start([]() {});
+
+  // Fill everything between the guest and the adb server, which doesn't
+  // read anything yet, until the guest can't write anymore.
+  std::vector<std::uint8_t> chunk(64 * 1024, 0x42);
+  std::size_t written = 0;
+  for (int idle_rounds = 0; idle_rounds < 5;) {
+    const auto n = ::send(topology.guest, chunk.data(), chunk.size(), MSG_DONTWAIT);
+    if (n > 0) {
+      written += n;
+      idle_rounds = 0;
+      continue;
+    }
+    ASSERT_EQ(EAGAIN, errno);
+    idle_rounds++;
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+  }
+
+  // The proxy itself only buffers a pipe worth of data, everything else
+  // sits in the socket buffers of the kernel.
+  EXPECT_LT(written, std::size_t{64 * 1024 * 1024});
+
+  std::size_t received = 0;
+  while (received < written) {
+    const auto n = ::read(topology.adb_server, chunk.data(), chunk.size());
+    ASSERT_LT(0, n);
+    received += n;
+  }
+  EXPECT_EQ(written, received);
+  EXPECT_EQ(written, proxy->forwarded_to_second());
+
+  proxy->stop();
+  rt->stop();
+}
+
+TEST(SpliceProxy, FinishesWhenPeerCloses) {
+  auto rt = Runtime::create(1);
+  rt->start();
+
+  AdbTopology topology;
+  auto proxy = std::make_shared<SpliceProxy>(rt, topology.guest_proxy, topology.host_proxy);
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+  proxy->start([&]() {
+    std::lock_guard<std::mutex> l(mutex);
+    done = true;
+    cv.notify_all();
+  });
+
+  const std::string message{"OKAY"};
+  ASSERT_EQ(static_cast<ssize_t>(message.size()), ::write(topology.adb_server, message.data(), message.size()));
+  ::close(topology.adb_server);
+  topology.adb_server = -1;
+
+  // Data sent before closing still reaches the guest, followed by the end
+  // of the stream.
+  std::array<char, 4> buffer;
+  ASSERT_EQ(static_cast<ssize_t>(buffer.size()), ::read(topology.guest, buffer.data(), buffer.size()));
+  EXPECT_EQ(message, std::string(buffer.data(), buffer.size()));
+  EXPECT_EQ(0, ::read(topology.guest, buffer.data(), buffer.size()));
+
+  // The guest closing its side as well finishes the proxy
+  ::close(topology.guest);
+  topology.guest = -1;
+
+  std::unique_lock<std::mutex> l(mutex);
+  EXPECT_TRUE(cv.wait_for(l, std::chrono::seconds{5}, [&]() { return done; }));
+
+  rt->stop();
+}
+
+TEST(SpliceProxy, DeliversReplyAfterHalfClose) {
+  auto rt = Runtime::create(1);
+  rt->start();
+
+  AdbTopology topology;
+  auto proxy = std::make_shared<SpliceProxy>(rt, topology.guest_proxy, topology.host_proxy);
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+  proxy->start([&]() {
+    std::lock_guard<std::mutex> l(mutex);
+    done = true;
+    cv.notify_all();
+  });
+
+  // The guest sends its request and shuts down its sending side
+  const std::string request{"host:version"};
+  ASSERT_EQ(static_cast<ssize_t>(request.size()), ::write(topology.guest, request.data(), request.size()));
+  ASSERT_EQ(0, ::shutdown(topology.guest, SHUT_WR));
+
+  // The server reads the request up to its end before it replies
+  std::string received;
+  std::array<char, 64> buffer;
+  for (;;) {
+    const auto n = ::read(topology.adb_server, buffer.data(), buffer.size());
+    ASSERT_LE(0, n);
+    if (n == 0) break;
+    received.append(buffer.data(), n);
+  }
+  EXPECT_EQ(request, received);
+
+  const std::string reply{"OKAY0004001f"};
+  ASSERT_EQ(static_cast<ssize_t>(reply.size()), ::write(topology.adb_server, reply.data(), reply.size()));
+  ::close(topology.adb_server);
+  topology.adb_server = -1;
+
+  received.clear();
+  for (;;) {
+    const auto n = ::read(topology.guest, buffer.data(), buffer.size());
+    ASSERT_LE(0, n);
+    if (n == 0) break;
+    received.append(buffer.data(), n);
+  }
+  EXPECT_EQ(reply, received);
+
+  std::unique_lock<std::mutex> l(mutex);
+  EXPECT_TRUE(cv.wait_for(l, std::chrono::seconds{5}, [&]() { return done; }));
+  EXPECT_EQ(request.size(), proxy->forwarded_to_second());
+  EXPECT_EQ(reply.size(), proxy->forwarded_to_first());
+
+  rt->stop();
+}
+}  // namespace network
+}  // namespace anbox
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/camera/converter.h"
+#include "anbox/camera/frame_ring.h"
+#include "anbox/camera/manager.h"
+#include "anbox/camera/synthetic_source.h"
+#include "anbox/qemu/camera_message_processor.h"
+#include "anbox/utils.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace anbox {
+namespace qemu {
+namespace {
+// Plays the part of the camera HAL and decodes the replies of the camera
+// service.
+class CameraClient : public network::SocketMessenger {
+ public:
+  // network::SocketMessenger
+  network::Credentials creds() const override { return {0, 0, 0}; }
+  unsigned short local_port() const override { return 0; }
+  void set_no_delay() override {}
+  void close() override {}
+  void send_fds(std::vector<Fd> const &fds) override {
+    fds_.insert(fds_.end(), fds.begin(), fds.end());
+  }
+  int native_handle() const override { return -1; }
+
+  // network::MessageSender
+  void send(char const *data, size_t length) override {
+    struct iovec buffer = {const_cast<char *>(data), length};
+    send_vectored(&buffer, 1);
+  }
+  ssize_t send_raw(char const *data, size_t length) override {
+    send(data, length);
+    return length;
+  }
+  void send_vectored(struct iovec const *buffers, size_t count) override {
+    std::string data;
+    for (size_t n = 0; n < count; n++)
+      data.append(static_cast<const char *>(buffers[n].iov_base), buffers[n].iov_len);
+
+    ASSERT_GE(data.size(), 11u);
+    ASSERT_EQ(data.size() - 8, std::strtoul(data.substr(0, 8).c_str(), nullptr, 16));
+    replies_.push_back(data.substr(8));
+  }
+
+  // network::MessageReceiver
+  void async_receive_msg(AnboxReadHandler const &,
+                         boost::asio::mutable_buffers_1 const &) override {}
+  boost::system::error_code receive_msg(
+      boost::asio::mutable_buffers_1 const &) override {
+    return boost::system::error_code{};
+  }
+  size_t available_bytes() override { return 0; }
+
+  std::string last_reply() const { return replies_.empty() ? "" : replies_.back(); }
+  const std::vector<Fd> &fds() const { return fds_; }
+
+ private:
+  std::vector<std::string> replies_;
+  std::vector<Fd> fds_;
+};
+
+void query(CameraMessageProcessor &processor, const std::string &q) {
+  std::vector<std::uint8_t> data(q.begin(), q.end());
+  data.push_back('\0');
+  processor.process_data(data);
+}
+
+const std::string ok{"ok", 3};
+
+class CameraMessageProcessorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    camera::Manager::get()->add_source(std::make_shared<camera::SyntheticSource>());
+  }
+  void TearDown() override {
+    camera::Manager::get()->remove_source("synthetic");
+  }
+
+  std::shared_ptr<CameraClient> client{std::make_shared<CameraClient>()};
+};
+
+std::string start_query(int width, int height, camera::PixelFormat format) {
+  return utils::string_format("start dim=%dx%d pix=%d", width, height,
+                              static_cast<std::uint32_t>(format));
+}
+}  // namespace
+
+TEST_F(CameraMessageProcessorTest, FactoryListsCameras) {
+  CameraMessageProcessor processor(client);
+  query(processor, "list");
+  const auto reply = client->last_reply();
+  ASSERT_EQ("ok:", reply.substr(0, 3));
+  EXPECT_NE(std::string::npos, reply.find("name=synthetic "));
+  EXPECT_NE(std::string::npos, reply.find(" dir=back "));
+  EXPECT_NE(std::string::npos, reply.find(" framedims=640x480,"));
+  EXPECT_EQ(std::string("\n", 2), reply.substr(reply.size() - 2));
+}
+
+TEST_F(CameraMessageProcessorTest, DeliversFramesInReplies) {
+  CameraMessageProcessor processor(client, "name=synthetic");
+  query(processor, "frame video=0 preview=0");
+  EXPECT_EQ("ko:", client->last_reply().substr(0, 3));
+
+  query(processor, "connect");
+  EXPECT_EQ(ok, client->last_reply());
+  query(processor, start_query(320, 240, camera::PixelFormat::nv21));
+  EXPECT_EQ(ok, client->last_reply());
+
+  const auto video_size = camera::frame_size(camera::PixelFormat::nv21, 320, 240);
+  const auto preview_size = 320 * 240 * 4;
+  query(processor, utils::string_format(
+      "frame video=%d preview=%d whiteb=1,1,1 expcomp=1", video_size, preview_size));
+  const auto reply = client->last_reply();
+  ASSERT_EQ("ok:", reply.substr(0, 3));
+  EXPECT_EQ(3 + video_size + preview_size, reply.size());
+
+  query(processor, "frame video=42 preview=0");
+  EXPECT_EQ("ko:", client->last_reply().substr(0, 3));
+
+  query(processor, "stop");
+  EXPECT_EQ(ok, client->last_reply());
+  query(processor, "disconnect");
+  EXPECT_EQ(ok, client->last_reply());
+}
+
+TEST_F(CameraMessageProcessorTest, DeliversFramesThroughSharedMemory) {
+  CameraMessageProcessor processor(client, "name=synthetic");
+  query(processor, "connect");
+  query(processor, start_query(176, 144, camera::PixelFormat::yuv420) + " shm");
+  ASSERT_EQ("ok:shm=", client->last_reply().substr(0, 7));
+  ASSERT_EQ(1u, client->fds().size());
+
+  const auto ring = camera::FrameRing::attach(client->fds()[0]);
+  const auto video_size = camera::frame_size(camera::PixelFormat::yuv420, 176, 144);
+  query(processor, utils::string_format("frame video=%d preview=0", video_size));
+  const auto expected = utils::string_format("ok:slot=0,%d,0", video_size);
+  ASSERT_EQ(expected, client->last_reply().substr(0, client->last_reply().size() - 1));
+
+  std::vector<std::uint8_t> out(ring->slot_size());
+  camera::FrameRing::SlotInfo info;
+  ASSERT_TRUE(ring->read(0, out.data(), info));
+  EXPECT_EQ(video_size, info.video_size);
+  EXPECT_EQ(0u, info.preview_size);
+}
+
+TEST_F(CameraMessageProcessorTest, RejectsInvalidStartParameters) {
+  CameraMessageProcessor processor(client, "name=synthetic");
+  query(processor, start_query(320, 240, camera::PixelFormat::nv21));
+  EXPECT_EQ("ko:", client->last_reply().substr(0, 3));
+
+  query(processor, "connect");
+  query(processor, start_query(321, 240, camera::PixelFormat::nv21));
+  EXPECT_EQ("ko:", client->last_reply().substr(0, 3));
+  query(processor, "start dim=320x240 pix=1234");
+  EXPECT_EQ("ko:", client->last_reply().substr(0, 3));
+}
+
+TEST_F(CameraMessageProcessorTest, UnknownCameraCannotBeConnected) {
+  CameraMessageProcessor processor(client, "name=unknown");
+  query(processor, "connect");
+  EXPECT_EQ("ko:", client->last_reply().substr(0, 3));
+}
+
+TEST_F(CameraMessageProcessorTest, CameraIsOnlyUsedByOneClient) {
+  auto other_client = std::make_shared<CameraClient>();
+  CameraMessageProcessor processor(client, "name=synthetic");
+  query(processor, "connect");
+  ASSERT_EQ(ok, client->last_reply());
+
+  {
+    CameraMessageProcessor other(other_client, "name=synthetic");
+    query(other, "connect");
+    EXPECT_EQ("ko:", other_client->last_reply().substr(0, 3));
+  }
+
+  query(processor, "disconnect");
+  ASSERT_EQ(ok, client->last_reply());
+
+  CameraMessageProcessor other(other_client, "name=synthetic");
+  query(other, "connect");
+  EXPECT_EQ(ok, other_client->last_reply());
+}
+}  // namespace qemu
+}  // namespace anbox
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/qemu/frame_parser.h"
+
+#include <string>
+#include <vector>
+
+namespace anbox {
+namespace qemu {
+namespace {
+std::vector<std::uint8_t> bytes(const std::string &s) {
+  return std::vector<std::uint8_t>(s.begin(), s.end());
+}
+
+struct Collector {
+  FrameParser::FrameHandler handler() {
+    return [this](const boost::string_view &frame) {
+      frames.push_back(frame.to_string());
+    };
+  }
+  std::vector<std::string> frames;
+};
+}  // namespace
+
+TEST(FrameParser, LengthPrefixedHandlesMultipleFramesPerChunk) {
+  auto parser = FrameParser::length_prefixed();
+  Collector c;
+
+  ASSERT_TRUE(parser.feed(bytes("0004list000clist-sensors0000"), c.handler()));
+  ASSERT_EQ(3u, c.frames.size());
+  EXPECT_EQ("list", c.frames[0]);
+  EXPECT_EQ("list-sensors", c.frames[1]);
+  EXPECT_EQ("", c.frames[2]);
+  EXPECT_EQ(0u, parser.pending());
+}
+
+TEST(FrameParser, LengthPrefixedReassemblesPartialFrames) {
+  auto parser = FrameParser::length_prefixed();
+  Collector c;
+
+  const std::string stream{"000dretrieve-icon0006listen"};
+  for (const auto &byte : stream) {
+    ASSERT_TRUE(parser.feed(bytes(std::string(1, byte)), c.handler()));
+  }
+
+  ASSERT_EQ(2u, c.frames.size());
+  EXPECT_EQ("retrieve-icon", c.frames[0]);
+  EXPECT_EQ("listen", c.frames[1]);
+  EXPECT_EQ(0u, parser.pending());
+}
+
+TEST(FrameParser, LengthPrefixedKeepsTrailingPartialFrame) {
+  auto parser = FrameParser::length_prefixed();
+  Collector c;
+
+  ASSERT_TRUE(parser.feed(bytes("0004list0006lis"), c.handler()));
+  ASSERT_EQ(1u, c.frames.size());
+  EXPECT_EQ(7u, parser.pending());
+
+  ASSERT_TRUE(parser.feed(bytes("ten0004list"), c.handler()));
+  ASSERT_EQ(3u, c.frames.size());
+  EXPECT_EQ("listen", c.frames[1]);
+  EXPECT_EQ("list", c.frames[2]);
+  EXPECT_EQ(0u, parser.pending());
+}
+
+TEST(FrameParser, LengthPrefixedRejectsInvalidHeader) {
+  auto parser = FrameParser::length_prefixed();
+  Collector c;
+
+  EXPECT_FALSE(parser.feed(bytes("zzzzlist"), c.handler()));
+  EXPECT_TRUE(c.frames.empty());
+  EXPECT_EQ(0u, parser.pending());
+
+  // The parser starts over with the next chunk
+  ASSERT_TRUE(parser.feed(bytes("0004list"), c.handler()));
+  ASSERT_EQ(1u, c.frames.size());
+}
+
+TEST(FrameParser, NulDelimitedSplitsFrames) {
+  auto parser = FrameParser::nul_delimited();
+  Collector c;
+
+  std::vector<std::uint8_t> data{'l', 'i', 's', 't', 0, 'c', 'o'};
+  ASSERT_TRUE(parser.feed(data, c.handler()));
+  ASSERT_EQ(1u, c.frames.size());
+  EXPECT_EQ("list", c.frames[0]);
+  EXPECT_EQ(2u, parser.pending());
+
+  data = {'n', 'n', 'e', 'c', 't', 0, 0};
+  ASSERT_TRUE(parser.feed(data, c.handler()));
+  ASSERT_EQ(3u, c.frames.size());
+  EXPECT_EQ("connect", c.frames[1]);
+  EXPECT_EQ("", c.frames[2]);
+}
+
+TEST(FrameParser, DelimitedAcceptsAnyOfTheDelimiters) {
+  auto parser = FrameParser::delimited("\r\n");
+  Collector c;
+
+  ASSERT_TRUE(parser.feed(bytes("ATE0Q0V1\r\nAT+CFUN?\rAT+C"), c.handler()));
+  ASSERT_EQ(3u, c.frames.size());
+  EXPECT_EQ("ATE0Q0V1", c.frames[0]);
+  EXPECT_EQ("", c.frames[1]);
+  EXPECT_EQ("AT+CFUN?", c.frames[2]);
+  EXPECT_EQ(4u, parser.pending());
+}
+
+TEST(FrameParser, DelimitedDropsOversizedFrames) {
+  auto parser = FrameParser::nul_delimited();
+  Collector c;
+
+  const std::vector<std::uint8_t> data(FrameParser::max_frame_size + 1, 'a');
+  EXPECT_FALSE(parser.feed(data, c.handler()));
+  EXPECT_TRUE(c.frames.empty());
+  EXPECT_EQ(0u, parser.pending());
+}
+}  // namespace qemu
+}  // namespace anbox
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/qemu/pipe_handshake.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace anbox {
+namespace qemu {
+namespace {
+// Hands out whatever the test feeds it as result of the pending read.
+class HandshakeClient : public network::SocketMessenger {
+ public:
+  // network::SocketMessenger
+  network::Credentials creds() const override { return {0, 0, 0}; }
+  unsigned short local_port() const override { return 0; }
+  void set_no_delay() override {}
+  void close() override {}
+  void send_fds(std::vector<Fd> const &) override {}
+  int native_handle() const override { return -1; }
+
+  // network::MessageSender
+  void send(char const *, size_t) override {}
+  ssize_t send_raw(char const *, size_t length) override { return length; }
+  void send_vectored(struct iovec const *, size_t) override {}
+
+  // network::MessageReceiver
+  void async_receive_msg(AnboxReadHandler const &handler,
+                         boost::asio::mutable_buffers_1 const &buffer) override {
+    handler_ = handler;
+    buffer_ = buffer;
+  }
+  boost::system::error_code receive_msg(
+      boost::asio::mutable_buffers_1 const &) override {
+    return boost::system::error_code{};
+  }
+  size_t available_bytes() override { return 0; }
+
+  bool reading() const { return static_cast<bool>(handler_); }
+
+  void feed(const std::string &data) {
+    ASSERT_TRUE(reading());
+    ASSERT_LE(data.size(), boost::asio::buffer_size(buffer_));
+    std::memcpy(boost::asio::buffer_cast<void *>(buffer_), data.data(), data.size());
+    auto handler = handler_;
+    handler_ = nullptr;
+    handler(boost::system::error_code{}, data.size());
+  }
+
+ private:
+  AnboxReadHandler handler_;
+  boost::asio::mutable_buffers_1 buffer_{nullptr, 0};
+};
+
+struct Handshake {
+  explicit Handshake(std::size_t header_size)
+      : client{std::make_shared<HandshakeClient>()},
+        handshake{std::make_shared<PipeHandshake>(
+            client,
+            [header_size](const std::string &) { return header_size; },
+            [this](const std::shared_ptr<PipeHandshake> &) { completed++; })} {
+    handshake->start();
+  }
+
+  std::shared_ptr<HandshakeClient> client;
+  std::shared_ptr<PipeHandshake> handshake;
+  int completed = 0;
+};
+
+std::string bytes(const std::vector<std::uint8_t> &data) {
+  return std::string(data.begin(), data.end());
+}
+}  // namespace
+
+TEST(PipeHandshake, ReassemblesIdentifierSplitAcrossReads) {
+  Handshake h{0};
+
+  h.client->feed("pipe:qemud");
+  EXPECT_EQ(0, h.completed);
+  h.client->feed(":sens");
+  EXPECT_EQ(0, h.completed);
+  h.client->feed(std::string("ors\0", 4));
+
+  ASSERT_EQ(1, h.completed);
+  EXPECT_EQ("pipe:qemud:sensors", h.handshake->identifier());
+  EXPECT_TRUE(h.handshake->header().empty());
+  EXPECT_TRUE(h.handshake->leftover().empty());
+  EXPECT_FALSE(h.client->reading());
+}
+
+TEST(PipeHandshake, DropsOverlongIdentifier) {
+  Handshake h{0};
+
+  const std::string chunk(100, 'a');
+  h.client->feed(chunk);
+  h.client->feed(chunk);
+  h.client->feed(chunk);
+
+  EXPECT_EQ(0, h.completed);
+  EXPECT_FALSE(h.client->reading());
+}
+
+TEST(PipeHandshake, DropsOverlongIdentifierWithinSingleRead) {
+  Handshake h{0};
+
+  h.client->feed(std::string(PipeHandshake::max_identifier_size, 'a') + '\0');
+
+  EXPECT_EQ(0, h.completed);
+  EXPECT_FALSE(h.client->reading());
+}
+
+TEST(PipeHandshake, WaitsForHeaderSplitAcrossReads) {
+  Handshake h{4};
+
+  h.client->feed(std::string("pipe:opengles\0\x01", 15));
+  EXPECT_EQ(0, h.completed);
+  ASSERT_EQ("pipe:opengles", h.handshake->identifier());
+  h.client->feed("\x02");
+  EXPECT_EQ(0, h.completed);
+  h.client->feed("\x03\x04");
+
+  ASSERT_EQ(1, h.completed);
+  EXPECT_EQ("\x01\x02\x03\x04", bytes(h.handshake->header()));
+  EXPECT_TRUE(h.handshake->leftover().empty());
+}
+
+TEST(PipeHandshake, KeepsLeftoverData) {
+  Handshake h{2};
+
+  h.client->feed(std::string("pipe:opengles\0hdcommand", 23));
+
+  ASSERT_EQ(1, h.completed);
+  EXPECT_EQ("pipe:opengles", h.handshake->identifier());
+  EXPECT_EQ("hd", bytes(h.handshake->header()));
+  EXPECT_EQ("command", bytes(h.handshake->leftover()));
+}
+}  // namespace qemu
+}  // namespace anbox
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/qemu/frame_parser.h"
+#include "anbox/qemu/qemud_message_processor.h"
+
+namespace anbox {
+namespace qemu {
+namespace {
+// Collects everything written to it as one byte stream.
+class RecordingMessenger : public network::SocketMessenger {
+ public:
+  // network::SocketMessenger
+  network::Credentials creds() const override { return {0, 0, 0}; }
+  unsigned short local_port() const override { return 0; }
+  void set_no_delay() override {}
+  void close() override {}
+  void send_fds(std::vector<Fd> const &) override {}
+  int native_handle() const override { return -1; }
+
+  // network::MessageSender
+  void send(char const *data, size_t length) override {
+    struct iovec buffer = {const_cast<char *>(data), length};
+    send_vectored(&buffer, 1);
+  }
+  ssize_t send_raw(char const *data, size_t length) override {
+    send(data, length);
+    return length;
+  }
+  void send_vectored(struct iovec const *buffers, size_t count) override {
+    writes++;
+    for (size_t n = 0; n < count; n++) {
+      const auto begin = static_cast<const std::uint8_t *>(buffers[n].iov_base);
+      data.insert(data.end(), begin, begin + buffers[n].iov_len);
+    }
+  }
+
+  // network::MessageReceiver
+  void async_receive_msg(AnboxReadHandler const &,
+                         boost::asio::mutable_buffers_1 const &) override {}
+  boost::system::error_code receive_msg(
+      boost::asio::mutable_buffers_1 const &) override {
+    return boost::system::error_code{};
+  }
+  size_t available_bytes() override { return 0; }
+
+  std::size_t writes = 0;
+  std::vector<std::uint8_t> data;
+};
+
+class TestProcessor : public QemudMessageProcessor {
+ public:
+  TestProcessor() : QemudMessageProcessor(nullptr) {}
+
+  using QemudMessageProcessor::send_frames;
+
+ protected:
+  void handle_command(const boost::string_view &) override {}
+};
+
+std::vector<std::string> parse(const std::vector<std::uint8_t> &data) {
+  std::vector<std::string> frames;
+  auto parser = FrameParser::length_prefixed();
+  parser.feed(data, [&](const boost::string_view &frame) {
+    frames.push_back(frame.to_string());
+  });
+  return frames;
+}
+}  // namespace
+
+TEST(QemudMessageProcessor, SendsFramesInOneWrite) {
+  RecordingMessenger messenger;
+  TestProcessor::send_frames(messenger, {"first", "second"}, false);
+
+  EXPECT_EQ(1u, messenger.writes);
+  EXPECT_EQ(std::vector<std::string>({"first", "second"}), parse(messenger.data));
+}
+
+TEST(QemudMessageProcessor, SendsFramesOfMaximumSize) {
+  RecordingMessenger messenger;
+  const std::string frame(FrameParser::max_frame_size, 'a');
+  TestProcessor::send_frames(messenger, {frame}, false);
+
+  const auto frames = parse(messenger.data);
+  ASSERT_EQ(1u, frames.size());
+  EXPECT_EQ(frame, frames[0]);
+}
+
+TEST(QemudMessageProcessor, RejectsFramesTooBigForTheLengthHeader) {
+  RecordingMessenger messenger;
+  const std::string frame(FrameParser::max_frame_size + 1, 'a');
+  EXPECT_THROW(TestProcessor::send_frames(messenger, {"small", frame}, true),
+               std::runtime_error);
+  EXPECT_EQ(0u, messenger.writes);
+}
+}  // namespace qemu
+}  // namespace anbox
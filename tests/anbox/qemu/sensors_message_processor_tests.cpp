@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/qemu/frame_parser.h"
+#include "anbox/qemu/sensors_message_processor.h"
+#include "anbox/sensors/manager.h"
+#include "anbox/sensors/synthetic_source.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace anbox {
+namespace qemu {
+namespace {
+// Longest we wait for the processor to deliver something.
+constexpr const std::chrono::seconds delivery_timeout{5};
+
+// Plays the part of the sensors HAL: decodes everything the processor
+// writes and remembers how the events were split up into writes.
+class SensorsClient : public network::SocketMessenger {
+ public:
+  struct Write {
+    std::size_t events = 0;
+    std::size_t syncs = 0;
+  };
+
+  SensorsClient() : parser_(FrameParser::length_prefixed()) {}
+
+  // network::SocketMessenger
+  network::Credentials creds() const override { return {0, 0, 0}; }
+  unsigned short local_port() const override { return 0; }
+  void set_no_delay() override {}
+  void close() override {}
+  void send_fds(std::vector<Fd> const &) override {}
+  int native_handle() const override { return -1; }
+
+  // network::MessageSender
+  void send(char const *data, size_t length) override {
+    struct iovec buffer = {const_cast<char *>(data), length};
+    send_vectored(&buffer, 1);
+  }
+  ssize_t send_raw(char const *data, size_t length) override {
+    send(data, length);
+    return length;
+  }
+  void send_vectored(struct iovec const *buffers, size_t count) override {
+    std::vector<std::uint8_t> data;
+    for (size_t n = 0; n < count; n++) {
+      const auto begin = static_cast<const std::uint8_t *>(buffers[n].iov_base);
+      data.insert(data.end(), begin, begin + buffers[n].iov_len);
+    }
+
+    std::lock_guard<std::mutex> l(lock_);
+    Write write;
+    parser_.feed(data, [&](const boost::string_view &frame) {
+      if (frame.starts_with("sync:")) {
+        write.syncs++;
+        syncs_.push_back(std::stoll(frame.substr(5).to_string()));
+      } else {
+        write.events++;
+        events_.push_back(frame.to_string());
+      }
+    });
+    writes_.push_back(write);
+    changed_.notify_all();
+  }
+
+  // network::MessageReceiver
+  void async_receive_msg(AnboxReadHandler const &,
+                         boost::asio::mutable_buffers_1 const &) override {}
+  boost::system::error_code receive_msg(
+      boost::asio::mutable_buffers_1 const &) override {
+    return boost::system::error_code{};
+  }
+  size_t available_bytes() override { return 0; }
+
+  std::vector<Write> writes() const {
+    std::lock_guard<std::mutex> l(lock_);
+    return writes_;
+  }
+  std::vector<std::string> events() const {
+    std::lock_guard<std::mutex> l(lock_);
+    return events_;
+  }
+  std::vector<long long> syncs() const {
+    std::lock_guard<std::mutex> l(lock_);
+    return syncs_;
+  }
+
+  // Wait until at least count writes or samples arrived. They return false
+  // if that didn't happen within the delivery timeout.
+  bool wait_for_writes(std::size_t count) const {
+    std::unique_lock<std::mutex> l(lock_);
+    return changed_.wait_for(l, delivery_timeout, [&]() { return writes_.size() >= count; });
+  }
+  bool wait_for_syncs(std::size_t count) const {
+    std::unique_lock<std::mutex> l(lock_);
+    return changed_.wait_for(l, delivery_timeout, [&]() { return syncs_.size() >= count; });
+  }
+
+ private:
+  mutable std::mutex lock_;
+  mutable std::condition_variable changed_;
+  FrameParser parser_;
+  std::vector<Write> writes_;
+  std::vector<std::string> events_;
+  std::vector<long long> syncs_;
+};
+
+void send_command(SensorsMessageProcessor &processor,
+                  const std::string &command) {
+  char header[5];
+  std::snprintf(header, sizeof(header), "%04zx", command.size());
+  std::vector<std::uint8_t> data(header, header + 4);
+  data.insert(data.end(), command.begin(), command.end());
+  processor.process_data(data);
+}
+
+struct SensorsMessageProcessorTest : public ::testing::Test {
+  void SetUp() override {
+    sensors::Manager::get()->set_source(
+        std::make_shared<sensors::SyntheticSource>());
+    rt->start();
+  }
+
+  void TearDown() override {
+    rt->stop();
+    sensors::Manager::get()->set_source(
+        sensors::Manager::create_source("static"));
+  }
+
+  std::shared_ptr<Runtime> rt = Runtime::create(1);
+  std::shared_ptr<SensorsClient> client = std::make_shared<SensorsClient>();
+};
+}  // namespace
+
+TEST_F(SensorsMessageProcessorTest, ListsAvailableSensors) {
+  SensorsMessageProcessor processor(client, rt);
+  send_command(processor, "list-sensors");
+
+  // The mask is a single message terminated by a NUL byte
+  const auto events = client->events();
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ(std::to_string(sensors::all_sensors), events[0]);
+}
+
+TEST_F(SensorsMessageProcessorTest, AnswersWake) {
+  SensorsMessageProcessor processor(client, rt);
+  send_command(processor, "wake");
+
+  const auto events = client->events();
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ("wake", events[0]);
+}
+
+TEST_F(SensorsMessageProcessorTest, DeliversAtRequestedRateInBatches) {
+  const std::chrono::milliseconds delivery_period{50};
+  const std::size_t num_samples = 100;
+
+  SensorsMessageProcessor processor(client, rt, delivery_period);
+  send_command(processor, "set-delay:5");
+  send_command(processor, "set:acceleration:1");
+  send_command(processor, "set:light:1");
+  ASSERT_TRUE(client->wait_for_syncs(num_samples));
+  send_command(processor, "set:acceleration:0");
+  send_command(processor, "set:light:0");
+
+  // A batch taken before the sensors were disabled might still be on its
+  // way to us.
+  const auto stats = processor.statistics();
+  ASSERT_TRUE(client->wait_for_writes(stats.writes));
+
+  // Samples are written out once per delivery period and not one by one
+  const auto writes = client->writes();
+  EXPECT_EQ(stats.writes, writes.size());
+  EXPECT_GE(stats.samples / writes.size(), 5u);
+
+  // Every sample has one event per enabled sensor before its sync
+  std::size_t syncs = 0;
+  for (const auto &write : writes) {
+    EXPECT_EQ(2 * write.syncs, write.events);
+    syncs += write.syncs;
+  }
+  EXPECT_EQ(stats.samples, syncs);
+
+  // Sample timestamps are spaced by the requested delay
+  const auto timestamps = client->syncs();
+  for (std::size_t n = 1; n < timestamps.size(); n++)
+    EXPECT_EQ(5000, timestamps[n] - timestamps[n - 1]);
+
+  const auto events = client->events();
+  ASSERT_LE(2u, events.size());
+  EXPECT_EQ(0u, events[0].find("acceleration:"));
+  EXPECT_EQ(0u, events[1].find("light:"));
+}
+
+TEST_F(SensorsMessageProcessorTest, StopsDeliveringWhenDisabled) {
+  const std::chrono::milliseconds delivery_period{10};
+
+  SensorsMessageProcessor processor(client, rt, delivery_period);
+  send_command(processor, "set-delay:10");
+  send_command(processor, "set:magnetic-field:1");
+  ASSERT_TRUE(client->wait_for_syncs(1));
+  send_command(processor, "set:magnetic-field:0");
+
+  const auto stats = processor.statistics();
+  EXPECT_GT(stats.samples, 0u);
+  ASSERT_TRUE(client->wait_for_writes(stats.writes));
+
+  const auto events = client->events();
+  ASSERT_FALSE(events.empty());
+  EXPECT_EQ(0u, events[0].find("magnetic:"));
+
+  // Nothing tells us that no further delivery happens, so give it a few
+  // delivery periods.
+  std::this_thread::sleep_for(5 * delivery_period);
+  EXPECT_EQ(stats.samples, processor.statistics().samples);
+  EXPECT_EQ(stats.writes, client->writes().size());
+}
+
+TEST_F(SensorsMessageProcessorTest, IgnoresInvalidCommands) {
+  SensorsMessageProcessor processor(client, rt);
+  send_command(processor, "set:gyroscope:1");
+  send_command(processor, "set:acceleration");
+  send_command(processor, "bogus");
+  std::this_thread::sleep_for(std::chrono::milliseconds{50});
+  EXPECT_TRUE(client->writes().empty());
+}
+}  // namespace qemu
+}  // namespace anbox
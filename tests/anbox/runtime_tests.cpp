@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/runtime.h"
+
+#include <condition_variable>
+#include <future>
+
+namespace anbox {
+TEST(Runtime, UnknownExecutorFallsBackToDefault) {
+  auto rt = Runtime::create(1);
+  EXPECT_EQ(rt->executor(), rt->executor("unknown"));
+  EXPECT_EQ(&rt->service(), &rt->service("unknown"));
+
+  auto input = rt->add_executor({"input", 1, Runtime::Priority::normal, {}});
+  EXPECT_EQ(input, rt->executor("input"));
+  EXPECT_NE(&rt->service(), &rt->service("input"));
+}
+
+TEST(Runtime, RejectsDuplicateExecutors) {
+  auto rt = Runtime::create(1);
+  rt->add_executor({"audio", 1, Runtime::Priority::normal, {}});
+  EXPECT_THROW(rt->add_executor({"audio", 1, Runtime::Priority::normal, {}}), std::runtime_error);
+}
+
+TEST(Runtime, BlockedExecutorDoesNotDelayOthers) {
+  auto rt = Runtime::create(1);
+  rt->add_executor({"input", 1, Runtime::Priority::normal, {}});
+  rt->start();
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool blocked = true;
+  rt->service().post([&]() {
+    std::unique_lock<std::mutex> l(mutex);
+    cv.wait(l, [&]() { return !blocked; });
+  });
+
+  std::promise<void> delivered;
+  rt->service("input").post([&]() { delivered.set_value(); });
+  EXPECT_EQ(std::future_status::ready,
+            delivered.get_future().wait_for(std::chrono::seconds{5}));
+
+  {
+    std::lock_guard<std::mutex> l(mutex);
+    blocked = false;
+  }
+  cv.notify_all();
+
+  rt->stop();
+}
+
+TEST(Runtime, ExecutorTracksQueueLatency) {
+  auto rt = Runtime::create(1);
+  auto executor = rt->executor();
+  rt->start();
+
+  // Keep the only thread busy for a few probe intervals so the probe gets
+  // delayed.
+  const auto blocked_for = 3 * Runtime::Executor::probe_interval;
+  executor->service().post([&]() { std::this_thread::sleep_for(blocked_for); });
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+  while (executor->queue_latency().max() < Runtime::Executor::probe_interval &&
+         std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+
+  EXPECT_LE(Runtime::Executor::probe_interval, executor->queue_latency().max());
+
+  const auto stats = rt->statistics();
+  EXPECT_EQ(1u, stats.at("default_threads"));
+  EXPECT_LE(1u, stats.at("default_queue_latency_count"));
+
+  rt->stop();
+}
+
+TEST(Runtime, ExecutorTracksPostedTasks) {
+  auto rt = Runtime::create(1);
+  auto executor = rt->executor();
+
+  // Nothing runs before the runtime is started, so all tasks stay queued.
+  const auto busy_for = std::chrono::milliseconds{20};
+  std::promise<void> done;
+  boost::asio::io_service::strand strand{executor->service()};
+  executor->post([&]() { std::this_thread::sleep_for(busy_for); });
+  executor->post(strand, [&]() { std::this_thread::sleep_for(busy_for); });
+  executor->post([&]() { done.set_value(); });
+  EXPECT_EQ(3u, executor->queue_depth());
+
+  rt->start();
+  ASSERT_EQ(std::future_status::ready,
+            done.get_future().wait_for(std::chrono::seconds{5}));
+
+  // The depth is only updated once the last handler returned.
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+  while (executor->queue_depth() > 0 && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+
+  EXPECT_EQ(0u, executor->queue_depth());
+  EXPECT_EQ(3u, executor->handler_latency().count());
+  EXPECT_LE(busy_for, executor->handler_latency().max());
+
+  const auto stats = rt->statistics();
+  EXPECT_EQ(0u, stats.at("default_queue_depth"));
+  EXPECT_EQ(3u, stats.at("default_handler_latency_count"));
+
+  rt->stop();
+}
+}  // namespace anbox
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2017 Simon Fels <morphis@gravedo.de>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3, as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "anbox/sensors/replay_source.h"
+
+#include <sstream>
+
+namespace anbox {
+namespace sensors {
+TEST(ReplaySource, HoldsValuesUntilNextEntryAndLoops) {
+  std::istringstream recording(
+      "# time sensor values\n"
+      "0 acceleration 0 9.81 0\n"
+      "0 light 100\n"
+      "\n"
+      "100 acceleration 9.81 0 0\n"
+      "200 light 200\n");
+  const auto start = std::chrono::steady_clock::now();
+  ReplaySource source(recording, start);
+
+  EXPECT_EQ(mask_for(Type::acceleration) | mask_for(Type::light),
+            source.available());
+
+  Values values;
+  ASSERT_TRUE(source.sample(Type::acceleration, start + std::chrono::milliseconds{50}, values));
+  EXPECT_FLOAT_EQ(9.81f, values[1]);
+  ASSERT_TRUE(source.sample(Type::acceleration, start + std::chrono::milliseconds{150}, values));
+  EXPECT_FLOAT_EQ(9.81f, values[0]);
+  ASSERT_TRUE(source.sample(Type::light, start + std::chrono::milliseconds{150}, values));
+  EXPECT_FLOAT_EQ(100.0f, values[0]);
+
+  // The recording is 200ms long so 250ms is 50ms into the second iteration
+  ASSERT_TRUE(source.sample(Type::acceleration, start + std::chrono::milliseconds{250}, values));
+  EXPECT_FLOAT_EQ(9.81f, values[1]);
+
+  EXPECT_FALSE(source.sample(Type::proximity, start, values));
+}
+
+TEST(ReplaySource, RejectsInvalidRecordings) {
+  std::istringstream unknown_sensor("0 gyroscope 1 2 3\n");
+  EXPECT_THROW(ReplaySource{unknown_sensor}, std::runtime_error);
+
+  std::istringstream missing_values("0 acceleration 1 2\n");
+  EXPECT_THROW(ReplaySource{missing_values}, std::runtime_error);
+
+  std::istringstream unsorted("100 light 1\n50 light 2\n");
+  EXPECT_THROW(ReplaySource{unsorted}, std::runtime_error);
+}
+}  // namespace sensors
+}  // namespace anbox